@@ -22,6 +22,8 @@
 #include "common/Shader/nvvk/spv/sky_simple.slang.h"
 #include "common/Shader/nvvk/spv/tonemapper.slang.h"
 #include "common/Shader/Shader.h"
+#include "feature/PathTracing/CPUBSDF.h"
+#include "feature/ReSTIRDI/ReSTIRDI.h"
 
 void FzbRenderer::Application::getAppInfoFromXML(nvapp::ApplicationCreateInfo& appInfo) {
 	std::filesystem::path exePath = nvutils::getExecutablePath().parent_path();
@@ -40,6 +42,25 @@ void FzbRenderer::Application::getAppInfoFromXML(nvapp::ApplicationCreateInfo& a
 	sceneResource.scenePath = rendererInfo.child("sceneXML").attribute("path").value();
 	sceneResource.scenePath = std::filesystem::absolute(exePath / TARGET_EXE_TO_SOURCE_DIRECTORY / "resources") / sceneResource.scenePath;
 
+	if (pugi::xml_node benchmarkNode = rendererInfo.child("primitivesBenchmark"))
+		primitivesBenchmarkCount = uint32_t(getIntFromString(benchmarkNode.attribute("value").value()));
+	if (pugi::xml_node bsdfValidationNode = rendererInfo.child("bsdfValidation"))
+		bsdfValidationCount = uint32_t(getIntFromString(bsdfValidationNode.attribute("value").value()));
+	if (pugi::xml_node samplerBenchmarkNode = rendererInfo.child("samplerBenchmark"))
+		samplerBenchmarkCount = uint32_t(getIntFromString(samplerBenchmarkNode.attribute("value").value()));
+	if (pugi::xml_node stringParsingBenchmarkNode = rendererInfo.child("stringParsingBenchmark"))
+		stringParsingBenchmarkCount = uint32_t(getIntFromString(stringParsingBenchmarkNode.attribute("value").value()));
+	if (pugi::xml_node restirValidationNode = rendererInfo.child("restirValidation"))
+		restirValidationCount = uint32_t(getIntFromString(restirValidationNode.attribute("value").value()));
+	if (pugi::xml_node cpuRenderNode = rendererInfo.child("cpuMotionBlurRender")) {
+		cpuPathTracerSetting.enable = true;
+		if (pugi::xml_attribute attribute = cpuRenderNode.attribute("spp")) cpuPathTracerSetting.spp = std::max(uint32_t(getIntFromString(attribute.value())), 1u);
+		if (pugi::xml_attribute attribute = cpuRenderNode.attribute("maxDepth")) cpuPathTracerSetting.maxDepth = uint32_t(getIntFromString(attribute.value()));
+		cpuPathTracerSetting.resolution = glm::uvec2(appInfo.windowSize.x, appInfo.windowSize.y);
+		std::string output = cpuRenderNode.attribute("output") ? cpuRenderNode.attribute("output").value() : "cpuMotionBlur.hdr";
+		cpuPathTracerSetting.outputPath = std::filesystem::absolute(exePath / TARGET_EXE_TO_SOURCE_DIRECTORY / "result") / output;
+	}
+
 	if (pugi::xml_node rendererNode = rendererInfo.child("renderer")) {
 		std::string rendererType = rendererNode.attribute("type").value();
 		RendererCreateInfo rendererCreateInfo{
@@ -115,12 +136,25 @@ void FzbRenderer::Application::onAttach(nvapp::Application* app) {
 		.vulkanApiVersion = VK_API_VERSION_1_4,
 	};
 	allocator.init(allocatorInfo);
+	profiler.init();
 	stagingUploader.init(&allocator, true);   //所有的CPU、GPU只一方可见的缓冲的交互都要经过暂存缓冲区
 	initSlangCompiler();
+	prewarmShaders();
+	deviceShaderCache.init(app->getPhysicalDevice(), app->getDevice(), nvutils::getExecutablePath().parent_path() / "shaderCache");
 	samplerPool.init(app->getDevice());
+	if (primitivesBenchmarkCount > 0 && !primitives.benchmark(primitivesBenchmarkCount))
+		throw std::runtime_error("GPUPrimitives与CPU结果不一致");
+	if (bsdfValidationCount > 0) CPUBSDF::validate(bsdfValidationCount);
+	ldSampler.init();
+	if (samplerBenchmarkCount > 0) ldSampler.benchmark(samplerBenchmarkCount);
+	if (restirValidationCount > 0) ReSTIRDI::validate(restirValidationCount);
+	if (stringParsingBenchmarkCount > 0) benchmarkStringParsing(stringParsingBenchmarkCount);
 
 	sceneResource.createSceneFromXML();
+	if (cpuPathTracerSetting.enable) CPUPathTracer::render(cpuPathTracerSetting);
 	renderer->init();
+	shaderCache.saveManifest();
+	deviceShaderCache.save();
 
 	skySimple.init(&allocator, std::span(sky_simple_slang));
 	tonemapper.init(&allocator, std::span(tonemapper_slang));
@@ -167,6 +201,14 @@ void FzbRenderer::Application::initSlangCompiler() {
 		AftermathCrashTracker::getInstance().addShaderBinary(data);
 		});
 #endif
+
+	shaderCache.init(nvutils::getExecutablePath().parent_path() / "shaderCache");
+}
+
+void FzbRenderer::Application::prewarmShaders() {
+	std::vector<ShaderCompileRequest> requests;
+	renderer->collectShaderRequests(requests);
+	shaderCache.prewarm(requests);
 }
 
 void FzbRenderer::Application::onDetach() {
@@ -181,6 +223,11 @@ void FzbRenderer::Application::onDetach() {
 	skySimple.deinit();
 	tonemapper.deinit();
 	samplerPool.deinit();
+	primitives.clean();
+	ldSampler.clean();
+	shaderCache.clean();
+	deviceShaderCache.clean();
+	profiler.clean();
 	allocator.deinit();
 }
 void FzbRenderer::Application::onUIRender() {
@@ -235,6 +282,7 @@ void FzbRenderer::Application::onUIRender() {
 	}
 	ImGui::End();
 	renderer->uiRender();
+	profiler.uiRender();
 
 	if (ImGui::Begin("Viewport"))
 		ImGui::Image(ImTextureID(viewportImage), ImGui::GetContentRegionAvail());
@@ -244,13 +292,20 @@ void FzbRenderer::Application::onResize(VkCommandBuffer cmd, const VkExtent2D& s
 	renderer->resize(cmd, size);	//这一步会初始化gBuffer
 }
 void FzbRenderer::Application::onPreRender() {
+	profiler.beginFrame();
 	frameIndex = std::min(++frameIndex, MAX_FRAME);
+	auto preRenderSection = profiler.section(nullptr, "PreRender");
 	sceneResource.preRender();
 	renderer->preRender();
 }
 void FzbRenderer::Application::onRender(VkCommandBuffer cmd) {
-	updateDataPerFrame(cmd);
+	profiler.cmdResetQueries(cmd);
+	{
+		auto updateSection = profiler.section(cmd, "UpdateDataPerFrame");
+		updateDataPerFrame(cmd);
+	}
 	renderer->render(cmd);
+	profiler.endFrame();
 }
 void FzbRenderer::Application::updateDataPerFrame(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd);
@@ -264,15 +319,21 @@ void FzbRenderer::Application::onUIMenu() {
 	if (ImGui::BeginMenu("Tools"))
 	{
 		reload |= ImGui::MenuItem("Reload shaders", "F5");
+		if (ImGui::MenuItem("Dump profiler trace"))
+			profiler.dumpChromeTrace(nvutils::getExecutablePath().replace_extension(".trace.json"));
 		ImGui::EndMenu();
 	}
 	reload |= ImGui::IsKeyPressed(ImGuiKey_F5);
 	if (reload)
 	{
 		vkQueueWaitIdle(app->getQueue(0).queue);
+		prewarmShaders();
 		renderer->compileAndCreateShaders();
+		shaderCache.saveManifest();
+		deviceShaderCache.save();
 	}
 }
 void FzbRenderer::Application::onLastHeadlessFrame() {
 	renderer->onLastHeadlessFrame();
+	profiler.dumpChromeTrace(nvutils::getExecutablePath().replace_extension(".trace.json"));
 }
\ No newline at end of file
@@ -11,6 +11,12 @@
 #include <nvaftermath/aftermath.hpp>
 #include <renderer/Renderer.h>
 #include <common/Scene/Scene.h>
+#include <common/Profiler/Profiler.h>
+#include <common/Shader/ShaderCache.h>
+#include <common/Shader/DeviceShaderCache.h>
+#include <common/Primitives/Primitives.h>
+#include <common/Sampler/Sampler.h>
+#include <feature/PathTracing/CPUPathTracer.h>
 #include <nvvk/context.hpp>
 
 #include <nvutils/camera_manipulator.hpp>
@@ -70,6 +76,11 @@ public:
 	inline static nvvk::StagingUploader   stagingUploader{};
 	inline static nvvk::SamplerPool       samplerPool{};
 	inline static nvslang::SlangCompiler     slangCompiler{};
+	inline static FzbRenderer::ShaderCache shaderCache{};
+	inline static FzbRenderer::DeviceShaderCache deviceShaderCache{};
+	inline static FzbRenderer::Profiler profiler{};
+	inline static FzbRenderer::GPUPrimitives primitives{};
+	inline static FzbRenderer::LowDiscrepancySampler ldSampler{};
 
 	inline static FzbRenderer::Scene sceneResource;
 
@@ -89,10 +100,17 @@ private:
 	*/
 	void getAppInfoFromXML(nvapp::ApplicationCreateInfo& appInfo);
 	void initSlangCompiler();
+	void prewarmShaders();		//бmanifestʧЧshaderrenderershader״ʱҲشб
 
 	void updateDataPerFrame(VkCommandBuffer cmd);
 
 	std::vector<std::string> slangIncludes;	//slangincludeַ
+	uint32_t primitivesBenchmarkCount = 0;	//rendererInfo<primitivesBenchmark value = "N" />0ʱʱԲԭNԪصĲ
+	uint32_t bsdfValidationCount = 0;		//rendererInfo<bsdfValidation value = "N" />0ʱʱN֤CPU BSDF
+	uint32_t samplerBenchmarkCount = 0;		//rendererInfo<samplerBenchmark value = "N" />0ʱʱԱȸ1N sppRMSE
+	uint32_t stringParsingBenchmarkCount = 0;	//rendererInfo<stringParsingBenchmark value = "N" />0ʱʱNʵĳļʱ
+	uint32_t restirValidationCount = 0;	//rendererInfo<restirValidation value = "N" />0ʱʱNCPU汾ReSTIR DIƫ
+	CPUPathTracerSetting cpuPathTracerSetting;	//rendererInfo<cpuMotionBlurRender spp = "16" maxDepth = "4" output = "cpuMotionBlur.hdr" />ʱغCPUȾһ֡˶ģ
 
 	std::shared_ptr<FzbRenderer::Renderer> renderer;
 };
@@ -4,6 +4,7 @@
 #include <common/Application/Application.h>
 #include <common/utils.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtc/constants.hpp>
 
 using namespace FzbRenderer;
 
@@ -62,7 +63,7 @@ void InstanceSet::getTransformMatrixFromXML(pugi::xml_node& transformNode){
 
 	if(type == InstanceType::PeriodMotion) {
 		if (pugi::xml_node periodNode = transformNode.child("period")) {
-			if (periodNode.attribute("speed")) time = std::stof(periodNode.attribute("time").value());
+			if (periodNode.attribute("speed")) time = FzbRenderer::getFloatFromString(periodNode.attribute("time").value());
 			if (pugi::xml_node translateNode = periodNode.child("translate")) {
 				if (pugi::xml_node translateStartNode = translateNode.child("start")) {
 					glm::vec3 translateValue = FzbRenderer::getRGBFromString(translateStartNode.attribute("value").value());
@@ -109,7 +110,6 @@ InstanceSet::InstanceSet(pugi::xml_node& instanceNode) {
 	if (instanceNode.attribute("id")) instanceID = instanceNode.attribute("id").value();
 
 	std::string meshSetID = instanceNode.child("meshRef").attribute("id").value();
-	std::vector<MeshInfo> childMeshInfos;
 	if (meshSetID == "custom") {
 		useCustomMeshSet = true;
 
@@ -117,18 +117,24 @@ InstanceSet::InstanceSet(pugi::xml_node& instanceNode) {
 		nvutils::PrimitiveMesh primitive;
 		if (meshType == "plane") primitive = FzbRenderer::MeshSet::createPlane(1, 1.0f, 1.0f);
 		meshSetID = "custom" + meshType + std::to_string(customMeshSetCount++);
-		customMeshSet = FzbRenderer::MeshSet(meshSetID, primitive);
+		FzbRenderer::MeshSet customMeshSet(meshSetID, primitive);
+		meshSetIndex = scene.meshSets.size();
 		scene.addMeshSet(customMeshSet);
-		childMeshInfos = customMeshSet.childMeshInfos;
 	}
 	else {
 		if (!scene.meshSetIDToIndex.count(meshSetID)) LOGW("ʵûжӦmesh%s\n", meshSetID.c_str());
-		FzbRenderer::MeshSet& meshSet = scene.meshSets[scene.meshSetIDToIndex[meshSetID]];
-		childMeshInfos = meshSet.childMeshInfos;
+		meshSetIndex = scene.meshSetIDToIndex[meshSetID];
 	}
-	childInstances.resize(childMeshInfos.size());
-	for (int i = 0; i < childMeshInfos.size(); i++) {
-		MeshInfo& childMesh = childMeshInfos[i];
+	const MeshSet& meshSet = scene.meshSets[meshSetIndex];
+
+	//ʵûеtransformֻͳһtransformһ㣻ҪtransformӦõó
+	if (pugi::xml_node transformNode = instanceNode.child("transform")) getTransformMatrixFromXML(transformNode);
+
+	//gltfڵͬһmeshĽڵ㹲childMeshֻǱ任ͬʵtransformΪbaseMatrix * ڵ任
+	std::vector<MeshInstanceInfo> meshInstanceInfos = meshSet.getInstanceInfos();
+	childInstances.resize(meshInstanceInfos.size());
+	for (int i = 0; i < meshInstanceInfos.size(); i++) {
+		const MeshInfo& childMesh = meshSet.childMeshInfos[meshInstanceInfos[i].childMeshIndex];
 		shaderio::Instance& instance = childInstances[i];
 		instance.meshIndex = childMesh.meshIndex;
 
@@ -137,12 +143,60 @@ InstanceSet::InstanceSet(pugi::xml_node& instanceNode) {
 		else materialID = childMesh.materialID;
 		if (!scene.uniqueMaterialIDToIndex.count(materialID)) materialID = "defaultMaterial";
 		instance.materialIndex = scene.uniqueMaterialIDToIndex[materialID];
-
-		//ʵûеtransformֻͳһtransformһ㣻ҪtransformӦõó
-		if (pugi::xml_node transformNode = instanceNode.child("transform")) getTransformMatrixFromXML(transformNode);
-		instance.transform = baseMatrix;
+		instance.transform = baseMatrix * meshInstanceInfos[i].transform;
 	}
 }
+/*
+<instanceArray>ɴ̬ʵҪΪÿʵдһinstanceڵ㣻meshRefmaterialReftransforminstanceڵͬ
+1. <grid count="x,y,z" spacing="x,y,z" origin="x,y,z"/>
+2. <scatter count="n" min="x,y,z" max="x,y,z" seed="s" rotateY="true" scale="min max"/>ڰΧ㣬yת
+ɵÿʵı任Ϊ arrayMatrix * ʵı任baseMatrix * gltfڵ任arrayMatrix = translate * rotateY * scale
+*/
+uint32_t InstanceSet::getInstanceArrayCount(pugi::xml_node& arrayNode) {
+	if (pugi::xml_node gridNode = arrayNode.child("grid")) {
+		glm::uvec3 count = glm::max(glm::uvec3(FzbRenderer::getRGBFromString(gridNode.attribute("count").value())), glm::uvec3(1));
+		return count.x * count.y * count.z;
+	}
+	if (pugi::xml_node scatterNode = arrayNode.child("scatter"))
+		return std::max(FzbRenderer::getIntFromString(scatterNode.attribute("count").value()), 0);
+	return 0;
+}
+void InstanceSet::expandInstanceArray(pugi::xml_node& arrayNode, std::vector<shaderio::Instance>& instances) {
+	auto appendInstances = [&](const glm::mat4& arrayMatrix) {
+		for (const shaderio::Instance& childInstance : childInstances) {
+			shaderio::Instance& instance = instances.emplace_back(childInstance);
+			instance.transform = arrayMatrix * childInstance.transform;
+		}
+	};
+	instances.reserve(instances.size() + getInstanceArrayCount(arrayNode) * childInstances.size());
+
+	if (pugi::xml_node gridNode = arrayNode.child("grid")) {
+		glm::uvec3 count = glm::max(glm::uvec3(FzbRenderer::getRGBFromString(gridNode.attribute("count").value())), glm::uvec3(1));
+		glm::vec3 spacing = gridNode.attribute("spacing") ? FzbRenderer::getRGBFromString(gridNode.attribute("spacing").value()) : glm::vec3(1.0f);
+		glm::vec3 origin = FzbRenderer::getRGBFromString(gridNode.attribute("origin").value());
+		for (uint32_t z = 0; z < count.z; ++z)
+			for (uint32_t y = 0; y < count.y; ++y)
+				for (uint32_t x = 0; x < count.x; ++x)
+					appendInstances(glm::translate(glm::mat4(1.0f), origin + glm::vec3(x, y, z) * spacing));
+	}
+	else if (pugi::xml_node scatterNode = arrayNode.child("scatter")) {
+		uint32_t count = getInstanceArrayCount(arrayNode);
+		glm::vec3 minPos = FzbRenderer::getRGBFromString(scatterNode.attribute("min").value());
+		glm::vec3 maxPos = FzbRenderer::getRGBFromString(scatterNode.attribute("max").value());
+		uint32_t seed = FzbRenderer::getIntFromString(scatterNode.attribute("seed").value());
+		bool rotateY = std::string(scatterNode.attribute("rotateY").value()) == "true";
+		glm::vec2 scaleRange = scatterNode.attribute("scale") ? FzbRenderer::getfloat2FromString(scatterNode.attribute("scale").value()) : glm::vec2(1.0f);
+		for (uint32_t i = 0; i < count; ++i) {
+			uint32_t randomSeed = seed * 0x9E3779B9u + i * 5;
+			glm::vec3 random = glm::vec3(FzbRenderer::rand(randomSeed), FzbRenderer::rand(randomSeed + 1), FzbRenderer::rand(randomSeed + 2));
+			glm::mat4 arrayMatrix = glm::translate(glm::mat4(1.0f), glm::mix(minPos, maxPos, random));
+			if (rotateY) arrayMatrix = glm::rotate(arrayMatrix, FzbRenderer::rand(randomSeed + 3) * glm::two_pi<float>(), glm::vec3(0, 1, 0));
+			arrayMatrix = glm::scale(arrayMatrix, glm::vec3(glm::mix(scaleRange.x, scaleRange.y, FzbRenderer::rand(randomSeed + 4))));
+			appendInstances(arrayMatrix);
+		}
+	}
+	else LOGW("instanceArrayûgridscatterڵ㣺%s\n", instanceID.c_str());
+}
 
 void InstanceSet::getInstance(std::vector<shaderio::Instance>& instances, int offset, float time) {
 	if (type != InstanceType::PeriodMotion) {
@@ -153,7 +207,7 @@ void InstanceSet::getInstance(std::vector<shaderio::Instance>& instances, int of
 		shaderio::Instance instance;
 		instance.meshIndex = childInstances[i].meshIndex;
 		instance.materialIndex = childInstances[i].materialIndex;
-		instance.transform = ((1.0f - time) * startMatrix + time * endMatrix) * baseMatrix;	//interpolateTransforms(startMatrix, endMatrix, time);
+		instance.transform = ((1.0f - time) * startMatrix + time * endMatrix) * childInstances[i].transform;	//interpolateTransforms(startMatrix, endMatrix, time);
 		instances[offset + i] = instance;
 	}
 }
@@ -166,18 +220,22 @@ void LightInstance::copyInstanceInfo(const InstanceSet& instance) {
 	this->startMatrix = instance.startMatrix;
 	this->endMatrix = instance.endMatrix;
 	this->useCustomMeshSet = instance.useCustomMeshSet;
-	//this->customMeshSet = instance.customMeshSet;
+	this->meshSetIndex = instance.meshSetIndex;
 }
 LightInstance::LightInstance(pugi::xml_node& lightNode) {
 	Scene& scene = Application::sceneResource;
 
 	if (pugi::xml_node instanceRefNode = lightNode.child("instanceRef")) {
 		std::string instanceID = instanceRefNode.attribute("id").value();
-		if (scene.instanceIDToInstance.count(instanceID)) {
-			std::pair<uint32_t, uint32_t> instanceTypeAndIndex = scene.instanceIDToInstance[instanceID];
-			type = (InstanceType)instanceTypeAndIndex.first;
-			InstanceSet instanceSet = scene.getInstanceSet(type, instanceTypeAndIndex.second);
-			copyInstanceInfo(instanceSet);
+		auto it = scene.instanceIDToInstance.find(instanceID);
+		if (it != scene.instanceIDToInstance.end()) {
+			type = (InstanceType)it->second.first;
+			//̬ʵֻscene.instancesУڶһʵ
+			if (type == InstanceType::Static) {
+				this->instanceID = instanceID;
+				baseMatrix = scene.instances[it->second.second].transform;
+			}
+			else copyInstanceInfo(scene.getInstanceSet(type, it->second.second));
 		}
 		else printf("ԴûӦinstanceID%s\n", instanceID);
 	}
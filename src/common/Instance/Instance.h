@@ -27,7 +27,7 @@ public:
 	glm::mat4 endMatrix = glm::mat4(1.0f);
 
 	bool useCustomMeshSet = false;
-	MeshSet customMeshSet;
+	uint32_t meshSetIndex = 0;		//ֻ¼meshSetScene::meshSets
 
 	std::vector<shaderio::Instance> childInstances;
 
@@ -36,6 +36,8 @@ public:
 
 	void getTransformMatrixFromXML(pugi::xml_node& transformNode);
 	void getInstance(std::vector<shaderio::Instance>& instance, int offset, float time);
+	uint32_t getInstanceArrayCount(pugi::xml_node& arrayNode);
+	void expandInstanceArray(pugi::xml_node& arrayNode, std::vector<shaderio::Instance>& instances);
 };
 
 class LightInstance : public InstanceSet {
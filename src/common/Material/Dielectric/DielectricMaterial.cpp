@@ -14,8 +14,8 @@ void FzbRenderer::DielectricMaterial::getMaterialInfoFromSceneInfoXML(
 		pugi::xml_node intIorNode = bsdfNode.child("int_ior");
 		pugi::xml_node extIorNode = bsdfNode.child("ext_ior");
 		if (intIorNode && extIorNode) {
-			float intIor = std::stof(intIorNode.attribute("value").value());
-			float extIor = std::stof(extIorNode.attribute("value").value());
+			float intIor = FzbRenderer::getFloatFromString(intIorNode.attribute("value").value());
+			float extIor = FzbRenderer::getFloatFromString(extIorNode.attribute("value").value());
 
 			if (intIor == extIor) LOGW("ͬ");
 			if (intIor == 0 || extIor == 0) LOGW("Ϊ0");
@@ -7,7 +7,7 @@ void FzbRenderer::RoughConductorMaterial::getMaterialInfoFromSceneInfoXML(
 	shaderio::BSDFMaterial& material) {
 	material.type = shaderio::RoughConductor;
 	if (pugi::xml_node roughnessNode = bsdfNode.child("roughness"))
-		material.roughness = std::stof(roughnessNode.attribute("value").value());
+		material.roughness = FzbRenderer::getFloatFromString(roughnessNode.attribute("value").value());
 
 	pugi::xml_node etaNode = bsdfNode.child("eta");
 	pugi::xml_node kNode = bsdfNode.child("k");
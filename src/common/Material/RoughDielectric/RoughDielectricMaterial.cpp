@@ -7,7 +7,7 @@ void FzbRenderer::RoughDielectricMaterial::getMaterialInfoFromSceneInfoXML(
 	shaderio::BSDFMaterial& material) {
 	material.type = shaderio::RoughDielectric;
 	if (pugi::xml_node roughnessNode = bsdfNode.child("roughness"))
-		material.roughness = std::stof(roughnessNode.attribute("value").value());
+		material.roughness = FzbRenderer::getFloatFromString(roughnessNode.attribute("value").value());
 
 	if (pugi::xml_node etaNode = bsdfNode.child("eta"))
 		material.eta = FzbRenderer::getRGBFromString(etaNode.attribute("value").value());
@@ -15,8 +15,8 @@ void FzbRenderer::RoughDielectricMaterial::getMaterialInfoFromSceneInfoXML(
 		pugi::xml_node intIorNode = bsdfNode.child("int_ior");
 		pugi::xml_node extIorNode = bsdfNode.child("ext_ior");
 		if (intIorNode && extIorNode) {
-			float intIor = std::stof(intIorNode.attribute("value").value());
-			float extIor = std::stof(extIorNode.attribute("value").value());
+			float intIor = FzbRenderer::getFloatFromString(intIorNode.attribute("value").value());
+			float extIor = FzbRenderer::getFloatFromString(extIorNode.attribute("value").value());
 
 			if (intIor == extIor) LOGW("ͬ");
 			if (intIor == 0 || extIor == 0) LOGW("Ϊ0");
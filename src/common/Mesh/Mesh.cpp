@@ -4,6 +4,10 @@
 #include <common/Application/Application.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
+#include <functional>
+#include <unordered_map>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include "./Mesh.h"
 #include <common/Material/Material.h>
 
@@ -73,17 +77,47 @@ shaderio::BSDFMaterial loadGltfMaterial(const tinygltf::Material& gltfMaterial)
 		.roughness = float(gltfMaterial.pbrMetallicRoughness.roughnessFactor),
 	};
 }
-void FzbRenderer::MeshSet::loadGltfData(const tinygltf::Model& model, bool importInstance) {
+uint32_t addData(std::vector<uint8_t>& data, std::vector<uint8_t>& newData, uint32_t alignment) {
+	uint32_t dataSize = data.size();
+	uint32_t padding = (alignment - dataSize % alignment) % alignment;
+	data.reserve(dataSize + padding + newData.size());
+	
+	if (padding > 0) {
+		std::vector<uint8_t> paddingData(padding);
+		data.insert(data.end(), paddingData.begin(), paddingData.end());
+	}
+	data.insert(data.end(), newData.begin(), newData.end());
+
+	return padding;
+}
+glm::mat4 getGltfNodeMatrix(const tinygltf::Node& node) {
+	if (!node.matrix.empty()) return glm::mat4(glm::make_mat4(node.matrix.data()));
+
+	glm::mat4 nodeMatrix = glm::mat4(1.0f);		//T * R * S
+	if (!node.translation.empty()) nodeMatrix = glm::translate(nodeMatrix, glm::vec3(glm::make_vec3(node.translation.data())));
+	if (!node.rotation.empty()) nodeMatrix = nodeMatrix * glm::mat4_cast(glm::quat(glm::make_quat(node.rotation.data())));	//gltfԪΪxyzw
+	if (!node.scale.empty()) nodeMatrix = glm::scale(nodeMatrix, glm::vec3(glm::make_vec3(node.scale.data())));
+	return nodeMatrix;
+}
+/*
+1. ÿmeshÿprimitiveһchildMeshεprimitive
+2. meshByteDataֻ汻accessorõbufferViewaccessorͬһbufferViewʱֻһΣͼƬݲ
+3. չĬsceneĽڵÿmeshĽڵΪÿprimitiveһMeshInstanceInfo
+   ͬһmeshNڵʱֻһݶݺһBLASʵInstanceSet
+*/
+void FzbRenderer::MeshSet::loadGltfData(const tinygltf::Model& model) {
 	SCOPED_TIMER(__FUNCTION__);
 
 	auto getElementByteSize = [](int type) -> uint32_t {	//СݵԪĴС
-		return  type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? 2U :
+		return  type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ? 1U :
+			type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? 2U :
 			type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT ? 4U :
 			type == TINYGLTF_COMPONENT_TYPE_FLOAT ? 4U :
 			0U;
 		};
 	auto getTypeSize = [](int type) -> uint32_t {			//һݵԪ
-		return  type == TINYGLTF_TYPE_VEC2 ? 2U :
+		return  type == TINYGLTF_TYPE_SCALAR ? 1U :
+			type == TINYGLTF_TYPE_VEC2 ? 2U :
 			type == TINYGLTF_TYPE_VEC3 ? 3U :
 			type == TINYGLTF_TYPE_VEC4 ? 4U :
 			type == TINYGLTF_TYPE_MAT2 ? 4U * 2U :
@@ -91,8 +125,19 @@ void FzbRenderer::MeshSet::loadGltfData(const tinygltf::Model& model, bool impor
 			type == TINYGLTF_TYPE_MAT4 ? 4U * 4U :
 			0U;
 		};
+	std::unordered_map<int, uint32_t> bufferViewToOffset;	//bufferViewmeshByteDataе
+	auto copyBufferView = [&](int bufferViewIndex) -> uint32_t {
+		if (auto it = bufferViewToOffset.find(bufferViewIndex); it != bufferViewToOffset.end()) return it->second;
+		const tinygltf::BufferView& bv = model.bufferViews[bufferViewIndex];
+		const std::vector<unsigned char>& bufferData = model.buffers[bv.buffer].data;
+		std::vector<uint8_t> viewData(bufferData.begin() + bv.byteOffset, bufferData.begin() + bv.byteOffset + bv.byteLength);
+		uint32_t offset = uint32_t(meshByteData.size());
+		offset += addData(meshByteData, viewData, 4);		//accessorbufferViewаС룬bufferView4ֽڶ뼴
+		bufferViewToOffset.insert({ bufferViewIndex, offset });
+		return offset;
+		};
 	auto extractAttribute = [&](const std::string& name, shaderio::BufferView& attr, const tinygltf::Primitive& primitive) {
-		if (!primitive.attributes.contains(name)) {
+		if (!primitive.attributes.contains(name) || model.accessors[primitive.attributes.at(name)].bufferView < 0) {
 			attr.offset = -1;
 			return;
 		}
@@ -100,128 +145,111 @@ void FzbRenderer::MeshSet::loadGltfData(const tinygltf::Model& model, bool impor
 		const tinygltf::BufferView& bv = model.bufferViews[acc.bufferView];				//bufferView֪bufferĳһεϢ
 		assert((acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) && "Should be floats");
 		attr = {
-			//bv.byteOffset൱bufferе;acc.byteOffset涥ĳڶеƫƣȷ˵normaloffsetΪ3*4=12
-			.offset = uint32_t(bv.byteOffset + acc.byteOffset),
+			//bufferViewmeshByteDataе;acc.byteOffset涥ĳڶеƫƣȷ˵normaloffsetΪ3*4=12
+			.offset = uint32_t(copyBufferView(acc.bufferView) + acc.byteOffset),
 			.count = uint32_t(acc.count),
 			.byteStride = uint32_t(bv.byteStride ? uint32_t(bv.byteStride) : getTypeSize(acc.type) * getElementByteSize(acc.componentType)),
 		};
 		};
-
-	meshByteData = model.buffers[0].data;
-	for (size_t meshIdx = 0; meshIdx < model.meshes.size(); ++meshIdx) {
-		shaderio::Mesh mesh{};
-
-		const tinygltf::Mesh& tinyMesh = model.meshes[meshIdx];
-		const tinygltf::Primitive& primitive = tinyMesh.primitives.front();
-		assert((tinyMesh.primitives.size() == 1 && primitive.mode == TINYGLTF_MODE_TRIANGLES) && "Must have one triangle primitive");
-
-		auto& accessor = model.accessors[primitive.indices];
-		auto& bufferView = model.bufferViews[accessor.bufferView];
-		assert((accessor.count % 3 == 0) && "Should be a multiple of 3");
-		mesh.triMesh.indices = {
-			.offset = uint32_t(bufferView.byteOffset + accessor.byteOffset),
-			.count = uint32_t(accessor.count),
-			.byteStride = uint32_t(bufferView.byteStride ? bufferView.byteStride : getElementByteSize(accessor.componentType)),
-		};
-		mesh.indexType = accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
-
-		extractAttribute("POSITION", mesh.triMesh.positions, primitive);
-		extractAttribute("NORMAL", mesh.triMesh.normals, primitive);
-		extractAttribute("COLOR_0", mesh.triMesh.colorVert, primitive);
-		extractAttribute("TEXCOORD_0", mesh.triMesh.texCoords, primitive);
-		extractAttribute("TANGENT", mesh.triMesh.tangents, primitive);
-
-		std::string materialID = "defaultMaterial";
-		shaderio::BSDFMaterial material = FzbRenderer::defaultMaterial;
-		if (primitive.material >= 0) {
-			const tinygltf::Material& gltfMaterial = model.materials[primitive.material];
-			materialID = gltfMaterial.name;
-			material = loadGltfMaterial(gltfMaterial);
+	auto extractIndices = [&](const tinygltf::Primitive& primitive, shaderio::Mesh& mesh) {
+		std::vector<uint32_t> indexData;
+		if (primitive.indices < 0) {		//ûʱ˳
+			indexData.resize(model.accessors[primitive.attributes.at("POSITION")].count);
+			for (uint32_t i = 0; i < indexData.size(); ++i) indexData[i] = i;
 		}
-
-		FzbRenderer::MeshInfo childMesh = {
-			.meshID = meshID + model.meshes[meshIdx].name,
-			.mesh = mesh,
-			.materialID = materialID,
-			.material = material
+		else {
+			const tinygltf::Accessor& acc = model.accessors[primitive.indices];
+			const tinygltf::BufferView& bv = model.bufferViews[acc.bufferView];
+			if (acc.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
+				mesh.triMesh.indices = {
+					.offset = uint32_t(copyBufferView(acc.bufferView) + acc.byteOffset),
+					.count = uint32_t(acc.count),
+					.byteStride = uint32_t(bv.byteStride ? bv.byteStride : getElementByteSize(acc.componentType)),
+				};
+				mesh.indexType = acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+				return;
+			}
+			//vulkanҪչ֧uint8չΪuint32
+			const uint8_t* src = model.buffers[bv.buffer].data.data() + bv.byteOffset + acc.byteOffset;
+			uint32_t stride = bv.byteStride ? uint32_t(bv.byteStride) : 1u;
+			indexData.resize(acc.count);
+			for (uint32_t i = 0; i < indexData.size(); ++i) indexData[i] = src[i * stride];
+		}
+		std::vector<uint8_t> indexByteData(sizeof(uint32_t) * indexData.size());
+		std::memcpy(indexByteData.data(), indexData.data(), indexByteData.size());
+		mesh.triMesh.indices.offset = uint32_t(meshByteData.size());
+		mesh.triMesh.indices.offset += addData(meshByteData, indexByteData, 4);
+		mesh.triMesh.indices.count = uint32_t(indexData.size());
+		mesh.triMesh.indices.byteStride = sizeof(uint32_t);
+		mesh.indexType = VK_INDEX_TYPE_UINT32;
 		};
-		childMeshInfos.push_back(childMesh);
-	}
 
-	/*
-	if (importInstance) {
-		std::function<void(const tinygltf::Node&, const glm::mat4&)> processNode = [&](const tinygltf::Node& node, const glm::mat4& parentTransform) {
-			glm::mat4 nodeTransform = parentTransform;	//ǰnodeı任븸nodeı任
-			if (!node.matrix.empty()) {
-				glm::mat4 matrix = glm::make_mat4(node.matrix.data());
-				nodeTransform = parentTransform * matrix;
-			}
-			else {
-				if (!node.translation.empty()) {
-					glm::vec3 translation = glm::make_vec3(node.translation.data());
-					nodeTransform = glm::translate(nodeTransform, translation);
-				}
-				if (!node.rotation.empty())
-				{
-					glm::quat rotation = glm::make_quat(node.rotation.data());
-					nodeTransform = nodeTransform * glm::mat4_cast(rotation);
-				}
-				if (!node.scale.empty())
-				{
-					glm::vec3 scale = glm::make_vec3(node.scale.data());
-					nodeTransform = glm::scale(nodeTransform, scale);
-				}
+	std::vector<std::vector<uint32_t>> meshToChildMeshIndices(model.meshes.size());	//gltf meshÿprimitiveӦchildMesh
+	for (size_t meshIdx = 0; meshIdx < model.meshes.size(); ++meshIdx) {
+		const tinygltf::Mesh& tinyMesh = model.meshes[meshIdx];
+		for (size_t primitiveIdx = 0; primitiveIdx < tinyMesh.primitives.size(); ++primitiveIdx) {
+			const tinygltf::Primitive& primitive = tinyMesh.primitives[primitiveIdx];
+			if (primitive.mode != TINYGLTF_MODE_TRIANGLES && primitive.mode != -1) {
+				LOGW("εprimitive%s %s[%zu]\n", meshID.c_str(), tinyMesh.name.c_str(), primitiveIdx);
+				continue;
 			}
-
-			if (node.mesh != -1) {
-				const tinygltf::Mesh& tinyMesh = model.meshes[node.mesh];
-				const tinygltf::Primitive& primitive = tinyMesh.primitives.front();
-				assert((tinyMesh.primitives.size() == 1 && primitive.mode == TINYGLTF_MODE_TRIANGLES) && "Must have one triangle primitive");
-				shaderio::Instance instance{};
-				instance.meshIndex = node.mesh + meshOffset;
-				instance.transform = nodeTransform;
-				scene.instances.push_back(instance);
+			if (!primitive.attributes.contains("POSITION")) continue;
+
+			shaderio::Mesh mesh{};
+			extractIndices(primitive, mesh);
+			assert((mesh.triMesh.indices.count % 3 == 0) && "Should be a multiple of 3");
+
+			extractAttribute("POSITION", mesh.triMesh.positions, primitive);
+			extractAttribute("NORMAL", mesh.triMesh.normals, primitive);
+			extractAttribute("COLOR_0", mesh.triMesh.colorVert, primitive);
+			extractAttribute("TEXCOORD_0", mesh.triMesh.texCoords, primitive);
+			extractAttribute("TANGENT", mesh.triMesh.tangents, primitive);
+
+			std::string materialID = "defaultMaterial";
+			shaderio::BSDFMaterial material = FzbRenderer::defaultMaterial;
+			if (primitive.material >= 0) {
+				const tinygltf::Material& gltfMaterial = model.materials[primitive.material];
+				materialID = gltfMaterial.name;
+				material = loadGltfMaterial(gltfMaterial);
 			}
 
-			for (int childIdx : node.children)
-			{
-				if (childIdx >= 0 && childIdx < static_cast<int>(model.nodes.size()))
-					processNode(model.nodes[childIdx], nodeTransform);
-			}
+			std::string childMeshID = meshID + tinyMesh.name;
+			if (tinyMesh.primitives.size() > 1) childMeshID += "_" + std::to_string(primitiveIdx);
+			FzbRenderer::MeshInfo childMesh = {
+				.meshID = childMeshID,
+				.mesh = mesh,
+				.materialID = materialID,
+				.material = material
 			};
-
-		for (size_t nodeIdx = 0; nodeIdx < model.nodes.size(); ++nodeIdx) {
-			const tinygltf::Node& node = model.nodes[nodeIdx];
-			bool isRootNode = true;
-			for (const auto& otherNode : model.nodes) {
-				for (int childIdx : otherNode.children) {
-					if (childIdx == static_cast<int>(nodeIdx)) {
-						isRootNode = false;
-						break;
-					}
-				}
-				if (!isRootNode) break;
-			}
-
-			if (isRootNode) processNode(node, glm::mat4(1.0f));
+			meshToChildMeshIndices[meshIdx].push_back(uint32_t(childMeshInfos.size()));
+			childMeshInfos.push_back(childMesh);
 		}
 	}
-	*/
-};
 
-uint32_t addData(std::vector<uint8_t>& data, std::vector<uint8_t>& newData, uint32_t alignment) {
-	uint32_t dataSize = data.size();
-	uint32_t padding = (alignment - dataSize % alignment) % alignment;
-	data.reserve(dataSize + padding + newData.size());
-	
-	if (padding > 0) {
-		std::vector<uint8_t> paddingData(padding);
-		data.insert(data.end(), paddingData.begin(), paddingData.end());
+	std::function<void(int, const glm::mat4&)> processNode = [&](int nodeIdx, const glm::mat4& parentTransform) {
+		const tinygltf::Node& node = model.nodes[nodeIdx];
+		glm::mat4 nodeTransform = parentTransform * getGltfNodeMatrix(node);	//ǰnodeı任븸nodeı任
+		if (node.mesh >= 0)
+			for (uint32_t childMeshIndex : meshToChildMeshIndices[node.mesh])
+				childInstanceInfos.push_back({ childMeshIndex, nodeTransform });
+		for (int childIdx : node.children)
+			if (childIdx >= 0 && childIdx < static_cast<int>(model.nodes.size())) processNode(childIdx, nodeTransform);
+		};
+	if (!model.scenes.empty()) {
+		const tinygltf::Scene& gltfScene = model.scenes[model.defaultScene >= 0 ? model.defaultScene : 0];
+		for (int nodeIdx : gltfScene.nodes) processNode(nodeIdx, glm::mat4(1.0f));
 	}
-	data.insert(data.end(), newData.begin(), newData.end());
+	else {		//ûsceneʱиڵչ
+		std::vector<bool> isChildNode(model.nodes.size(), false);
+		for (const tinygltf::Node& node : model.nodes)
+			for (int childIdx : node.children)
+				if (childIdx >= 0 && childIdx < static_cast<int>(model.nodes.size())) isChildNode[childIdx] = true;
+		for (size_t nodeIdx = 0; nodeIdx < model.nodes.size(); ++nodeIdx)
+			if (!isChildNode[nodeIdx]) processNode(int(nodeIdx), glm::mat4(1.0f));
+	}
+	LOGI("%s%zuchildMesh%zuڵʵ%zuKB\n", meshID.c_str(), childMeshInfos.size(), childInstanceInfos.size(), meshByteData.size() / 1024);
+};
 
-	return padding;
-}
 shaderio::BSDFMaterial loadMtlMaterial(aiMaterial* mtlMaterial) {
 	shaderio::BSDFMaterial material;
 
@@ -514,12 +542,18 @@ nvvk::Buffer FzbRenderer::MeshSet::createMeshDataBuffer() {
 	return bData;
 }
 
+std::vector<FzbRenderer::MeshInstanceInfo> FzbRenderer::MeshSet::getInstanceInfos() const {
+	if (!childInstanceInfos.empty()) return childInstanceInfos;
+	std::vector<MeshInstanceInfo> meshInstanceInfos(childMeshInfos.size());
+	for (uint32_t i = 0; i < childMeshInfos.size(); ++i) meshInstanceInfos[i].childMeshIndex = i;
+	return meshInstanceInfos;
+}
 shaderio::AABB FzbRenderer::MeshSet::getAABB(glm::mat4 transformMatrix) {
 	glm::vec3 maxmum = { FLT_MAX, FLT_MAX, FLT_MAX };
 	if (aabb.minimum != maxmum && aabb.maximum != -maxmum) return aabb;
 
-	for (auto& childMeshInfo : childMeshInfos) {
-		shaderio::AABB childMeshAABB = childMeshInfo.getAABB(transformMatrix);
+	for (const MeshInstanceInfo& meshInstanceInfo : getInstanceInfos()) {
+		shaderio::AABB childMeshAABB = childMeshInfos[meshInstanceInfo.childMeshIndex].getAABB(transformMatrix * meshInstanceInfo.transform);
 
 		aabb.minimum.x = std::min(childMeshAABB.minimum.x, aabb.minimum.x);
 		aabb.minimum.y = std::min(childMeshAABB.minimum.y, aabb.minimum.y);
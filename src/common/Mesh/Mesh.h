@@ -26,6 +26,11 @@ struct MeshInfo {
 
 	shaderio::AABB getAABB(glm::mat4 transformMatrix = glm::mat4(1.0f));
 };
+//gltfڵչһʵڵͬһmeshʱchildMeshݺBLASֻһݣ
+struct MeshInstanceInfo {
+	uint32_t childMeshIndex;		//childMeshInfosе
+	glm::mat4 transform = glm::mat4(1.0f);		//ڵ任
+};
 
 class MeshSet{
 public:
@@ -35,6 +40,7 @@ public:
 
 	nvvk::Buffer createMeshDataBuffer();
 	shaderio::AABB getAABB(glm::mat4 transformMatrix = glm::mat4(1.0f));
+	std::vector<MeshInstanceInfo> getInstanceInfos() const;		//ʵmeshSetʱÿԪһshaderio::Instance
 
 	static nvutils::PrimitiveMesh createPlane(int steps, float width, float height);
 	static nvutils::PrimitiveMesh createCube(bool normal = false, bool texCoords = false, float width = 1.0F, float height = 1.0F, float depth = 1.0F);
@@ -42,11 +48,12 @@ public:
 
 	std::string meshID;
 	uint32_t meshOffset;
-	std::vector<MeshInfo> childMeshInfos;		//ǰmeshеСmesh
+	std::vector<MeshInfo> childMeshInfos;		//ǰmeshеСmeshgltfÿprimitiveһ
+	std::vector<MeshInstanceInfo> childInstanceInfos;	//gltfڵеʵΪʱÿchildMeshԵλ任ʵһ
 	std::vector<uint8_t> meshByteData;
 	shaderio::AABB aabb = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
 private:
-	void loadGltfData(const tinygltf::Model& model, bool importInstance = false);
+	void loadGltfData(const tinygltf::Model& model);
 	void processMesh(aiMesh* meshData, const aiScene* sceneData);
 	void processNode(aiNode* node, const aiScene* sceneData);
 	void loadObjData(std::filesystem::path meshPath);
@@ -0,0 +1,328 @@
+#include "./MeshLOD.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+using namespace FzbRenderer;
+
+namespace {
+//Գ4x4ǣ˳Ϊxx xy xz xw yy yz yw zz zw ww
+struct Quadric {
+	std::array<double, 10> a{};
+
+	void addPlane(const glm::dvec3& normal, double d, double weight) {
+		a[0] += weight * normal.x * normal.x; a[1] += weight * normal.x * normal.y; a[2] += weight * normal.x * normal.z; a[3] += weight * normal.x * d;
+		a[4] += weight * normal.y * normal.y; a[5] += weight * normal.y * normal.z; a[6] += weight * normal.y * d;
+		a[7] += weight * normal.z * normal.z; a[8] += weight * normal.z * d;
+		a[9] += weight * d * d;
+	}
+	void add(const Quadric& other) { for (int i = 0; i < 10; ++i) a[i] += other.a[i]; }
+	double evaluate(const glm::dvec3& p) const {
+		return a[0] * p.x * p.x + 2.0 * a[1] * p.x * p.y + 2.0 * a[2] * p.x * p.z + 2.0 * a[3] * p.x
+			+ a[4] * p.y * p.y + 2.0 * a[5] * p.y * p.z + 2.0 * a[6] * p.y
+			+ a[7] * p.z * p.z + 2.0 * a[8] * p.z
+			+ a[9];
+	}
+};
+struct Collapse {
+	double cost;
+	uint32_t from;
+	uint32_t to;
+	uint32_t fromVersion;
+	uint32_t toVersion;
+
+	bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+struct EdgeInfo {
+	uint32_t triangleCount = 0;
+	uint32_t triangle = 0;			//һʹøñߵ
+	uint64_t originalKey = 0;		//һиñߵԭ
+	bool seam = false;
+};
+uint64_t getEdgeKey(uint32_t a, uint32_t b) {
+	return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+}
+
+std::vector<MeshLODLevel> MeshLOD::generate(const std::vector<uint8_t>& meshByteData, const shaderio::Mesh& mesh,
+	const MeshLODSetting& setting, std::vector<uint32_t>& lodIndices) {
+	std::vector<MeshLODLevel> levels;
+	const shaderio::TriangleMesh& triMesh = mesh.triMesh;
+	uint32_t triangleCount = triMesh.indices.count / 3;
+	if (triangleCount < std::max(setting.minTriangleCount, 2u) || setting.levelCount == 0) return levels;
+
+	//-------------------------------------------ȡ--------------------------------------------------
+	uint32_t vertexCount = triMesh.positions.count;
+	auto readVec3 = [&](const shaderio::BufferView& view, uint32_t vertexIndex) -> glm::vec3 {
+		uint32_t stride = view.byteStride ? view.byteStride : uint32_t(sizeof(glm::vec3));
+		glm::vec3 value;
+		memcpy(&value, meshByteData.data() + view.offset + size_t(stride) * vertexIndex, sizeof(glm::vec3));
+		return value;
+		};
+	std::vector<glm::vec3> positions(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i) positions[i] = readVec3(triMesh.positions, i);
+	bool hasNormal = triMesh.normals.count == vertexCount;
+	std::vector<glm::vec3> normals(hasNormal ? vertexCount : 0);
+	for (uint32_t i = 0; i < normals.size(); ++i) normals[i] = readVec3(triMesh.normals, i);
+
+	const uint8_t* indexData = meshByteData.data() + triMesh.indices.offset;
+	std::vector<uint32_t> indices(3 * size_t(triangleCount));
+	for (uint32_t i = 0; i < indices.size(); ++i) {
+		if (triMesh.indices.byteStride == sizeof(uint16_t)) indices[i] = reinterpret_cast<const uint16_t*>(indexData)[i];
+		else indices[i] = reinterpret_cast<const uint32_t*>(indexData)[i];
+		if (indices[i] >= vertexCount) return levels;
+	}
+
+	//-------------------------------------------λú--------------------------------------------------
+	struct PositionHash {
+		size_t operator()(const glm::vec3& p) const {
+			uint32_t bits[3];
+			memcpy(bits, &p, sizeof(bits));
+			return size_t(bits[0]) * 73856093u ^ size_t(bits[1]) * 19349663u ^ size_t(bits[2]) * 83492791u;
+		}
+	};
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> positionToWelded;
+	positionToWelded.reserve(vertexCount);
+	std::vector<uint32_t> weldedIndex(vertexCount);
+	std::vector<glm::dvec3> weldedPositions;
+	for (uint32_t i = 0; i < vertexCount; ++i) {
+		auto [it, inserted] = positionToWelded.try_emplace(positions[i], uint32_t(weldedPositions.size()));
+		if (inserted) weldedPositions.push_back(glm::dvec3(positions[i]));
+		weldedIndex[i] = it->second;
+	}
+	uint32_t weldedCount = uint32_t(weldedPositions.size());
+
+	//ͬһӶԭ㣬CSR
+	std::vector<uint32_t> wedgeOffsets(weldedCount + 1, 0);
+	std::vector<uint32_t> wedges(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i) ++wedgeOffsets[weldedIndex[i] + 1];
+	for (uint32_t i = 0; i < weldedCount; ++i) wedgeOffsets[i + 1] += wedgeOffsets[i];
+	{
+		std::vector<uint32_t> cursor(wedgeOffsets.begin(), wedgeOffsets.end() - 1);
+		for (uint32_t i = 0; i < vertexCount; ++i) wedges[cursor[weldedIndex[i]]++] = i;
+	}
+
+	//---------------------------------------------------------------------------------------------
+	std::vector<std::array<uint32_t, 3>> corners;		//ԭ
+	std::vector<std::array<uint32_t, 3>> triangles;		//Ӷ۵ʱ
+	corners.reserve(triangleCount);
+	triangles.reserve(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; ++i) {
+		std::array<uint32_t, 3> corner = { indices[3 * i], indices[3 * i + 1], indices[3 * i + 2] };
+		std::array<uint32_t, 3> triangle = { weldedIndex[corner[0]], weldedIndex[corner[1]], weldedIndex[corner[2]] };
+		if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) continue;
+		corners.push_back(corner);
+		triangles.push_back(triangle);
+	}
+	uint32_t aliveCount = uint32_t(triangles.size());
+	if (aliveCount < std::max(setting.minTriangleCount, 2u)) return levels;
+
+	auto getFaceNormal = [&](const std::array<uint32_t, 3>& triangle) -> glm::dvec3 {
+		return glm::cross(weldedPositions[triangle[1]] - weldedPositions[triangle[0]], weldedPositions[triangle[2]] - weldedPositions[triangle[0]]);
+		};
+	std::vector<Quadric> quadrics(weldedCount);
+	//еĸλƽ(n, d)Լ˸ƽĺӶ㣬ڼÿļ
+	std::vector<glm::dvec4> planes;
+	std::vector<std::vector<uint32_t>> vertexPlanes(weldedCount);
+	std::vector<glm::dvec3> weldedNormals(weldedCount, glm::dvec3(0.0));
+	std::unordered_map<uint64_t, EdgeInfo> edges;
+	edges.reserve(3 * triangles.size());
+	for (uint32_t t = 0; t < triangles.size(); ++t) {
+		const std::array<uint32_t, 3>& triangle = triangles[t];
+		glm::dvec3 normal = getFaceNormal(triangle);
+		double length = glm::length(normal);
+		if (length > 0.0) {
+			normal /= length;
+			double d = -glm::dot(normal, weldedPositions[triangle[0]]);
+			for (uint32_t k = 0; k < 3; ++k) {
+				quadrics[triangle[k]].addPlane(normal, d, 1.0);
+				vertexPlanes[triangle[k]].push_back(uint32_t(planes.size()));
+			}
+			planes.push_back(glm::dvec4(normal, d));
+		}
+		for (uint32_t k = 0; k < 3; ++k) {
+			weldedNormals[triangle[k]] += hasNormal ? glm::dvec3(normals[corners[t][k]]) : normal;
+
+			uint32_t next = (k + 1) % 3;
+			EdgeInfo& edge = edges[getEdgeKey(triangle[k], triangle[next])];
+			uint64_t originalKey = getEdgeKey(corners[t][k], corners[t][next]);
+			if (edge.triangleCount++ == 0) {
+				edge.triangle = t;
+				edge.originalKey = originalKey;
+			}
+			else if (edge.originalKey != originalKey) edge.seam = true;
+		}
+	}
+	//߽ӷ죺ñҴֱεԼƽ
+	for (auto& [key, edge] : edges) {
+		if (edge.triangleCount != 1 && !edge.seam) continue;
+		uint32_t a = uint32_t(key >> 32);
+		uint32_t b = uint32_t(key & 0xffffffffu);
+		glm::dvec3 faceNormal = getFaceNormal(triangles[edge.triangle]);
+		glm::dvec3 constraintNormal = glm::cross(weldedPositions[b] - weldedPositions[a], faceNormal);
+		double length = glm::length(constraintNormal);
+		if (length <= 0.0) continue;
+		constraintNormal /= length;
+		double d = -glm::dot(constraintNormal, weldedPositions[a]);
+		quadrics[a].addPlane(constraintNormal, d, setting.boundaryWeight);
+		quadrics[b].addPlane(constraintNormal, d, setting.boundaryWeight);
+		vertexPlanes[a].push_back(uint32_t(planes.size()));
+		vertexPlanes[b].push_back(uint32_t(planes.size()));
+		planes.push_back(glm::dvec4(constraintNormal, d));
+	}
+	for (glm::dvec3& normal : weldedNormals) {
+		double length = glm::length(normal);
+		normal = length > 0.0 ? normal / length : glm::dvec3(0.0);
+	}
+
+	std::vector<std::vector<uint32_t>> vertexTriangles(weldedCount);
+	for (uint32_t t = 0; t < triangles.size(); ++t)
+		for (uint32_t k = 0; k < 3; ++k) vertexTriangles[triangles[t][k]].push_back(t);
+
+	//-------------------------------------------۵--------------------------------------------------
+	std::vector<bool> triangleAlive(triangles.size(), true);
+	std::vector<uint32_t> collapsedTo(weldedCount, UINT32_MAX);
+	std::vector<uint32_t> versions(weldedCount, 0);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+	auto getCost = [&](uint32_t from, uint32_t to) -> double {
+		Quadric quadric = quadrics[from];
+		quadric.add(quadrics[to]);
+		double cost = std::max(quadric.evaluate(weldedPositions[to]), 0.0);
+		double lengthSquared = glm::dot(weldedPositions[to] - weldedPositions[from], weldedPositions[to] - weldedPositions[from]);
+		cost += setting.normalWeight * (1.0 - glm::dot(weldedNormals[from], weldedNormals[to])) * 0.5 * lengthSquared;
+		return cost;
+		};
+	auto pushEdge = [&](uint32_t a, uint32_t b) {
+		double costAB = getCost(a, b);
+		double costBA = getCost(b, a);
+		if (costAB <= costBA) heap.push({ costAB, a, b, versions[a], versions[b] });
+		else heap.push({ costBA, b, a, versions[b], versions[a] });
+		};
+	for (const auto& [key, edge] : edges) pushEdge(uint32_t(key >> 32), uint32_t(key & 0xffffffffu));
+
+	//fromƵto󣬲toβܷת˻
+	auto canCollapse = [&](uint32_t from, uint32_t to) -> bool {
+		for (uint32_t t : vertexTriangles[from]) {
+			if (!triangleAlive[t]) continue;
+			std::array<uint32_t, 3> triangle = triangles[t];
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+			glm::dvec3 oldNormal = getFaceNormal(triangle);
+			for (uint32_t& vertex : triangle) if (vertex == from) vertex = to;
+			glm::dvec3 newNormal = getFaceNormal(triangle);
+			double oldLength = glm::length(oldNormal);
+			double newLength = glm::length(newNormal);
+			if (newLength <= 1e-12 * std::max(oldLength, 1e-30)) return false;
+			if (glm::dot(oldNormal, newNormal) < 0.2 * oldLength * newLength) return false;
+		}
+		return true;
+		};
+	auto getRoot = [&](uint32_t vertex) -> uint32_t {
+		uint32_t root = vertex;
+		while (collapsedTo[root] != UINT32_MAX) root = collapsedTo[root];
+		while (collapsedTo[vertex] != UINT32_MAX) {
+			uint32_t next = collapsedTo[vertex];
+			collapsedTo[vertex] = root;
+			vertex = next;
+		}
+		return root;
+		};
+
+	//λͬԭѡӽ
+	auto emitLevel = [&](double maxError) {
+		MeshLODLevel level;
+		level.indexOffset = uint32_t(lodIndices.size());
+		level.error = float(maxError);
+		std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+		for (uint32_t t = 0; t < triangles.size(); ++t) {
+			if (!triangleAlive[t]) continue;
+			for (uint32_t k = 0; k < 3; ++k) {
+				uint32_t original = corners[t][k];
+				if (remap[original] == UINT32_MAX) {
+					uint32_t root = getRoot(weldedIndex[original]);
+					uint32_t best = wedges[wedgeOffsets[root]];
+					if (hasNormal) {
+						float bestDot = -FLT_MAX;
+						for (uint32_t w = wedgeOffsets[root]; w < wedgeOffsets[root + 1]; ++w) {
+							float d = glm::dot(normals[original], normals[wedges[w]]);
+							if (d > bestDot) {
+								bestDot = d;
+								best = wedges[w];
+							}
+						}
+					}
+					remap[original] = best;
+				}
+				lodIndices.push_back(remap[original]);
+			}
+		}
+		level.indexCount = uint32_t(lodIndices.size()) - level.indexOffset;
+		levels.push_back(level);
+		};
+
+	double maxError = 0.0;
+	uint32_t lastCount = aliveCount;
+	float target = float(aliveCount);
+	for (uint32_t levelIndex = 0; levelIndex < setting.levelCount; ++levelIndex) {
+		target *= setting.reduction;
+		if (target < float(setting.minTriangleCount)) break;
+		while (aliveCount > uint32_t(target) && !heap.empty()) {
+			Collapse collapse = heap.top();
+			heap.pop();
+			uint32_t from = collapse.from;
+			uint32_t to = collapse.to;
+			if (collapsedTo[from] != UINT32_MAX || collapsedTo[to] != UINT32_MAX) continue;
+			if (versions[from] != collapse.fromVersion || versions[to] != collapse.toVersion) continue;
+			if (!canCollapse(from, to)) continue;
+
+			for (uint32_t t : vertexTriangles[from]) {
+				if (!triangleAlive[t]) continue;
+				std::array<uint32_t, 3>& triangle = triangles[t];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+					triangleAlive[t] = false;
+					--aliveCount;
+					continue;
+				}
+				for (uint32_t& vertex : triangle) if (vertex == from) vertex = to;
+				vertexTriangles[to].push_back(t);
+			}
+			vertexTriangles[from].clear();
+			quadrics[to].add(quadrics[from]);
+			collapsedTo[from] = to;
+			++versions[to];
+
+			//toλò䣬ֻfromƽµϲtoԭƽ涼toб
+			std::vector<uint32_t>& toPlanes = vertexPlanes[to];
+			for (uint32_t plane : vertexPlanes[from]) {
+				maxError = std::max(maxError, std::abs(glm::dot(glm::dvec3(planes[plane]), weldedPositions[to]) + planes[plane].w));
+				toPlanes.push_back(plane);
+			}
+			std::vector<uint32_t>().swap(vertexPlanes[from]);
+			std::sort(toPlanes.begin(), toPlanes.end());
+			toPlanes.erase(std::unique(toPlanes.begin(), toPlanes.end()), toPlanes.end());
+
+			//ȥΣΪtoһ¼
+			std::vector<uint32_t>& toTriangles = vertexTriangles[to];
+			toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [&](uint32_t t) { return !triangleAlive[t]; }), toTriangles.end());
+			std::sort(toTriangles.begin(), toTriangles.end());
+			toTriangles.erase(std::unique(toTriangles.begin(), toTriangles.end()), toTriangles.end());
+			for (uint32_t t : toTriangles)
+				for (uint32_t vertex : triangles[t])
+					if (vertex != to) pushEdge(to, vertex);
+		}
+		//۵ʱתԼûбߣ
+		if (aliveCount >= lastCount || float(aliveCount) > float(lastCount) * (1.0f - 0.5f * (1.0f - setting.reduction))) break;
+		emitLevel(maxError);
+		lastCount = aliveCount;
+	}
+	return levels;
+}
+float MeshLOD::getMaxError(const MeshLODSetting& setting, const glm::mat4& transform, const glm::vec3& voxelSize) {
+	glm::mat3 linear = glm::mat3(transform);
+	float scale = std::max(glm::length(linear[0]), std::max(glm::length(linear[1]), glm::length(linear[2])));
+	return setting.errorScale * std::min(voxelSize.x, std::min(voxelSize.y, voxelSize.z)) / std::max(scale, 1e-6f);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common/Shader/shaderStructType.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef FZBRENDERER_MESH_LOD_H
+#define FZBRENDERER_MESH_LOD_H
+
+namespace FzbRenderer {
+struct MeshLODSetting {
+	bool enable = false;
+	uint32_t levelCount = 4;			//ɵLODԭmesh
+	float reduction = 0.5f;				//ÿΪһreduction
+	uint32_t minTriangleCount = 64;		//ڸֵmesh㲻ټ
+	float normalWeight = 1.0f;			//۵˷߲ĳͷ
+	float boundaryWeight = 10.0f;		//߽ԽӷԼƽȨ
+	float errorScale = 0.5f;			//ʹߣLODerrorScale
+};
+struct MeshLODLevel {
+	uint32_t indexOffset = 0;	//Scene::bMeshLODIndicesеƫƣuint32ƣ
+	uint32_t indexCount = 0;
+	float error = 0.0f;			//ռľ룺Ķ㵽ϲԭһƽ
+};
+/*
+ڶGarland & Heckbert 1997ĵʱ򻯣ΪÿmeshLOD
+1. ۵ֻϲеĶϣLODֻһµȻָԭmeshĶݣɫ붥ȡҪĶ
+2. λúӶλͬԲͬĶ㣨ߡuvӷ죩ʱѡӽһ
+3. Ը֪߽Խӷ봹ֱڱߵԼƽ棬۵˷߲ԽԽߣܾʹηת۵
+4. ۵ۣ߳ͷ߽Ȩأֻÿسߴͬλľ룺
+   ÿӶ¼еԭƽ棨ƽ߽Լƽ棩۵ʱȡĶ㵽ϲƽ
+*/
+class MeshLOD {
+public:
+	//ɵ׷ӵlodIndicesصĸindexOffsetΪlodIndicesеλ
+	static std::vector<MeshLODLevel> generate(const std::vector<uint8_t>& meshByteData, const shaderio::Mesh& mesh,
+		const MeshLODSetting& setting, std::vector<uint32_t>& lodIndices);
+	//任ΪtransformʵĶռerrorScaleسʵ
+	static float getMaxError(const MeshLODSetting& setting, const glm::mat4& transform, const glm::vec3& voxelSize);
+};
+}
+
+#endif
@@ -0,0 +1,440 @@
+#include "./Primitives.h"
+#include <common/Application/Application.h>
+#include <common/Shader/Shader.h>
+#include <nvutils/timers.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvvk/compute_pipeline.hpp>
+#include <nvvk/debug_util.hpp>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+using namespace FzbRenderer;
+
+//-----------------------------------------------------CPU--------------------------------------------------------
+static uint64_t getChunkCount(uint64_t elementCount) {
+	const uint64_t threadCount = std::max<uint64_t>(1, nvutils::get_thread_pool().get_thread_count());
+	return std::clamp<uint64_t>(elementCount / 4096, 1, threadCount);
+}
+
+uint64_t Primitives::exclusiveScan(std::span<const uint32_t> input, std::span<uint32_t> output, bool predicate) {
+	const uint64_t elementCount = input.size();
+	if (elementCount == 0) return 0;
+
+	const uint64_t chunkCount = getChunkCount(elementCount);
+	const uint64_t chunkSize = (elementCount + chunkCount - 1) / chunkCount;
+	std::vector<uint64_t> chunkSums(chunkCount, 0);
+	nvutils::parallel_batches_pooled<1>(chunkCount, [&](uint64_t chunkIndex, uint32_t threadIndex) {
+		uint64_t end = std::min(elementCount, (chunkIndex + 1) * chunkSize);
+		uint64_t sum = 0;
+		for (uint64_t i = chunkIndex * chunkSize; i < end; ++i) sum += predicate ? (input[i] != 0 ? 1 : 0) : input[i];
+		chunkSums[chunkIndex] = sum;
+	});
+
+	uint64_t total = 0;
+	for (uint64_t& chunkSum : chunkSums) {
+		uint64_t sum = chunkSum;
+		chunkSum = total;
+		total += sum;
+	}
+
+	nvutils::parallel_batches_pooled<1>(chunkCount, [&](uint64_t chunkIndex, uint32_t threadIndex) {
+		uint64_t end = std::min(elementCount, (chunkIndex + 1) * chunkSize);
+		uint64_t prefix = chunkSums[chunkIndex];
+		for (uint64_t i = chunkIndex * chunkSize; i < end; ++i) {
+			output[i] = uint32_t(prefix);
+			prefix += predicate ? (input[i] != 0 ? 1 : 0) : input[i];
+		}
+	});
+	return total;
+}
+uint32_t Primitives::compact(std::span<const uint32_t> flags, std::span<const uint32_t> values, std::span<uint32_t> output) {
+	std::vector<uint32_t> offsets(flags.size());
+	uint32_t count = uint32_t(exclusiveScan(flags, offsets, true));
+	nvutils::parallel_ranges_pooled<65536>(flags.size(), [&](uint64_t begin, uint64_t end, uint32_t threadIndex) {
+		for (uint64_t i = begin; i < end; ++i)
+			if (flags[i] != 0) output[offsets[i]] = values[i];
+	});
+	return count;
+}
+template<typename Key>
+static void radixSortKeyValue(std::vector<Key>& keys, std::vector<uint32_t>* values, uint32_t keyBitCount) {
+	if (values == nullptr) {
+		Primitives::radixSortByKey(keys, keyBitCount, [](Key key) { return uint64_t(key); });
+		return;
+	}
+
+	struct KeyValue {
+		Key key;
+		uint32_t value;
+	};
+	std::vector<KeyValue> items(keys.size());
+	nvutils::parallel_ranges_pooled<65536>(keys.size(), [&](uint64_t begin, uint64_t end, uint32_t threadIndex) {
+		for (uint64_t i = begin; i < end; ++i) items[i] = { keys[i], (*values)[i] };
+	});
+	Primitives::radixSortByKey(items, keyBitCount, [](const KeyValue& item) { return uint64_t(item.key); });
+	nvutils::parallel_ranges_pooled<65536>(keys.size(), [&](uint64_t begin, uint64_t end, uint32_t threadIndex) {
+		for (uint64_t i = begin; i < end; ++i) {
+			keys[i] = items[i].key;
+			(*values)[i] = items[i].value;
+		}
+	});
+}
+void Primitives::radixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>* values, uint32_t keyBitCount) {
+	radixSortKeyValue(keys, values, std::min(keyBitCount, 32u));
+}
+void Primitives::radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>* values, uint32_t keyBitCount) {
+	radixSortKeyValue(keys, values, std::min(keyBitCount, 64u));
+}
+//-----------------------------------------------------GPU--------------------------------------------------------
+void GPUPrimitives::init() {
+	if (initialized) return;
+	nvvk::DescriptorBindings bindings;
+	for (uint32_t binding = 0; binding < bindingBuffers.size(); ++binding)
+		bindings.addBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+	NVVK_CHECK(Application::deviceShaderCache.initDescriptorPack(descPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT));
+	NVVK_DBG_NAME(descPack.getLayout());
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(shaderio::PrimitivesPushConstant)
+	};
+	const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = descPack.getLayoutPtr(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
+	NVVK_DBG_NAME(pipelineLayout);
+
+	compileAndCreateShaders();
+	initialized = true;
+}
+void GPUPrimitives::clean() {
+	if (!initialized) return;
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_exclusiveScan, nullptr);
+	vkDestroyShaderEXT(device, computeShader_compact, nullptr);
+	vkDestroyShaderEXT(device, computeShader_radixHistogram, nullptr);
+	vkDestroyShaderEXT(device, computeShader_radixScatter, nullptr);
+	vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+	descPack.deinit();
+
+	Application::allocator.destroyBuffer(partitionStatusBuffer);
+	Application::allocator.destroyBuffer(histogramBuffer);
+	Application::allocator.destroyBuffer(scanOffsetBuffer);
+	Application::allocator.destroyBuffer(keysTempBuffer);
+	Application::allocator.destroyBuffer(valuesTempBuffer);
+	capacity = 0;
+	key64Reserved = false;
+	valuesReserved = false;
+	initialized = false;
+}
+void GPUPrimitives::compileAndCreateShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "primitives.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(shaderio::PrimitivesPushConstant),
+	};
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.pName = "main",
+		.setLayoutCount = 1,
+		.pSetLayouts = descPack.getLayoutPtr(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	VkDevice device = Application::app->getDevice();
+	auto createShader = [&](const char* entryName, VkShaderEXT& shader) {
+		vkDestroyShaderEXT(device, shader, nullptr);
+		shaderInfo.pName = entryName;
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &shader);
+		NVVK_DBG_NAME(shader);
+	};
+	createShader("computeMain_exclusiveScan", computeShader_exclusiveScan);
+	createShader("computeMain_compact", computeShader_compact);
+	createShader("computeMain_radixHistogram", computeShader_radixHistogram);
+	createShader("computeMain_radixScatter", computeShader_radixScatter);
+}
+void GPUPrimitives::reserve(uint32_t maxElementCount, bool key64, bool hasValues) {
+	if (!initialized) init();
+	if (maxElementCount <= capacity && (!key64 || key64Reserved) && (!hasValues || valuesReserved)) return;
+	capacity = std::max(capacity, maxElementCount);
+	key64Reserved |= key64;
+	valuesReserved |= hasValues;
+
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->destroyBuffer(partitionStatusBuffer);
+	allocator->destroyBuffer(histogramBuffer);
+	allocator->destroyBuffer(scanOffsetBuffer);
+	allocator->destroyBuffer(keysTempBuffer);
+	allocator->destroyBuffer(valuesTempBuffer);
+
+	//ֱͼǰ׺ҲʹpartitionStatusBufferһΪֿ
+	uint32_t partitionCount = nvvk::getGroupCounts(capacity, PRIMITIVES_PARTITION_SIZE);
+	uint32_t histogramCount = partitionCount * PRIMITIVES_RADIX_SIZE;
+	uint32_t statusCount = std::max(partitionCount, nvvk::getGroupCounts(histogramCount, PRIMITIVES_PARTITION_SIZE)) + 1;
+
+	const VkBufferUsageFlags2 usage = VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT;
+	allocator->createBuffer(partitionStatusBuffer, VkDeviceSize(statusCount) * sizeof(uint32_t), usage);
+	NVVK_DBG_NAME(partitionStatusBuffer.buffer);
+	allocator->createBuffer(histogramBuffer, VkDeviceSize(histogramCount) * sizeof(uint32_t), usage);
+	NVVK_DBG_NAME(histogramBuffer.buffer);
+	allocator->createBuffer(scanOffsetBuffer, VkDeviceSize(capacity) * sizeof(uint32_t), usage);
+	NVVK_DBG_NAME(scanOffsetBuffer.buffer);
+	allocator->createBuffer(keysTempBuffer, VkDeviceSize(capacity) * sizeof(uint32_t) * (key64Reserved ? 2 : 1), usage);
+	NVVK_DBG_NAME(keysTempBuffer.buffer);
+	allocator->createBuffer(valuesTempBuffer, VkDeviceSize(valuesReserved ? capacity : 1) * sizeof(uint32_t), usage);
+	NVVK_DBG_NAME(valuesTempBuffer.buffer);
+}
+void GPUPrimitives::cmdDispatch(VkCommandBuffer cmd, VkShaderEXT shader, uint32_t groupCount) {
+	//δʹõbindingҲҪЧĻ
+	nvvk::WriteSetContainer write{};
+	for (uint32_t binding = 0; binding < bindingBuffers.size(); ++binding)
+		write.append(descPack.makeWrite(binding), bindingBuffers[binding] ? *bindingBuffers[binding] : partitionStatusBuffer);
+	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, write.size(), write.data());
+	bindingBuffers.fill(nullptr);
+
+	VkPushConstantsInfo pushInfo{
+		.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+		.layout = pipelineLayout,
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(shaderio::PrimitivesPushConstant),
+		.pValues = &pushConstant,
+	};
+	vkCmdPushConstants2(cmd, &pushInfo);
+
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &shader);
+	vkCmdDispatch(cmd, groupCount, 1, 1);
+}
+void GPUPrimitives::cmdScan(VkCommandBuffer cmd, const nvvk::Buffer& input, const nvvk::Buffer& output, uint32_t elementCount,
+	const nvvk::Buffer* totalCount, bool predicate) {
+	uint32_t partitionCount = nvvk::getGroupCounts(elementCount, PRIMITIVES_PARTITION_SIZE);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	vkCmdFillBuffer(cmd, partitionStatusBuffer.buffer, 0, VkDeviceSize(partitionCount + 1) * sizeof(uint32_t), 0);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	pushConstant = {
+		.elementCount = elementCount,
+		.partitionCount = partitionCount,
+		.scanPredicate = predicate ? 1u : 0u,
+		.writeTotalCount = totalCount ? 1u : 0u,
+	};
+	bindingBuffers[shaderio::eScanInput] = &input;
+	bindingBuffers[shaderio::eScanOutput] = &output;
+	bindingBuffers[shaderio::ePartitionStatus] = &partitionStatusBuffer;
+	bindingBuffers[shaderio::eTotalCount] = totalCount;
+	cmdDispatch(cmd, computeShader_exclusiveScan, partitionCount);
+}
+void GPUPrimitives::cmdExclusiveScan(VkCommandBuffer cmd, const nvvk::Buffer& input, const nvvk::Buffer& output, uint32_t elementCount,
+	const nvvk::Buffer* totalCount, bool predicate) {
+	NVVK_DBG_SCOPE(cmd);
+	if (elementCount == 0) return;
+	if (elementCount > capacity) throw std::runtime_error("GPUPrimitives: elementCountreserve");
+
+	cmdScan(cmd, input, output, elementCount, totalCount, predicate);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+}
+void GPUPrimitives::cmdCompact(VkCommandBuffer cmd, const nvvk::Buffer& flags, const nvvk::Buffer& values, const nvvk::Buffer& output,
+	const nvvk::Buffer& outputCount, uint32_t elementCount) {
+	NVVK_DBG_SCOPE(cmd);
+	if (elementCount == 0) {
+		vkCmdFillBuffer(cmd, outputCount.buffer, 0, sizeof(uint32_t), 0);
+		return;
+	}
+	if (elementCount > capacity) throw std::runtime_error("GPUPrimitives: elementCountreserve");
+
+	cmdScan(cmd, flags, scanOffsetBuffer, elementCount, &outputCount, true);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	pushConstant = { .elementCount = elementCount };
+	bindingBuffers[shaderio::eScanInput] = &flags;
+	bindingBuffers[shaderio::eScanOutput] = &scanOffsetBuffer;
+	bindingBuffers[shaderio::eValuesIn] = &values;
+	bindingBuffers[shaderio::eValuesOut] = &output;
+	cmdDispatch(cmd, computeShader_compact, nvvk::getGroupCounts(elementCount, PRIMITIVES_THREADGROUP_SIZE));
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+}
+void GPUPrimitives::cmdRadixSort(VkCommandBuffer cmd, const nvvk::Buffer& keys, const nvvk::Buffer* values, uint32_t elementCount,
+	uint32_t keyBitCount, bool key64) {
+	NVVK_DBG_SCOPE(cmd);
+	if (elementCount <= 1) return;
+	if (elementCount > capacity || (key64 && !key64Reserved) || (values && !valuesReserved))
+		throw std::runtime_error("GPUPrimitives: Ԫسreserve");
+
+	keyBitCount = std::min(keyBitCount, key64 ? 64u : 32u);
+	uint32_t partitionCount = nvvk::getGroupCounts(elementCount, PRIMITIVES_PARTITION_SIZE);
+	const nvvk::Buffer* keysIn = &keys;
+	const nvvk::Buffer* keysOut = &keysTempBuffer;
+	const nvvk::Buffer* valuesIn = values ? values : &valuesTempBuffer;
+	const nvvk::Buffer* valuesOut = &valuesTempBuffer;
+	uint32_t passCount = 0;
+	for (uint32_t shift = 0; shift < keyBitCount; shift += PRIMITIVES_RADIX_BITS, ++passCount) {
+		const shaderio::PrimitivesPushConstant passPushConstant = {
+			.elementCount = elementCount,
+			.partitionCount = partitionCount,
+			.radixShift = shift,
+			.keyWordCount = key64 ? 2u : 1u,
+			.hasValues = values ? 1u : 0u,
+		};
+
+		pushConstant = passPushConstant;
+		bindingBuffers[shaderio::eKeysIn] = keysIn;
+		bindingBuffers[shaderio::eHistogram] = &histogramBuffer;
+		cmdDispatch(cmd, computeShader_radixHistogram, partitionCount);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+		cmdScan(cmd, histogramBuffer, histogramBuffer, partitionCount * PRIMITIVES_RADIX_SIZE, nullptr, false);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+		pushConstant = passPushConstant;
+		bindingBuffers[shaderio::eKeysIn] = keysIn;
+		bindingBuffers[shaderio::eKeysOut] = keysOut;
+		bindingBuffers[shaderio::eValuesIn] = valuesIn;
+		bindingBuffers[shaderio::eValuesOut] = valuesOut;
+		bindingBuffers[shaderio::eHistogram] = &histogramBuffer;
+		cmdDispatch(cmd, computeShader_radixScatter, partitionCount);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+
+		std::swap(keysIn, keysOut);
+		std::swap(valuesIn, valuesOut);
+	}
+
+	//ʱʱ
+	if (passCount % 2 == 1) {
+		VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = VkDeviceSize(elementCount) * sizeof(uint32_t) * (key64 ? 2 : 1) };
+		vkCmdCopyBuffer(cmd, keysTempBuffer.buffer, keys.buffer, 1, &region);
+		if (values) {
+			region.size = VkDeviceSize(elementCount) * sizeof(uint32_t);
+			vkCmdCopyBuffer(cmd, valuesTempBuffer.buffer, values->buffer, 1, &region);
+		}
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	}
+}
+//-----------------------------------------------------benchmark--------------------------------------------------------
+bool GPUPrimitives::benchmark(uint32_t elementCount) {
+	if (elementCount == 0) return true;
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	const VkBufferUsageFlags2 usage = VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT;
+	reserve(elementCount, true, true);
+
+	std::mt19937 rng(1234);
+	std::vector<uint32_t> scanInput(elementCount), flags(elementCount), values(elementCount), keys32(elementCount);
+	std::vector<uint64_t> keys64(elementCount);
+	for (uint32_t i = 0; i < elementCount; ++i) {
+		scanInput[i] = rng() & 0xF;		//ܺҪС2^30
+		flags[i] = (rng() & 3) == 0 ? 1 : 0;
+		values[i] = i;
+		keys32[i] = rng();
+		keys64[i] = (uint64_t(rng()) << 32) | rng();
+	}
+
+	auto createBuffer = [&](nvvk::Buffer& buffer, VkDeviceSize size, const void* data) {
+		allocator->createBuffer(buffer, size, usage);
+		NVVK_DBG_NAME(buffer.buffer);
+		if (data) NVVK_CHECK(Application::stagingUploader.appendBuffer(buffer, 0, size, data));
+	};
+	nvvk::Buffer scanInputBuffer, scanOutputBuffer, flagBuffer, valueBuffer, compactBuffer, countBuffer, keyBuffer32, keyBuffer64, sortValueBuffer;
+	createBuffer(scanInputBuffer, elementCount * sizeof(uint32_t), scanInput.data());
+	createBuffer(scanOutputBuffer, elementCount * sizeof(uint32_t), nullptr);
+	createBuffer(flagBuffer, elementCount * sizeof(uint32_t), flags.data());
+	createBuffer(valueBuffer, elementCount * sizeof(uint32_t), values.data());
+	createBuffer(compactBuffer, elementCount * sizeof(uint32_t), nullptr);
+	createBuffer(countBuffer, sizeof(uint32_t), nullptr);
+	createBuffer(keyBuffer32, elementCount * sizeof(uint32_t), keys32.data());
+	createBuffer(keyBuffer64, elementCount * sizeof(uint64_t), keys64.data());
+	createBuffer(sortValueBuffer, elementCount * sizeof(uint32_t), values.data());
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	Application::stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	Application::stagingUploader.releaseStaging();
+
+	//GPUʱύȴ
+	auto timeGPU = [&](auto&& record) {
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		auto start = std::chrono::high_resolution_clock::now();
+		record(cmd);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	auto timeCPU = [](auto&& run) {
+		auto start = std::chrono::high_resolution_clock::now();
+		run();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	nvvk::Buffer readbackBuffer;
+	allocator->createBuffer(readbackBuffer, elementCount * sizeof(uint64_t), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(readbackBuffer.buffer);
+	auto readback = [&](const nvvk::Buffer& buffer, VkDeviceSize size, void* data) {
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = size };
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		vkCmdCopyBuffer(cmd, buffer.buffer, readbackBuffer.buffer, 1, &region);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+		vmaInvalidateAllocation(*allocator, readbackBuffer.allocation, 0, VK_WHOLE_SIZE);
+		memcpy(data, readbackBuffer.mapping, size);
+	};
+
+	//exclusive scan
+	std::vector<uint32_t> cpuResult(elementCount), gpuResult(elementCount);
+	double cpuTime = timeCPU([&]() { Primitives::exclusiveScan(scanInput, cpuResult); });
+	double gpuTime = timeGPU([&](VkCommandBuffer cmd) { cmdExclusiveScan(cmd, scanInputBuffer, scanOutputBuffer, elementCount); });
+	readback(scanOutputBuffer, elementCount * sizeof(uint32_t), gpuResult.data());
+	bool match = cpuResult == gpuResult;
+	bool allMatch = match;
+	LOGI("Primitives benchmark: exclusiveScan %u, CPU %.3f ms, GPU %.3f ms, %s\n", elementCount, cpuTime, gpuTime, match ? "match" : "MISMATCH");
+
+	//stream compaction
+	uint32_t cpuCount = 0, gpuCount = 0;
+	cpuTime = timeCPU([&]() { cpuCount = Primitives::compact(flags, values, cpuResult); });
+	gpuTime = timeGPU([&](VkCommandBuffer cmd) { cmdCompact(cmd, flagBuffer, valueBuffer, compactBuffer, countBuffer, elementCount); });
+	readback(countBuffer, sizeof(uint32_t), &gpuCount);
+	readback(compactBuffer, elementCount * sizeof(uint32_t), gpuResult.data());
+	match = cpuCount == gpuCount && std::equal(cpuResult.begin(), cpuResult.begin() + cpuCount, gpuResult.begin());
+	allMatch &= match;
+	LOGI("Primitives benchmark: compact %u -> %u, CPU %.3f ms, GPU %.3f ms, %s\n", elementCount, cpuCount, cpuTime, gpuTime, match ? "match" : "MISMATCH");
+
+	//32λkey-value
+	std::vector<uint32_t> cpuKeys32 = keys32, cpuValues = values, gpuKeys32(elementCount), gpuValues(elementCount);
+	cpuTime = timeCPU([&]() { Primitives::radixSort(cpuKeys32, &cpuValues, 32); });
+	gpuTime = timeGPU([&](VkCommandBuffer cmd) { cmdRadixSort(cmd, keyBuffer32, &sortValueBuffer, elementCount, 32); });
+	readback(keyBuffer32, elementCount * sizeof(uint32_t), gpuKeys32.data());
+	readback(sortValueBuffer, elementCount * sizeof(uint32_t), gpuValues.data());
+	match = cpuKeys32 == gpuKeys32 && cpuValues == gpuValues;
+	allMatch &= match;
+	LOGI("Primitives benchmark: radixSort32 %u, CPU %.3f ms, GPU %.3f ms, %s\n", elementCount, cpuTime, gpuTime, match ? "match" : "MISMATCH");
+
+	//64λkey
+	std::vector<uint64_t> cpuKeys64 = keys64, gpuKeys64(elementCount);
+	cpuTime = timeCPU([&]() { Primitives::radixSort(cpuKeys64, nullptr, 64); });
+	gpuTime = timeGPU([&](VkCommandBuffer cmd) { cmdRadixSort(cmd, keyBuffer64, nullptr, elementCount, 64, true); });
+	readback(keyBuffer64, elementCount * sizeof(uint64_t), gpuKeys64.data());
+	match = cpuKeys64 == gpuKeys64;
+	allMatch &= match;
+	LOGI("Primitives benchmark: radixSort64 %u, CPU %.3f ms, GPU %.3f ms, %s\n", elementCount, cpuTime, gpuTime, match ? "match" : "MISMATCH");
+
+	for (nvvk::Buffer* buffer : { &scanInputBuffer, &scanOutputBuffer, &flagBuffer, &valueBuffer, &compactBuffer, &countBuffer,
+		&keyBuffer32, &keyBuffer64, &sortValueBuffer, &readbackBuffer })
+		allocator->destroyBuffer(*buffer);
+	if (!allMatch) LOGE("Primitives benchmark: GPU results MISMATCH CPU results\n");
+	return allMatch;
+}
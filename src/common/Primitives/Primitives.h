@@ -0,0 +1,138 @@
+#pragma once
+
+#include "./PrimitivesShaderio.h"
+#include <nvvk/resources.hpp>
+#include <nvvk/descriptors.hpp>
+#include <nvutils/parallel_work.hpp>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
+#ifndef FZBRENDERER_PRIMITIVES_H
+#define FZBRENDERER_PRIMITIVES_H
+
+namespace FzbRenderer {
+/*
+ԭCPUGPUshaders/primitives.slangͬػ˲pass
+1. exclusiveScanuint32ǰ׺ͣpredicateΪtrueʱ(input != 0)ǰ׺
+2. compactflagsΪ0valueԭ˳򣬷ر
+3. radixSortLSDÿ8λȶkeyΪ32λ64λvalueѡ
+CPU汾ʹnvutils̳߳أÿֿͳֱͼ(, ֿ)˳ƫƣȶ
+*/
+class Primitives {
+public:
+	static uint64_t exclusiveScan(std::span<const uint32_t> input, std::span<uint32_t> output, bool predicate = false);
+	static uint32_t compact(std::span<const uint32_t> flags, std::span<const uint32_t> values, std::span<uint32_t> output);
+	static void radixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>* values, uint32_t keyBitCount = 32);
+	static void radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>* values, uint32_t keyBitCount = 64);
+
+	//getKey(const T&)uint64_tֻеkeyBitCountλ
+	template<typename T, typename GetKey>
+	static void radixSortByKey(std::vector<T>& items, uint32_t keyBitCount, GetKey getKey);
+};
+
+template<typename T, typename GetKey>
+void Primitives::radixSortByKey(std::vector<T>& items, uint32_t keyBitCount, GetKey getKey) {
+	constexpr uint32_t RADIX_SIZE = PRIMITIVES_RADIX_SIZE;
+	const uint64_t itemCount = items.size();
+	if (itemCount <= 1) return;
+
+	const uint64_t threadCount = std::max<uint64_t>(1, nvutils::get_thread_pool().get_thread_count());
+	const uint64_t chunkCount = std::clamp<uint64_t>(itemCount / 4096, 1, threadCount);
+	const uint64_t chunkSize = (itemCount + chunkCount - 1) / chunkCount;
+	std::vector<std::array<uint64_t, RADIX_SIZE>> chunkOffsets(chunkCount);
+	std::vector<T> sortedItems(itemCount);
+
+	for (uint32_t shift = 0; shift < keyBitCount; shift += PRIMITIVES_RADIX_BITS) {
+		nvutils::parallel_batches_pooled<1>(chunkCount, [&](uint64_t chunkIndex, uint32_t threadIndex) {
+			std::array<uint64_t, RADIX_SIZE>& histogram = chunkOffsets[chunkIndex];
+			histogram.fill(0);
+			uint64_t end = std::min(itemCount, (chunkIndex + 1) * chunkSize);
+			for (uint64_t i = chunkIndex * chunkSize; i < end; ++i) ++histogram[(uint64_t(getKey(items[i])) >> shift) & (RADIX_SIZE - 1)];
+		});
+
+		//keyһλͬʱ
+		bool singleDigit = false;
+		for (uint32_t digit = 0; digit < RADIX_SIZE && !singleDigit; ++digit) {
+			uint64_t digitCount = 0;
+			for (uint64_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) digitCount += chunkOffsets[chunkIndex][digit];
+			singleDigit = digitCount == itemCount;
+		}
+		if (singleDigit) continue;
+
+		//Ȱֿٰ֡˳ƫƣ֤ȶ
+		uint64_t offset = 0;
+		for (uint32_t digit = 0; digit < RADIX_SIZE; ++digit) {
+			for (uint64_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+				uint64_t count = chunkOffsets[chunkIndex][digit];
+				chunkOffsets[chunkIndex][digit] = offset;
+				offset += count;
+			}
+		}
+
+		nvutils::parallel_batches_pooled<1>(chunkCount, [&](uint64_t chunkIndex, uint32_t threadIndex) {
+			std::array<uint64_t, RADIX_SIZE>& offsets = chunkOffsets[chunkIndex];
+			uint64_t end = std::min(itemCount, (chunkIndex + 1) * chunkSize);
+			for (uint64_t i = chunkIndex * chunkSize; i < end; ++i)
+				sortedItems[offsets[(uint64_t(getKey(items[i])) >> shift) & (RADIX_SIZE - 1)]++] = items[i];
+		});
+		items.swap(sortedItems);
+	}
+}
+
+/*
+GPUԭʹpush descriptorֻҪṩ
+1. һreserveʱŴshaderpipeline layoutʱreserve䣬ʹǵִڼ
+2. ǰ׺͵ܺҪС2^30partition statusĵ30λ
+3. cmd*ֻ¼Ҫڵǰɼʱcompute -> compute/transfer
+*/
+class GPUPrimitives {
+public:
+	GPUPrimitives() = default;
+	~GPUPrimitives() = default;
+
+	void init();
+	void clean();
+	void reserve(uint32_t maxElementCount, bool key64 = false, bool hasValues = true);
+
+	void cmdExclusiveScan(VkCommandBuffer cmd, const nvvk::Buffer& input, const nvvk::Buffer& output, uint32_t elementCount,
+		const nvvk::Buffer* totalCount = nullptr, bool predicate = false);
+	//output[0, outputCount)ΪflagsΪ0value
+	void cmdCompact(VkCommandBuffer cmd, const nvvk::Buffer& flags, const nvvk::Buffer& values, const nvvk::Buffer& output,
+		const nvvk::Buffer& outputCount, uint32_t elementCount);
+	//64λkey(32λ, 32λ)ţдkeysvalues
+	void cmdRadixSort(VkCommandBuffer cmd, const nvvk::Buffer& keys, const nvvk::Buffer* values, uint32_t elementCount,
+		uint32_t keyBitCount, bool key64 = false);
+
+	//ϱȽGPUCPUĽͺʱMISMATCHʱfalse
+	bool benchmark(uint32_t elementCount);
+private:
+	void compileAndCreateShaders();
+	void cmdScan(VkCommandBuffer cmd, const nvvk::Buffer& input, const nvvk::Buffer& output, uint32_t elementCount,
+		const nvvk::Buffer* totalCount, bool predicate);
+	void cmdDispatch(VkCommandBuffer cmd, VkShaderEXT shader, uint32_t groupCount);
+
+	nvvk::DescriptorPack descPack;
+	VkPipelineLayout pipelineLayout{};
+	shaderio::PrimitivesPushConstant pushConstant{};
+	std::array<const nvvk::Buffer*, shaderio::BindingPoints_Primitives::eHistogram + 1> bindingBuffers{};
+
+	VkShaderEXT computeShader_exclusiveScan{};
+	VkShaderEXT computeShader_compact{};
+	VkShaderEXT computeShader_radixHistogram{};
+	VkShaderEXT computeShader_radixScatter{};
+
+	bool initialized = false;
+	uint32_t capacity = 0;
+	bool key64Reserved = false;
+	bool valuesReserved = false;
+	nvvk::Buffer partitionStatusBuffer;
+	nvvk::Buffer histogramBuffer;
+	nvvk::Buffer scanOffsetBuffer;
+	nvvk::Buffer keysTempBuffer;
+	nvvk::Buffer valuesTempBuffer;
+};
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <common/Shader/shaderStructType.h>
+
+#ifndef FZBRENDERER_PRIMITIVES_SHADERIO_H
+#define FZBRENDERER_PRIMITIVES_SHADERIO_H
+NAMESPACE_SHADERIO_BEGIN()
+
+#define PRIMITIVES_THREADGROUP_SIZE 256
+#define PRIMITIVES_ITEMS_PER_THREAD 4
+#define PRIMITIVES_PARTITION_SIZE (PRIMITIVES_THREADGROUP_SIZE * PRIMITIVES_ITEMS_PER_THREAD)
+
+#define PRIMITIVES_RADIX_BITS 8
+#define PRIMITIVES_RADIX_SIZE (1 << PRIMITIVES_RADIX_BITS)
+
+// decoupled look-back partition status: 2 flag bits + 30 bit value, so a scan total must be < 2^30
+#define PRIMITIVES_STATUS_NOT_READY 0u
+#define PRIMITIVES_STATUS_AGGREGATE 0x40000000u
+#define PRIMITIVES_STATUS_INCLUSIVE 0x80000000u
+#define PRIMITIVES_STATUS_FLAG_MASK 0xC0000000u
+#define PRIMITIVES_STATUS_VALUE_MASK 0x3FFFFFFFu
+
+enum BindingPoints_Primitives {
+	eScanInput = 0,
+	eScanOutput,
+	ePartitionStatus,		// partitionCount status + 1 partition counter
+	eTotalCount,
+	eKeysIn,
+	eKeysOut,
+	eValuesIn,
+	eValuesOut,
+	eHistogram,
+};
+
+struct PrimitivesPushConstant {
+	uint elementCount;
+	uint partitionCount;
+	uint scanPredicate;		// 1: scan (input != 0) instead of input, used by stream compaction
+	uint writeTotalCount;
+	uint radixShift;
+	uint keyWordCount;		// 1: 32 bit key, 2: 64 bit key stored as (low, high)
+	uint hasValues;
+};
+
+NAMESPACE_SHADERIO_END()
+#endif
@@ -0,0 +1,285 @@
+#include "./Profiler.h"
+#include <common/Application/Application.h>
+#include <nvgui/property_editor.hpp>
+#include <fstream>
+
+using namespace FzbRenderer;
+
+void Profiler::init() {
+	VkPhysicalDevice physicalDevice = Application::app->getPhysicalDevice();
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	timestampPeriod = properties.limits.timestampPeriod;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies[Application::app->getQueue(0).familyIndex].timestampValidBits;
+	timestampMask = timestampValidBits >= 64 ? UINT64_MAX : ((uint64_t(1) << timestampValidBits) - 1);
+
+	frameCycleSize = Application::app->getFrameCycleSize();
+	frames.resize(frameCycleSize);
+	traceFrames.resize(PROFILER_TRACE_FRAME_COUNT);
+
+	if (timestampValidBits == 0) {
+		LOGW("Profiler: queue does not support timestamps, only CPU time is recorded\n");
+		return;
+	}
+
+	VkQueryPoolCreateInfo queryPoolInfo{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = frameCycleSize * PROFILER_MAX_SECTION_PER_FRAME * 2,
+	};
+	NVVK_CHECK(vkCreateQueryPool(Application::app->getDevice(), &queryPoolInfo, nullptr, &queryPool));
+	NVVK_DBG_NAME(queryPool);
+	vkResetQueryPool(Application::app->getDevice(), queryPool, 0, queryPoolInfo.queryCount);
+}
+void Profiler::clean() {
+	vkDestroyQueryPool(Application::app->getDevice(), queryPool, nullptr);
+	queryPool = VK_NULL_HANDLE;
+	frames.clear();
+	traceFrames.clear();
+	statistics.clear();
+	statisticsIndices.clear();
+}
+
+void Profiler::beginFrame() {
+	frameCycleIndex = Application::app->getFrameCycleIndex() % frameCycleSize;
+	FrameRecord& frame = frames[frameCycleIndex];
+	resolveFrame(frame);		//onPreRenderʱframe cyclefenceѾȴˣһεʱһ
+
+	frame.frameNumber = frameNumber;
+	frame.queryCount = 0;
+	frame.sections.clear();
+	sectionStack.clear();
+	inFrame = enable;
+	queriesReset = false;
+}
+void Profiler::cmdResetQueries(VkCommandBuffer cmd) {
+	if (!inFrame || queryPool == VK_NULL_HANDLE) return;
+	vkCmdResetQueryPool(cmd, queryPool, frameCycleIndex * PROFILER_MAX_SECTION_PER_FRAME * 2, PROFILER_MAX_SECTION_PER_FRAME * 2);
+	queriesReset = true;
+}
+void Profiler::endFrame() {
+	while (!sectionStack.empty()) endSection(nullptr, sectionStack.back());
+	inFrame = false;
+	queriesReset = false;
+	++frameNumber;
+}
+
+uint32_t Profiler::beginSection(VkCommandBuffer cmd, const std::string& name) {
+	if (!inFrame) return UINT32_MAX;
+
+	auto it = statisticsIndices.find(name);
+	uint32_t statisticsIndex;
+	if (it == statisticsIndices.end()) {
+		statisticsIndex = uint32_t(statistics.size());
+		statisticsIndices[name] = statisticsIndex;
+		statistics.emplace_back();
+		statistics.back().name = name;
+	}
+	else statisticsIndex = it->second;
+	statistics[statisticsIndex].level = uint32_t(sectionStack.size());
+
+	FrameRecord& frame = frames[frameCycleIndex];
+	SectionRecord section{
+		.statisticsIndex = statisticsIndex,
+		.level = uint32_t(sectionStack.size()),
+		.queryIndex = UINT32_MAX,
+		.cpuBegin = timer.getMicroseconds(),
+		.cpuEnd = 0.0,
+	};
+	if (queriesReset && cmd && frame.queryCount + 2 <= PROFILER_MAX_SECTION_PER_FRAME * 2) {
+		section.queryIndex = frameCycleIndex * PROFILER_MAX_SECTION_PER_FRAME * 2 + frame.queryCount;
+		frame.queryCount += 2;
+		vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, queryPool, section.queryIndex);
+	}
+
+	uint32_t sectionIndex = uint32_t(frame.sections.size());
+	frame.sections.push_back(section);
+	sectionStack.push_back(sectionIndex);
+	return sectionIndex;
+}
+void Profiler::endSection(VkCommandBuffer cmd, uint32_t sectionIndex) {
+	if (!inFrame || sectionIndex == UINT32_MAX) return;
+	FrameRecord& frame = frames[frameCycleIndex];
+	if (sectionIndex >= frame.sections.size()) return;
+
+	SectionRecord& section = frame.sections[sectionIndex];
+	section.cpuEnd = timer.getMicroseconds();
+	if (section.queryIndex != UINT32_MAX) {
+		//beginSectionʱcmdendʱͬһcmdд룬sectionGPUʱЧ
+		if (cmd) vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, queryPool, section.queryIndex + 1);
+		else section.queryIndex = UINT32_MAX;
+	}
+
+	if (!sectionStack.empty() && sectionStack.back() == sectionIndex) sectionStack.pop_back();
+}
+
+void Profiler::resolveFrame(FrameRecord& frame) {
+	if (frame.sections.empty()) return;
+
+	uint32_t firstQuery = frameCycleIndex * PROFILER_MAX_SECTION_PER_FRAME * 2;
+	std::vector<uint64_t> timestamps;
+	bool gpuValid = false;
+	if (queryPool && frame.queryCount > 0) {
+		timestamps.resize(frame.queryCount);
+		VkResult result = vkGetQueryPoolResults(Application::app->getDevice(), queryPool, firstQuery, frame.queryCount,
+			timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		gpuValid = result == VK_SUCCESS;
+	}
+
+	std::vector<TraceEvent>& traceFrame = traceFrames[traceWriteIndex];
+	traceWriteIndex = (traceWriteIndex + 1) % PROFILER_TRACE_FRAME_COUNT;
+	traceFrame.clear();
+
+	for (const SectionRecord& section : frame.sections) {
+		double cpuTime = section.cpuEnd - section.cpuBegin;
+		double gpuBegin = 0.0;
+		double gpuTime = -1.0;
+		if (gpuValid && section.queryIndex != UINT32_MAX) {
+			uint64_t begin = timestamps[section.queryIndex - firstQuery] & timestampMask;
+			uint64_t end = timestamps[section.queryIndex - firstQuery + 1] & timestampMask;
+			gpuBegin = double(begin) * timestampPeriod / 1000.0;
+			gpuTime = double(end - begin) * timestampPeriod / 1000.0;		//ns -> us
+		}
+		addSample(statistics[section.statisticsIndex], frame.frameNumber, cpuTime, gpuTime);
+
+		traceFrame.push_back({
+			.statisticsIndex = section.statisticsIndex,
+			.level = section.level,
+			.frameNumber = frame.frameNumber,
+			.cpuBegin = section.cpuBegin,
+			.cpuDuration = cpuTime,
+			.gpuBegin = gpuBegin,
+			.gpuDuration = gpuTime,
+		});
+	}
+	frame.sections.clear();
+	frame.queryCount = 0;
+}
+void Profiler::addSample(Statistics& stat, uint64_t frameNumber, double cpuTime, double gpuTime) {
+	gpuTime = std::max(gpuTime, 0.0);
+	if (stat.lastFrameNumber == frameNumber) {		//ͬһ֡ͬsectionۼ
+		uint32_t lastIndex = (stat.writeIndex + PROFILER_STATISTICS_FRAME_COUNT - 1) % PROFILER_STATISTICS_FRAME_COUNT;
+		stat.cpuTimes[lastIndex] += cpuTime;
+		stat.gpuTimes[lastIndex] += gpuTime;
+		return;
+	}
+	stat.lastFrameNumber = frameNumber;
+	stat.cpuTimes[stat.writeIndex] = cpuTime;
+	stat.gpuTimes[stat.writeIndex] = gpuTime;
+	stat.writeIndex = (stat.writeIndex + 1) % PROFILER_STATISTICS_FRAME_COUNT;
+	stat.sampleCount = std::min(stat.sampleCount + 1, uint32_t(PROFILER_STATISTICS_FRAME_COUNT));
+}
+
+void Profiler::uiRender() {
+	namespace PE = nvgui::PropertyEditor;
+	if (ImGui::Begin("Profiler")) {
+		PE::begin();
+		PE::Checkbox("Enable", &enable);
+		PE::end();
+		if (ImGui::Button("Dump Chrome Trace")) {
+			std::filesystem::path tracePath = nvutils::getExecutablePath().replace_extension(".trace.json");
+			dumpChromeTrace(tracePath);
+		}
+		if (queryPool == VK_NULL_HANDLE) ImGui::TextDisabled("GPU timestamps not supported");
+
+		ImGuiTableFlags tableFlags = ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+		if (ImGui::BeginTable("ProfilerTable", 5, tableFlags)) {
+			ImGui::TableSetupColumn("Section");
+			ImGui::TableSetupColumn("GPU avg (ms)");
+			ImGui::TableSetupColumn("GPU min (ms)");
+			ImGui::TableSetupColumn("GPU max (ms)");
+			ImGui::TableSetupColumn("CPU avg (ms)");
+			ImGui::TableHeadersRow();
+			for (const Statistics& stat : statistics) {
+				if (stat.sampleCount == 0) continue;
+				double gpuSum = 0.0, cpuSum = 0.0;
+				double gpuMin = DBL_MAX, gpuMax = 0.0;
+				for (uint32_t i = 0; i < stat.sampleCount; ++i) {
+					gpuSum += stat.gpuTimes[i];
+					cpuSum += stat.cpuTimes[i];
+					gpuMin = std::min(gpuMin, stat.gpuTimes[i]);
+					gpuMax = std::max(gpuMax, stat.gpuTimes[i]);
+				}
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%*s%s", int(stat.level * 2), "", stat.name.c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", gpuSum / stat.sampleCount / 1000.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", gpuMin / 1000.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", gpuMax / 1000.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", cpuSum / stat.sampleCount / 1000.0);
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+}
+/*
+chrome://tracingĸʽCPUGPUΪ̣
+GPUʱCPUʱ䲻ͬһʱʱ߸Դ0ʼ
+*/
+bool Profiler::dumpChromeTrace(const std::filesystem::path& tracePath) {
+	std::ofstream file(tracePath);
+	if (!file.is_open()) {
+		LOGE("Profiler: failed to open %s\n", nvutils::utf8FromPath(tracePath).c_str());
+		return false;
+	}
+
+	double cpuBase = DBL_MAX, gpuBase = DBL_MAX;
+	for (const std::vector<TraceEvent>& traceFrame : traceFrames) {
+		for (const TraceEvent& event : traceFrame) {
+			cpuBase = std::min(cpuBase, event.cpuBegin);
+			if (event.gpuDuration >= 0.0) gpuBase = std::min(gpuBase, event.gpuBegin);
+		}
+	}
+
+	auto escape = [](const std::string& str) {
+		std::string result;
+		for (char c : str) {
+			if (c == '"' || c == '\\') result.push_back('\\');
+			result.push_back(c);
+		}
+		return result;
+		};
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+	char line[512];
+	for (uint32_t i = 0; i < PROFILER_TRACE_FRAME_COUNT; ++i) {
+		const std::vector<TraceEvent>& traceFrame = traceFrames[(traceWriteIndex + i) % PROFILER_TRACE_FRAME_COUNT];		//ɵ֡ʼ
+		for (const TraceEvent& event : traceFrame) {
+			std::string name = escape(statistics[event.statisticsIndex].name);
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+				name.c_str(), event.cpuBegin - cpuBase, event.cpuDuration, (unsigned long long)event.frameNumber);
+			file << line;
+			if (event.gpuDuration < 0.0) continue;
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+				name.c_str(), event.gpuBegin - gpuBase, event.gpuDuration, (unsigned long long)event.frameNumber);
+			file << line;
+		}
+	}
+	file << "\n]";
+	if (!reports.empty()) {
+		file << ",\"otherData\":{";
+		bool first = true;
+		for (const auto& [name, json] : reports) {
+			file << (first ? "\n" : ",\n") << "\"" << escape(name) << "\":" << json;
+			first = false;
+		}
+		file << "\n}";
+	}
+	file << "}\n";
+	file.close();
+
+	LOGI("Profiler: chrome trace saved to %s\n", nvutils::utf8FromPath(tracePath).c_str());
+	return true;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <cfloat>
+#include <nvutils/timers.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+
+#ifndef FZBRENDERER_PROFILER_H
+#define FZBRENDERER_PROFILER_H
+
+#define PROFILER_MAX_SECTION_PER_FRAME 128		//ÿ֡sectionÿsectionʱ
+#define PROFILER_STATISTICS_FRAME_COUNT 128		//ͳƵ֡
+#define PROFILER_TRACE_FRAME_COUNT 64			//chrome traceʱ֡
+
+namespace FzbRenderer {
+/*
+֡
+1. ÿsectioncmdдһʱVK_QUERY_TYPE_TIMESTAMPͬʱ¼CPUĿʼͽʱ
+2. ÿframe cycle֡ռquerypoolһΣö´αʹʱGPUһѾִϣʱؽ
+3. ͳPROFILER_STATISTICS_FRAME_COUNT֡ƽСʱImGuiʾ
+4. PROFILER_TRACE_FRAME_COUNT֡¼ԵΪchrome://tracingjsonsetReportıһд
+*/
+class Profiler {
+public:
+	class Section {
+	public:
+		Section(Profiler* profiler, VkCommandBuffer cmd, uint32_t sectionIndex) : profiler(profiler), cmd(cmd), sectionIndex(sectionIndex) {};
+		Section(const Section&) = delete;
+		Section& operator=(const Section&) = delete;
+		Section(Section&& other) noexcept : profiler(other.profiler), cmd(other.cmd), sectionIndex(other.sectionIndex) { other.profiler = nullptr; };
+		~Section() { if (profiler) profiler->endSection(cmd, sectionIndex); };
+	private:
+		Profiler* profiler;
+		VkCommandBuffer cmd;
+		uint32_t sectionIndex;
+	};
+
+	Profiler() = default;
+	~Profiler() = default;
+
+	void init();
+	void clean();
+
+	void beginFrame();		//onPreRenderеãظframe cycleһεĽ
+	void cmdResetQueries(VkCommandBuffer cmd);		//֡cmdʼʱã֮sectionŻдGPUʱ
+	void endFrame();
+
+	uint32_t beginSection(VkCommandBuffer cmd, const std::string& name);		//cmdΪnullptrʱֻ¼CPUʱ
+	void endSection(VkCommandBuffer cmd, uint32_t sectionIndex);
+	Section section(VkCommandBuffer cmd, const std::string& name) { return Section(this, cmd, beginSection(cmd, name)); };
+
+	void uiRender();
+	bool dumpChromeTrace(const std::filesystem::path& tracePath);
+	//jsonΪһjsonֵchrome traceʱдotherDataٽṹԴͳ
+	void setReport(const std::string& name, const std::string& json) { reports[name] = json; };
+
+	bool enable = true;
+private:
+	struct SectionRecord {
+		uint32_t statisticsIndex;
+		uint32_t level;
+		uint32_t queryIndex;		//UINT32_MAXʾûGPUʱ
+		double cpuBegin;
+		double cpuEnd;
+	};
+	struct FrameRecord {
+		uint64_t frameNumber = 0;
+		uint32_t queryCount = 0;
+		std::vector<SectionRecord> sections;
+	};
+	struct TraceEvent {
+		uint32_t statisticsIndex;
+		uint32_t level;
+		uint64_t frameNumber;
+		double cpuBegin;
+		double cpuDuration;
+		double gpuBegin;		//GPUʱߣλus
+		double gpuDuration;		//С0ʾûGPUʱ
+	};
+	struct Statistics {
+		std::string name;
+		uint32_t level = 0;
+		uint64_t lastFrameNumber = UINT64_MAX;
+		uint32_t sampleCount = 0;
+		uint32_t writeIndex = 0;
+		double cpuTimes[PROFILER_STATISTICS_FRAME_COUNT] = {};
+		double gpuTimes[PROFILER_STATISTICS_FRAME_COUNT] = {};
+	};
+
+	void resolveFrame(FrameRecord& frame);
+	void addSample(Statistics& stat, uint64_t frameNumber, double cpuTime, double gpuTime);
+
+	VkQueryPool queryPool{};
+	float timestampPeriod = 1.0f;		//ÿtickns
+	uint64_t timestampMask = 0;			//Ϊ0ʾöв֧ʱֻ¼CPU
+	uint32_t frameCycleSize = 0;
+	uint32_t frameCycleIndex = 0;
+	uint64_t frameNumber = 0;
+	bool inFrame = false;
+	bool queriesReset = false;
+
+	std::vector<FrameRecord> frames;
+	std::vector<uint32_t> sectionStack;
+
+	std::vector<Statistics> statistics;
+	std::unordered_map<std::string, uint32_t> statisticsIndices;
+
+	std::vector<std::vector<TraceEvent>> traceFrames;		//αPROFILER_TRACE_FRAME_COUNT֡¼
+	uint32_t traceWriteIndex = 0;
+
+	std::map<std::string, std::string> reports;
+
+	nvutils::PerformanceTimer timer;
+};
+}
+
+#endif
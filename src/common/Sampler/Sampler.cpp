@@ -0,0 +1,392 @@
+#include "./Sampler.h"
+#include <common/Application/Application.h>
+#include <common/Shader/Shader.h>
+#include <feature/PathTracing/CPUBSDF.h>
+#include <nvutils/timers.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvvk/compute_pipeline.hpp>
+#include <nvvk/debug_util.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace FzbRenderer;
+
+//-----------------------------------------------------ϣ--------------------------------------------------------
+//nvshaders/random.h.slangͬ
+static uint32_t xxhash32(glm::uvec3 p) {
+	const glm::uvec4 primes = glm::uvec4(2246822519U, 3266489917U, 668265263U, 374761393U);
+	uint32_t h32;
+	h32 = p.z + primes.w + p.x * primes.y;
+	h32 = primes.z * ((h32 << 17) | (h32 >> (32 - 17)));
+	h32 += p.y * primes.y;
+	h32 = primes.z * ((h32 << 17) | (h32 >> (32 - 17)));
+	h32 = primes.x * (h32 ^ (h32 >> 15));
+	h32 = primes.y * (h32 ^ (h32 >> 13));
+	return h32 ^ (h32 >> 16);
+}
+static uint32_t pcg(uint32_t& state) {
+	uint32_t prev = state * 747796405u + 2891336453u;
+	uint32_t word = ((prev >> ((prev >> 28u) + 4u)) ^ prev) * 277803737u;
+	state = prev;
+	return (word >> 22u) ^ word;
+}
+static float rand(uint32_t& seed) {
+	uint32_t r = pcg(seed);
+	return float(r) * (1.F / float(0xffffffffu));
+}
+static uint32_t reverseBits(uint32_t x) {
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+	x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+	return (x >> 16) | (x << 16);
+}
+static uint32_t laineKarrasPermutation(uint32_t x, uint32_t seed) {
+	x += seed;
+	x ^= x * 0x6c50b47cu;
+	x ^= x * 0xb82f1e52u;
+	x ^= x * 0xc7afe638u;
+	x ^= x * 0x8d22f6e6u;
+	return x;
+}
+static uint32_t nestedUniformScramble(uint32_t x, uint32_t seed) {
+	return reverseBits(laineKarrasPermutation(reverseBits(x), seed));
+}
+//-------------------------------------------------------------------------------------------------------------
+static void generateSobolMatrices(uint32_t* matrices) {
+	//0άΪvan der Corput3ά(s, a, m)Joe-Kuonew-joe-kuo-6.21201
+	struct SobolParameter { uint32_t s, a; uint32_t m[3]; };
+	const SobolParameter parameters[SAMPLER_SOBOL_DIMENSION_COUNT - 1] = { { 1, 0, { 1 } }, { 2, 1, { 1, 3 } }, { 3, 1, { 1, 3, 1 } } };
+
+	for (uint32_t bit = 0; bit < SAMPLER_SOBOL_BIT_COUNT; ++bit) matrices[bit] = 1u << (31 - bit);
+	for (uint32_t dimension = 1; dimension < SAMPLER_SOBOL_DIMENSION_COUNT; ++dimension) {
+		const SobolParameter& parameter = parameters[dimension - 1];
+		uint32_t* v = matrices + dimension * SAMPLER_SOBOL_BIT_COUNT;
+		for (uint32_t i = 0; i < SAMPLER_SOBOL_BIT_COUNT; ++i) {
+			if (i < parameter.s) {
+				v[i] = parameter.m[i] << (31 - i);
+				continue;
+			}
+			v[i] = v[i - parameter.s] ^ (v[i - parameter.s] >> parameter.s);
+			for (uint32_t k = 1; k < parameter.s; ++k)
+				if ((parameter.a >> (parameter.s - 1 - k)) & 1u) v[i] ^= v[i - k];
+		}
+	}
+}
+/*
+Ulichneyvoid-and-clusterϸ˹
+1. 10%ĵ㣬ĴƵĿնֱȶ
+2. ӳʼͼƳĴأӴС
+3. ӳʼͼĿնС󣻸˹ڻܺ͹̶0ؾ1ն˺βطת
+*/
+static void generateBlueNoiseRanks(uint32_t* ranks) {
+	constexpr int size = SAMPLER_BLUE_NOISE_SIZE;
+	constexpr int pixelCount = SAMPLER_BLUE_NOISE_PIXEL_COUNT;
+	constexpr float sigma = 1.9f;
+
+	std::vector<float> kernel(pixelCount);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			float dx = float(std::min(x, size - x));
+			float dy = float(std::min(y, size - y));
+			kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+		}
+	}
+	auto splat = [&](std::vector<float>& energy, int pixel, float sign) {
+		int px = pixel % size, py = pixel / size;
+		for (int y = 0; y < size; ++y) {
+			const float* row = &kernel[((y - py) & (size - 1)) * size];
+			for (int x = 0; x < size; ++x) energy[y * size + x] += sign * row[(x - px) & (size - 1)];
+		}
+	};
+	auto tightestCluster = [&](const std::vector<float>& energy, const std::vector<uint8_t>& pattern) {
+		int best = -1;
+		for (int i = 0; i < pixelCount; ++i)
+			if (pattern[i] && (best < 0 || energy[i] > energy[best])) best = i;
+		return best;
+	};
+	auto largestVoid = [&](const std::vector<float>& energy, const std::vector<uint8_t>& pattern) {
+		int best = -1;
+		for (int i = 0; i < pixelCount; ++i)
+			if (!pattern[i] && (best < 0 || energy[i] < energy[best])) best = i;
+		return best;
+	};
+
+	std::vector<uint8_t> pattern(pixelCount, 0);
+	std::vector<float> energy(pixelCount, 0.0f);
+	std::mt19937 rng(1234);
+	const int initialCount = pixelCount / 10;
+	for (int count = 0; count < initialCount;) {
+		int pixel = int(rng() % pixelCount);
+		if (pattern[pixel]) continue;
+		pattern[pixel] = 1;
+		splat(energy, pixel, 1.0f);
+		++count;
+	}
+	while (true) {
+		int cluster = tightestCluster(energy, pattern);
+		pattern[cluster] = 0;
+		splat(energy, cluster, -1.0f);
+		int hole = largestVoid(energy, pattern);
+		pattern[hole] = 1;
+		splat(energy, hole, 1.0f);
+		if (hole == cluster) break;
+	}
+
+	std::vector<uint8_t> phasePattern = pattern;
+	std::vector<float> phaseEnergy = energy;
+	for (int rank = initialCount - 1; rank >= 0; --rank) {
+		int cluster = tightestCluster(phaseEnergy, phasePattern);
+		phasePattern[cluster] = 0;
+		splat(phaseEnergy, cluster, -1.0f);
+		ranks[cluster] = uint32_t(rank);
+	}
+	for (int rank = initialCount; rank < pixelCount; ++rank) {
+		int hole = largestVoid(energy, pattern);
+		pattern[hole] = 1;
+		splat(energy, hole, 1.0f);
+		ranks[hole] = uint32_t(rank);
+	}
+}
+void LowDiscrepancySampler::generateTables(shaderio::SamplerTables& tables) {
+	generateSobolMatrices(tables.sobolMatrices);
+	generateBlueNoiseRanks(tables.blueNoiseRanks);
+}
+//-----------------------------------------------------CPU--------------------------------------------------------
+float LowDiscrepancySampler::get(const shaderio::SamplerTables& tables, shaderio::SamplerType samplerType, uint32_t pixelKey, uint32_t sampleIndex, uint32_t dimension) {
+	uint32_t dimensionSet = dimension / SAMPLER_SOBOL_DIMENSION_COUNT;
+	uint32_t component = dimension % SAMPLER_SOBOL_DIMENSION_COUNT;
+	uint32_t seed = xxhash32(glm::uvec3(samplerType == shaderio::SamplerType_Sobol ? pixelKey : 0u, dimensionSet, uint32_t(samplerType)));
+
+	uint32_t index = nestedUniformScramble(sampleIndex, seed);
+	uint32_t x = 0;
+	for (uint32_t bit = 0; index != 0; index >>= 1, ++bit)
+		if (index & 1u) x ^= tables.sobolMatrices[component * SAMPLER_SOBOL_BIT_COUNT + bit];
+	x = nestedUniformScramble(x, xxhash32(glm::uvec3(seed, component, 0x9e3779b9u))) >> 8;
+
+	if (samplerType == shaderio::SamplerType_BlueNoise) {
+		glm::uvec2 tile = glm::uvec2(pixelKey % SAMPLER_BLUE_NOISE_SIZE, pixelKey / SAMPLER_BLUE_NOISE_SIZE);
+		tile = (tile + glm::uvec2(dimension * 47u, dimension * 29u)) % glm::uvec2(SAMPLER_BLUE_NOISE_SIZE);
+		uint32_t rank = tables.blueNoiseRanks[tile.y * SAMPLER_BLUE_NOISE_SIZE + tile.x];
+		x = (x + rank * (16777216u / SAMPLER_BLUE_NOISE_PIXEL_COUNT) + (8388608u / SAMPLER_BLUE_NOISE_PIXEL_COUNT)) & 0xffffffu;
+	}
+	return float(x) * (1.0f / 16777216.0f);
+}
+uint32_t LowDiscrepancySampler::getPixelKey(shaderio::SamplerType samplerType, glm::uvec2 pixel) {
+	if (samplerType == shaderio::SamplerType_BlueNoise)
+		return (pixel.y % SAMPLER_BLUE_NOISE_SIZE) * SAMPLER_BLUE_NOISE_SIZE + pixel.x % SAMPLER_BLUE_NOISE_SIZE;
+	return xxhash32(glm::uvec3(pixel, 0x85ebca6bu));
+}
+glm::uvec2 LowDiscrepancySampler::initState(shaderio::SamplerType samplerType, glm::uvec2 pixel, uint32_t sampleIndex) {
+	if (samplerType == shaderio::SamplerType_Hash) return glm::uvec2(xxhash32(glm::uvec3(pixel, sampleIndex)), 0u);
+	return glm::uvec2(getPixelKey(samplerType, pixel), (sampleIndex & SAMPLER_STATE_SAMPLE_MASK) << SAMPLER_STATE_DIMENSION_BITS);
+}
+float LowDiscrepancySampler::next(const shaderio::SamplerTables& tables, shaderio::SamplerType samplerType, glm::uvec2& state) {
+	if (samplerType == shaderio::SamplerType_Hash) return rand(state.x);
+
+	uint32_t dimension = state.y & SAMPLER_STATE_DIMENSION_MASK;
+	uint32_t sampleIndex = state.y >> SAMPLER_STATE_DIMENSION_BITS;
+	state.y = (state.y & ~SAMPLER_STATE_DIMENSION_MASK) | ((dimension + 1) & SAMPLER_STATE_DIMENSION_MASK);
+	return get(tables, samplerType, state.x, sampleIndex, dimension);
+}
+//-----------------------------------------------------GPU--------------------------------------------------------
+void LowDiscrepancySampler::init() {
+	SCOPED_TIMER(__FUNCTION__);
+	generateTables(tables);
+
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->createBuffer(tablesBuffer, sizeof(shaderio::SamplerTables), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT);
+	NVVK_DBG_NAME(tablesBuffer.buffer);
+	NVVK_CHECK(Application::stagingUploader.appendBuffer(tablesBuffer, 0, std::span<const shaderio::SamplerTables>(&tables, 1)));
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	Application::stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	Application::stagingUploader.releaseStaging();
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(shaderio::SamplerPushConstant)
+	};
+	const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 0,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
+	NVVK_DBG_NAME(pipelineLayout);
+
+	compileAndCreateShaders();
+}
+void LowDiscrepancySampler::clean() {
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_fill, nullptr);
+	vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+	Application::allocator.destroyBuffer(tablesBuffer);
+}
+void LowDiscrepancySampler::compileAndCreateShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "samplerFill.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(shaderio::SamplerPushConstant),
+	};
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.pName = "computeMain_fill",
+		.setLayoutCount = 0,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_fill, nullptr);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_fill);
+	NVVK_DBG_NAME(computeShader_fill);
+}
+//-------------------------------------------------------------------------------------------------------------
+void LowDiscrepancySampler::benchmark(uint32_t maxSampleCount) {
+	if (maxSampleCount == 0) return;
+	maxSampleCount = std::min(maxSampleCount, SAMPLER_MAX_SAMPLE_COUNT);
+	const char* samplerNames[shaderio::SamplerType_Count] = { "hash", "sobol", "blueNoise" };
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+
+	//GPUCPUλȽ
+	constexpr uint32_t size = 64, sampleCount = 16, dimensionCount = 8;
+	const uint32_t valueCount = size * size * sampleCount * dimensionCount;
+	nvvk::Buffer outputBuffer, readbackBuffer;
+	allocator->createBuffer(outputBuffer, valueCount * sizeof(float), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+	NVVK_DBG_NAME(outputBuffer.buffer);
+	allocator->createBuffer(readbackBuffer, valueCount * sizeof(float), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(readbackBuffer.buffer);
+	for (uint32_t type = 0; type < shaderio::SamplerType_Count; ++type) {
+		shaderio::SamplerPushConstant pushConstant{
+			.samplerType = type,
+			.sampleOffset = 1000,
+			.sampleCount = sampleCount,
+			.dimensionCount = dimensionCount,
+			.size = glm::uvec2(size),
+			.tables = getTablesAddress(),
+			.output = (float*)outputBuffer.address,
+		};
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		VkPushConstantsInfo pushInfo{
+			.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+			.layout = pipelineLayout,
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(shaderio::SamplerPushConstant),
+			.pValues = &pushConstant,
+		};
+		vkCmdPushConstants2(cmd, &pushInfo);
+		VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_fill);
+		vkCmdDispatch(cmd, nvvk::getGroupCounts(size * size, SAMPLER_THREADGROUP_SIZE), 1, 1);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = valueCount * sizeof(float) };
+		vkCmdCopyBuffer(cmd, outputBuffer.buffer, readbackBuffer.buffer, 1, &region);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+
+		const float* gpuValues = static_cast<const float*>(readbackBuffer.mapping);
+		float maxError = 0.0f;
+		for (uint32_t pixelIndex = 0; pixelIndex < size * size; ++pixelIndex) {
+			glm::uvec2 pixel(pixelIndex % size, pixelIndex / size);
+			for (uint32_t sample = 0; sample < sampleCount; ++sample) {
+				shaderio::SamplerType samplerType = shaderio::SamplerType(type);
+				glm::uvec2 state = initState(samplerType, pixel, pushConstant.sampleOffset + sample);
+				for (uint32_t dimension = 0; dimension < dimensionCount; ++dimension) {
+					float value = next(tables, samplerType, state);
+					maxError = std::max(maxError, std::abs(value - gpuValues[(pixelIndex * sampleCount + sample) * dimensionCount + dimension]));
+				}
+			}
+		}
+		//LowDiscrepancyΪ㣬Ӧȫһ£hashuintתfloat
+		LOGI("Sampler benchmark: %s CPU/GPU max error %g, %s\n", samplerNames[type], maxError, maxError <= (type == shaderio::SamplerType_Hash ? 1e-6f : 0.0f) ? "match" : "MISMATCH");
+	}
+	allocator->destroyBuffer(outputBuffer);
+	allocator->destroyBuffer(readbackBuffer);
+
+	/*
+	ÿع֪Ļ֣ر仯
+	1. edgeڵֱ߱Եά01ΪڶE = Եڵ
+	2. pathedgeµԲ̹Դά23CPUBSDFҲE = edge * (1 - cos^2)
+	*/
+	constexpr uint32_t imageSize = 64;
+	struct PixelIntegrand { float slope, offset, cosTheta, edgeReference; };
+	std::vector<PixelIntegrand> integrands(imageSize * imageSize);
+	for (uint32_t pixelIndex = 0; pixelIndex < integrands.size(); ++pixelIndex) {
+		PixelIntegrand& integrand = integrands[pixelIndex];
+		uint32_t hash = xxhash32(glm::uvec3(pixelIndex, 17, 31));
+		integrand.slope = float(hash & 0xffff) / 65535.0f;
+		integrand.offset = 0.2f + 0.8f * float(hash >> 16) / 65535.0f;
+		integrand.cosTheta = 0.3f + 0.6f * float((hash >> 8) & 0xff) / 255.0f;
+		//x + slope * y < offsetֶԣе㹻ȷ
+		double area = 0.0;
+		constexpr int stepCount = 1 << 16;
+		for (int step = 0; step < stepCount; ++step) {
+			double y = (step + 0.5) / stepCount;
+			area += std::clamp(double(integrand.offset) - integrand.slope * y, 0.0, 1.0);
+		}
+		integrand.edgeReference = float(area / stepCount);
+	}
+	shaderio::BSDFMaterial diffuse{};
+	diffuse.type = shaderio::Diffuse;
+	diffuse.albedo = glm::vec3(1.0f);
+
+	for (uint32_t type = 0; type < shaderio::SamplerType_Count; ++type) {
+		shaderio::SamplerType samplerType = shaderio::SamplerType(type);
+		std::vector<double> edgeSums(integrands.size(), 0.0), pathSums(integrands.size(), 0.0);
+		std::vector<glm::uvec2> hashStates(integrands.size());
+		for (uint32_t pixelIndex = 0; pixelIndex < integrands.size(); ++pixelIndex)
+			hashStates[pixelIndex] = initState(shaderio::SamplerType_Hash, glm::uvec2(pixelIndex % imageSize, pixelIndex / imageSize), 0);
+
+		std::string line;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t sampleIndex = 0, reportCount = 1; sampleIndex < maxSampleCount; ++sampleIndex) {
+			for (uint32_t pixelIndex = 0; pixelIndex < integrands.size(); ++pixelIndex) {
+				const PixelIntegrand& integrand = integrands[pixelIndex];
+				//׷shaderͬhashÿ֡һȡͲÿ³ʼ
+				glm::uvec2& state = hashStates[pixelIndex];
+				if (samplerType != shaderio::SamplerType_Hash) state = initState(samplerType, glm::uvec2(pixelIndex % imageSize, pixelIndex / imageSize), sampleIndex);
+				float u0 = next(tables, samplerType, state);
+				float u1 = next(tables, samplerType, state);
+				float u2 = next(tables, samplerType, state);
+				float u3 = next(tables, samplerType, state);
+
+				float edge = u0 + integrand.slope * u1 < integrand.offset ? 1.0f : 0.0f;
+				CPUBSDFSample sample = CPUBSDF::sample(diffuse, glm::vec3(0.0f, 0.0f, 1.0f), true, glm::vec3(u2, u3, 0.0f));
+				float light = sample.valid && sample.incidence.z > integrand.cosTheta ? sample.bsdf.x * sample.incidence.z / sample.pdf : 0.0f;
+				edgeSums[pixelIndex] += edge;
+				pathSums[pixelIndex] += edge * light;
+			}
+			if (sampleIndex + 1 != reportCount) continue;
+			double edgeError = 0.0, pathError = 0.0;
+			for (uint32_t pixelIndex = 0; pixelIndex < integrands.size(); ++pixelIndex) {
+				const PixelIntegrand& integrand = integrands[pixelIndex];
+				double edge = edgeSums[pixelIndex] / reportCount - integrand.edgeReference;
+				double path = pathSums[pixelIndex] / reportCount - integrand.edgeReference * (1.0 - integrand.cosTheta * integrand.cosTheta);
+				edgeError += edge * edge;
+				pathError += path * path;
+			}
+			char text[96];
+			snprintf(text, sizeof(text), " %u:%.5f/%.5f", reportCount, std::sqrt(edgeError / integrands.size()), std::sqrt(pathError / integrands.size()));
+			line += text;
+			reportCount *= 2;
+		}
+		double cpuTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		LOGI("Sampler benchmark: %s RMSE edge/path per spp%s, CPU %.3f ms\n", samplerNames[type], line.c_str(), cpuTime);
+	}
+}
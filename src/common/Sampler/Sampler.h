@@ -0,0 +1,47 @@
+#pragma once
+
+#include "./SamplerShaderio.h"
+#include <nvvk/resources.hpp>
+#include <glm/glm.hpp>
+
+#ifndef FZBRENDERER_SAMPLER_H
+#define FZBRENDERER_SAMPLER_H
+
+namespace FzbRenderer {
+/*
+ͲGPU汾shaders/sampler.slangλһ
+1. CPUɣ4άSobolɾJoe-Kuo64x64void-and-clusterinitʱϴһ
+2. (, , ά)״̬Ϊuint2xΪ32λkeyyΪ26λź6λάȣpayloadrandomSeedsamplerNextÿȡһά
+3. SamplerType_Hashԭxxhash32 + pcgΪ
+*/
+class LowDiscrepancySampler {
+public:
+	LowDiscrepancySampler() = default;
+	~LowDiscrepancySampler() = default;
+
+	static void generateTables(shaderio::SamplerTables& tables);
+	static float get(const shaderio::SamplerTables& tables, shaderio::SamplerType samplerType, uint32_t pixelKey, uint32_t sampleIndex, uint32_t dimension);
+	static uint32_t getPixelKey(shaderio::SamplerType samplerType, glm::uvec2 pixel);
+	static glm::uvec2 initState(shaderio::SamplerType samplerType, glm::uvec2 pixel, uint32_t sampleIndex);
+	static float next(const shaderio::SamplerTables& tables, shaderio::SamplerType samplerType, glm::uvec2& state);
+
+	void init();
+	void clean();
+	shaderio::SamplerTables* getTablesAddress() const { return (shaderio::SamplerTables*)tablesBuffer.address; }
+	/*
+	1. GPUCPUͬһ(, , ά)ϵĽǷһ
+	2. ÿعƽ֪Ļ֣ԱֲRMSE1maxSampleCountÿηı仯
+	*/
+	void benchmark(uint32_t maxSampleCount);
+
+	shaderio::SamplerTables tables{};
+	nvvk::Buffer tablesBuffer;
+private:
+	void compileAndCreateShaders();
+
+	VkPipelineLayout pipelineLayout{};
+	VkShaderEXT computeShader_fill{};
+};
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <common/Shader/shaderStructType.h>
+
+#ifndef FZBRENDERER_SAMPLER_SHADERIO_H
+#define FZBRENDERER_SAMPLER_SHADERIO_H
+NAMESPACE_SHADERIO_BEGIN()
+
+#define SAMPLER_THREADGROUP_SIZE 256
+
+// Owen-scrambled Sobol (Burley 2020): 4D Sobol, every 4 dimensions form a set with its own scramble seed
+#define SAMPLER_SOBOL_DIMENSION_COUNT 4
+#define SAMPLER_SOBOL_BIT_COUNT 32
+
+// screen-space blue-noise rank table (void-and-cluster), tiled over the screen
+#define SAMPLER_BLUE_NOISE_SIZE 64
+#define SAMPLER_BLUE_NOISE_PIXEL_COUNT (SAMPLER_BLUE_NOISE_SIZE * SAMPLER_BLUE_NOISE_SIZE)
+
+// sampler state, a uint2 that replaces the uint randomSeed of the path tracer payloads:
+// x = pixel key (the pcg state for SamplerType_Hash), y = sample index | dimension
+#define SAMPLER_STATE_DIMENSION_BITS 6
+#define SAMPLER_STATE_SAMPLE_BITS (32 - SAMPLER_STATE_DIMENSION_BITS)
+#define SAMPLER_STATE_DIMENSION_MASK ((1u << SAMPLER_STATE_DIMENSION_BITS) - 1u)
+#define SAMPLER_STATE_SAMPLE_MASK ((1u << SAMPLER_STATE_SAMPLE_BITS) - 1u)
+#define SAMPLER_MAX_SAMPLE_COUNT (1u << SAMPLER_STATE_SAMPLE_BITS)		// sample indices wrap after this, 2^26
+
+enum SamplerType {
+	SamplerType_Hash = 0,			// xxhash32 seed + pcg, the original rand(seed)
+	SamplerType_Sobol = 1,			// Owen-scrambled Sobol, per pixel scramble
+	SamplerType_BlueNoise = 2,		// Owen-scrambled Sobol shared by all pixels, per pixel toroidal shift from the blue-noise ranks
+	SamplerType_Count,
+};
+
+struct SamplerTables {
+	uint sobolMatrices[SAMPLER_SOBOL_DIMENSION_COUNT * SAMPLER_SOBOL_BIT_COUNT];		// column i of dimension d, most significant bit first
+	uint blueNoiseRanks[SAMPLER_BLUE_NOISE_PIXEL_COUNT];								// 0 .. SAMPLER_BLUE_NOISE_PIXEL_COUNT - 1
+};
+
+// computeMain_fill writes output[(pixel * sampleCount + sample) * dimensionCount + dimension]
+struct SamplerPushConstant {
+	uint samplerType;
+	uint sampleOffset;
+	uint sampleCount;
+	uint dimensionCount;
+	uint2 size;
+	SamplerTables* tables;
+	float* output;
+};
+
+NAMESPACE_SHADERIO_END()
+#endif
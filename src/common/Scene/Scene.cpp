@@ -8,6 +8,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <common/Material/Material.h>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <nvutils/parallel_work.hpp>
 
 int FzbRenderer::Scene::loadTexture(const std::filesystem::path& texturePath) {
 	if (texturePathToIndex.count(texturePath)) return texturePathToIndex[texturePath];
@@ -61,7 +62,7 @@ void FzbRenderer::Scene::createSceneFromXML() {
 		//float fov = glm::radians(std::stof(cameraNode.select_node(".//float[@name='fov']").node().attribute("value").value()));
 		//float aspect = (float)resolution.width / resolution.height;
 		//fov = 2.0f * atanf(tanf(fov * 0.5f) / aspect);	//ҶиfovˮƽģglmҪǴֱ
-		float fov = std::stof(cameraNode.child("fov").attribute("value").value());
+		float fov = FzbRenderer::getFloatFromString(cameraNode.child("fov").attribute("value").value());
 		cameraManip->setFov(fov);
 
 		bool isPerspective = std::string(cameraNode.attribute("type").value()) == "perspective" ? true : false;
@@ -126,31 +127,45 @@ void FzbRenderer::Scene::createSceneFromXML() {
 	2. ΪmeshSetÿһchildMeshһinstancechildMeshmeshID֪meshes
 	3. materialIDuniqueMaterialIDToIndexҵ
 	4. ¼meshesmaterials
+	̬ʵinstanceArrayչʵֱ׷ӵinstancesУInstanceSet̬ʵͳһ׷ӵ̬ʵ֮
 	*/
-	staticInstanceSets.resize(0); periodInstanceSets.resize(0); randomInstanceSets.resize(0);
+	periodInstanceSets.resize(0); randomInstanceSets.resize(0);
+	instances.resize(0);
+	instanceIDToInstance.clear();
 	pugi::xml_node instancesNode = sceneInfoNode.child("instances");
-	for (pugi::xml_node instanceNode : instancesNode.children("instance")) {
+	for (pugi::xml_node instanceNode : instancesNode.children()) {
+		std::string nodeName = instanceNode.name();
+		if (nodeName != "instance" && nodeName != "instanceArray") continue;
+
 		InstanceSet instanceSet = InstanceSet(instanceNode);
-		if(instanceSet.instanceID != "defaultInstanceID")
-			instanceIDToInstance.insert({ instanceSet.instanceID, {instanceSet.type, getInstanceSetSize(instanceSet.type)}});
-		addInstanceSet(instanceSet);
-		if(instanceSet.type == Static) staticInstanceCount += instanceSet.childInstances.size();
-		else if(instanceSet.type == PeriodMotion) periodInstanceCount += instanceSet.childInstances.size();
-		else if(instanceSet.type == RandomMotion) randomInstanceCount += instanceSet.childInstances.size();
+		if (nodeName == "instanceArray" && instanceSet.type != Static) {
+			LOGW("instanceArrayֻ֧־̬ʵ%s\n", instanceSet.instanceID.c_str());
+			instanceSet.type = Static;
+		}
+		if (instanceSet.instanceID != "defaultInstanceID") {
+			uint32_t index = instanceSet.type == Static ? instances.size() : getInstanceSetSize(instanceSet.type);
+			instanceIDToInstance.insert({ instanceSet.instanceID, {instanceSet.type, index} });
+		}
+
+		if (nodeName == "instanceArray") instanceSet.expandInstanceArray(instanceNode, instances);
+		else addInstanceSet(instanceSet);
 	}
+	staticInstanceCount = instances.size();
 
-	uint32_t offset = 0;
+	uint32_t offset = staticInstanceCount;
+	periodInstanceCount = 0;
+	for (InstanceSet& instanceSet : periodInstanceSets) periodInstanceCount += instanceSet.childInstances.size();
+	randomInstanceCount = 0;
+	for (InstanceSet& instanceSet : randomInstanceSets) randomInstanceCount += instanceSet.childInstances.size();
 	instances.resize(staticInstanceCount + periodInstanceCount + randomInstanceCount);
-	for (int i = 0; i < staticInstanceSets.size(); ++i) {
-		staticInstanceSets[i].getInstance(instances, offset, 0);
-		offset += staticInstanceSets[i].childInstances.size();
-	}
+	periodInstanceIndexToInstanceSetIndex.resize(0);
+	periodInstanceIndexToInstanceSetIndex.reserve(periodInstanceCount);
 	for (int i = 0; i < periodInstanceSets.size(); ++i) {
 		InstanceSet& instanceSet = periodInstanceSets[i];
 		instanceSet.getInstance(instances, offset, 0);
 
-		for (int j = 0; j < periodInstanceSets[i].childInstances.size(); ++j)
-			periodInstanceIndexToInstanceSetIndex.insert({ offset, i });
+		for (int j = 0; j < instanceSet.childInstances.size(); ++j)
+			periodInstanceIndexToInstanceSetIndex.push_back(i);
 
 		offset += instanceSet.childInstances.size();
 	}
@@ -183,7 +198,7 @@ void FzbRenderer::Scene::createSceneFromXML() {
 			if (pugi::xml_node emissiveNode = lightNode.child("emissive"))
 				light.color = FzbRenderer::getRGBFromString(emissiveNode.attribute("value").value());
 			if (pugi::xml_node intensityNode = lightNode.child("intensity"))
-				light.intensity = std::stof(intensityNode.attribute("value").value());
+				light.intensity = FzbRenderer::getFloatFromString(intensityNode.attribute("value").value());
 
 			if (lightType == "point") {
 				light.type = shaderio::Point;
@@ -195,7 +210,7 @@ void FzbRenderer::Scene::createSceneFromXML() {
 				light.direction = glm::normalize(glm::vec3(lightInstance.baseMatrix * glm::vec4(1.0f, 1.0f, 2.0f, 1.0f)));
 				light.coneAngle = 60.0f;
 				if (pugi::xml_node coneAngleNode = lightNode.child("coneAngle"))
-					light.coneAngle = std::stof(coneAngleNode.attribute("value").value());
+					light.coneAngle = FzbRenderer::getFloatFromString(coneAngleNode.attribute("value").value());
 			}
 			else if (lightType == "sun") {
 				light.type == shaderio::Direction;
@@ -247,7 +262,8 @@ void FzbRenderer::Scene::createSceneFromXML() {
 shaderлȡݵ
 1. Ȼȡǰʵ
 	a. ͨpushconstantõ
-	b. rtͨInstanceIndexõvulkanڴtlasʱԶӣҪ֤tlasĴ˳instancesvector˳ͬ
+	b. rtͨsceneInfo.tlasInstanceMap[InstanceID() + GeometryIndex()]õ̬ʵܱϲͬһBLASУÿʵһΣ
+	   tlasʵ˳instances˳ͬӳAccelerationStructureManagerڴtlasʱ
 2. ȻsceneInfoõgltfInstanceݣ֪任materialIndexmeshIndex
 3. ȻsceneInfoõgltfMesh
 	a. УɫvertexIndexԸbufferViewoffsetvertexIndexټaccessoroffsetõ
@@ -309,6 +325,9 @@ void FzbRenderer::Scene::clean() {
 	allocator.destroyBuffer(bInstances);
 	for (auto& data : bDatas)
 		allocator.destroyBuffer(data);
+	allocator.destroyBuffer(bMeshLODIndices);
+	meshLODs.clear();
+	meshLODIndices.clear();
 	for (auto& texture : textures)
 		allocator.destroyImage(texture);
 }
@@ -319,8 +338,7 @@ void FzbRenderer::Scene::preRender() {
 	else time = 2.0f - (time / periodFrameIndex);
 
 	for (int i = 0; i < sceneInfo.numLights; ++i) {
-		LightInstance lightInstanceInfo = lightInstances[i];		
-		sceneInfo.lights[i] = lightInstanceInfo.getLight(time);
+		sceneInfo.lights[i] = lightInstances[i].getLight(time);
 	}
 
 	const glm::mat4& viewMatrix = cameraManip->getViewMatrix();
@@ -389,20 +407,19 @@ FzbRenderer::MeshInfo FzbRenderer::Scene::getMeshInfo(uint32_t meshIndex) {
 	MeshSet& meshSet = meshSets[meshSetIndex];
 	return meshSet.childMeshInfos[meshIndex - meshSet.meshOffset];
 }
-FzbRenderer::InstanceSet FzbRenderer::Scene::getInstanceSet(InstanceType type, uint32_t index) {
+FzbRenderer::InstanceSet& FzbRenderer::Scene::getInstanceSet(InstanceType type, uint32_t index) {
 	switch (type) {
-		case Static: return staticInstanceSets[index]; break;
 		case PeriodMotion: return periodInstanceSets[index]; break;
 		case RandomMotion: return randomInstanceSets[index]; break;
-		default: printf("ʵûӦͻû%d", index);
+		default: break;
 	}
-	return InstanceSet();
+	throw std::runtime_error("̬ʵûInstanceSetʵûӦ");
 }
 uint32_t FzbRenderer::Scene::getInstanceSetSize(InstanceType type) {
 	switch (type) {
 		case Static: return staticInstanceCount; break;
-		case PeriodMotion: return periodInstanceCount; break;
-		case RandomMotion: return randomInstanceCount; break;
+		case PeriodMotion: return periodInstanceSets.size(); break;
+		case RandomMotion: return randomInstanceSets.size(); break;
 		default: printf("ʵûӦ"); return 0;
 	}
 
@@ -410,9 +427,55 @@ uint32_t FzbRenderer::Scene::getInstanceSetSize(InstanceType type) {
 }
 void FzbRenderer::Scene::addInstanceSet(InstanceSet& instanceSet) {
 	switch (instanceSet.type) {
-		case Static: return staticInstanceSets.push_back(instanceSet); break;
+		case Static: instances.insert(instances.end(), instanceSet.childInstances.begin(), instanceSet.childInstances.end()); break;
 		case PeriodMotion: return periodInstanceSets.push_back(instanceSet); break;
 		case RandomMotion: return randomInstanceSets.push_back(instanceSet); break;
 		default: printf("ʵûӦ");
 	}
-}
\ No newline at end of file
+}
+
+void FzbRenderer::Scene::createMeshLODs(const MeshLODSetting& setting) {
+	if (!meshLODs.empty() || meshes.empty()) return;
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::vector<std::vector<uint32_t>> perMeshIndices(meshes.size());
+	meshLODs.resize(meshes.size());
+	nvutils::parallel_batches_pooled<1>(meshes.size(), [&](uint64_t meshIndex, uint32_t threadIndex) {
+		const MeshSet& meshSet = meshSets[getMeshSetIndex(uint32_t(meshIndex))];
+		meshLODs[meshIndex] = MeshLOD::generate(meshSet.meshByteData, meshes[meshIndex], setting, perMeshIndices[meshIndex]);
+		});
+
+	//ϲΪһ
+	uint64_t originalTriangleCount = 0, coarsestTriangleCount = 0;
+	uint32_t levelCount = 0;
+	for (uint32_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
+		uint32_t baseOffset = uint32_t(meshLODIndices.size());
+		for (MeshLODLevel& level : meshLODs[meshIndex]) level.indexOffset += baseOffset;
+		meshLODIndices.insert(meshLODIndices.end(), perMeshIndices[meshIndex].begin(), perMeshIndices[meshIndex].end());
+
+		originalTriangleCount += meshes[meshIndex].triMesh.indices.count / 3;
+		coarsestTriangleCount += (meshLODs[meshIndex].empty() ? meshes[meshIndex].triMesh.indices.count : meshLODs[meshIndex].back().indexCount) / 3;
+		levelCount += uint32_t(meshLODs[meshIndex].size());
+	}
+	LOGI("Mesh LOD: %zu meshes, %u levels, %llu -> %llu triangles at the coarsest level, %.2f MB of indices\n", meshes.size(), levelCount,
+		(unsigned long long)originalTriangleCount, (unsigned long long)coarsestTriangleCount, meshLODIndices.size() * sizeof(uint32_t) / (1024.0 * 1024.0));
+	if (meshLODIndices.empty()) return;
+
+	nvvk::StagingUploader& stagingUploader = Application::stagingUploader;
+	NVVK_CHECK(stagingUploader.getResourceAllocator()->createBuffer(bMeshLODIndices, std::span(meshLODIndices).size_bytes(),
+		VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT));
+	NVVK_DBG_NAME(bMeshLODIndices.buffer);
+	NVVK_CHECK(stagingUploader.appendBuffer(bMeshLODIndices, 0, std::span<const uint32_t>(meshLODIndices)));
+
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	stagingUploader.releaseStaging();
+}
+const FzbRenderer::MeshLODLevel* FzbRenderer::Scene::getMeshLOD(uint32_t meshIndex, float maxError) const {
+	if (meshIndex >= meshLODs.size()) return nullptr;
+	const std::vector<MeshLODLevel>& levels = meshLODs[meshIndex];
+	for (int i = int(levels.size()) - 1; i >= 0; --i)
+		if (levels[i].error <= maxError) return &levels[i];
+	return nullptr;
+}
@@ -15,6 +15,7 @@ sceneManager
 #include <unordered_set>
 
 #include <common/Mesh/Mesh.h>
+#include <common/Mesh/MeshLOD.h>
 #include <nvutils/camera_manipulator.hpp>
 #include <common/Mesh/nvvk/gltf_utils.hpp>
 #include <common/Shader/shaderStructType.h>
@@ -40,8 +41,7 @@ public:
 	bool cameraChange = false;
 	
 	std::vector<FzbRenderer::MeshSet> meshSets;
-	uint32_t staticInstanceCount = 0;
-	std::vector<InstanceSet> staticInstanceSets;
+	uint32_t staticInstanceCount = 0;		//̬ʵInstanceSetֱչinstancesǰstaticInstanceCount
 	uint32_t periodInstanceCount = 0;
 	std::vector<InstanceSet> periodInstanceSets;
 	uint32_t frameIndex = 0;
@@ -66,6 +66,10 @@ public:
 	nvvk::Buffer bInstances;
 	nvvk::Buffer bMaterials;
 	nvvk::Buffer bSceneInfo;
+
+	std::vector<std::vector<MeshLODLevel>> meshLODs;	//meshLODs[meshIndex]ϸ֣ԭmesh
+	std::vector<uint32_t> meshLODIndices;	//LODuint32ָmeshԭĶݣCPUػҲʹ
+	nvvk::Buffer bMeshLODIndices;
 	//-----------------------------------------------------------------------------------------------------
 	int loadTexture(const std::filesystem::path& texturePath);
 	void addMeshSet(MeshSet& meshSet);
@@ -75,11 +79,17 @@ public:
 	int getTextureIndex(std::filesystem::path texturePath) { return texturePathToIndex[texturePath]; }
 	int getMeshBufferIndex(uint32_t meshIndex) { return meshToBufferIndex[meshIndex]; };
 	int getMeshSetIndex(uint32_t meshIndex) { return meshIndexToMeshSetIndex[meshIndex]; };
-	InstanceSet getInstanceSet(InstanceType type, uint32_t instanceSetIndex);
+	InstanceSet& getInstanceSet(InstanceType type, uint32_t instanceSetIndex);
 	uint32_t getInstanceSetSize(InstanceType type);
 	void addInstanceSet(InstanceSet& instanceSet);
 
 	MeshInfo getMeshInfo(uint32_t meshIndex);
+	/*
+	ΪmeshQEM򻯵LODϴֻڵһεʱɣҪfeatureinitе
+	getMeshLODضռmaxErrorһ㣬ûʱnullptrʹԭmesh
+	*/
+	void createMeshLODs(const MeshLODSetting& setting);
+	const MeshLODLevel* getMeshLOD(uint32_t meshIndex, float maxError) const;
 
 	//ӳ
 	std::unordered_map<std::string, uint32_t> uniqueMaterialIDToIndex;
@@ -87,8 +97,8 @@ public:
 	std::map<std::string, uint32_t> meshSetIDToIndex;	//meshSetIDȡmeshSet
 	std::vector<uint32_t> meshToBufferIndex;	//meshToBufferIndex[meshIndex] = bufferIndexǰʱȾʱmeshȾʱʹ
 	std::vector<uint32_t> meshIndexToMeshSetIndex;
-	std::map<std::string, std::pair<uint32_t, uint32_t>> instanceIDToInstance;
-	std::map<uint32_t, uint32_t> periodInstanceIndexToInstanceSetIndex;
+	std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> instanceIDToInstance;	//(type, ̬ʵΪInstanceSet̬ʵΪinstancesе)
+	std::vector<uint32_t> periodInstanceIndexToInstanceSetIndex;	//periodInstanceIndexToInstanceSetIndex[instanceIndex - staticInstanceCount]
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "DeviceShaderCache.h"
+#include "common/Application/Application.h"
+#include <nvutils/timers.hpp>
+#include <nvvk/debug_util.hpp>
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+
+using namespace FzbRenderer;
+
+#define DEVICE_SHADER_CACHE_MAGIC 0x43535A46		//"FZSC"
+
+static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+void DeviceShaderCache::init(VkPhysicalDevice physicalDevice, VkDevice device, const std::filesystem::path& cacheDir) {
+	SCOPED_TIMER(__FUNCTION__);
+	this->device = device;
+
+	VkPhysicalDeviceShaderObjectPropertiesEXT shaderObjectProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_PROPERTIES_EXT };
+	VkPhysicalDeviceIDProperties idProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES, .pNext = &shaderObjectProperties };
+	VkPhysicalDeviceProperties2 properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &idProperties };
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	deviceHeader.magic = DEVICE_SHADER_CACHE_MAGIC;
+	deviceHeader.headerSize = sizeof(CacheFileHeader);
+	deviceHeader.vendorID = properties.properties.vendorID;
+	deviceHeader.deviceID = properties.properties.deviceID;
+	deviceHeader.driverVersion = properties.properties.driverVersion;
+	deviceHeader.shaderBinaryVersion = shaderObjectProperties.shaderBinaryVersion;
+	memcpy(deviceHeader.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+	memcpy(deviceHeader.shaderBinaryUUID, shaderObjectProperties.shaderBinaryUUID, VK_UUID_SIZE);
+	memcpy(deviceHeader.pipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+	std::string deviceName;
+	char hexByte[3];
+	for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+		snprintf(hexByte, sizeof(hexByte), "%02x", idProperties.deviceUUID[i]);
+		deviceName += hexByte;
+	}
+	deviceName += "_" + std::to_string(properties.properties.driverVersion);
+	shaderBinaryPath = cacheDir / (deviceName + ".shaderBinary");
+	pipelineCachePath = cacheDir / (deviceName + ".pipelineCache");
+	std::error_code errorCode;
+	std::filesystem::create_directories(cacheDir, errorCode);
+
+	//shaderƣkey(uint64) + size(uint64) + data
+	std::vector<uint8_t> data;
+	if (readCacheFile(shaderBinaryPath, data)) {
+		size_t offset = 0;
+		while (offset + 2 * sizeof(uint64_t) <= data.size()) {
+			uint64_t key, size;
+			memcpy(&key, data.data() + offset, sizeof(uint64_t));
+			memcpy(&size, data.data() + offset + sizeof(uint64_t), sizeof(uint64_t));
+			offset += 2 * sizeof(uint64_t);
+			if (size > data.size() - offset) break;
+			shaderBinaries[key].assign(data.data() + offset, data.data() + offset + size);
+			offset += size;
+		}
+	}
+
+	std::vector<uint8_t> pipelineCacheData;
+	bool hasPipelineCacheData = readCacheFile(pipelineCachePath, pipelineCacheData);
+	VkPipelineCacheCreateInfo pipelineCacheInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = hasPipelineCacheData ? pipelineCacheData.size() : 0,
+		.pInitialData = hasPipelineCacheData ? pipelineCacheData.data() : nullptr,
+	};
+	if (vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+		LOGW("߻治ã´յĹ߻\n");
+		pipelineCacheInfo.initialDataSize = 0;
+		pipelineCacheInfo.pInitialData = nullptr;
+		NVVK_CHECK(vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache));
+	}
+	NVVK_DBG_NAME(pipelineCache);
+	LOGI("%dshader, ߻%dֽ\n", int(shaderBinaries.size()), int(pipelineCacheInfo.initialDataSize));
+}
+void DeviceShaderCache::clean() {
+	save();
+	vkDestroyPipelineCache(device, pipelineCache, nullptr);
+	pipelineCache = VK_NULL_HANDLE;
+	shaderBinaries.clear();
+	setLayoutHashes.clear();
+}
+void DeviceShaderCache::save() {
+	if (device == VK_NULL_HANDLE) return;
+	if (shaderBinariesChanged) {
+		std::vector<uint8_t> data;
+		for (auto& [key, binary] : shaderBinaries) {
+			uint64_t size = binary.size();
+			data.insert(data.end(), reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<const uint8_t*>(&key) + sizeof(uint64_t));
+			data.insert(data.end(), reinterpret_cast<const uint8_t*>(&size), reinterpret_cast<const uint8_t*>(&size) + sizeof(uint64_t));
+			data.insert(data.end(), binary.begin(), binary.end());
+		}
+		if (writeCacheFile(shaderBinaryPath, data.data(), data.size())) shaderBinariesChanged = false;
+	}
+
+	size_t pipelineCacheSize = 0;
+	if (pipelineCache && vkGetPipelineCacheData(device, pipelineCache, &pipelineCacheSize, nullptr) == VK_SUCCESS && pipelineCacheSize > 0) {
+		std::vector<uint8_t> pipelineCacheData(pipelineCacheSize);
+		if (vkGetPipelineCacheData(device, pipelineCache, &pipelineCacheSize, pipelineCacheData.data()) == VK_SUCCESS)
+			writeCacheFile(pipelineCachePath, pipelineCacheData.data(), pipelineCacheSize);
+	}
+}
+
+VkResult DeviceShaderCache::createShaders(uint32_t createInfoCount, const VkShaderCreateInfoEXT* pCreateInfos,
+	const VkAllocationCallbacks* pAllocator, VkShaderEXT* pShaders) {
+	bool linkStage = false;
+	for (uint32_t i = 0; i < createInfoCount; ++i) linkStage |= (pCreateInfos[i].flags & VK_SHADER_CREATE_LINK_STAGE_BIT_EXT) != 0;
+	if (linkStage || device == VK_NULL_HANDLE) return vkCreateShadersEXT(Application::app->getDevice(), createInfoCount, pCreateInfos, pAllocator, pShaders);
+
+	for (uint32_t i = 0; i < createInfoCount; ++i) {
+		VkResult result = createShader(pCreateInfos[i], pAllocator, &pShaders[i]);
+		if (result != VK_SUCCESS) return result;
+	}
+	return VK_SUCCESS;
+}
+VkResult DeviceShaderCache::initDescriptorPack(nvvk::DescriptorPack& descPack, const nvvk::DescriptorBindings& bindings, uint32_t numSets,
+	VkDescriptorSetLayoutCreateFlags layoutFlags, VkDescriptorPoolCreateFlags poolFlags) {
+	VkResult result = descPack.init(bindings, Application::app->getDevice(), numSets, layoutFlags, poolFlags);
+	if (result != VK_SUCCESS) return result;
+
+	//Աhashṹpaddingimmutable samplerֻʱЧӰ
+	uint64_t hash = 14695981039346656037ull;
+	hashBytes(hash, &layoutFlags, sizeof(layoutFlags));
+	const std::vector<VkDescriptorSetLayoutBinding>& layoutBindings = bindings.getBindings();
+	const std::vector<VkDescriptorBindingFlags>& bindingFlags = bindings.getBindingFlags();
+	for (size_t i = 0; i < layoutBindings.size(); ++i) {
+		const VkDescriptorSetLayoutBinding& binding = layoutBindings[i];
+		hashBytes(hash, &binding.binding, sizeof(binding.binding));
+		hashBytes(hash, &binding.descriptorType, sizeof(binding.descriptorType));
+		hashBytes(hash, &binding.descriptorCount, sizeof(binding.descriptorCount));
+		hashBytes(hash, &binding.stageFlags, sizeof(binding.stageFlags));
+		hashBytes(hash, &bindingFlags[i], sizeof(VkDescriptorBindingFlags));
+	}
+	//ٺ󱻸ãֱӸǾɵļ¼
+	setLayoutHashes[descPack.getLayout()] = hash;
+	return result;
+}
+VkResult DeviceShaderCache::createShader(const VkShaderCreateInfoEXT& createInfo, const VkAllocationCallbacks* pAllocator, VkShaderEXT* pShader) {
+	if (createInfo.codeType != VK_SHADER_CODE_TYPE_SPIRV_EXT) return vkCreateShadersEXT(device, 1U, &createInfo, pAllocator, pShader);
+
+	uint64_t key;
+	if (!computeKey(createInfo, key)) return vkCreateShadersEXT(device, 1U, &createInfo, pAllocator, pShader);
+	auto it = shaderBinaries.find(key);
+	if (it != shaderBinaries.end()) {
+		//std::vectorڴٰ16ֽڶ룬pCodeĶҪ
+		VkShaderCreateInfoEXT binaryInfo = createInfo;
+		binaryInfo.codeType = VK_SHADER_CODE_TYPE_BINARY_EXT;
+		binaryInfo.codeSize = it->second.size();
+		binaryInfo.pCode = it->second.data();
+		VkResult result = vkCreateShadersEXT(device, 1U, &binaryInfo, pAllocator, pShader);
+		if (result == VK_SUCCESS) return result;
+
+		LOGW("shaderƲ(%s)˵SPIR-V\n", createInfo.pName ? createInfo.pName : "");
+		shaderBinaries.erase(it);
+		shaderBinariesChanged = true;
+		*pShader = VK_NULL_HANDLE;
+	}
+
+	VkResult result = vkCreateShadersEXT(device, 1U, &createInfo, pAllocator, pShader);
+	if (result != VK_SUCCESS) return result;
+
+	size_t binarySize = 0;
+	if (vkGetShaderBinaryDataEXT(device, *pShader, &binarySize, nullptr) == VK_SUCCESS && binarySize > 0) {
+		std::vector<uint8_t> binary(binarySize);
+		if (vkGetShaderBinaryDataEXT(device, *pShader, &binarySize, binary.data()) == VK_SUCCESS) {
+			shaderBinaries[key] = std::move(binary);
+			shaderBinariesChanged = true;
+		}
+	}
+	return result;
+}
+bool DeviceShaderCache::computeKey(const VkShaderCreateInfoEXT& createInfo, uint64_t& key) const {
+	//ֻ봴ʱͬĲԳ⣬stageڡset layoutpush constantػҲhash
+	uint64_t hash = 14695981039346656037ull;
+	hashBytes(hash, &createInfo.flags, sizeof(createInfo.flags));
+	hashBytes(hash, &createInfo.stage, sizeof(createInfo.stage));
+	hashBytes(hash, &createInfo.nextStage, sizeof(createInfo.nextStage));
+	hashBytes(hash, createInfo.pCode, createInfo.codeSize);
+	if (createInfo.pName) hashBytes(hash, createInfo.pName, strlen(createInfo.pName));
+	hashBytes(hash, &createInfo.setLayoutCount, sizeof(createInfo.setLayoutCount));
+	for (uint32_t i = 0; i < createInfo.setLayoutCount; ++i) {
+		auto it = setLayoutHashes.find(createInfo.pSetLayouts[i]);
+		if (it == setLayoutHashes.end()) return false;
+		hashBytes(hash, &it->second, sizeof(uint64_t));
+	}
+	if (createInfo.pushConstantRangeCount > 0)
+		hashBytes(hash, createInfo.pPushConstantRanges, createInfo.pushConstantRangeCount * sizeof(VkPushConstantRange));
+	if (const VkSpecializationInfo* specializationInfo = createInfo.pSpecializationInfo) {
+		if (specializationInfo->mapEntryCount > 0)
+			hashBytes(hash, specializationInfo->pMapEntries, specializationInfo->mapEntryCount * sizeof(VkSpecializationMapEntry));
+		if (specializationInfo->dataSize > 0) hashBytes(hash, specializationInfo->pData, specializationInfo->dataSize);
+	}
+	key = hash;
+	return true;
+}
+
+bool DeviceShaderCache::readCacheFile(const std::filesystem::path& filePath, std::vector<uint8_t>& data) const {
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) return false;
+	size_t fileSize = (size_t)file.tellg();
+	if (fileSize < sizeof(CacheFileHeader)) return false;
+
+	CacheFileHeader header;
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader));
+	//豸Ƹʽͬ
+	if (!file || memcmp(&header, &deviceHeader, offsetof(CacheFileHeader, dataSize)) != 0) {
+		LOGW("뵱ǰ豸ƥ䣬Ѻ: %s\n", filePath.string().c_str());
+		return false;
+	}
+	if (header.dataSize != fileSize - sizeof(CacheFileHeader)) return false;
+
+	data.resize(header.dataSize);
+	file.read(reinterpret_cast<char*>(data.data()), header.dataSize);
+	return bool(file);
+}
+bool DeviceShaderCache::writeCacheFile(const std::filesystem::path& filePath, const void* data, size_t dataSize) const {
+	std::filesystem::path tempPath = filePath;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return false;
+		CacheFileHeader header = deviceHeader;
+		header.dataSize = dataSize;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+		file.write(reinterpret_cast<const char*>(data), dataSize);
+		if (!file) return false;
+	}
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, filePath, errorCode);
+	return !errorCode;
+}
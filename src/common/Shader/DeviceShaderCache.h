@@ -0,0 +1,69 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <nvvk/descriptors.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#ifndef FZBRENDERER_DEVICE_SHADER_CACHE_H
+#define FZBRENDERER_DEVICE_SHADER_CACHE_H
+
+namespace FzbRenderer {
+/*
+shader棬ʡȥÿʱSPIR-VΪʱ
+1. VkShaderEXTSPIR-VͨvkGetShaderBinaryDataEXTȡöƣ´ͬSPIR-VʹʱֱVK_SHADER_CODE_TYPE_BINARY_EXT
+	VK_INCOMPATIBLE_SHADER_BINARY_EXTöƲ˵SPIR-V
+2. ׷ߣʹVkPipelineCache˳ʱͨvkGetPipelineCacheDataл
+3. shaderkeyаpSetLayoutslayoutݣlayoutͨinitDescriptorPackδ¼layoutshader
+4. ļdeviceUUIDdriverVersionļͷлshaderBinaryUUID/shaderBinaryVersionpipelineCacheUUIDһʱ
+*/
+class DeviceShaderCache {
+public:
+	DeviceShaderCache() = default;
+	~DeviceShaderCache() = default;
+
+	void init(VkPhysicalDevice physicalDevice, VkDevice device, const std::filesystem::path& cacheDir);
+	void clean();
+
+	//vkCreateShadersEXTĲͬʹLINK_STAGEĶshader
+	VkResult createShaders(uint32_t createInfoCount, const VkShaderCreateInfoEXT* pCreateInfos,
+		const VkAllocationCallbacks* pAllocator, VkShaderEXT* pShaders);
+	void save();
+	//DescriptorPack::initͬʱ¼layoutbindingflagscomputeKeyݶǾhash
+	VkResult initDescriptorPack(nvvk::DescriptorPack& descPack, const nvvk::DescriptorBindings& bindings, uint32_t numSets,
+		VkDescriptorSetLayoutCreateFlags layoutFlags, VkDescriptorPoolCreateFlags poolFlags = 0);
+
+	VkPipelineCache pipelineCache{};
+private:
+	struct CacheFileHeader {
+		uint32_t magic;
+		uint32_t headerSize;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint32_t shaderBinaryVersion;
+		uint8_t deviceUUID[VK_UUID_SIZE];
+		uint8_t shaderBinaryUUID[VK_UUID_SIZE];
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t dataSize;
+	};
+
+	//δ¼layoutʱfalse
+	bool computeKey(const VkShaderCreateInfoEXT& createInfo, uint64_t& key) const;
+	VkResult createShader(const VkShaderCreateInfoEXT& createInfo, const VkAllocationCallbacks* pAllocator, VkShaderEXT* pShader);
+	bool readCacheFile(const std::filesystem::path& filePath, std::vector<uint8_t>& data) const;
+	bool writeCacheFile(const std::filesystem::path& filePath, const void* data, size_t dataSize) const;
+
+	VkDevice device{};
+	CacheFileHeader deviceHeader{};
+	std::filesystem::path shaderBinaryPath;
+	std::filesystem::path pipelineCachePath;
+
+	std::unordered_map<uint64_t, std::vector<uint8_t>> shaderBinaries;
+	bool shaderBinariesChanged = false;
+	std::unordered_map<VkDescriptorSetLayout, uint64_t> setLayoutHashes;
+};
+}
+
+#endif
@@ -7,57 +7,25 @@
 VkShaderModuleCreateInfo FzbRenderer::compileSlangShader(const std::filesystem::path& shaderSource, const std::span<const uint32_t>& spirv) {
 	SCOPED_TIMER(__FUNCTION__);
 
+	//spirvΪʱͨshaderCacheȡصpCodeshaderCache.cleanǰһֱЧ
 	VkShaderModuleCreateInfo shaderCode = nvsamples::getShaderModuleCreateInfo(spirv);
 	if (spirv.empty()) {
-		if (Application::slangCompiler.compileFile(shaderSource))
-		{
-			shaderCode.codeSize = Application::slangCompiler.getSpirvSize();
-			shaderCode.pCode = Application::slangCompiler.getSpirv();
-		}
-		else
-		{
-			LOGE("Error compiling shers: %s\n%s\n", shaderSource.string().c_str(),
-				Application::slangCompiler.getLastDiagnosticMessage().c_str());
-		}
+		std::span<const uint32_t> cachedSpirv = Application::shaderCache.getOrCompile(shaderSource);
+		shaderCode.codeSize = cachedSpirv.size_bytes();
+		shaderCode.pCode = cachedSpirv.data();
 	}
 	return shaderCode;
 };
 VkShaderModuleCreateInfo FzbRenderer::compileSlangShader(std::filesystem::path& shaderPath, std::vector<uint32_t>& shaderBuffer) {
 	SCOPED_TIMER(__FUNCTION__);
 
-	VkShaderModuleCreateInfo shaderCode = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-
-	std::filesystem::path spvPath = shaderPath;
-	spvPath = spvPath.replace_extension(".spv");
-
-	auto getShaderCode = [&] {
-		shaderCode = compileSlangShader(shaderPath, {});
-
-		FzbRenderer::saveShaderToFile(shaderCode, spvPath);
-		FzbRenderer::validateSPIRVFile(spvPath);
-		};
+	//ǷҪ±shaderCacheԴļincludeհͱѡж
+	std::span<const uint32_t> cachedSpirv = Application::shaderCache.getOrCompile(shaderPath);
+	shaderBuffer.assign(cachedSpirv.begin(), cachedSpirv.end());
 
-	if (!std::filesystem::exists(spvPath)) getShaderCode();
-	else {
-		auto shaderFileCreateTime = std::filesystem::last_write_time(shaderPath);
-		auto spvFileCreateTime = std::filesystem::last_write_time(spvPath);
-		if (spvFileCreateTime < shaderFileCreateTime) getShaderCode(); 		//˵
-		else {
-			std::ifstream spvFile(spvPath, std::ios::ate | std::ios::binary);
-			if (spvFile.is_open()) {
-				size_t fileSize = (size_t)spvFile.tellg();
-				shaderBuffer.resize(fileSize / sizeof(uint32_t));
-
-				spvFile.seekg(0);
-				spvFile.read(reinterpret_cast<char*>(shaderBuffer.data()), fileSize);
-				spvFile.close();
-
-				shaderCode.codeSize = shaderBuffer.size() * sizeof(uint32_t);
-				shaderCode.pCode = shaderBuffer.data();
-			}
-			else getShaderCode();
-		}
-	}
+	VkShaderModuleCreateInfo shaderCode = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	shaderCode.codeSize = shaderBuffer.size() * sizeof(uint32_t);
+	shaderCode.pCode = shaderBuffer.data();
 	return shaderCode;
 }
 
@@ -0,0 +1,309 @@
+#include "ShaderCache.h"
+#include "common/Application/Application.h"
+#include <nvutils/timers.hpp>
+#include <nvutils/parallel_work.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+using namespace FzbRenderer;
+
+static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+	//FNV-1aҪȶԲʹstd::hash
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+static void hashString(uint64_t& hash, const std::string& str) {
+	hashBytes(hash, str.data(), str.size());
+	hashBytes(hash, "\0", 1);
+}
+static bool readFile(const std::filesystem::path& filePath, std::string& content) {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) return false;
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	content = buffer.str();
+	return true;
+}
+static std::string getRequestString(const ShaderCompileRequest& request) {
+	std::string requestString = request.shaderSource.string();
+	for (auto& macro : request.macros) requestString += "\t" + macro.first + "=" + macro.second;
+	return requestString;
+}
+
+void ShaderCache::init(const std::filesystem::path& cacheDir) {
+	this->cacheDir = cacheDir;
+	this->manifestPath = cacheDir / "manifest.txt";
+	std::error_code errorCode;
+	std::filesystem::create_directories(cacheDir, errorCode);
+	if (errorCode) LOGW("޷shaderĿ¼: %s\n", cacheDir.string().c_str());
+
+	std::ifstream manifestFile(manifestPath);
+	std::string line;
+	while (std::getline(manifestFile, line)) {
+		if (line.empty()) continue;
+		ShaderCompileRequest request;
+		std::stringstream lineStream(line);
+		std::string token;
+		std::getline(lineStream, token, '\t');
+		request.shaderSource = token;
+		while (std::getline(lineStream, token, '\t')) {
+			size_t equalPos = token.find('=');
+			if (equalPos == std::string::npos) continue;
+			request.macros.push_back({ token.substr(0, equalPos), token.substr(equalPos + 1) });
+		}
+		if (manifestKeys.insert(getRequestString(request)).second) manifest.push_back(request);
+	}
+}
+void ShaderCache::clean() {
+	saveManifest();
+	spirvCache.clear();
+}
+
+std::span<const uint32_t> ShaderCache::getOrCompile(const std::filesystem::path& shaderSource) {
+	ShaderCompileRequest request{ .shaderSource = shaderSource };
+	for (const slang::PreprocessorMacroDesc& macro : Application::slangCompiler.macros())
+		request.macros.push_back({ macro.name, macro.value ? macro.value : "" });
+	recordRequest(request);
+
+	uint64_t key = computeKey(request);
+	std::span<const uint32_t> spirv = findInMemory(key);
+	if (spirv.empty()) spirv = loadFromDisk(key);
+	if (!spirv.empty()) return spirv;
+
+	if (!Application::slangCompiler.compileFile(shaderSource)) {
+		LOGE("Error compiling shaders: %s\n%s\n", shaderSource.string().c_str(),
+			Application::slangCompiler.getLastDiagnosticMessage().c_str());
+		return {};
+	}
+	saveToDisk(key, Application::slangCompiler.getSpirv(), Application::slangCompiler.getSpirvSize());
+	return store(key, Application::slangCompiler.getSpirv(), Application::slangCompiler.getSpirvSize());
+}
+void ShaderCache::compileParallel(const std::vector<ShaderCompileRequest>& requests) {
+	SCOPED_TIMER(__FUNCTION__);
+
+	//keyļҪļ߳ɣͬʱȥظѾ
+	std::vector<const ShaderCompileRequest*> dirtyRequests;
+	std::vector<uint64_t> dirtyKeys;
+	std::unordered_set<uint64_t> visitedKeys;
+	for (const ShaderCompileRequest& request : requests) {
+		if (!std::filesystem::exists(request.shaderSource)) continue;
+		uint64_t key = computeKey(request);
+		if (!visitedKeys.insert(key).second) continue;
+		if (spirvCache.count(key) || std::filesystem::exists(getCachePath(key))) continue;
+		dirtyRequests.push_back(&request);
+		dirtyKeys.push_back(key);
+	}
+	if (dirtyRequests.empty()) return;
+
+	std::vector<std::unique_ptr<nvslang::SlangCompiler>> compilers(std::max(1u, uint32_t(nvutils::get_thread_pool().get_thread_count())));
+	std::atomic<uint32_t> failedCount = 0;
+	nvutils::parallel_batches_pooled<1>(dirtyRequests.size(), [&](uint64_t i, uint32_t threadIndex) {
+		std::unique_ptr<nvslang::SlangCompiler>& compiler = compilers[threadIndex];
+		if (!compiler) compiler = std::make_unique<nvslang::SlangCompiler>();
+		configureCompiler(*compiler, *dirtyRequests[i]);
+		if (compiler->compileFile(dirtyRequests[i]->shaderSource))
+			saveToDisk(dirtyKeys[i], compiler->getSpirv(), compiler->getSpirvSize());
+		else {
+			++failedCount;
+			LOGW("Error compiling shaders: %s\n%s\n", dirtyRequests[i]->shaderSource.string().c_str(),
+				compiler->getLastDiagnosticMessage().c_str());
+		}
+	});
+	LOGI("б%dshaderʧ%d\n", int(dirtyRequests.size()), int(failedCount.load()));
+}
+void ShaderCache::prewarm(const std::vector<ShaderCompileRequest>& requests) {
+	std::vector<ShaderCompileRequest> allRequests = manifest;
+	allRequests.insert(allRequests.end(), requests.begin(), requests.end());
+	compileParallel(allRequests);
+}
+void ShaderCache::saveManifest() {
+	if (!manifestChanged || cacheDir.empty()) return;
+	std::ofstream manifestFile(manifestPath, std::ios::trunc);
+	if (!manifestFile.is_open()) {
+		LOGW("޷дshadermanifest: %s\n", manifestPath.string().c_str());
+		return;
+	}
+	for (const ShaderCompileRequest& request : manifest) manifestFile << getRequestString(request) << "\n";
+	manifestChanged = false;
+}
+uint64_t ShaderCache::getSourceHash(const std::filesystem::path& shaderSource) {
+	return computeKey(ShaderCompileRequest{ .shaderSource = shaderSource });
+}
+
+uint64_t ShaderCache::computeKey(const ShaderCompileRequest& request) {
+	uint64_t hash = 14695981039346656037ull;
+	hashString(hash, spGetBuildTagString());
+
+	std::unordered_set<std::string> visitedFiles;
+	hashIncludeClosure(request.shaderSource, hash, visitedFiles);
+
+	for (auto& macro : request.macros) {
+		hashString(hash, macro.first);
+		hashString(hash, macro.second);
+	}
+	for (const slang::CompilerOptionEntry& option : Application::slangCompiler.options()) {
+		hashBytes(hash, &option.name, sizeof(option.name));
+		hashBytes(hash, &option.value.kind, sizeof(option.value.kind));
+		hashBytes(hash, &option.value.intValue0, sizeof(option.value.intValue0));
+		hashBytes(hash, &option.value.intValue1, sizeof(option.value.intValue1));
+		hashString(hash, option.value.stringValue0 ? option.value.stringValue0 : "");
+		hashString(hash, option.value.stringValue1 ? option.value.stringValue1 : "");
+	}
+	for (const slang::TargetDesc& target : Application::slangCompiler.targets()) {
+		hashBytes(hash, &target.format, sizeof(target.format));
+		hashBytes(hash, &target.profile, sizeof(target.profile));
+		hashBytes(hash, &target.flags, sizeof(target.flags));
+	}
+	return hash;
+}
+/*
+ݹhashԴļincludeհ
+1. ֧#include "x"#include <x>__include "x"import x.y;תΪx/y.slang
+2. ԵǰļĿ¼ңsearchPathsIncludeѡĿ¼в
+3. Ҳģslangģ飩ֻhash
+*/
+void ShaderCache::hashIncludeClosure(const std::filesystem::path& filePath, uint64_t& hash, std::unordered_set<std::string>& visitedFiles) {
+	std::error_code errorCode;
+	std::string canonicalPath = std::filesystem::weakly_canonical(filePath, errorCode).string();
+	if (!visitedFiles.insert(canonicalPath).second) return;
+
+	std::string content;
+	if (!readFile(filePath, content)) {
+		hashString(hash, filePath.string());
+		return;
+	}
+	hashString(hash, content);
+
+	std::filesystem::path currentDir = filePath.parent_path();
+	std::stringstream contentStream(content);
+	std::string line;
+	while (std::getline(contentStream, line)) {
+		size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos) continue;
+		std::string_view lineView(line.data() + start, line.size() - start);
+
+		std::string includeName;
+		bool isModule = false;
+		if (lineView.starts_with("#include") || lineView.starts_with("__include")) {
+			size_t nameStart = lineView.find_first_of("\"<");
+			if (nameStart == std::string_view::npos) {		//__include x;
+				size_t spacePos = lineView.find_first_of(" \t");
+				if (spacePos == std::string_view::npos) continue;
+				includeName = std::string(lineView.substr(spacePos + 1));
+			}
+			else {
+				size_t nameEnd = lineView.find_first_of("\">", nameStart + 1);
+				if (nameEnd == std::string_view::npos) continue;
+				includeName = std::string(lineView.substr(nameStart + 1, nameEnd - nameStart - 1));
+			}
+		}
+		else if (lineView.starts_with("import ")) {
+			includeName = std::string(lineView.substr(7));
+			isModule = true;
+		}
+		else continue;
+
+		size_t semicolonPos = includeName.find(';');
+		if (semicolonPos != std::string::npos) includeName.resize(semicolonPos);
+		while (!includeName.empty() && (includeName.back() == ' ' || includeName.back() == '\t' || includeName.back() == '\r')) includeName.pop_back();
+		while (!includeName.empty() && (includeName.front() == ' ' || includeName.front() == '"')) includeName.erase(0, 1);
+		if (!includeName.empty() && includeName.back() == '"') includeName.pop_back();
+		if (includeName.empty()) continue;
+
+		std::filesystem::path includePath = resolveInclude(includeName, currentDir, isModule);
+		if (includePath.empty()) hashString(hash, includeName);
+		else hashIncludeClosure(includePath, hash, visitedFiles);
+	}
+}
+std::filesystem::path ShaderCache::resolveInclude(const std::string& includeName, const std::filesystem::path& currentDir, bool isModule) {
+	std::vector<std::string> candidateNames = { includeName };
+	if (isModule) {		//importģ
+		std::string moduleName = includeName;
+		std::replace(moduleName.begin(), moduleName.end(), '.', '/');
+		candidateNames.push_back(moduleName + ".slang");
+		std::replace(moduleName.begin(), moduleName.end(), '_', '-');
+		candidateNames.push_back(moduleName + ".slang");
+	}
+
+	std::vector<std::filesystem::path> searchDirs = { currentDir };
+	for (const std::filesystem::path& searchPath : Application::slangCompiler.searchPaths()) searchDirs.push_back(searchPath);
+	for (const slang::CompilerOptionEntry& option : Application::slangCompiler.options())
+		if (option.name == slang::CompilerOptionName::Include && option.value.stringValue0)
+			searchDirs.push_back(option.value.stringValue0);
+
+	for (const std::filesystem::path& searchDir : searchDirs)
+		for (const std::string& candidateName : candidateNames) {
+			std::filesystem::path candidatePath = searchDir / candidateName;
+			if (std::filesystem::is_regular_file(candidatePath)) return candidatePath;
+		}
+	return {};
+}
+std::filesystem::path ShaderCache::getCachePath(uint64_t key) const {
+	char keyString[17];
+	snprintf(keyString, sizeof(keyString), "%016llx", (unsigned long long)key);
+	return cacheDir / (std::string(keyString) + ".spv");
+}
+
+std::span<const uint32_t> ShaderCache::findInMemory(uint64_t key) {
+	auto it = spirvCache.find(key);
+	if (it == spirvCache.end()) return {};
+	return std::span<const uint32_t>(it->second);
+}
+std::span<const uint32_t> ShaderCache::loadFromDisk(uint64_t key) {
+	if (cacheDir.empty()) return {};
+	std::ifstream spvFile(getCachePath(key), std::ios::ate | std::ios::binary);
+	if (!spvFile.is_open()) return {};
+
+	size_t fileSize = (size_t)spvFile.tellg();
+	if (fileSize < sizeof(uint32_t) || fileSize % sizeof(uint32_t) != 0) return {};
+	std::vector<uint32_t> spirv(fileSize / sizeof(uint32_t));
+	spvFile.seekg(0);
+	spvFile.read(reinterpret_cast<char*>(spirv.data()), fileSize);
+	if (!spvFile || spirv[0] != 0x07230203) return {};		//SPIR-Vħ
+
+#if defined(AFTERMATH_AVAILABLE)
+	AftermathCrashTracker::getInstance().addShaderBinary(std::span<const uint32_t>(spirv));
+#endif
+	return store(key, spirv.data(), fileSize);
+}
+std::span<const uint32_t> ShaderCache::store(uint64_t key, const uint32_t* spirv, size_t spirvSize) {
+	auto it = spirvCache.emplace(key, std::vector<uint32_t>(spirv, spirv + spirvSize / sizeof(uint32_t))).first;
+	return std::span<const uint32_t>(it->second);
+}
+bool ShaderCache::saveToDisk(uint64_t key, const uint32_t* spirv, size_t spirvSize) {
+	if (cacheDir.empty()) return false;
+	//дʱļжʱ²Ļ
+	std::filesystem::path cachePath = getCachePath(key);
+	std::filesystem::path tempPath = cachePath;
+	tempPath += ".tmp";
+	{
+		std::ofstream spvFile(tempPath, std::ios::binary | std::ios::trunc);
+		if (!spvFile.is_open()) return false;
+		spvFile.write(reinterpret_cast<const char*>(spirv), spirvSize);
+		if (!spvFile) return false;
+	}
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, cachePath, errorCode);
+	return !errorCode;
+}
+void ShaderCache::recordRequest(const ShaderCompileRequest& request) {
+	if (manifestKeys.insert(getRequestString(request)).second) {
+		manifest.push_back(request);
+		manifestChanged = true;
+	}
+}
+void ShaderCache::configureCompiler(nvslang::SlangCompiler& compiler, const ShaderCompileRequest& request) {
+	compiler.clearTargets();
+	for (const slang::TargetDesc& target : Application::slangCompiler.targets()) compiler.addTarget(target);
+	compiler.clearOptions();
+	for (const slang::CompilerOptionEntry& option : Application::slangCompiler.options()) compiler.addOption(option);
+	compiler.clearSearchPaths();
+	compiler.addSearchPaths(Application::slangCompiler.searchPaths());
+	compiler.clearMacros();
+	for (auto& macro : request.macros) compiler.addMacro({ .name = macro.first.c_str(), .value = macro.second.c_str() });
+}
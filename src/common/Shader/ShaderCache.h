@@ -0,0 +1,69 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <nvslang/slang.hpp>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef FZBRENDERER_SHADER_CACHE_H
+#define FZBRENDERER_SHADER_CACHE_H
+
+namespace FzbRenderer {
+struct ShaderCompileRequest {
+	std::filesystem::path shaderSource;
+	std::vector<std::pair<std::string, std::string>> macros;	//name, value
+};
+/*
+ݵshader
+1. key = hash(Դļݹincludeļ +  + ѡ + target + slang汾)ļ޸ʱ޹
+2. <key>.spvcacheDirУдԴĿ¼getOrCompileĽͬʱڴУصָcleanǰһֱЧ
+3. ÿ(Դļ, )¼manifestУ´¼shaderʱprewarm̳߳زбmanifestʧЧshader
+	֮FeaturecompileAndCreateShadersдʱֱл
+	״ûmanifestprewarmrendererinitǰͨcollectShaderRequests
+4. slangCompiler̰߳ȫģÿ߳ʹԼSlangCompilertargetѡ·Application::slangCompilerƣ
+	ֻ߳д̻棬ڴ滺̵ֻ߳getOrCompileз
+*/
+class ShaderCache {
+public:
+	ShaderCache() = default;
+	~ShaderCache() = default;
+
+	void init(const std::filesystem::path& cacheDir);
+	void clean();
+
+	//ʹApplication::slangCompilerǰĺ룬лʱ룻ʧʱؿ
+	std::span<const uint32_t> getOrCompile(const std::filesystem::path& shaderSource);
+	void compileParallel(const std::vector<ShaderCompileRequest>& requests);
+	void prewarm(const std::vector<ShaderCompileRequest>& requests = {});
+	void saveManifest();
+	//ԴļincludeհѡhashꣻshaderΪkeyһ
+	uint64_t getSourceHash(const std::filesystem::path& shaderSource);
+
+private:
+	uint64_t computeKey(const ShaderCompileRequest& request);
+	void hashIncludeClosure(const std::filesystem::path& filePath, uint64_t& hash, std::unordered_set<std::string>& visitedFiles);
+	std::filesystem::path resolveInclude(const std::string& includeName, const std::filesystem::path& currentDir, bool isModule);
+	std::filesystem::path getCachePath(uint64_t key) const;
+
+	std::span<const uint32_t> findInMemory(uint64_t key);
+	std::span<const uint32_t> loadFromDisk(uint64_t key);
+	std::span<const uint32_t> store(uint64_t key, const uint32_t* spirv, size_t spirvSize);
+	bool saveToDisk(uint64_t key, const uint32_t* spirv, size_t spirvSize);
+	void recordRequest(const ShaderCompileRequest& request);
+	void configureCompiler(nvslang::SlangCompiler& compiler, const ShaderCompileRequest& request);
+
+	std::filesystem::path cacheDir;
+	std::filesystem::path manifestPath;
+
+	std::unordered_map<uint64_t, std::vector<uint32_t>> spirvCache;
+
+	std::vector<ShaderCompileRequest> manifest;
+	std::unordered_set<std::string> manifestKeys;
+	bool manifestChanged = false;
+};
+}
+
+#endif
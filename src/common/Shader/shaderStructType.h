@@ -89,6 +89,7 @@ struct SceneInfo
 	Instance* instances;					// Address of the instance buffer containing GltfInstance data
 	Mesh* meshes;							// Address of the mesh buffer containing GltfMesh data
 	BSDFMaterial* materials;					// Material properties for the instance
+	uint32_t* tlasInstanceMap;				// TLAS instance custom index + geometry index -> index in instances
 	Light           lights[2];			// Array of punctual lights in the scene (up to 2)
 	SkySimpleParameters    skySimpleParam;
 };
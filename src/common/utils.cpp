@@ -24,9 +24,18 @@
 #include <nvutils/file_operations.hpp>
 
 #include <stb/stb_image.h>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 #include "utils.hpp"
 #include <common/Application/Application.h>
+#include <common/Instance/Instance.h>
+#include <common/Material/Material.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "pugixml.hpp"
 
 namespace nvsamples {
 
@@ -58,47 +67,212 @@ nvvk::Image loadAndCreateImage(VkCommandBuffer cmd, nvvk::StagingUploader& stagi
 }  // namespace nvsamples
 
 namespace FzbRenderer {
-	glm::vec3 getRGBFromString(std::string str) {
-		std::vector<float> float3_array(0);
-		std::stringstream ss(str);
-		std::string token;
-		while (std::getline(ss, token, ',')) {
-			float3_array.push_back(std::stof(token));
+	static bool isNumberSeparator(char c) {
+		return c == ',' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+	uint32_t getFloatsFromString(std::string_view str, float* values, uint32_t maxCount) {
+		const char* ptr = str.data();
+		const char* end = str.data() + str.size();
+		uint32_t count = 0;
+		while (ptr < end && count < maxCount) {
+			while (ptr < end && isNumberSeparator(*ptr)) ++ptr;
+			if (ptr < end && *ptr == '+') ++ptr;		//from_charsǰ+
+			if (ptr >= end) break;
+
+			std::from_chars_result result = std::from_chars(ptr, end, values[count]);
+			if (result.ec == std::errc()) ++count;
+			ptr = result.ptr;
+			while (ptr < end && !isNumberSeparator(*ptr)) ++ptr;		//޷Ĳ֣1.0fеf
 		}
-		if (float3_array.size() == 1) return glm::vec3(float3_array[0]);
+		return count;
+	}
+	float getFloatFromString(std::string_view str, float defaultValue) {
+		float value = defaultValue;
+		getFloatsFromString(str, &value, 1);
+		return value;
+	}
+	int getIntFromString(std::string_view str, int defaultValue) {
+		const char* ptr = str.data();
+		const char* end = str.data() + str.size();
+		while (ptr < end && (isNumberSeparator(*ptr) || *ptr == '+')) ++ptr;
+		int value = defaultValue;
+		std::from_chars(ptr, end, value);
+		return value;
+	}
+
+	glm::vec3 getRGBFromString(std::string_view str) {
+		float float3_array[3] = {};
+		uint32_t count = getFloatsFromString(str, float3_array, 3);
+		if (count == 1) return glm::vec3(float3_array[0]);
 		return glm::vec3(float3_array[0], float3_array[1], float3_array[2]);
 	}
-	glm::mat4 getMat4FromString(std::string str) {
-		std::vector<float> mat4_array;
-		std::stringstream ss(str);
-		std::string token;
-		while (std::getline(ss, token, ' ')) {
-			mat4_array.push_back(std::stof(token));
-		}
+	glm::mat4 getMat4FromString(std::string_view str) {
+		float mat4_array[16] = {};
+		getFloatsFromString(str, mat4_array, 16);
 		return glm::mat4(mat4_array[0], mat4_array[4], mat4_array[8], mat4_array[12],
 			mat4_array[1], mat4_array[5], mat4_array[9], mat4_array[13],
 			mat4_array[2], mat4_array[6], mat4_array[10], mat4_array[14],
 			mat4_array[3], mat4_array[7], mat4_array[11], mat4_array[15]);
 	}
-	glm::vec2 getfloat2FromString(std::string str) {
-		std::vector<float> float2_array;
-		std::stringstream ss(str);
-		std::string token;
-		while (std::getline(ss, token, ' ')) {
-			float2_array.push_back(std::stof(token));
-		}
+	glm::vec2 getfloat2FromString(std::string_view str) {
+		float float2_array[2] = {};
+		getFloatsFromString(str, float2_array, 2);
 		return glm::vec2(float2_array[0], float2_array[1]);
 	}
-	glm::vec4 getRGBAFromString(std::string str) {
-		std::vector<float> float4_array;
-		std::stringstream ss(str);
-		std::string token;
-		while (std::getline(ss, token, ',')) {
-			float4_array.push_back(std::stof(token));
-		}
-		if (float4_array.size() == 3) return glm::vec4(float4_array[0], float4_array[1], float4_array[2], 1.0f);
+	glm::vec4 getRGBAFromString(std::string_view str) {
+		float float4_array[4] = {};
+		uint32_t count = getFloatsFromString(str, float4_array, 4);
+		if (count == 3) return glm::vec4(float4_array[0], float4_array[1], float4_array[2], 1.0f);
 		return glm::vec4(float4_array[0], float4_array[1], float4_array[2], float4_array[3]);
 	}
+	bool benchmarkStringParsing(uint32_t instanceCount) {
+		if (instanceCount == 0) return true;
+
+		//1. instanceCountʵĳļʽsceneInfo.xmlͬÿʵmatrixtranslaterotatescaleÿ16ʵһdiffuse
+		struct GeneratedInstance {
+			float matrix[16];
+			glm::vec3 translate;
+			glm::vec3 rotate;
+			glm::vec3 scale;
+		};
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+		std::vector<GeneratedInstance> generatedInstances(instanceCount);
+		for (GeneratedInstance& instance : generatedInstances) {
+			for (float& value : instance.matrix) value = distribution(rng);
+			instance.translate = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+			instance.rotate = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+			instance.scale = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+		}
+		uint32_t materialCount = (instanceCount + 15) / 16;
+		std::vector<glm::vec4> generatedAlbedos(materialCount);
+		std::vector<glm::vec3> generatedEmissives(materialCount);
+		for (uint32_t i = 0; i < materialCount; ++i) {
+			generatedAlbedos[i] = glm::vec4(distribution(rng), distribution(rng), distribution(rng), 1.0f);
+			generatedEmissives[i] = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+		}
+
+		//to_chars̵ĿɻԭʾӦɵֵλͬ
+		auto appendFloats = [](std::string& str, const float* values, uint32_t count, const char* separator) {
+			char buffer[32];
+			for (uint32_t i = 0; i < count; ++i) {
+				if (i) str += separator;
+				str.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), values[i]).ptr);
+			}
+		};
+		std::string xml = "<scene>\n\t<bsdfs>\n";
+		for (uint32_t i = 0; i < materialCount; ++i) {
+			xml += "\t\t<bsdf type=\"diffuse\" id=\"bsdf" + std::to_string(i) + "\">\n\t\t\t<albedo value=\"";
+			appendFloats(xml, &generatedAlbedos[i].x, 4, ", ");
+			xml += "\" />\n\t\t\t<emissive value = \"";
+			appendFloats(xml, &generatedEmissives[i].x, 3, ", ");
+			xml += "\" />\n\t\t</bsdf>\n";
+		}
+		xml += "\t</bsdfs>\n\t<instances>\n";
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			const GeneratedInstance& instance = generatedInstances[i];
+			xml += "\t\t<instance>\n\t\t\t<transform name=\"to_world\">\n\t\t\t\t<matrix value=\"";
+			appendFloats(xml, instance.matrix, 16, " ");
+			xml += "\"/>\n\t\t\t\t<translate value=\"";
+			appendFloats(xml, &instance.translate.x, 3, ", ");
+			xml += "\"/>\n\t\t\t\t<rotate value=\"";
+			appendFloats(xml, &instance.rotate.x, 3, ", ");
+			xml += "\" />\n\t\t\t\t<scale value=\"";
+			appendFloats(xml, &instance.scale.x, 3, ", ");
+			xml += "\" />\n\t\t\t</transform>\n\t\t\t<meshRef id = \"Cube\" />\n\t\t\t<materialRef id = \"bsdf" + std::to_string(i / 16) + "\" />\n\t\t</instance>\n";
+		}
+		xml += "\t</instances>\n</scene>\n";
+
+		std::filesystem::path scenePath = std::filesystem::temp_directory_path() / "FzbRenderer_stringParsingBenchmark.xml";
+		{
+			std::ofstream file(scenePath, std::ios::binary | std::ios::trunc);
+			file.write(xml.data(), xml.size());
+			if (!file) {
+				LOGE("String parsing benchmark: ޷д%s\n", scenePath.string().c_str());
+				return false;
+			}
+		}
+
+		auto timeCPU = [](auto&& run) {
+			auto start = std::chrono::high_resolution_clock::now();
+			run();
+			return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		};
+
+		//2. Scene::createSceneFromXMLͬ·pugiȡļʵtransformʹʱĽ
+		pugi::xml_document doc;
+		pugi::xml_parse_result result;
+		double loadTime = timeCPU([&]() { result = doc.load_file(scenePath.c_str()); });
+		std::error_code errorCode;
+		std::filesystem::remove(scenePath, errorCode);
+		if (!result) {
+			LOGE("String parsing benchmark: ɵĳļʧ: %s\n", result.description());
+			return false;
+		}
+		pugi::xml_node sceneNode = doc.document_element();
+
+		std::vector<shaderio::BSDFMaterial> materials;
+		std::vector<glm::mat4> matrices;
+		materials.reserve(materialCount);
+		matrices.reserve(instanceCount);
+		double parseTime = timeCPU([&]() {
+			for (pugi::xml_node bsdfNode : sceneNode.child("bsdfs").children("bsdf")) materials.push_back(getMaterialInfoFromSceneInfoXML(bsdfNode));
+			for (pugi::xml_node instanceNode : sceneNode.child("instances").children("instance")) {
+				InstanceSet instanceSet;
+				if (pugi::xml_node transformNode = instanceNode.child("transform")) instanceSet.getTransformMatrixFromXML(transformNode);
+				matrices.push_back(instanceSet.baseMatrix);
+			}
+		});
+
+		//3. Ϊfrom_chars֮ǰstringstream + stofͬһĵͬԣΪʱĲ
+		auto legacyParse = [](const char* str, char separator, std::vector<float>& values) {
+			std::stringstream ss(str);
+			std::string token;
+			while (std::getline(ss, token, separator)) values.push_back(std::stof(token));
+		};
+		std::vector<float> legacyValues;
+		legacyValues.reserve(size_t(instanceCount) * 25 + size_t(materialCount) * 7);
+		double legacyTime = timeCPU([&]() {
+			for (pugi::xml_node bsdfNode : sceneNode.child("bsdfs").children("bsdf")) {
+				legacyParse(bsdfNode.child("albedo").attribute("value").value(), ',', legacyValues);
+				legacyParse(bsdfNode.child("emissive").attribute("value").value(), ',', legacyValues);
+			}
+			for (pugi::xml_node instanceNode : sceneNode.child("instances").children("instance")) {
+				pugi::xml_node transformNode = instanceNode.child("transform");
+				legacyParse(transformNode.child("matrix").attribute("value").value(), ' ', legacyValues);
+				for (const char* name : { "translate", "rotate", "scale" })
+					legacyParse(transformNode.child(name).attribute("value").value(), ',', legacyValues);
+			}
+		});
+
+		//ֻӦλͬgetTransformMatrixFromXML˳ɵֵϣͬ뵥Ԫ
+		bool match = materials.size() == materialCount && matrices.size() == instanceCount;
+		for (uint32_t i = 0; match && i < materialCount; ++i)
+			match = materials[i].albedo == glm::vec3(generatedAlbedos[i]) && materials[i].emissive == generatedEmissives[i];
+		for (uint32_t i = 0; match && i < instanceCount; ++i) {
+			const GeneratedInstance& instance = generatedInstances[i];
+			const float* m = instance.matrix;
+			glm::mat4 expected = glm::mat4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+			expected = glm::translate(expected, instance.translate);
+			glm::vec3 rotateAngle = glm::radians(instance.rotate);
+			if (rotateAngle.x != 0.0f) expected = glm::rotate(expected, rotateAngle.x, glm::vec3(1, 0, 0));
+			if (rotateAngle.y != 0.0f) expected = glm::rotate(expected, rotateAngle.y, glm::vec3(0, 1, 0));
+			if (rotateAngle.z != 0.0f) expected = glm::rotate(expected, rotateAngle.z, glm::vec3(0, 0, 1));
+			expected = glm::scale(expected, instance.scale);
+			for (int column = 0; column < 4; ++column)
+				for (int row = 0; row < 4; ++row) {
+					float difference = std::abs(matrices[i][column][row] - expected[column][row]);
+					match &= difference <= 1e-6f * std::max(std::abs(expected[column][row]), 1.0f);
+				}
+		}
+
+		double fileSize = double(xml.size()) / (1024.0 * 1024.0);
+		if (match) LOGI("String parsing benchmark: %u instances, %.1f MB scene file, load %.3f ms, from_chars loader %.3f ms, stringstream on the same attributes %.3f ms, match\n",
+			instanceCount, fileSize, loadTime, parseTime, legacyTime);
+		else LOGE("String parsing benchmark: %u instances, %.1f MB scene file, load %.3f ms, from_chars loader %.3f ms, stringstream on the same attributes %.3f ms, MISMATCH\n",
+			instanceCount, fileSize, loadTime, parseTime, legacyTime);
+		return match;
+	}
 
 	void printfMat4(glm::mat4& matrix) {
 		printf("TLAS transform:\n%f %f %f %f\n%f %f %f %f\n%f %f %f %f\n%f %f %f %f\n",
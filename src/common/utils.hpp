@@ -23,6 +23,7 @@
 #include <filesystem>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <nvutils/file_operations.hpp>
@@ -51,10 +52,17 @@ nvvk::Image loadAndCreateImage(VkCommandBuffer              cmd,
 }  // namespace nvsamples
 
 namespace FzbRenderer {
-    glm::vec3 getRGBFromString(std::string str);
-    glm::mat4 getMat4FromString(std::string str);
-    glm::vec2 getfloat2FromString(std::string str);
-    glm::vec4 getRGBAFromString(std::string str);
+    //std::from_charsڴ棻ָǶšոƱУʵʽĸ
+    uint32_t getFloatsFromString(std::string_view str, float* values, uint32_t maxCount);
+    float getFloatFromString(std::string_view str, float defaultValue = 0.0f);
+    int getIntFromString(std::string_view str, int defaultValue = 0);
+
+    glm::vec3 getRGBFromString(std::string_view str);
+    glm::mat4 getMat4FromString(std::string_view str);
+    glm::vec2 getfloat2FromString(std::string_view str);
+    glm::vec4 getRGBAFromString(std::string_view str);
+    //instanceCountʵĳļʱpugiʱĲʡʵtransformԾɵstringstream + stofͬԵĺʱգɵֵһʱfalse
+    bool benchmarkStringParsing(uint32_t instanceCount);
 
     void printfMat4(glm::mat4* matrix);
     float rand(uint32_t seed);
@@ -0,0 +1,508 @@
+#include "./Denoiser.h"
+#include <common/Application/Application.h>
+#include <common/Shader/Shader.h>
+#include <nvutils/timers.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvvk/compute_pipeline.hpp>
+#include <nvvk/debug_util.hpp>
+#include <nvgui/property_editor.hpp>
+#include <fstream>
+
+using namespace FzbRenderer;
+
+//-----------------------------------------------------CPU汾--------------------------------------------------------
+//shaders/denoiserCommon.slangͬ
+static float luminance(glm::vec3 color) {
+	return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+static glm::vec3 demodulationAlbedo(glm::vec3 albedo) {
+	return glm::vec3(albedo.x > DENOISER_ALBEDO_EPSILON ? albedo.x : 1.0f,
+		albedo.y > DENOISER_ALBEDO_EPSILON ? albedo.y : 1.0f,
+		albedo.z > DENOISER_ALBEDO_EPSILON ? albedo.z : 1.0f);
+}
+static glm::vec3 decodeNormal(uint32_t encoded) {
+	glm::vec2 e = glm::vec2(float(int16_t(encoded & 0xffffu)), float(int16_t(encoded >> 16))) / 32767.0f;
+	glm::vec3 normal = glm::vec3(e, 1.0f - std::abs(e.x) - std::abs(e.y));
+	if (normal.z < 0.0f) {
+		normal.x = (1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+		normal.y = (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return glm::normalize(normal);
+}
+static glm::vec3 sanitizeColor(glm::vec3 color) {
+	if (glm::any(glm::isnan(color)) || glm::any(glm::isinf(color))) return glm::vec3(0.0f);
+	return glm::max(color, glm::vec3(0.0f));
+}
+static glm::vec2 projectToScreen(const glm::mat4& viewProjMatrix, glm::vec3 position, glm::ivec2 size) {
+	glm::vec4 clipPos = viewProjMatrix * glm::vec4(position, 1.0f);
+	glm::vec2 ndc = glm::vec2(clipPos) / clipPos.w;
+	return (ndc * 0.5f + 0.5f) * glm::vec2(size);
+}
+
+void Denoiser::denoiseCPU(const DenoiserSetting& setting, VkExtent2D size, const glm::mat4& prevViewProjMatrix, const glm::mat4& viewProjMatrix,
+	const std::vector<shaderio::DenoiserFeature>& features, const std::vector<shaderio::DenoiserFeature>* prevFeatures,
+	const std::vector<shaderio::DenoiserHistory>* prevHistory, std::vector<shaderio::DenoiserHistory>& history, std::vector<glm::vec4>& output) {
+	const glm::ivec2 sceneSize(size.width, size.height);
+	const uint32_t pixelCount = size.width * size.height;
+	const bool hasHistory = prevFeatures != nullptr && prevHistory != nullptr;
+	history.assign(pixelCount, shaderio::DenoiserHistory{});
+	output.assign(pixelCount, glm::vec4(0.0f));
+	std::array<std::vector<glm::vec4>, 2> filter = { std::vector<glm::vec4>(pixelCount), std::vector<glm::vec4>(pixelCount) };
+
+	auto isInside = [&](glm::ivec2 pixel) { return pixel.x >= 0 && pixel.y >= 0 && pixel.x < sceneSize.x && pixel.y < sceneSize.y; };
+	auto getPixelIndex = [&](glm::ivec2 pixel) { return uint32_t(pixel.y) * size.width + uint32_t(pixel.x); };
+	auto getDepthGradient = [&](glm::ivec2 pixel, float depth) {
+		float gradient[2] = { 0.0f, 0.0f };
+		for (int axis = 0; axis < 2; ++axis) {
+			float minDifference = 1e30f;
+			for (int side = -1; side <= 1; side += 2) {
+				glm::ivec2 neighbour = pixel + (axis == 0 ? glm::ivec2(side, 0) : glm::ivec2(0, side));
+				if (!isInside(neighbour)) continue;
+				float neighbourDepth = features[getPixelIndex(neighbour)].depth;
+				if (neighbourDepth < 0.0f) continue;
+				minDifference = std::min(minDifference, std::abs(neighbourDepth - depth));
+			}
+			gradient[axis] = minDifference < 1e30f ? minDifference : 0.0f;
+		}
+		return std::max(gradient[0], gradient[1]);
+	};
+	auto getEdgeWeight = [&](glm::vec3 centerNormal, float centerDepth, float depthGradient, const shaderio::DenoiserFeature& neighbour, float pixelDistance) {
+		float normalWeight = std::pow(std::max(glm::dot(centerNormal, decodeNormal(neighbour.normal)), 0.0f), setting.phiNormal);
+		float depthWeight = std::abs(neighbour.depth - centerDepth) / (setting.phiDepth * depthGradient * pixelDistance + 1e-3f);
+		return normalWeight * std::exp(-depthWeight);
+	};
+
+	//temporal
+	for (int y = 0; y < sceneSize.y; ++y) {
+		for (int x = 0; x < sceneSize.x; ++x) {
+			glm::ivec2 pixel(x, y);
+			uint32_t pixelIndex = getPixelIndex(pixel);
+			const shaderio::DenoiserFeature& feature = features[pixelIndex];
+			glm::vec3 color = sanitizeColor(feature.color);
+			shaderio::DenoiserHistory& pixelHistory = history[pixelIndex];
+			if (feature.depth < 0.0f) {
+				pixelHistory.illumination = color;
+				filter[0][pixelIndex] = glm::vec4(color, 0.0f);
+				continue;
+			}
+			glm::vec3 normal = decodeNormal(feature.normal);
+			glm::vec3 illumination = color / demodulationAlbedo(feature.albedo);
+			float pixelLuminance = luminance(illumination);
+			glm::vec2 moments(pixelLuminance, pixelLuminance * pixelLuminance);
+
+			glm::vec2 motion = projectToScreen(prevViewProjMatrix, feature.position, sceneSize) - projectToScreen(viewProjMatrix, feature.position, sceneSize);
+			glm::vec2 prevPixel = glm::vec2(pixel) + motion;
+			glm::ivec2 prevBase = glm::ivec2(glm::floor(prevPixel));
+			glm::vec2 prevFraction = prevPixel - glm::vec2(prevBase);
+
+			glm::vec3 prevIllumination(0.0f);
+			glm::vec2 prevMoments(0.0f);
+			float prevHistoryLength = 0.0f;
+			float weightSum = 0.0f;
+			for (int tap = 0; hasHistory && tap < 4; ++tap) {
+				glm::ivec2 offset(tap & 1, tap >> 1);
+				glm::ivec2 tapPixel = prevBase + offset;
+				if (!isInside(tapPixel)) continue;
+				uint32_t tapIndex = getPixelIndex(tapPixel);
+				const shaderio::DenoiserFeature& prevFeature = (*prevFeatures)[tapIndex];
+				if (prevFeature.depth < 0.0f || std::abs(feature.depth - prevFeature.depth) > 0.1f * feature.depth ||
+					glm::dot(normal, decodeNormal(prevFeature.normal)) < 0.9f) continue;
+				float weight = (offset.x == 1 ? prevFraction.x : 1.0f - prevFraction.x) * (offset.y == 1 ? prevFraction.y : 1.0f - prevFraction.y);
+				const shaderio::DenoiserHistory& tapHistory = (*prevHistory)[tapIndex];
+				prevIllumination += tapHistory.illumination * weight;
+				prevMoments += tapHistory.moments * weight;
+				prevHistoryLength += tapHistory.historyLength * weight;
+				weightSum += weight;
+			}
+			if (weightSum > 1e-3f) {
+				prevIllumination /= weightSum;
+				prevMoments /= weightSum;
+				prevHistoryLength /= weightSum;
+			}
+			else prevHistoryLength = 0.0f;
+
+			pixelHistory.historyLength = std::min(prevHistoryLength + 1.0f, float(setting.maxHistoryLength));
+			float alpha = 1.0f / pixelHistory.historyLength;
+			pixelHistory.illumination = glm::mix(prevIllumination, illumination, alpha);
+			pixelHistory.moments = glm::mix(prevMoments, moments, alpha);
+			float variance = std::max(pixelHistory.moments.y - pixelHistory.moments.x * pixelHistory.moments.x, 0.0f);
+			filter[0][pixelIndex] = glm::vec4(pixelHistory.illumination, variance);
+		}
+	}
+
+	//variance
+	for (int y = 0; y < sceneSize.y; ++y) {
+		for (int x = 0; x < sceneSize.x; ++x) {
+			glm::ivec2 pixel(x, y);
+			uint32_t pixelIndex = getPixelIndex(pixel);
+			const shaderio::DenoiserFeature& feature = features[pixelIndex];
+			const shaderio::DenoiserHistory& pixelHistory = history[pixelIndex];
+			if (feature.depth < 0.0f || pixelHistory.historyLength >= float(DENOISER_MIN_HISTORY_LENGTH)) {
+				filter[1][pixelIndex] = filter[0][pixelIndex];
+				continue;
+			}
+			glm::vec3 normal = decodeNormal(feature.normal);
+			float depthGradient = getDepthGradient(pixel, feature.depth);
+			glm::vec3 illuminationSum(0.0f);
+			glm::vec2 momentsSum(0.0f);
+			float weightSum = 0.0f;
+			for (int dy = -DENOISER_VARIANCE_RADIUS; dy <= DENOISER_VARIANCE_RADIUS; ++dy) {
+				for (int dx = -DENOISER_VARIANCE_RADIUS; dx <= DENOISER_VARIANCE_RADIUS; ++dx) {
+					glm::ivec2 neighbourPixel = pixel + glm::ivec2(dx, dy);
+					if (!isInside(neighbourPixel)) continue;
+					uint32_t neighbourIndex = getPixelIndex(neighbourPixel);
+					const shaderio::DenoiserFeature& neighbour = features[neighbourIndex];
+					if (neighbour.depth < 0.0f) continue;
+					float weight = getEdgeWeight(normal, feature.depth, depthGradient, neighbour, glm::length(glm::vec2(dx, dy)));
+					illuminationSum += history[neighbourIndex].illumination * weight;
+					momentsSum += history[neighbourIndex].moments * weight;
+					weightSum += weight;
+				}
+			}
+			illuminationSum /= weightSum;
+			momentsSum /= weightSum;
+			float variance = std::max(momentsSum.y - momentsSum.x * momentsSum.x, 0.0f) * float(DENOISER_MIN_HISTORY_LENGTH) / std::max(pixelHistory.historyLength, 1.0f);
+			filter[1][pixelIndex] = glm::vec4(illuminationSum, variance);
+		}
+	}
+
+	//a-trous
+	const float gaussianKernel[2] = { 0.25f, 0.125f };
+	const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+	uint32_t inputIndex = 1;
+	for (int iteration = 0; iteration < setting.atrousIterationCount; ++iteration) {
+		const std::vector<glm::vec4>& input = filter[inputIndex];
+		std::vector<glm::vec4>& result = filter[inputIndex ^ 1];
+		const int stepSize = 1 << iteration;
+		for (int y = 0; y < sceneSize.y; ++y) {
+			for (int x = 0; x < sceneSize.x; ++x) {
+				glm::ivec2 pixel(x, y);
+				uint32_t pixelIndex = getPixelIndex(pixel);
+				const shaderio::DenoiserFeature& feature = features[pixelIndex];
+				glm::vec4 center = input[pixelIndex];
+				if (feature.depth < 0.0f) {
+					result[pixelIndex] = center;
+					continue;
+				}
+
+				float blurredVariance = 0.0f;
+				for (int dy = -1; dy <= 1; ++dy) {
+					for (int dx = -1; dx <= 1; ++dx) {
+						glm::ivec2 neighbourPixel = glm::clamp(pixel + glm::ivec2(dx, dy), glm::ivec2(0), sceneSize - 1);
+						blurredVariance += input[getPixelIndex(neighbourPixel)].w * gaussianKernel[std::abs(dx)] * gaussianKernel[std::abs(dy)] * 4.0f;
+					}
+				}
+
+				glm::vec3 normal = decodeNormal(feature.normal);
+				float depthGradient = getDepthGradient(pixel, feature.depth);
+				float centerLuminance = luminance(glm::vec3(center));
+				float phiLuminance = setting.phiColor * std::sqrt(std::max(blurredVariance, 0.0f)) + 1e-10f;
+
+				glm::vec3 illuminationSum(0.0f);
+				float varianceSum = 0.0f;
+				float weightSum = 0.0f;
+				for (int dy = -2; dy <= 2; ++dy) {
+					for (int dx = -2; dx <= 2; ++dx) {
+						glm::ivec2 neighbourPixel = pixel + glm::ivec2(dx, dy) * stepSize;
+						if (!isInside(neighbourPixel)) continue;
+						uint32_t neighbourIndex = getPixelIndex(neighbourPixel);
+						const shaderio::DenoiserFeature& neighbour = features[neighbourIndex];
+						if (neighbour.depth < 0.0f) continue;
+						glm::vec4 neighbourValue = input[neighbourIndex];
+
+						float luminanceWeight = std::abs(luminance(glm::vec3(neighbourValue)) - centerLuminance) / phiLuminance;
+						float weight = getEdgeWeight(normal, feature.depth, depthGradient, neighbour, glm::length(glm::vec2(dx, dy)) * float(stepSize))
+							* std::exp(-luminanceWeight) * kernel[std::abs(dx)] * kernel[std::abs(dy)];
+						illuminationSum += glm::vec3(neighbourValue) * weight;
+						varianceSum += neighbourValue.w * weight * weight;
+						weightSum += weight;
+					}
+				}
+				result[pixelIndex] = glm::vec4(illuminationSum / weightSum, varianceSum / (weightSum * weightSum));
+				if (iteration == 0) history[pixelIndex].illumination = glm::vec3(result[pixelIndex]);
+			}
+		}
+		inputIndex ^= 1;
+	}
+
+	//modulate
+	for (uint32_t pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex) {
+		const shaderio::DenoiserFeature& feature = features[pixelIndex];
+		glm::vec3 illumination = glm::vec3(filter[inputIndex][pixelIndex]);
+		glm::vec3 color = feature.depth < 0.0f ? illumination : illumination * demodulationAlbedo(feature.albedo);
+		output[pixelIndex] = glm::vec4(color, 1.0f);
+	}
+}
+
+//-----------------------------------------------------GPU汾--------------------------------------------------------
+Denoiser::Denoiser(pugi::xml_node& featureNode) {
+	profileName = "Denoiser";
+	if (pugi::xml_node enableNode = featureNode.child("enable"))
+		enable = std::string(enableNode.attribute("value").value()) == "true";
+	if (pugi::xml_node iterationNode = featureNode.child("atrousIterationCount"))
+		setting.atrousIterationCount = std::stoi(iterationNode.attribute("value").value());
+	if (pugi::xml_node historyNode = featureNode.child("maxHistoryLength"))
+		setting.maxHistoryLength = std::stoi(historyNode.attribute("value").value());
+	if (pugi::xml_node phiColorNode = featureNode.child("phiColor"))
+		setting.phiColor = std::stof(phiColorNode.attribute("value").value());
+	if (pugi::xml_node phiNormalNode = featureNode.child("phiNormal"))
+		setting.phiNormal = std::stof(phiNormalNode.attribute("value").value());
+	if (pugi::xml_node phiDepthNode = featureNode.child("phiDepth"))
+		setting.phiDepth = std::stof(phiDepthNode.attribute("value").value());
+}
+void Denoiser::init() {
+	createDescriptorSetLayout();
+	Feature::createPipelineLayout(sizeof(shaderio::DenoiserPushConstant));
+	compileAndCreateShaders();
+}
+void Denoiser::clean() {
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_temporal, nullptr);
+	vkDestroyShaderEXT(device, computeShader_variance, nullptr);
+	vkDestroyShaderEXT(device, computeShader_atrous, nullptr);
+	vkDestroyShaderEXT(device, computeShader_modulate, nullptr);
+	destroyBuffers();
+	Feature::clean();
+}
+void Denoiser::uiRender() {
+	bool& UIModified = Application::UIModified;
+	namespace PE = nvgui::PropertyEditor;
+	if (ImGui::Begin("Denoiser")) {
+		UIModified |= ImGui::Checkbox("Enable", &enable);
+		PE::begin();
+		PE::SliderInt("A-trous Iterations", &setting.atrousIterationCount, 0, 8, "%d", ImGuiSliderFlags_AlwaysClamp, "Number of a-trous filter iterations");
+		PE::SliderInt("Max History", &setting.maxHistoryLength, 1, 64, "%d", ImGuiSliderFlags_AlwaysClamp, "The new frame is blended with at least 1 / maxHistory");
+		PE::SliderFloat("Phi Color", &setting.phiColor, 0.1f, 32.0f, "%.2f", ImGuiSliderFlags_Logarithmic, "Luminance edge stopping, in standard deviations");
+		PE::SliderFloat("Phi Normal", &setting.phiNormal, 1.0f, 256.0f, "%.1f", ImGuiSliderFlags_Logarithmic, "Exponent of the normal edge stopping");
+		PE::SliderFloat("Phi Depth", &setting.phiDepth, 0.1f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic, "Depth edge stopping, in units of the depth gradient");
+		PE::end();
+		if (ImGui::Button("Save Regression Images")) regressionRequested = true;
+	}
+	ImGui::End();
+}
+void Denoiser::resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex) {
+	sceneSize = size;
+	destroyBuffers();
+	createBuffers(size);
+	historyReset = true;
+
+	nvvk::WriteSetContainer write{};
+	VkWriteDescriptorSet outImageWrite = staticDescPack.makeWrite(shaderio::StaticBindingPoints_Denoiser::eOutImage_Denoiser, 0, 0, 1);
+	write.append(outImageWrite, outGBuffer.getColorImageView(outImageIndex), VK_IMAGE_LAYOUT_GENERAL);
+	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+}
+void Denoiser::preRender() {
+	if (regressionPending) {
+		vkQueueWaitIdle(Application::app->getQueue(0).queue);
+		saveRegressionImages();
+		regressionPending = false;
+	}
+	//֡дһʷһ֡ΪͶӰԴ
+	frameParity ^= 1;
+}
+void Denoiser::render(VkCommandBuffer cmd, int maxHistoryLength) {
+	NVVK_DBG_SCOPE(cmd);
+	if (sceneSize.width == 0 || sceneSize.height == 0) return;
+	auto section = profileStage(cmd, "Denoise");
+
+	const glm::mat4& viewProjMatrix = Application::sceneResource.sceneInfo.viewProjMatrix;
+	const uint32_t previous = frameParity ^ 1;
+	pushConstant.prevViewProjMatrix = prevViewProjMatrix;
+	pushConstant.viewProjMatrix = viewProjMatrix;
+	pushConstant.sceneSize = shaderio::uint2(sceneSize.width, sceneSize.height);
+	pushConstant.maxHistoryLength = maxHistoryLength;
+	pushConstant.phiColor = setting.phiColor;
+	pushConstant.phiNormal = setting.phiNormal;
+	pushConstant.phiDepth = setting.phiDepth;
+	//عͼûʷһ֡ϱȽϣCPU汾Ҫһ֡
+	pushConstant.resetHistory = historyReset || regressionRequested ? 1 : 0;
+	pushConstant.writeHistory = 0;
+	pushConstant.features = (shaderio::DenoiserFeature*)featureBuffers[frameParity].address;
+	pushConstant.prevFeatures = (shaderio::DenoiserFeature*)featureBuffers[previous].address;
+	pushConstant.history = (shaderio::DenoiserHistory*)historyBuffers[frameParity].address;
+	pushConstant.prevHistory = (shaderio::DenoiserHistory*)historyBuffers[previous].address;
+
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, staticDescPack.getSetPtr(), 0, nullptr);
+
+	pushConstant.filterOutput = (shaderio::float4*)filterBuffers[0].address;
+	dispatch(cmd, computeShader_temporal);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	pushConstant.filterInput = (shaderio::float4*)filterBuffers[0].address;
+	pushConstant.filterOutput = (shaderio::float4*)filterBuffers[1].address;
+	dispatch(cmd, computeShader_variance);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	finalFilterIndex = 1;
+	for (int iteration = 0; iteration < setting.atrousIterationCount; ++iteration) {
+		pushConstant.stepSize = 1 << iteration;
+		pushConstant.writeHistory = iteration == 0 ? 1 : 0;
+		pushConstant.filterInput = (shaderio::float4*)filterBuffers[finalFilterIndex].address;
+		pushConstant.filterOutput = (shaderio::float4*)filterBuffers[finalFilterIndex ^ 1].address;
+		dispatch(cmd, computeShader_atrous);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		finalFilterIndex ^= 1;
+	}
+
+	pushConstant.filterInput = (shaderio::float4*)filterBuffers[finalFilterIndex].address;
+	dispatch(cmd, computeShader_modulate);
+
+	if (regressionRequested) {
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		const VkDeviceSize pixelCount = VkDeviceSize(sceneSize.width) * sceneSize.height;
+		nvvk::ResourceAllocator* allocator = &Application::allocator;
+		allocator->createBuffer(regressionFeatureBuffer, pixelCount * sizeof(shaderio::DenoiserFeature), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+		NVVK_DBG_NAME(regressionFeatureBuffer.buffer);
+		allocator->createBuffer(regressionResultBuffer, pixelCount * sizeof(glm::vec4), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+		NVVK_DBG_NAME(regressionResultBuffer.buffer);
+
+		VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = pixelCount * sizeof(shaderio::DenoiserFeature) };
+		vkCmdCopyBuffer(cmd, featureBuffers[frameParity].buffer, regressionFeatureBuffer.buffer, 1, &region);
+		region.size = pixelCount * sizeof(glm::vec4);
+		vkCmdCopyBuffer(cmd, filterBuffers[finalFilterIndex].buffer, regressionResultBuffer.buffer, 1, &region);
+		regressionRequested = false;
+		regressionPending = true;
+	}
+
+	prevViewProjMatrix = viewProjMatrix;
+	historyReset = false;
+}
+
+void Denoiser::createDescriptorSetLayout() {
+	nvvk::DescriptorBindings bindings;
+	bindings.addBinding({
+		.binding = shaderio::StaticBindingPoints_Denoiser::eOutImage_Denoiser,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+	NVVK_DBG_NAME(staticDescPack.getLayout());
+	NVVK_DBG_NAME(staticDescPack.getPool());
+	NVVK_DBG_NAME(staticDescPack.getSet(0));
+}
+void Denoiser::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "denoiser.slang" });
+}
+void Denoiser::compileAndCreateShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "denoiser.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::DenoiserPushConstant),
+	};
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.setLayoutCount = 1,
+		.pSetLayouts = staticDescPack.getLayoutPtr(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	VkDevice device = Application::app->getDevice();
+	std::array<std::pair<VkShaderEXT*, const char*>, 4> shaders = { {
+		{ &computeShader_temporal, "computeMain_temporal" },
+		{ &computeShader_variance, "computeMain_variance" },
+		{ &computeShader_atrous, "computeMain_atrous" },
+		{ &computeShader_modulate, "computeMain_modulate" },
+	} };
+	for (auto& [shader, entryName] : shaders) {
+		vkDestroyShaderEXT(device, *shader, nullptr);
+		shaderInfo.pName = entryName;
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, shader);
+		NVVK_DBG_NAME(*shader);
+	}
+}
+
+void Denoiser::createBuffers(VkExtent2D size) {
+	const VkDeviceSize pixelCount = std::max(VkDeviceSize(size.width) * size.height, VkDeviceSize(1));
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	for (int i = 0; i < 2; ++i) {
+		allocator->createBuffer(featureBuffers[i], pixelCount * sizeof(shaderio::DenoiserFeature), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(featureBuffers[i].buffer);
+		allocator->createBuffer(historyBuffers[i], pixelCount * sizeof(shaderio::DenoiserHistory), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(historyBuffers[i].buffer);
+		allocator->createBuffer(filterBuffers[i], pixelCount * sizeof(glm::vec4), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(filterBuffers[i].buffer);
+	}
+}
+void Denoiser::destroyBuffers() {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	for (int i = 0; i < 2; ++i) {
+		allocator->destroyBuffer(featureBuffers[i]);
+		allocator->destroyBuffer(historyBuffers[i]);
+		allocator->destroyBuffer(filterBuffers[i]);
+	}
+	allocator->destroyBuffer(regressionFeatureBuffer);
+	allocator->destroyBuffer(regressionResultBuffer);
+}
+void Denoiser::dispatch(VkCommandBuffer cmd, VkShaderEXT shader) {
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &shader);
+	VkPushConstantsInfo pushInfo{
+		.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+		.layout = pipelineLayout,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::DenoiserPushConstant),
+		.pValues = &pushConstant,
+	};
+	vkCmdPushConstants2(cmd, &pushInfo);
+	VkExtent2D groupSize = nvvk::getGroupCounts(sceneSize, VkExtent2D{ DENOISER_THREADGROUP_SIZE_X, DENOISER_THREADGROUP_SIZE_Y });
+	vkCmdDispatch(cmd, groupSize.width, groupSize.height, 1);
+}
+
+//-----------------------------------------------------ع--------------------------------------------------------
+//pfmΪĸRGBдµ
+static void writePFM(const std::filesystem::path& path, VkExtent2D size, const std::vector<glm::vec3>& pixels) {
+	std::ofstream file(path, std::ios::binary);
+	file << "PF\n" << size.width << " " << size.height << "\n-1.0\n";
+	for (int y = int(size.height) - 1; y >= 0; --y)
+		file.write(reinterpret_cast<const char*>(pixels.data() + size_t(y) * size.width), std::streamsize(size.width * sizeof(glm::vec3)));
+}
+void Denoiser::saveRegressionImages() {
+	SCOPED_TIMER(__FUNCTION__);
+	const uint32_t pixelCount = sceneSize.width * sceneSize.height;
+	const shaderio::DenoiserFeature* gpuFeatures = static_cast<const shaderio::DenoiserFeature*>(regressionFeatureBuffer.mapping);
+	const glm::vec4* gpuFiltered = static_cast<const glm::vec4*>(regressionResultBuffer.mapping);
+	std::vector<shaderio::DenoiserFeature> features(gpuFeatures, gpuFeatures + pixelCount);
+
+	std::vector<shaderio::DenoiserHistory> history;
+	std::vector<glm::vec4> cpuOutput;
+	denoiseCPU(setting, sceneSize, glm::mat4(1.0f), glm::mat4(1.0f), features, nullptr, nullptr, history, cpuOutput);
+
+	std::vector<glm::vec3> noisyImage(pixelCount), gpuImage(pixelCount), cpuImage(pixelCount);
+	double squaredErrorSum = 0.0, squaredReferenceSum = 0.0;
+	for (uint32_t i = 0; i < pixelCount; ++i) {
+		noisyImage[i] = sanitizeColor(features[i].color);
+		gpuImage[i] = features[i].depth < 0.0f ? glm::vec3(gpuFiltered[i]) : glm::vec3(gpuFiltered[i]) * demodulationAlbedo(features[i].albedo);
+		cpuImage[i] = glm::vec3(cpuOutput[i]);
+		glm::vec3 difference = gpuImage[i] - cpuImage[i];
+		squaredErrorSum += glm::dot(difference, difference);
+		squaredReferenceSum += glm::dot(cpuImage[i], cpuImage[i]);
+	}
+
+	std::filesystem::path outputPath = nvutils::getExecutablePath().parent_path();
+	writePFM(outputPath / "denoiser_noisy.pfm", sceneSize, noisyImage);
+	writePFM(outputPath / "denoiser_gpu.pfm", sceneSize, gpuImage);
+	writePFM(outputPath / "denoiser_cpu.pfm", sceneSize, cpuImage);
+	//GPUCPUexppowȲֻͬҪС
+	double relativeRMSE = std::sqrt(squaredErrorSum / std::max(squaredReferenceSum, 1e-30));
+	LOGI("Denoiser regression: %ux%u, CPU/GPU relative RMSE %g, %s, images saved to %s\n", sceneSize.width, sceneSize.height, relativeRMSE,
+		relativeRMSE < 1e-3 ? "match" : "MISMATCH", outputPath.string().c_str());
+
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->destroyBuffer(regressionFeatureBuffer);
+	allocator->destroyBuffer(regressionResultBuffer);
+}
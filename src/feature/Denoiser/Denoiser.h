@@ -0,0 +1,87 @@
+#pragma once
+
+#include "feature/Feature.h"
+#include "./shaderio.h"
+#include <pugixml.hpp>
+
+#ifndef FZBRENDERER_FEATURE_DENOISER_H
+#define FZBRENDERER_FEATURE_DENOISER_H
+
+namespace FzbRenderer {
+struct DenoiserSetting {
+	int atrousIterationCount = 5;
+	int maxHistoryLength = 8;
+	float phiColor = 4.0f;
+	float phiNormal = 128.0f;
+	float phiDepth = 1.0f;
+};
+/*
+Ե֪ʱս루SVGFRenderer::postProcess֮ǰ
+1. ·׷ÿ֡radiance״еalbedoߡȡλдgetFeatureAddress()shaders/denoiserCommon.slangdenoiserMakeFeature
+2. temporalһ֡viewProjͶӰõ˶ȡһʱʷϣۼȵһ׾
+3. varianceʷ϶̵7x7˫Ʒ
+4. a-trousԷȵıԵֹͣatrousIterationCountΣһεĽдʷ
+5. modulate˻albedoдȾͼ
+denoiseCPUGPUͬCPU汾ɻعͼ
+*/
+class Denoiser : public Feature {
+public:
+	Denoiser() = default;
+	virtual ~Denoiser() = default;
+
+	Denoiser(pugi::xml_node& featureNode);
+
+	void init() override;
+	void clean() override;
+	void uiRender() override;
+	void resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex);
+	void preRender();
+	void render(VkCommandBuffer cmd, int maxHistoryLength);
+
+	void createDescriptorSetLayout() override;
+	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
+
+	shaderio::DenoiserFeature* getFeatureAddress() const { return (shaderio::DenoiserFeature*)featureBuffers[frameParity].address; }
+	void resetHistory() { historyReset = true; }
+
+	/*
+	CPU汾shaders/denoiser.slangpassһ
+	prevFeaturesprevHistoryΪʱΪûʷhistoryoutputoutputΪƺɫ
+	*/
+	static void denoiseCPU(const DenoiserSetting& setting, VkExtent2D size, const glm::mat4& prevViewProjMatrix, const glm::mat4& viewProjMatrix,
+		const std::vector<shaderio::DenoiserFeature>& features, const std::vector<shaderio::DenoiserFeature>* prevFeatures,
+		const std::vector<shaderio::DenoiserHistory>* prevHistory, std::vector<shaderio::DenoiserHistory>& history, std::vector<glm::vec4>& output);
+
+	DenoiserSetting setting;
+	bool enable = true;
+private:
+	void createBuffers(VkExtent2D size);
+	void destroyBuffers();
+	void dispatch(VkCommandBuffer cmd, VkShaderEXT shader);
+	//ѱ֡GPUأdenoiseCPUԱȲΪpfm
+	void saveRegressionImages();
+
+	VkExtent2D sceneSize{};
+	uint32_t frameParity = 0;
+	bool historyReset = true;
+	bool regressionRequested = false;
+	bool regressionPending = false;
+	glm::mat4 prevViewProjMatrix = glm::mat4(1.0f);
+
+	std::array<nvvk::Buffer, 2> featureBuffers;
+	std::array<nvvk::Buffer, 2> historyBuffers;
+	std::array<nvvk::Buffer, 2> filterBuffers;
+	nvvk::Buffer regressionFeatureBuffer;
+	nvvk::Buffer regressionResultBuffer;
+	uint32_t finalFilterIndex = 0;
+
+	shaderio::DenoiserPushConstant pushConstant{};
+	VkShaderEXT computeShader_temporal{};
+	VkShaderEXT computeShader_variance{};
+	VkShaderEXT computeShader_atrous{};
+	VkShaderEXT computeShader_modulate{};
+};
+}
+
+#endif
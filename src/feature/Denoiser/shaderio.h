@@ -0,0 +1,59 @@
+#pragma once
+
+#include <common/Shader/shaderStructType.h>
+
+#ifndef FZBRENDERER_DENOISER_SHADER_IO_H
+#define FZBRENDERER_DENOISER_SHADER_IO_H
+NAMESPACE_SHADERIO_BEGIN()
+
+#define DENOISER_THREADGROUP_SIZE_X 16
+#define DENOISER_THREADGROUP_SIZE_Y 16
+
+#define DENOISER_MISS_DEPTH -1.0f				// depth of pixels whose primary ray leaves the scene, they are not filtered
+#define DENOISER_MIN_HISTORY_LENGTH 4			// below this the variance is estimated spatially instead of from the temporal moments
+#define DENOISER_VARIANCE_RADIUS 3				// 7x7 bilateral window of the spatial variance estimate
+#define DENOISER_ALBEDO_EPSILON 1e-3f			// albedo channels below this are not demodulated
+
+// primary hit features written by the path tracers, one per pixel
+struct DenoiserFeature {
+	float3 color;			// noisy radiance of this frame
+	float depth;			// distance from the camera to the primary hit, DENOISER_MISS_DEPTH on miss
+	float3 albedo;			// the filters work on color / albedo so textures are not blurred
+	uint normal;			// octahedral snorm16x2, see denoiserEncodeNormal
+	float3 position;		// world position of the primary hit, reprojected with the previous view projection
+	float padding;
+};
+
+// temporally integrated illumination of a pixel
+struct DenoiserHistory {
+	float3 illumination;
+	float historyLength;	// frames integrated, 0 for disoccluded pixels
+	float2 moments;			// first and second moment of the luminance
+	float2 padding;
+};
+
+struct DenoiserPushConstant {
+	float4x4 prevViewProjMatrix;
+	float4x4 viewProjMatrix;
+	uint2 sceneSize;
+	int stepSize = 1;				// a-trous tap distance, 1 << iteration
+	int maxHistoryLength = 8;		// the new frame is blended with 1 / min(historyLength, maxHistoryLength)
+	float phiColor = 4.0f;			// luminance edge stopping, in standard deviations
+	float phiNormal = 128.0f;		// exponent of the normal edge stopping
+	float phiDepth = 1.0f;			// depth edge stopping, in units of the local depth gradient
+	uint resetHistory = 0;
+	uint writeHistory = 0;			// the first a-trous iteration is fed back as history (SVGF)
+	DenoiserFeature* features;
+	DenoiserFeature* prevFeatures;
+	DenoiserHistory* history;
+	DenoiserHistory* prevHistory;
+	float4* filterInput;			// illumination and variance
+	float4* filterOutput;
+};
+
+enum StaticBindingPoints_Denoiser {
+	eOutImage_Denoiser = 0,
+};
+
+NAMESPACE_SHADERIO_END()
+#endif
@@ -52,7 +52,7 @@ void FzbRenderer::Feature::createDescriptorSetLayout() {
 						 .stageFlags = VK_SHADER_STAGE_ALL },
 		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
 		| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -89,6 +89,10 @@ void FzbRenderer::Feature::addTextureArrayDescriptor(uint32_t textureBinding, nv
 }
 
 void FzbRenderer::Feature::compileAndCreateShaders() {};
+void FzbRenderer::Feature::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {};
 void FzbRenderer::Feature::updateDataPerFrame(VkCommandBuffer cmd) {
 
-};
\ No newline at end of file
+};
+FzbRenderer::Profiler::Section FzbRenderer::Feature::profileStage(VkCommandBuffer cmd, const std::string& stageName) {
+	return Application::profiler.section(cmd, profileName + "/" + stageName);
+}
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <nvvk/descriptors.hpp>
 #include <common/Shader/shaderStructType.h>
 #include "common/Scene/Scene.h"
+#include "common/Profiler/Profiler.h"
+#include "common/Shader/ShaderCache.h"
 
 #ifndef FZBRENDERER_FEATURE_H
 #define FZBRENDERER_FEATURE_H
@@ -29,8 +31,14 @@ public:
 	virtual void addTextureArrayDescriptor(uint32_t textureBinding = shaderio::eTextures, nvvk::DescriptorPack* descPackPtr = nullptr);
 
 	virtual void compileAndCreateShaders();
+	//initǰcompileAndCreateShaders(Դļ, )ShaderCache::prewarmб룻ʱ˳һ
+	virtual void collectShaderRequests(std::vector<ShaderCompileRequest>& requests);
 	virtual void updateDataPerFrame(VkCommandBuffer cmd);
 
+	//֡صsectionʱΪprofileName/stageName
+	Profiler::Section profileStage(VkCommandBuffer cmd, const std::string& stageName);
+	std::string profileName = "Feature";
+
 	nvvk::GBuffer gBuffers{};	//GBufferʵϿΪеҪ
 	nvvk::DescriptorPack staticDescPack;
 	nvvk::DescriptorPack dynamicDescPack;	//ÿ֡µ
@@ -190,7 +190,7 @@ void FzbRenderer::LightInject::createDescriptorSetLayout() {
 		.descriptorCount = (uint32_t)setting.VGBs.size(),
 		.stageFlags = VK_SHADER_STAGE_ALL });
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	LOGI("LightInject ray tracing static descriptor layout created\n");
@@ -205,7 +205,7 @@ void FzbRenderer::LightInject::createDescriptorSetLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("LightInject ray tracing dynamic descriptor layout created\n");
 }
@@ -366,7 +366,7 @@ void FzbRenderer::LightInject::createPipeline() {
 #ifdef PathTracingMotionBlur
 	rtPipelineInfo.flags = VK_PIPELINE_CREATE_RAY_TRACING_ALLOW_MOTION_BIT_NV;
 #endif
-	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, {}, 1, & rtPipelineInfo, nullptr, &rtPipeline);
+	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, Application::deviceShaderCache.pipelineCache, 1, & rtPipelineInfo, nullptr, &rtPipeline);
 	NVVK_DBG_NAME(rtPipeline);
 
 	LOGI("Ray tracing pipeline layout created successfully\n");
@@ -403,7 +403,7 @@ void FzbRenderer::LightInject::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Cube);
 	NVVK_DBG_NAME(vertexShader_Cube);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -411,7 +411,7 @@ void FzbRenderer::LightInject::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Cube);
 	NVVK_DBG_NAME(fragmentShader_Cube);
 #endif
 }
@@ -0,0 +1,621 @@
+#include "./CPUBSDF.h"
+#include <nvutils/logger.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#if CPU_BSDF_SIMD_WIDTH == 8
+#include <immintrin.h>
+#elif CPU_BSDF_SIMD_WIDTH == 4
+#include <emmintrin.h>
+#endif
+
+using namespace FzbRenderer;
+
+static constexpr float BSDF_PI = 3.14159265358979323846f;
+static constexpr float BSDF_1_PI = 0.318309886183790671538f;
+//-----------------------------------------------------SIMD--------------------------------------------------------
+/*
+BSDFʽдģ壬FΪfloatʱ汾FΪSIMDFloatʱһμCPU_BSDF_SIMD_WIDTH
+֧ȫΪselect֧㣬laneгֵnanӰ
+*/
+static inline float select(bool mask, float a, float b) { return mask ? a : b; }
+static inline float vmax(float a, float b) { return std::max(a, b); }
+static inline float vmin(float a, float b) { return std::min(a, b); }
+static inline float vsqrt(float a) { return std::sqrt(a); }
+static inline float vabs(float a) { return std::abs(a); }
+
+#if CPU_BSDF_SIMD_WIDTH > 1
+#if CPU_BSDF_SIMD_WIDTH == 8
+using SIMDRegister = __m256;
+#define SIMD_OP(name) _mm256_##name
+#define SIMD_CMP(a, b, avxPredicate, sseName) _mm256_cmp_ps(a, b, avxPredicate)
+#define SIMD_ALL_ONES() _mm256_castsi256_ps(_mm256_set1_epi32(-1))
+#else
+using SIMDRegister = __m128;
+#define SIMD_OP(name) _mm_##name
+#define SIMD_CMP(a, b, avxPredicate, sseName) _mm_##sseName##_ps(a, b)
+#define SIMD_ALL_ONES() _mm_castsi128_ps(_mm_set1_epi32(-1))
+#endif
+struct SIMDMask { SIMDRegister v; };
+struct SIMDFloat {
+	SIMDRegister v;
+	SIMDFloat() = default;
+	SIMDFloat(SIMDRegister v) : v(v) {}
+	SIMDFloat(float f) : v(SIMD_OP(set1_ps)(f)) {}
+	static SIMDFloat load(const float* ptr) { return SIMD_OP(loadu_ps)(ptr); }
+	void store(float* ptr) const { SIMD_OP(storeu_ps)(ptr, v); }
+};
+static inline SIMDFloat operator+(SIMDFloat a, SIMDFloat b) { return SIMD_OP(add_ps)(a.v, b.v); }
+static inline SIMDFloat operator-(SIMDFloat a, SIMDFloat b) { return SIMD_OP(sub_ps)(a.v, b.v); }
+static inline SIMDFloat operator*(SIMDFloat a, SIMDFloat b) { return SIMD_OP(mul_ps)(a.v, b.v); }
+static inline SIMDFloat operator/(SIMDFloat a, SIMDFloat b) { return SIMD_OP(div_ps)(a.v, b.v); }
+static inline SIMDFloat operator-(SIMDFloat a) { return SIMD_OP(xor_ps)(a.v, SIMD_OP(set1_ps)(-0.0f)); }
+static inline SIMDMask operator<(SIMDFloat a, SIMDFloat b) { return { SIMD_CMP(a.v, b.v, _CMP_LT_OQ, cmplt) }; }
+static inline SIMDMask operator<=(SIMDFloat a, SIMDFloat b) { return { SIMD_CMP(a.v, b.v, _CMP_LE_OQ, cmple) }; }
+static inline SIMDMask operator>(SIMDFloat a, SIMDFloat b) { return { SIMD_CMP(a.v, b.v, _CMP_GT_OQ, cmpgt) }; }
+static inline SIMDMask operator>=(SIMDFloat a, SIMDFloat b) { return { SIMD_CMP(a.v, b.v, _CMP_GE_OQ, cmpge) }; }
+static inline SIMDMask operator!=(SIMDFloat a, SIMDFloat b) { return { SIMD_CMP(a.v, b.v, _CMP_NEQ_UQ, cmpneq) }; }
+static inline SIMDMask operator&(SIMDMask a, SIMDMask b) { return { SIMD_OP(and_ps)(a.v, b.v) }; }
+static inline SIMDMask operator|(SIMDMask a, SIMDMask b) { return { SIMD_OP(or_ps)(a.v, b.v) }; }
+static inline SIMDMask operator!(SIMDMask a) { return { SIMD_OP(xor_ps)(a.v, SIMD_ALL_ONES()) }; }
+static inline SIMDFloat select(SIMDMask mask, SIMDFloat a, SIMDFloat b) {
+	return SIMD_OP(or_ps)(SIMD_OP(and_ps)(mask.v, a.v), SIMD_OP(andnot_ps)(mask.v, b.v));
+}
+static inline SIMDFloat vmax(SIMDFloat a, SIMDFloat b) { return SIMD_OP(max_ps)(a.v, b.v); }
+static inline SIMDFloat vmin(SIMDFloat a, SIMDFloat b) { return SIMD_OP(min_ps)(a.v, b.v); }
+static inline SIMDFloat vsqrt(SIMDFloat a) { return SIMD_OP(sqrt_ps)(a.v); }
+static inline SIMDFloat vabs(SIMDFloat a) { return SIMD_OP(andnot_ps)(SIMD_OP(set1_ps)(-0.0f), a.v); }
+#endif
+
+template<typename F>
+struct Vec3T {
+	F x, y, z;
+};
+template<typename F> static inline Vec3T<F> operator+(const Vec3T<F>& a, const Vec3T<F>& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+template<typename F> static inline Vec3T<F> operator*(const Vec3T<F>& a, F s) { return { a.x * s, a.y * s, a.z * s }; }
+template<typename F> static inline F dot(const Vec3T<F>& a, const Vec3T<F>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+template<typename F> static inline Vec3T<F> normalize(const Vec3T<F>& a) { return a * (F(1.0f) / vsqrt(dot(a, a))); }
+template<typename F, typename M> static inline Vec3T<F> select(M mask, const Vec3T<F>& a, const Vec3T<F>& b) {
+	return { select(mask, a.x, b.x), select(mask, a.y, b.y), select(mask, a.z, b.z) };
+}
+
+template<typename F>
+struct BSDFEvalT {
+	Vec3T<F> bsdf;
+	F pdf;
+};
+//-----------------------------------------------------BSDFģ--------------------------------------------------------
+template<typename F> static inline F pow5(F x) { F x2 = x * x; return x2 * x2 * x; }
+//nvshadershvd_ggx_evalͬ
+template<typename F> static inline F ggxEval(float invRoughness, const Vec3T<F>& h) {
+	F x = h.x * F(invRoughness);
+	F y = h.y * F(invRoughness);
+	F f = x * x + y * y + h.z * h.z;
+	return F(BSDF_1_PI * invRoughness * invRoughness) * h.z / (f * f);
+}
+//nvshaderssmith_shadow_or_mask
+template<typename F> static inline F smithG1(const Vec3T<F>& k, float roughness) {
+	F kz2 = k.z * k.z;
+	F inv_a2 = (k.x * k.x + k.y * k.y) * F(roughness * roughness) / kz2;
+	return select(kz2 != F(0.0f), F(2.0f) / (F(1.0f) + vsqrt(F(1.0f) + inv_a2)), F(0.0f));
+}
+template<typename F> static inline Vec3T<F> schlickFresnel(const glm::vec3& albedo, F cosine) {
+	F w = pow5(F(1.0f) - cosine);
+	return { F(albedo.x) + F(1.0f - albedo.x) * w, F(albedo.y) + F(1.0f - albedo.y) * w, F(albedo.z) + F(1.0f - albedo.z) * w };
+}
+template<typename F> static inline F luminance(const Vec3T<F>& c) {
+	return F(0.299f) * c.x + F(0.587f) * c.y + F(0.114f) * c.z;
+}
+
+template<typename F>
+static BSDFEvalT<F> evaluateDiffuse(const shaderio::BSDFMaterial& material, const Vec3T<F>& incidence, const Vec3T<F>&) {
+	F cosineIN = incidence.z;
+	auto valid = cosineIN > F(0.0f);
+	Vec3T<F> bsdf = { F(BSDF_1_PI * material.albedo.x), F(BSDF_1_PI * material.albedo.y), F(BSDF_1_PI * material.albedo.z) };
+	Vec3T<F> zero = { F(0.0f), F(0.0f), F(0.0f) };
+	return { select(valid, bsdf, zero), F(BSDF_1_PI) * vmax(cosineIN, F(1e-10f)) };
+}
+template<typename F>
+static BSDFEvalT<F> evaluateConductor(const shaderio::BSDFMaterial& material, const Vec3T<F>& incidence, const Vec3T<F>& outgoing) {
+	F cosineIN = incidence.z;
+	F cosineON = outgoing.z;
+	Vec3T<F> reflection = { -incidence.x, -incidence.y, cosineIN };
+	auto valid = (cosineIN > F(0.0f)) & (cosineON > F(0.0f)) & (dot(outgoing, reflection) >= F(1.0f - 1e-4f));
+
+	Vec3T<F> fresnel = schlickFresnel(material.albedo, cosineIN);
+	Vec3T<F> zero = { F(0.0f), F(0.0f), F(0.0f) };
+	return { select(valid, fresnel * (F(1.0f) / cosineON), zero), select(valid, F(1.0f), F(0.0f)) };
+}
+template<typename F>
+static BSDFEvalT<F> evaluateDielectric(const shaderio::BSDFMaterial& material, float eta, const Vec3T<F>& incidence, const Vec3T<F>& outgoing) {
+	//incidenceڷ߱ʱת
+	F normalSign = select(incidence.z < F(0.0f), F(-1.0f), F(1.0f));
+	F cosineIN = vabs(incidence.z);
+	F cosineON = outgoing.z * normalSign;
+	auto isRefraction = cosineIN * cosineON < F(0.0f);
+	F cosineONAbs = vabs(cosineON) + F(1e-10f);
+
+	F SnellFactor = F(eta * eta) * (F(1.0f) - cosineIN * cosineIN);
+	auto totalReflection = SnellFactor >= F(1.0f);
+
+	Vec3T<F> fresnel = schlickFresnel(material.albedo, cosineIN);
+	F fresnelOneChannel = luminance(fresnel);
+
+	F refractionZ = -incidence.z * F(eta) + normalSign * (F(eta) * cosineIN - vsqrt(vmax(F(1.0f) - SnellFactor, F(0.0f))));
+	Vec3T<F> refraction = normalize(Vec3T<F>{ -incidence.x * F(eta), -incidence.y * F(eta), refractionZ });
+	Vec3T<F> reflection = { -incidence.x, -incidence.y, F(2.0f) * cosineIN * normalSign - incidence.z };
+	auto refractionValid = isRefraction & !totalReflection & (dot(outgoing, refraction) >= F(1.0f - 1e-4f));
+	auto reflectionValid = (!isRefraction) & (dot(outgoing, reflection) >= F(1.0f - 1e-4f));
+
+	F refractionScale = F(1.0f / (eta * eta)) / cosineONAbs;
+	Vec3T<F> refractionBSDF = { (F(1.0f) - fresnel.x) * refractionScale, (F(1.0f) - fresnel.y) * refractionScale, (F(1.0f) - fresnel.z) * refractionScale };
+	Vec3T<F> one = { F(1.0f), F(1.0f), F(1.0f) };
+	Vec3T<F> reflectionBSDF = select(totalReflection, one, fresnel) * (F(1.0f) / cosineONAbs);
+	Vec3T<F> zero = { F(0.0f), F(0.0f), F(0.0f) };
+
+	BSDFEvalT<F> result;
+	result.bsdf = select(refractionValid, refractionBSDF, select(reflectionValid, reflectionBSDF, zero));
+	result.pdf = select(refractionValid, F(1.0f) - fresnelOneChannel,
+		select(reflectionValid, select(totalReflection, F(1.0f), fresnelOneChannel), F(0.0f)));
+	return result;
+}
+template<typename F>
+static BSDFEvalT<F> evaluateRoughConductor(const shaderio::BSDFMaterial& material, const Vec3T<F>& incidence, const Vec3T<F>& outgoing) {
+	float roughness = material.roughness;
+	F cosineIN = incidence.z;
+	F cosineON = outgoing.z;
+	Vec3T<F> h = normalize(incidence + outgoing);
+	auto valid = (cosineIN > F(0.0f)) & (cosineON > F(0.0f)) & (h.z != F(0.0f));
+
+	F cosineOH = dot(h, outgoing);
+	F D_costhetaNH = ggxEval(1.0f / roughness, h);
+	F D = D_costhetaNH / h.z;
+	Vec3T<F> fresnel = schlickFresnel(material.albedo, cosineOH);
+	F G1_outgoing = smithG1(outgoing, roughness);
+	F G2 = G1_outgoing * smithG1(incidence, roughness);
+
+	Vec3T<F> zero = { F(0.0f), F(0.0f), F(0.0f) };
+	BSDFEvalT<F> result;
+	result.bsdf = select(valid & (G2 > F(0.0f)), fresnel * (D * G2 / (F(4.0f) * cosineIN * cosineON + F(1e-10f))), zero);
+	result.pdf = select(valid, G1_outgoing * D / (F(4.0f) * cosineON + F(1e-10f)), F(0.0f));
+	return result;
+}
+/*
+slangͬoutgoingڷ߱ʱת߿ռ䣬cosineINcosineONڷתĿռм
+etaΪoutgoingһincidenceһ֮ȣİƽincidence + eta * outgoingoutgoingһ
+pdfΪɼ߷ֲG1(o) * D * cosOH / cosONhincidenceſɱ
+*/
+template<typename F>
+static BSDFEvalT<F> evaluateRoughDielectric(const shaderio::BSDFMaterial& material, float eta, const Vec3T<F>& incidence, const Vec3T<F>& outgoing) {
+	float roughness = material.roughness;
+	F normalSign = select(outgoing.z < F(0.0f), F(-1.0f), F(1.0f));
+	Vec3T<F> incidence_tangentSpace = { incidence.x, incidence.y, incidence.z * normalSign };
+	Vec3T<F> outgoing_tangentSpace = { outgoing.x, outgoing.y, outgoing.z * normalSign };
+	F cosineIN = incidence_tangentSpace.z;
+	F cosineON = outgoing_tangentSpace.z;
+
+	auto isRefraction = cosineIN < F(0.0f);
+	Vec3T<F> h = normalize(select(isRefraction, incidence_tangentSpace + outgoing_tangentSpace * F(eta), incidence_tangentSpace + outgoing_tangentSpace));
+	h = select(h.z < F(0.0f), h * F(-1.0f), h);
+	F cosineIH = dot(incidence_tangentSpace, h);
+	F cosineOH = dot(outgoing_tangentSpace, h);
+	auto sideValid = (isRefraction & (cosineIH < F(0.0f))) | ((!isRefraction) & (cosineIH > F(0.0f)));
+	auto valid = (cosineIN != F(0.0f)) & (cosineON != F(0.0f)) & (h.z > F(0.0f)) & (cosineOH > F(0.0f)) & sideValid;
+
+	F SnellFactor = F(eta * eta) * (F(1.0f) - cosineOH * cosineOH);
+	auto totalReflection = SnellFactor >= F(1.0f);
+	valid = valid & !(isRefraction & totalReflection);
+
+	F D = ggxEval(1.0f / roughness, h) / h.z;
+	Vec3T<F> fresnel = schlickFresnel(material.albedo, cosineOH);
+	F fresnelOneChannel = luminance(fresnel);
+	F G1_outgoing = smithG1(outgoing_tangentSpace, roughness);
+	F G2 = G1_outgoing * smithG1(incidence_tangentSpace, roughness);
+
+	F weight = cosineIH * F(1.0f / eta) + cosineOH;
+	F refractionScale = D * G2 * vabs(cosineIH) * cosineOH / (weight * weight * vabs(cosineIN) * cosineON + F(1e-10f));
+	Vec3T<F> refractionBSDF = { (F(1.0f) - fresnel.x) * refractionScale, (F(1.0f) - fresnel.y) * refractionScale, (F(1.0f) - fresnel.z) * refractionScale };
+	Vec3T<F> one = { F(1.0f), F(1.0f), F(1.0f) };
+	Vec3T<F> reflectionBSDF = select(totalReflection, one, fresnel) * (D * G2 / (F(4.0f) * cosineIN * cosineON + F(1e-10f)));
+	Vec3T<F> zero = { F(0.0f), F(0.0f), F(0.0f) };
+
+	BSDFEvalT<F> result;
+	result.bsdf = select(valid & (G2 > F(0.0f)), select(isRefraction, refractionBSDF, reflectionBSDF), zero);
+
+	F refractionPdf = (F(1.0f) - fresnelOneChannel) * G1_outgoing * D * cosineOH * vabs(cosineIH) / (cosineON * F(eta * eta) * weight * weight + F(1e-10f));
+	F reflectionPdf = select(totalReflection, F(1.0f), fresnelOneChannel) * G1_outgoing * D / (F(4.0f) * cosineON + F(1e-10f));
+	result.pdf = select(valid, select(isRefraction, refractionPdf, reflectionPdf), F(0.0f));
+	return result;
+}
+template<typename F>
+static BSDFEvalT<F> evaluate(const shaderio::BSDFMaterial& material, bool isExt, const Vec3T<F>& incidence, const Vec3T<F>& outgoing) {
+	float eta = isExt ? material.eta.x : 1.0f / material.eta.x;
+	switch (material.type) {
+	case shaderio::Diffuse: return evaluateDiffuse(material, incidence, outgoing);
+	case shaderio::Conductor: return evaluateConductor(material, incidence, outgoing);
+	case shaderio::Dielectric: return evaluateDielectric(material, eta, incidence, outgoing);
+	case shaderio::RoughConductor: return evaluateRoughConductor(material, incidence, outgoing);
+	case shaderio::RoughDielectric: return evaluateRoughDielectric(material, eta, incidence, outgoing);
+	}
+	return { { F(0.0f), F(0.0f), F(0.0f) }, F(1.0f) };
+}
+//-----------------------------------------------------ӿ--------------------------------------------------------
+void CPUBSDFBatch::resize(size_t count) {
+	for (std::vector<float>* v : { &incidenceX, &incidenceY, &incidenceZ, &outgoingX, &outgoingY, &outgoingZ }) v->resize(count);
+}
+void CPUBSDFBatch::set(size_t index, const glm::vec3& incidence, const glm::vec3& outgoing) {
+	incidenceX[index] = incidence.x; incidenceY[index] = incidence.y; incidenceZ[index] = incidence.z;
+	outgoingX[index] = outgoing.x; outgoingY[index] = outgoing.y; outgoingZ[index] = outgoing.z;
+}
+void CPUBSDFBatchResult::resize(size_t count) {
+	for (std::vector<float>* v : { &bsdfR, &bsdfG, &bsdfB, &pdf }) v->resize(count);
+}
+
+glm::vec3 CPUBSDF::getBSDF(const shaderio::BSDFMaterial& material, const glm::vec3& incidence, const glm::vec3& outgoing, bool isExt) {
+	BSDFEvalT<float> result = evaluate<float>(material, isExt, { incidence.x, incidence.y, incidence.z }, { outgoing.x, outgoing.y, outgoing.z });
+	return glm::vec3(result.bsdf.x, result.bsdf.y, result.bsdf.z);
+}
+float CPUBSDF::getPdf(const shaderio::BSDFMaterial& material, const glm::vec3& incidence, const glm::vec3& outgoing, bool isExt) {
+	return evaluate<float>(material, isExt, { incidence.x, incidence.y, incidence.z }, { outgoing.x, outgoing.y, outgoing.z }).pdf;
+}
+void CPUBSDF::evaluateBatch(const shaderio::BSDFMaterial& material, bool isExt, const CPUBSDFBatch& batch, CPUBSDFBatchResult& result) {
+	const size_t count = batch.size();
+	result.resize(count);
+	size_t index = 0;
+#if CPU_BSDF_SIMD_WIDTH > 1
+	for (; index + CPU_BSDF_SIMD_WIDTH <= count; index += CPU_BSDF_SIMD_WIDTH) {
+		Vec3T<SIMDFloat> incidence = { SIMDFloat::load(&batch.incidenceX[index]), SIMDFloat::load(&batch.incidenceY[index]), SIMDFloat::load(&batch.incidenceZ[index]) };
+		Vec3T<SIMDFloat> outgoing = { SIMDFloat::load(&batch.outgoingX[index]), SIMDFloat::load(&batch.outgoingY[index]), SIMDFloat::load(&batch.outgoingZ[index]) };
+		BSDFEvalT<SIMDFloat> eval = evaluate<SIMDFloat>(material, isExt, incidence, outgoing);
+		eval.bsdf.x.store(&result.bsdfR[index]);
+		eval.bsdf.y.store(&result.bsdfG[index]);
+		eval.bsdf.z.store(&result.bsdfB[index]);
+		eval.pdf.store(&result.pdf[index]);
+	}
+#endif
+	for (; index < count; ++index) {
+		BSDFEvalT<float> eval = evaluate<float>(material, isExt,
+			{ batch.incidenceX[index], batch.incidenceY[index], batch.incidenceZ[index] },
+			{ batch.outgoingX[index], batch.outgoingY[index], batch.outgoingZ[index] });
+		result.bsdfR[index] = eval.bsdf.x;
+		result.bsdfG[index] = eval.bsdf.y;
+		result.bsdfB[index] = eval.bsdf.z;
+		result.pdf[index] = eval.pdf;
+	}
+}
+//-------------------------------------------------------------------------------------------------------------
+//nvshadershvd_ggx_sample_vndf
+static glm::vec3 ggxSampleVNDF(const glm::vec3& k, float roughness, float xi1, float xi2) {
+	const glm::vec3 v = glm::normalize(glm::vec3(k.x * roughness, k.y * roughness, k.z));
+	const glm::vec3 t1 = (v.z < 0.99999f) ? glm::normalize(glm::cross(v, glm::vec3(0.0f, 0.0f, 1.0f))) : glm::vec3(1.0f, 0.0f, 0.0f);
+	const glm::vec3 t2 = glm::cross(t1, v);
+
+	const float a = 1.0f / (1.0f + v.z);
+	const float r = std::sqrt(xi1);
+	const float phi = (xi2 < a) ? xi2 / a * BSDF_PI : BSDF_PI + (xi2 - a) / (1.0f - a) * BSDF_PI;
+	const float p1 = r * std::cos(phi);
+	const float p2 = r * std::sin(phi) * ((xi2 < a) ? 1.0f : v.z);
+
+	glm::vec3 h = p1 * t1 + p2 * t2 + std::sqrt(std::max(0.0f, 1.0f - p1 * p1 - p2 * p2)) * v;
+	h.x *= roughness;
+	h.y *= roughness;
+	h.z = std::max(h.z, 0.0f);
+	return glm::normalize(h);
+}
+static glm::vec3 reflect(const glm::vec3& direction, const glm::vec3& normal) {
+	return direction - 2.0f * glm::dot(normal, direction) * normal;
+}
+static float getMaterialEta(const shaderio::BSDFMaterial& material, bool isExt) {
+	return isExt ? material.eta.x : 1.0f / material.eta.x;
+}
+
+CPUBSDFSample CPUBSDF::sample(const shaderio::BSDFMaterial& material, const glm::vec3& outgoing, bool isExt, const glm::vec3& randomNumbers) {
+	CPUBSDFSample result;
+	result.isExt = isExt;
+	const glm::vec3 normal(0.0f, 0.0f, 1.0f);
+	const glm::vec3 albedo = material.albedo;
+	auto fresnel = [&](float cosine) { return albedo + (1.0f - albedo) * pow5(1.0f - cosine); };
+	auto fresnelOneChannel = [](const glm::vec3& F) { return 0.299f * F.x + 0.587f * F.y + 0.114f * F.z; };
+
+	if (material.type == shaderio::Diffuse) {
+		if (outgoing.z <= 0.0f) return result;
+		float cosTheta = std::sqrt(randomNumbers.x);
+		float sinTheta = std::sqrt(1.0f - randomNumbers.x);
+		float phi = 2.0f * BSDF_PI * randomNumbers.y;
+		result.incidence = glm::normalize(glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta));
+		result.pdf = BSDF_1_PI * result.incidence.z;
+		result.bsdf = albedo * BSDF_1_PI;
+	}
+	else if (material.type == shaderio::Conductor) {
+		float cosineON = outgoing.z;
+		if (cosineON <= 0.0f) return result;
+		result.incidence = reflect(-outgoing, normal);
+		result.bsdf = fresnel(cosineON) / cosineON;
+		result.pdf = 1.0f;
+	}
+	else if (material.type == shaderio::Dielectric) {
+		float cosineON = outgoing.z;
+		if (cosineON == 0.0f) return result;
+		glm::vec3 F = fresnel(cosineON);
+		float F_oneChannel = fresnelOneChannel(F);
+		float eta = getMaterialEta(material, isExt);
+
+		float SnellFactor = eta * eta * (1.0f - cosineON * cosineON);
+		bool totalInternalReflection = 1.0f <= SnellFactor;
+		glm::vec3 reflection = reflect(-outgoing, normal);
+		if (totalInternalReflection) {
+			result.incidence = reflection;
+			result.pdf = 1.0f;
+			result.bsdf = glm::vec3(1.0f) / cosineON;
+		}
+		else if (randomNumbers.x < F_oneChannel) {
+			result.incidence = reflection;
+			result.pdf = F_oneChannel;
+			result.bsdf = F / cosineON;
+		}
+		else {
+			glm::vec3 refraction = glm::normalize(-outgoing * eta + normal * (eta * cosineON - std::sqrt(1.0f - SnellFactor)));
+			result.incidence = refraction;
+			result.pdf = 1.0f - F_oneChannel;
+			result.bsdf = (1.0f - F) * (eta * eta) / std::abs(refraction.z);
+			result.isExt = !isExt;
+		}
+	}
+	else if (material.type == shaderio::RoughConductor) {
+		float roughness = material.roughness;
+		glm::vec3 h = ggxSampleVNDF(outgoing, roughness, randomNumbers.x, randomNumbers.y);
+		if (h.z == 0.0f) return result;
+		float cosineOH = glm::dot(outgoing, h);
+		if (cosineOH <= 0.0f) return result;
+		glm::vec3 incidence = reflect(-outgoing, h);
+		if (incidence.z <= 0.0f) return result;
+
+		float D = ggxEval<float>(1.0f / roughness, { h.x, h.y, h.z }) / h.z;
+		float G1_outgoing = smithG1<float>({ outgoing.x, outgoing.y, outgoing.z }, roughness);
+		float G2 = G1_outgoing * smithG1<float>({ incidence.x, incidence.y, incidence.z }, roughness);
+		if (G2 <= 0.0f) return result;
+
+		result.incidence = incidence;
+		result.pdf = G1_outgoing * D / (4.0f * outgoing.z);
+		result.bsdf = (D * G2 * fresnel(cosineOH)) / (4.0f * outgoing.z * incidence.z);
+	}
+	else if (material.type == shaderio::RoughDielectric) {
+		float roughness = material.roughness;
+		float eta = getMaterialEta(material, isExt);
+		glm::vec3 h = ggxSampleVNDF(outgoing, roughness, randomNumbers.x, randomNumbers.y);
+		if (h.z == 0.0f || outgoing.z == 0.0f) return result;
+		float cosineOH = glm::dot(outgoing, h);
+		if (cosineOH <= 0.0f) return result;
+
+		glm::vec3 F = fresnel(cosineOH);
+		float F_oneChannel = fresnelOneChannel(F);
+
+		glm::vec3 incidence;
+		bool refraction = false;
+		float SnellFactor = eta * eta * (1.0f - cosineOH * cosineOH);
+		bool totalReflection = SnellFactor >= 1.0f;
+		if (totalReflection || randomNumbers.z < F_oneChannel) incidence = reflect(-outgoing, h);
+		else {
+			incidence = glm::normalize(-outgoing * eta + h * (eta * cosineOH - std::sqrt(1.0f - SnellFactor)));
+			refraction = true;
+		}
+		if (refraction ? incidence.z >= 0.0f : incidence.z <= 0.0f) return result;
+
+		float D = ggxEval<float>(1.0f / roughness, { h.x, h.y, h.z }) / h.z;
+		float G1_outgoing = smithG1<float>({ outgoing.x, outgoing.y, outgoing.z }, roughness);
+		float G2 = G1_outgoing * smithG1<float>({ incidence.x, incidence.y, incidence.z }, roughness);
+		if (G2 <= 0.0f) return result;
+
+		result.incidence = incidence;
+		if (refraction) {
+			float cosineIH = glm::dot(incidence, h);
+			float weight = cosineIH / eta + cosineOH;
+			result.pdf = (1.0f - F_oneChannel) * G1_outgoing * D * cosineOH * std::abs(cosineIH) / (outgoing.z * eta * eta * weight * weight + 1e-10f);
+			result.bsdf = D * G2 * (1.0f - F) * std::abs(cosineIH) * cosineOH
+				/ (std::abs(weight * weight * outgoing.z * incidence.z) + 1e-10f);
+			result.isExt = !isExt;
+		}
+		else {
+			result.pdf = (totalReflection ? 1.0f : F_oneChannel) * G1_outgoing * D / (4.0f * outgoing.z + 1e-10f);
+			result.bsdf = D * G2 * (totalReflection ? glm::vec3(1.0f) : F) / (std::abs(4.0f * outgoing.z * incidence.z) + 1e-10f);
+		}
+	}
+	else return result;
+
+	result.valid = true;
+	return result;
+}
+//-----------------------------------------------------֤--------------------------------------------------------
+struct ValidationMaterial {
+	std::string name;
+	shaderio::BSDFMaterial material;
+};
+static std::vector<ValidationMaterial> getValidationMaterials() {
+	auto makeMaterial = [](shaderio::MaterialType type, float roughness) {
+		shaderio::BSDFMaterial material{};
+		material.type = type;
+		material.albedo = glm::vec3(1.0f);
+		material.eta = glm::vec3(1.0f / 1.5f);		//ext_ior(air) / int_ior(glass)
+		material.roughness = roughness;
+		material.materialMapIndex = { -1, -1, -1 };
+		if (type == shaderio::Dielectric || type == shaderio::RoughDielectric)		//DielectricMaterialһ£albedoΪF0
+			material.albedo = glm::vec3((material.eta - 1.0f) * (material.eta - 1.0f) / ((material.eta + 1.0f) * (material.eta + 1.0f)));
+		return material;
+	};
+	return {
+		{ "Diffuse", makeMaterial(shaderio::Diffuse, 1.0f) },
+		{ "Conductor", makeMaterial(shaderio::Conductor, 0.0f) },
+		{ "Dielectric", makeMaterial(shaderio::Dielectric, 0.0f) },
+		{ "RoughConductor(0.2)", makeMaterial(shaderio::RoughConductor, 0.2f) },
+		{ "RoughConductor(0.5)", makeMaterial(shaderio::RoughConductor, 0.5f) },
+		{ "RoughDielectric(0.2)", makeMaterial(shaderio::RoughDielectric, 0.2f) },
+		{ "RoughDielectric(0.5)", makeMaterial(shaderio::RoughDielectric, 0.5f) },
+	};
+}
+static glm::vec3 getOutgoing(float cosTheta) {
+	return glm::vec3(std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta)), 0.0f, cosTheta);
+}
+static glm::vec3 sphericalDirection(float z, float phi) {
+	float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+	return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+}
+//Wilson-HilfertyƵĿֲβ
+static double chiSquarePValue(double chiSquare, int degreesOfFreedom) {
+	if (degreesOfFreedom <= 0) return 1.0;
+	double k = degreesOfFreedom;
+	double z = (std::cbrt(chiSquare / k) - (1.0 - 2.0 / (9.0 * k))) / std::sqrt(2.0 / (9.0 * k));
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+bool CPUBSDF::validate(uint32_t sampleCount) {
+	if (sampleCount == 0) return true;
+	const float cosThetas[] = { 0.9f, 0.5f, 0.2f };
+	constexpr int THETA_BIN_COUNT = 10, PHI_BIN_COUNT = 20, THETA_SUBDIVISION = 256, PHI_SUBDIVISION = 16;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> uniform(0.0f, std::nextafter(1.0f, 0.0f));
+	bool allPassed = true;
+	auto report = [&](bool passed, const std::string& message) {
+		allPassed &= passed;
+		if (passed) LOGI("CPUBSDF validate: %s, pass\n", message.c_str());
+		else LOGW("CPUBSDF validate: %s, FAIL\n", message.c_str());
+	};
+
+	for (const ValidationMaterial& validationMaterial : getValidationMaterials()) {
+		const shaderio::BSDFMaterial& material = validationMaterial.material;
+		const char* name = validationMaterial.name.c_str();
+		const bool delta = isDelta(material.type);
+		const float eta = material.eta.x;
+
+		for (float cosTheta : cosThetas) {
+			glm::vec3 outgoing = getOutgoing(cosTheta);
+			char prefix[128];
+			snprintf(prefix, sizeof(prefix), "%s cosThetaO %.1f", name, cosTheta);
+
+			//¯뿨ͬһ
+			std::vector<double> histogram(THETA_BIN_COUNT * PHI_BIN_COUNT, 0.0);
+			double albedo = 0.0;
+			uint32_t validCount = 0;
+			for (uint32_t i = 0; i < sampleCount; ++i) {
+				CPUBSDFSample sample = CPUBSDF::sample(material, outgoing, true, glm::vec3(uniform(rng), uniform(rng), uniform(rng)));
+				if (!sample.valid || sample.pdf <= 0.0f) continue;
+				++validCount;
+				double weight = sample.bsdf.x * std::abs(sample.incidence.z) / sample.pdf;
+				if (!sample.isExt) weight /= double(eta) * eta;		//ȥ͸ʱradianceeta^2
+				if (std::isfinite(weight)) albedo += weight;
+
+				int thetaBin = std::clamp(int((sample.incidence.z * 0.5f + 0.5f) * THETA_BIN_COUNT), 0, THETA_BIN_COUNT - 1);
+				float phi = std::atan2(sample.incidence.y, sample.incidence.x);
+				if (phi < 0.0f) phi += 2.0f * BSDF_PI;
+				int phiBin = std::clamp(int(phi / (2.0f * BSDF_PI) * PHI_BIN_COUNT), 0, PHI_BIN_COUNT - 1);
+				histogram[thetaBin * PHI_BIN_COUNT + phiBin] += 1.0;
+			}
+			albedo /= sampleCount;
+			bool energyExact = material.type == shaderio::Diffuse || material.type == shaderio::Conductor || material.type == shaderio::Dielectric;
+			char message[256];
+			snprintf(message, sizeof(message), "%s white furnace albedo %.4f", prefix, albedo);
+			report(energyExact ? std::abs(albedo - 1.0) < 0.02 : albedo < 1.02, message);
+			if (delta) continue;
+
+			//pdfϻ֣ķϸֺеֲ֣͸z = -eta * cosThetaOмϣthetaϸָ
+			std::vector<double> expected(THETA_BIN_COUNT * PHI_BIN_COUNT, 0.0);
+			const double cellArea = (2.0 / (THETA_BIN_COUNT * THETA_SUBDIVISION)) * (2.0 * BSDF_PI / (PHI_BIN_COUNT * PHI_SUBDIVISION));
+			double pdfIntegral = 0.0;
+			for (int thetaCell = 0; thetaCell < THETA_BIN_COUNT * THETA_SUBDIVISION; ++thetaCell) {
+				float z = -1.0f + (thetaCell + 0.5f) * 2.0f / (THETA_BIN_COUNT * THETA_SUBDIVISION);
+				for (int phiCell = 0; phiCell < PHI_BIN_COUNT * PHI_SUBDIVISION; ++phiCell) {
+					float phi = (phiCell + 0.5f) * 2.0f * BSDF_PI / (PHI_BIN_COUNT * PHI_SUBDIVISION);
+					double pdf = getPdf(material, sphericalDirection(z, phi), outgoing, true) * cellArea;
+					if (!std::isfinite(pdf)) continue;
+					pdfIntegral += pdf;
+					expected[(thetaCell / THETA_SUBDIVISION) * PHI_BIN_COUNT + phiCell / PHI_SUBDIVISION] += pdf * sampleCount;
+				}
+			}
+			double validFraction = double(validCount) / sampleCount;
+			snprintf(message, sizeof(message), "%s pdf integral %.4f, valid sample fraction %.4f", prefix, pdfIntegral, validFraction);
+			report(std::abs(pdfIntegral - validFraction) < 0.02, message);
+
+			//С5ķϲ
+			double chiSquare = 0.0, pooledObserved = 0.0, pooledExpected = 0.0;
+			int degreesOfFreedom = -1;
+			for (size_t bin = 0; bin < expected.size(); ++bin) {
+				if (expected[bin] < 5.0) {
+					pooledObserved += histogram[bin];
+					pooledExpected += expected[bin];
+					continue;
+				}
+				double difference = histogram[bin] - expected[bin];
+				chiSquare += difference * difference / expected[bin];
+				++degreesOfFreedom;
+			}
+			if (pooledExpected >= 5.0) {
+				double difference = pooledObserved - pooledExpected;
+				chiSquare += difference * difference / pooledExpected;
+				++degreesOfFreedom;
+			}
+			else if (pooledObserved > 5.0 * std::max(pooledExpected, 1.0)) chiSquare += pooledObserved;		//pdfΪ0
+			double pValue = chiSquarePValue(chiSquare, degreesOfFreedom);
+			snprintf(message, sizeof(message), "%s chi-square %.1f, dof %d, p %.4f", prefix, chiSquare, degreesOfFreedom, pValue);
+			report(pValue > 0.01, message);
+		}
+		if (delta) continue;
+
+		//ԣֻڷķ
+		double maxReciprocityError = 0.0;
+		for (uint32_t i = 0; i < std::min(sampleCount, 65536u); ++i) {
+			glm::vec3 incidence = sphericalDirection(uniform(rng), 2.0f * BSDF_PI * uniform(rng));
+			glm::vec3 outgoing = sphericalDirection(uniform(rng), 2.0f * BSDF_PI * uniform(rng));
+			if (incidence.z < 0.05f || outgoing.z < 0.05f) continue;
+			glm::vec3 forward = getBSDF(material, incidence, outgoing, true);
+			glm::vec3 backward = getBSDF(material, outgoing, incidence, true);
+			double error = std::abs(forward.x - backward.x) / std::max(1e-4, double(std::max(forward.x, backward.x)));
+			maxReciprocityError = std::max(maxReciprocityError, error);
+		}
+		char message[256];
+		snprintf(message, sizeof(message), "%s reciprocity max relative error %.2e", name, maxReciprocityError);
+		report(maxReciprocityError < 1e-3, message);
+	}
+
+	//SIMDһԺ
+	CPUBSDFBatch batch;
+	batch.resize(sampleCount);
+	for (uint32_t i = 0; i < sampleCount; ++i) {
+		glm::vec3 incidence = sphericalDirection(2.0f * uniform(rng) - 1.0f, 2.0f * BSDF_PI * uniform(rng));
+		glm::vec3 outgoing = sphericalDirection(uniform(rng), 2.0f * BSDF_PI * uniform(rng));
+		batch.set(i, incidence, outgoing);
+	}
+	auto timeCPU = [](auto&& run) {
+		auto start = std::chrono::high_resolution_clock::now();
+		run();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	for (const ValidationMaterial& validationMaterial : getValidationMaterials()) {
+		const shaderio::BSDFMaterial& material = validationMaterial.material;
+		CPUBSDFBatchResult scalarResult, simdResult;
+		scalarResult.resize(sampleCount);
+		double scalarTime = timeCPU([&]() {
+			for (uint32_t i = 0; i < sampleCount; ++i) {
+				glm::vec3 incidence(batch.incidenceX[i], batch.incidenceY[i], batch.incidenceZ[i]);
+				glm::vec3 outgoing(batch.outgoingX[i], batch.outgoingY[i], batch.outgoingZ[i]);
+				glm::vec3 bsdf = getBSDF(material, incidence, outgoing, true);
+				scalarResult.bsdfR[i] = bsdf.x;
+				scalarResult.pdf[i] = getPdf(material, incidence, outgoing, true);
+			}
+		});
+		double simdTime = timeCPU([&]() { evaluateBatch(material, true, batch, simdResult); });
+
+		double maxError = 0.0;
+		for (uint32_t i = 0; i < sampleCount; ++i) {
+			for (auto [a, b] : { std::pair{ scalarResult.bsdfR[i], simdResult.bsdfR[i] }, std::pair{ scalarResult.pdf[i], simdResult.pdf[i] } }) {
+				if (!std::isfinite(a) && !std::isfinite(b)) continue;
+				maxError = std::max(maxError, std::abs(double(a) - b) / std::max(1.0, std::abs(double(a))));
+			}
+		}
+		char message[256];
+		snprintf(message, sizeof(message), "%s SIMD%d max error %.2e, scalar %.1f M/s, SIMD %.1f M/s", validationMaterial.name.c_str(), CPU_BSDF_SIMD_WIDTH,
+			maxError, sampleCount / std::max(scalarTime, 1e-6) * 1e-3, sampleCount / std::max(simdTime, 1e-6) * 1e-3);
+		report(maxError < 1e-4, message);
+	}
+	return allPassed;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/Shader/shaderStructType.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef FZBRENDERER_CPU_BSDF_H
+#define FZBRENDERER_CPU_BSDF_H
+
+//SIMDȣAVXΪ8SSE2Ϊ4ƽ̨˻Ϊ
+#if defined(__AVX__)
+#define CPU_BSDF_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPU_BSDF_SIMD_WIDTH 4
+#else
+#define CPU_BSDF_SIMD_WIDTH 1
+#endif
+
+namespace FzbRenderer {
+/*
+pathTracingCommon.slangBSDFCPU汾ʽжӦgetBSDF_*getPdf_*PopulateCallablePayload_*
+1. з߿ռУΪ+zslangmul(TBN, dir)Ľoutgoingincidence
+2. sampleӦBSDF_SAMPLEslangbsdf = 0pdf = 1ֹ·validΪfalse
+3. evaluateBatchSoAһʹͬһbsdfpdfӦwavefrontʷͰĶУÿδCPU_BSDF_SIMD_WIDTH
+*/
+struct CPUBSDFSample {
+	glm::vec3 incidence = glm::vec3(0.0f);
+	glm::vec3 bsdf = glm::vec3(0.0f);
+	float pdf = 1.0f;
+	bool isExt = true;
+	bool valid = false;
+};
+
+struct CPUBSDFBatch {
+	std::vector<float> incidenceX, incidenceY, incidenceZ;
+	std::vector<float> outgoingX, outgoingY, outgoingZ;
+
+	void resize(size_t count);
+	size_t size() const { return incidenceX.size(); }
+	void set(size_t index, const glm::vec3& incidence, const glm::vec3& outgoing);
+};
+struct CPUBSDFBatchResult {
+	std::vector<float> bsdfR, bsdfG, bsdfB;
+	std::vector<float> pdf;
+
+	void resize(size_t count);
+};
+
+class CPUBSDF {
+public:
+	static glm::vec3 getBSDF(const shaderio::BSDFMaterial& material, const glm::vec3& incidence, const glm::vec3& outgoing, bool isExt);
+	static float getPdf(const shaderio::BSDFMaterial& material, const glm::vec3& incidence, const glm::vec3& outgoing, bool isExt);
+	//randomNumbersζӦslangBSDF_SAMPLEĵrand
+	static CPUBSDFSample sample(const shaderio::BSDFMaterial& material, const glm::vec3& outgoing, bool isExt, const glm::vec3& randomNumbers);
+
+	static void evaluateBatch(const shaderio::BSDFMaterial& material, bool isExt, const CPUBSDFBatch& batch, CPUBSDFBatchResult& result);
+
+	static bool isDelta(shaderio::MaterialType type) { return type == shaderio::Conductor || type == shaderio::Dielectric; }
+
+	/*
+	ֵ֤־ȫͨʱtrue
+	1. ¯albedoΪ1ʱƷʣܴ1͸ʱȥeta^2radianceţ
+	2. pdf֣getPdfϵĻӦsampleɹı
+	3. sampleķֲgetPdfһ
+	4. ԣʱf(i, o) = f(o, i)
+	5. SIMDһ£ͳÿ
+	*/
+	static bool validate(uint32_t sampleCount);
+};
+}
+
+#endif
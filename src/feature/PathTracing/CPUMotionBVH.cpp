@@ -0,0 +1,410 @@
+#include "./CPUMotionBVH.h"
+#include <common/Application/Application.h>
+#include <nvutils/logger.hpp>
+#include <nvutils/parallel_work.hpp>
+#include <nvutils/timers.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+using namespace FzbRenderer;
+
+static constexpr uint32_t BVH_BIN_COUNT = 12;
+static constexpr uint32_t BVH_STACK_SIZE = 64;
+
+//ջʹջϵ飬BVH_STACK_SIZEĲַŵϣ˻BVHҲᶪ
+class TraversalStack {
+public:
+	void push(uint32_t node) {
+		if (size < BVH_STACK_SIZE) inlineNodes[size] = node;
+		else overflowNodes.push_back(node);
+		++size;
+	}
+	uint32_t pop() {
+		if (--size < BVH_STACK_SIZE) return inlineNodes[size];
+		uint32_t node = overflowNodes.back();
+		overflowNodes.pop_back();
+		return node;
+	}
+	bool empty() const { return size == 0; }
+private:
+	std::array<uint32_t, BVH_STACK_SIZE> inlineNodes;
+	std::vector<uint32_t> overflowNodes;
+	uint32_t size = 0;
+};
+
+static shaderio::AABB emptyAABB() {
+	return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+}
+static void growAABB(shaderio::AABB& aabb, const shaderio::AABB& other) {
+	aabb.minimum = glm::min(aabb.minimum, other.minimum);
+	aabb.maximum = glm::max(aabb.maximum, other.maximum);
+}
+static float getSurfaceArea(const shaderio::AABB& aabb) {
+	glm::vec3 size = glm::max(aabb.maximum - aabb.minimum, glm::vec3(0.0f));
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+static shaderio::AABB transformAABB(const shaderio::AABB& aabb, const glm::mat4& matrix) {
+	glm::vec3 center = glm::vec3(matrix * glm::vec4((aabb.minimum + aabb.maximum) * 0.5f, 1.0f));
+	glm::vec3 extent = (aabb.maximum - aabb.minimum) * 0.5f;
+	glm::mat3 absMatrix = glm::mat3(matrix);
+	for (int i = 0; i < 3; ++i) absMatrix[i] = glm::abs(absMatrix[i]);
+	extent = absMatrix * extent;
+	return { center - extent, center + extent };
+}
+//slabԣؽ룬δཻʱΪFLT_MAX
+static float intersectAABB(const shaderio::AABB& aabb, const glm::vec3& origin, const glm::vec3& invDirection, float tMin, float tMax) {
+	glm::vec3 t0 = (aabb.minimum - origin) * invDirection;
+	glm::vec3 t1 = (aabb.maximum - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+	return enter <= exit ? enter : FLT_MAX;
+}
+static glm::vec3 getInvDirection(const glm::vec3& direction) {
+	auto inv = [](float d) { return std::abs(d) > 1e-12f ? 1.0f / d : (d >= 0.0f ? 1e12f : -1e12f); };
+	return { inv(direction.x), inv(direction.y), inv(direction.z) };
+}
+//Moller-Trumbore˫棬GPUTRIANGLE_CULL_DISABLEһ
+static bool intersectTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+	float tMin, float tMax, float& t, glm::vec2& barycentrics) {
+	glm::vec3 edge1 = p1 - p0;
+	glm::vec3 edge2 = p2 - p0;
+	glm::vec3 p = glm::cross(direction, edge2);
+	float det = glm::dot(edge1, p);
+	if (std::abs(det) < 1e-12f) return false;
+	float invDet = 1.0f / det;
+	glm::vec3 s = origin - p0;
+	float u = glm::dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f) return false;
+	glm::vec3 q = glm::cross(s, edge1);
+	float v = glm::dot(direction, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f) return false;
+	t = glm::dot(edge2, q) * invDet;
+	if (t <= tMin || t >= tMax) return false;
+	barycentrics = { u, v };
+	return true;
+}
+//-------------------------------------------------------------------------------------------------------------
+void CPUMotionBVH::buildBVH(const std::vector<shaderio::AABB>& primitiveBounds, uint32_t maxLeafSize,
+	std::vector<CPUBVHNode>& nodes, std::vector<uint32_t>& primitiveOrder) {
+	uint32_t primitiveCount = uint32_t(primitiveBounds.size());
+	primitiveOrder.resize(primitiveCount);
+	for (uint32_t i = 0; i < primitiveCount; ++i) primitiveOrder[i] = i;
+	nodes.clear();
+	if (primitiveCount == 0) return;
+	nodes.reserve(2 * primitiveCount);
+
+	std::vector<glm::vec3> centroids(primitiveCount);
+	for (uint32_t i = 0; i < primitiveCount; ++i) centroids[i] = (primitiveBounds[i].minimum + primitiveBounds[i].maximum) * 0.5f;
+
+	struct BuildTask { uint32_t nodeIndex; uint32_t first; uint32_t count; };
+	std::vector<BuildTask> tasks;
+	nodes.push_back({});
+	tasks.push_back({ 0, 0, primitiveCount });
+	while (!tasks.empty()) {
+		BuildTask task = tasks.back();
+		tasks.pop_back();
+
+		shaderio::AABB bounds = emptyAABB();
+		shaderio::AABB centroidBounds = emptyAABB();
+		for (uint32_t i = task.first; i < task.first + task.count; ++i) {
+			growAABB(bounds, primitiveBounds[primitiveOrder[i]]);
+			growAABB(centroidBounds, { centroids[primitiveOrder[i]], centroids[primitiveOrder[i]] });
+		}
+		nodes[task.nodeIndex].bounds = bounds;
+		nodes[task.nodeIndex].leftOrFirst = task.first;
+		nodes[task.nodeIndex].count = task.count;
+		if (task.count <= maxLeafSize) continue;
+
+		//ÿͰSAHСĻ
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		glm::vec3 centroidExtent = centroidBounds.maximum - centroidBounds.minimum;
+		for (int axis = 0; axis < 3; ++axis) {
+			if (centroidExtent[axis] <= 0.0f) continue;
+			std::array<shaderio::AABB, BVH_BIN_COUNT> binBounds;
+			std::array<uint32_t, BVH_BIN_COUNT> binCounts{};
+			binBounds.fill(emptyAABB());
+			float scale = BVH_BIN_COUNT / centroidExtent[axis];
+			for (uint32_t i = task.first; i < task.first + task.count; ++i) {
+				uint32_t bin = std::min(uint32_t((centroids[primitiveOrder[i]][axis] - centroidBounds.minimum[axis]) * scale), BVH_BIN_COUNT - 1);
+				++binCounts[bin];
+				growAABB(binBounds[bin], primitiveBounds[primitiveOrder[i]]);
+			}
+			std::array<float, BVH_BIN_COUNT - 1> leftCosts;
+			shaderio::AABB leftBounds = emptyAABB();
+			uint32_t leftCount = 0;
+			for (uint32_t bin = 0; bin < BVH_BIN_COUNT - 1; ++bin) {
+				growAABB(leftBounds, binBounds[bin]);
+				leftCount += binCounts[bin];
+				leftCosts[bin] = leftCount * getSurfaceArea(leftBounds);
+			}
+			shaderio::AABB rightBounds = emptyAABB();
+			uint32_t rightCount = 0;
+			for (uint32_t bin = BVH_BIN_COUNT - 1; bin > 0; --bin) {
+				growAABB(rightBounds, binBounds[bin]);
+				rightCount += binCounts[bin];
+				if (rightCount == 0 || rightCount == task.count) continue;
+				float cost = leftCosts[bin - 1] + rightCount * getSurfaceArea(rightBounds);
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = bin;
+				}
+			}
+		}
+
+		uint32_t* begin = primitiveOrder.data() + task.first;
+		uint32_t* end = begin + task.count;
+		uint32_t* middle = nullptr;
+		if (bestAxis >= 0) {
+			//ֲȲָͼԪʱΪҶ
+			float leafCost = task.count * getSurfaceArea(bounds);
+			if (bestCost >= leafCost && task.count <= 4 * maxLeafSize) continue;
+			float scale = BVH_BIN_COUNT / centroidExtent[bestAxis];
+			float splitMin = centroidBounds.minimum[bestAxis];
+			middle = std::partition(begin, end, [&](uint32_t primitive) {
+				return std::min(uint32_t((centroids[primitive][bestAxis] - splitMin) * scale), BVH_BIN_COUNT - 1) < bestSplit;
+				});
+		}
+		else {		//غʱ԰
+			middle = begin + task.count / 2;
+		}
+		uint32_t leftCount = uint32_t(middle - begin);
+
+		uint32_t leftIndex = uint32_t(nodes.size());
+		nodes.push_back({});
+		nodes.push_back({});
+		nodes[task.nodeIndex].leftOrFirst = leftIndex;
+		nodes[task.nodeIndex].count = 0;
+		tasks.push_back({ leftIndex, task.first, leftCount });
+		tasks.push_back({ leftIndex + 1, task.first + leftCount, task.count - leftCount });
+	}
+}
+void CPUMotionBVH::buildMeshBVH(uint32_t meshIndex) {
+	Scene& sceneResource = Application::sceneResource;
+	const shaderio::Mesh& mesh = sceneResource.meshes[meshIndex];
+	const std::vector<uint8_t>& meshByteData = sceneResource.meshSets[sceneResource.getMeshSetIndex(meshIndex)].meshByteData;
+	const shaderio::TriangleMesh& triMesh = mesh.triMesh;
+
+	//gltfĶǽģbyteStrideȡ
+	const uint8_t* positionData = meshByteData.data() + triMesh.positions.offset;
+	uint32_t positionStride = triMesh.positions.byteStride ? triMesh.positions.byteStride : uint32_t(sizeof(glm::vec3));
+	auto getPosition = [&](uint32_t vertexIndex) -> glm::vec3 {
+		glm::vec3 position;
+		memcpy(&position, positionData + size_t(positionStride) * vertexIndex, sizeof(glm::vec3));
+		return position;
+		};
+	const uint8_t* indexData = meshByteData.data() + triMesh.indices.offset;
+	auto getIndex = [&](uint32_t i) -> uint32_t {
+		if (triMesh.indices.byteStride == sizeof(uint16_t)) return reinterpret_cast<const uint16_t*>(indexData)[i];
+		return reinterpret_cast<const uint32_t*>(indexData)[i];
+		};
+
+	uint32_t triangleCount = triMesh.indices.count / 3;
+	std::vector<shaderio::AABB> triangleBounds(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; ++i) {
+		glm::vec3 p0 = getPosition(getIndex(3 * i));
+		glm::vec3 p1 = getPosition(getIndex(3 * i + 1));
+		glm::vec3 p2 = getPosition(getIndex(3 * i + 2));
+		triangleBounds[i] = { glm::min(p0, glm::min(p1, p2)), glm::max(p0, glm::max(p1, p2)) };
+	}
+
+	CPUMeshBVH& meshBVH = meshBVHs[meshIndex];
+	buildBVH(triangleBounds, 4, meshBVH.nodes, meshBVH.primitiveIndices);
+	meshBVH.triangleVertices.resize(3 * size_t(triangleCount));
+	for (uint32_t i = 0; i < triangleCount; ++i) {
+		uint32_t primitive = meshBVH.primitiveIndices[i];
+		for (uint32_t k = 0; k < 3; ++k) meshBVH.triangleVertices[3 * i + k] = getPosition(getIndex(3 * primitive + k));
+	}
+}
+void CPUMotionBVH::build() {
+	SCOPED_TIMER(__FUNCTION__);
+	Scene& sceneResource = Application::sceneResource;
+
+	//ֻΪʵõmesh
+	meshBVHs.assign(sceneResource.meshes.size(), {});
+	std::vector<uint32_t> usedMeshes;
+	std::vector<bool> meshUsed(sceneResource.meshes.size(), false);
+	for (const shaderio::Instance& instance : sceneResource.instances) {
+		if (meshUsed[instance.meshIndex]) continue;
+		meshUsed[instance.meshIndex] = true;
+		usedMeshes.push_back(instance.meshIndex);
+	}
+	nvutils::parallel_batches_pooled<1>(usedMeshes.size(), [&](uint64_t i, uint32_t threadIndex) { buildMeshBVH(usedMeshes[i]); });
+
+	//ʵPeriodMotion˱任createTopLevelMotionAS_nvvkͬ
+	std::vector<CPUMotionInstance> instances(sceneResource.instances.size());
+	for (uint32_t i = 0; i < sceneResource.instances.size(); ++i) {
+		instances[i].instanceIndex = i;
+		instances[i].meshIndex = sceneResource.instances[i].meshIndex;
+		instances[i].transform0 = instances[i].transform1 = sceneResource.instances[i].transform;
+	}
+	uint32_t childInstanceIndex = 0;
+	for (uint32_t i = 0; i < sceneResource.periodInstanceCount; ++i) {
+		uint32_t instanceSetIndex = sceneResource.periodInstanceIndexToInstanceSetIndex[i];
+		if (i > 0 && instanceSetIndex != sceneResource.periodInstanceIndexToInstanceSetIndex[i - 1]) childInstanceIndex = 0;
+		InstanceSet& instanceSet = sceneResource.periodInstanceSets[instanceSetIndex];
+		const glm::mat4& childMatrix = instanceSet.childInstances[childInstanceIndex++].transform;
+
+		CPUMotionInstance& instance = instances[sceneResource.staticInstanceCount + i];
+		instance.transform0 = instanceSet.startMatrix * childMatrix;
+		instance.transform1 = instanceSet.endMatrix * childMatrix;
+		instance.moving = instance.transform0 != instance.transform1;
+	}
+
+	std::vector<shaderio::AABB> bounds0(instances.size());
+	std::vector<shaderio::AABB> bounds1(instances.size());
+	std::vector<shaderio::AABB> sweptBounds(instances.size());
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		CPUMotionInstance& instance = instances[i];
+		instance.invTransform = glm::inverse(instance.transform0);
+		const std::vector<CPUBVHNode>& meshNodes = meshBVHs[instance.meshIndex].nodes;
+		shaderio::AABB meshBounds = meshNodes.empty() ? shaderio::AABB{ glm::vec3(0.0f), glm::vec3(0.0f) } : meshNodes[0].bounds;
+		bounds0[i] = transformAABB(meshBounds, instance.transform0);
+		bounds1[i] = transformAABB(meshBounds, instance.transform1);
+		sweptBounds[i] = bounds0[i];
+		growAABB(sweptBounds[i], bounds1[i]);
+	}
+
+	std::vector<CPUBVHNode> sweptNodes;
+	std::vector<uint32_t> instanceOrder;
+	buildBVH(sweptBounds, 2, sweptNodes, instanceOrder);
+	motionInstances.resize(instances.size());
+	for (uint32_t i = 0; i < instanceOrder.size(); ++i) motionInstances[i] = instances[instanceOrder[i]];
+
+	//˵İΧзֱԵϺϲӵܴڸڵ㣬Ե򼴿
+	nodes.resize(sweptNodes.size());
+	for (int nodeIndex = int(sweptNodes.size()) - 1; nodeIndex >= 0; --nodeIndex) {
+		const CPUBVHNode& sweptNode = sweptNodes[nodeIndex];
+		CPUMotionBVHNode& node = nodes[nodeIndex];
+		node.leftOrFirst = sweptNode.leftOrFirst;
+		node.count = sweptNode.count;
+		node.bounds0 = emptyAABB();
+		node.bounds1 = emptyAABB();
+		if (sweptNode.count > 0) {
+			for (uint32_t i = sweptNode.leftOrFirst; i < sweptNode.leftOrFirst + sweptNode.count; ++i) {
+				growAABB(node.bounds0, bounds0[instanceOrder[i]]);
+				growAABB(node.bounds1, bounds1[instanceOrder[i]]);
+			}
+		}
+		else {
+			for (uint32_t child = sweptNode.leftOrFirst; child < sweptNode.leftOrFirst + 2; ++child) {
+				growAABB(node.bounds0, nodes[child].bounds0);
+				growAABB(node.bounds1, nodes[child].bounds1);
+			}
+		}
+	}
+
+	size_t triangleCount = 0, nodeCount = 0;
+	for (const CPUMeshBVH& meshBVH : meshBVHs) {
+		triangleCount += meshBVH.primitiveIndices.size();
+		nodeCount += meshBVH.nodes.size();
+	}
+	LOGI("CPU motion BVH: %zu meshes, %zu triangles, %zu mesh nodes, %zu instances (%u period motion), %zu top-level nodes\n",
+		usedMeshes.size(), triangleCount, nodeCount, motionInstances.size(), sceneResource.periodInstanceCount, nodes.size());
+}
+void CPUMotionBVH::clean() {
+	meshBVHs.clear();
+	motionInstances.clear();
+	nodes.clear();
+}
+//-------------------------------------------------------------------------------------------------------------
+glm::mat4 CPUMotionBVH::getTransform(const CPUMotionInstance& instance, float time) const {
+	if (!instance.moving) return instance.transform0;
+	return (1.0f - time) * instance.transform0 + time * instance.transform1;
+}
+bool CPUMotionBVH::intersectMesh(const CPUMeshBVH& meshBVH, const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax,
+	bool anyHit, uint32_t& primitive, glm::vec2& barycentrics) const {
+	if (meshBVH.nodes.empty()) return false;
+	glm::vec3 invDirection = getInvDirection(direction);
+	bool hit = false;
+
+	TraversalStack stack;
+	if (intersectAABB(meshBVH.nodes[0].bounds, origin, invDirection, tMin, tMax) == FLT_MAX) return false;
+	stack.push(0);
+	while (!stack.empty()) {
+		const CPUBVHNode& node = meshBVH.nodes[stack.pop()];
+		if (node.count > 0) {
+			for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+				float t;
+				glm::vec2 uv;
+				if (!intersectTriangle(origin, direction, meshBVH.triangleVertices[3 * i], meshBVH.triangleVertices[3 * i + 1],
+					meshBVH.triangleVertices[3 * i + 2], tMin, tMax, t, uv)) continue;
+				tMax = t;
+				primitive = i;
+				barycentrics = uv;
+				hit = true;
+				if (anyHit) return true;
+			}
+			continue;
+		}
+		//ĺӺջȱ
+		float tLeft = intersectAABB(meshBVH.nodes[node.leftOrFirst].bounds, origin, invDirection, tMin, tMax);
+		float tRight = intersectAABB(meshBVH.nodes[node.leftOrFirst + 1].bounds, origin, invDirection, tMin, tMax);
+		uint32_t nearChild = tLeft <= tRight ? node.leftOrFirst : node.leftOrFirst + 1;
+		uint32_t farChild = tLeft <= tRight ? node.leftOrFirst + 1 : node.leftOrFirst;
+		if (std::max(tLeft, tRight) != FLT_MAX) stack.push(farChild);
+		if (std::min(tLeft, tRight) != FLT_MAX) stack.push(nearChild);
+	}
+	return hit;
+}
+bool CPUMotionBVH::traverse(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time, bool anyHit, CPUHit& hit) const {
+	if (nodes.empty()) return false;
+	glm::vec3 invDirection = getInvDirection(direction);
+	auto getBounds = [time](const CPUMotionBVHNode& node) -> shaderio::AABB {
+		return { glm::mix(node.bounds0.minimum, node.bounds1.minimum, time), glm::mix(node.bounds0.maximum, node.bounds1.maximum, time) };
+		};
+	bool found = false;
+
+	TraversalStack stack;
+	if (intersectAABB(getBounds(nodes[0]), origin, invDirection, tMin, tMax) == FLT_MAX) return false;
+	stack.push(0);
+	while (!stack.empty()) {
+		const CPUMotionBVHNode& node = nodes[stack.pop()];
+		if (node.count > 0) {
+			for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+				const CPUMotionInstance& instance = motionInstances[i];
+				glm::mat4 transform = getTransform(instance, time);
+				glm::mat4 invTransform = instance.moving ? glm::inverse(transform) : instance.invTransform;
+				//ռķ򲻹һռͬ
+				glm::vec3 objectOrigin = glm::vec3(invTransform * glm::vec4(origin, 1.0f));
+				glm::vec3 objectDirection = glm::vec3(invTransform * glm::vec4(direction, 0.0f));
+
+				const CPUMeshBVH& meshBVH = meshBVHs[instance.meshIndex];
+				uint32_t primitive;
+				glm::vec2 barycentrics;
+				if (!intersectMesh(meshBVH, objectOrigin, objectDirection, tMin, tMax, anyHit, primitive, barycentrics)) continue;
+				found = true;
+				if (anyHit) return true;
+
+				const glm::vec3* p = meshBVH.triangleVertices.data() + 3 * primitive;
+				glm::vec3 objectNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+				hit.distance = tMax;
+				hit.instanceIndex = instance.instanceIndex;
+				hit.primitiveIndex = meshBVH.primitiveIndices[primitive];
+				hit.barycentrics = barycentrics;
+				hit.normal = glm::normalize(glm::transpose(glm::mat3(invTransform)) * objectNormal);
+			}
+			continue;
+		}
+		float tLeft = intersectAABB(getBounds(nodes[node.leftOrFirst]), origin, invDirection, tMin, tMax);
+		float tRight = intersectAABB(getBounds(nodes[node.leftOrFirst + 1]), origin, invDirection, tMin, tMax);
+		uint32_t nearChild = tLeft <= tRight ? node.leftOrFirst : node.leftOrFirst + 1;
+		uint32_t farChild = tLeft <= tRight ? node.leftOrFirst + 1 : node.leftOrFirst;
+		if (std::max(tLeft, tRight) != FLT_MAX) stack.push(farChild);
+		if (std::min(tLeft, tRight) != FLT_MAX) stack.push(nearChild);
+	}
+	return found;
+}
+bool CPUMotionBVH::intersect(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time, CPUHit& hit) const {
+	return traverse(origin, direction, tMin, tMax, time, false, hit);
+}
+bool CPUMotionBVH::occluded(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time) const {
+	CPUHit hit;
+	return traverse(origin, direction, tMin, tMax, time, true, hit);
+}
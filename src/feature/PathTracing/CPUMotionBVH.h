@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/Shader/shaderStructType.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef FZBRENDERER_CPU_MOTION_BVH_H
+#define FZBRENDERER_CPU_MOTION_BVH_H
+
+namespace FzbRenderer {
+struct CPUBVHNode {
+	shaderio::AABB bounds;
+	uint32_t leftOrFirst = 0;	//ڲڵΪҺӽ󣩣ҶΪһͼԪprimitiveOrderеλ
+	uint32_t count = 0;			//0ΪҶ
+};
+//ÿmeshһռ䣬ΰҶ˳չ
+struct CPUMeshBVH {
+	std::vector<CPUBVHNode> nodes;
+	std::vector<glm::vec3> triangleVertices;	//triangleVertices[3 * i + k]ΪҶ˳iεĵk
+	std::vector<uint32_t> primitiveIndices;		//Ҷ˳imeshеӦGPUPrimitiveIndex
+};
+//Ľڵ㱣ſرʱİΧУʱtİΧΪߵԲֵ
+struct CPUMotionBVHNode {
+	shaderio::AABB bounds0;
+	shaderio::AABB bounds1;
+	uint32_t leftOrFirst = 0;
+	uint32_t count = 0;
+};
+struct CPUMotionInstance {
+	glm::mat4 transform0;		//ſʱı任
+	glm::mat4 transform1;		//Źرʱı任
+	glm::mat4 invTransform;		//ֹʵԤ
+	uint32_t instanceIndex;		//instancesе
+	uint32_t meshIndex;
+	bool moving = false;
+};
+struct CPUHit {
+	float distance = FLT_MAX;
+	uint32_t instanceIndex = 0;
+	uint32_t primitiveIndex = 0;
+	glm::vec2 barycentrics = glm::vec2(0.0f);	//(u, v)GPUͬ
+	glm::vec3 normal = glm::vec3(0.0f);			//ռļηߣδ߷ת
+};
+/*
+createTopLevelMotionAS_nvvkCPU汾VK_NV_ray_tracing_motion_blur
+1. ײ㣺ÿmeshڶռ÷ͰSAHһBVHBLASһʵ
+2. 㣺̬ʵPeriodMotionʵPeriodMotionı任ڿڰԲֵNV˶ʵInstanceSet::getInstanceͬ
+   Ϊ˱任ԲֵʵʱtİΧа˰ΧеĲֵڵΧͬSAH(˰ΧеĲ)
+3. RandomMotionʵȡǰı任Ϊֹʵ
+4. ÿߴһʱtime[0, 1]ʱtimeֵڵΧУ˶ʵʱtimeֵõռĹ
+*/
+class CPUMotionBVH {
+public:
+	void build();
+	void clean();
+
+	bool intersect(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time, CPUHit& hit) const;
+	bool occluded(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time) const;
+
+	glm::mat4 getTransform(const CPUMotionInstance& instance, float time) const;
+
+	/*
+	ͰSAHprimitiveBoundsΪÿͼԪİΧУҶӵͼԪΪprimitiveOrder[first, first + count)
+	ڲڵڣnodes[0]Ϊ
+	*/
+	static void buildBVH(const std::vector<shaderio::AABB>& primitiveBounds, uint32_t maxLeafSize,
+		std::vector<CPUBVHNode>& nodes, std::vector<uint32_t>& primitiveOrder);
+
+	std::vector<CPUMeshBVH> meshBVHs;
+	std::vector<CPUMotionInstance> motionInstances;		//Ҷ˳
+	std::vector<CPUMotionBVHNode> nodes;
+private:
+	void buildMeshBVH(uint32_t meshIndex);
+	bool intersectMesh(const CPUMeshBVH& meshBVH, const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax,
+		bool anyHit, uint32_t& primitive, glm::vec2& barycentrics) const;
+	bool traverse(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float time, bool anyHit, CPUHit& hit) const;
+};
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include "./CPUPathTracer.h"
+#include "./CPUBSDF.h"
+#include <common/Application/Application.h>
+#include <nvutils/logger.hpp>
+#include <nvutils/parallel_work.hpp>
+#include <nvutils/timers.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stb/stb_image_write.h>
+
+using namespace FzbRenderer;
+
+static void getOrthonormalBasis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent) {
+	float sign = normal.z >= 0.0f ? 1.0f : -1.0f;
+	float a = -1.0f / (sign + normal.z);
+	float b = normal.x * normal.y * a;
+	tangent = glm::vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+	bitangent = glm::vec3(b, sign + normal.y * normal.y * a, -normal.y);
+}
+static bool isDielectric(shaderio::MaterialType type) {
+	return type == shaderio::Dielectric || type == shaderio::RoughDielectric;
+}
+
+void CPUPathTracer::render(const CPUPathTracerSetting& setting) {
+	glm::uvec2 resolution = setting.resolution;
+	std::vector<float> image = renderImage(setting);
+	if (image.empty()) return;
+
+	std::filesystem::create_directories(setting.outputPath.parent_path());
+	if (stbi_write_hdr(setting.outputPath.string().c_str(), int(resolution.x), int(resolution.y), 3, image.data()) == 0)
+		LOGW("CPU path tracer: failed to write %s\n", setting.outputPath.string().c_str());
+	else
+		LOGI("CPU path tracer: %ux%u, %u spp, max depth %u -> %s\n", resolution.x, resolution.y, setting.spp, setting.maxDepth, setting.outputPath.string().c_str());
+}
+std::vector<float> CPUPathTracer::renderImage(const CPUPathTracerSetting& setting) {
+	SCOPED_TIMER(__FUNCTION__);
+	Scene& sceneResource = Application::sceneResource;
+	const shaderio::SamplerTables& samplerTables = Application::ldSampler.tables;
+	const shaderio::SamplerType samplerType = shaderio::SamplerType_Hash;	//άSobol
+
+	glm::uvec2 resolution = setting.resolution;
+	if (resolution.x == 0 || resolution.y == 0 || setting.maxDepth == 0) {
+		LOGW("CPU path tracer: invalid resolution or max depth\n");
+		return {};
+	}
+	CPUMotionBVH bvh;
+	bvh.build();
+
+	glm::mat4 viewInverse = glm::inverse(sceneResource.cameraManip->getViewMatrix());
+	glm::mat4 projMatrix = glm::perspectiveRH_ZO(sceneResource.cameraManip->getRadFov(), float(resolution.x) / float(resolution.y), 0.1f, 1000.0f);
+	projMatrix[1][1] *= -1;
+	glm::mat4 projInverse = glm::inverse(projMatrix);
+
+	bool hasAreaLight = false;
+	for (LightInstance& lightInstance : sceneResource.lightInstances)
+		hasAreaLight |= lightInstance.light.type == shaderio::Area;
+
+	auto getNEE = [&](const glm::vec3& hitPos, const glm::vec3& hitNormal, const glm::mat3& TBN, const shaderio::BSDFMaterial& material,
+		const glm::vec3& outgoingTangent, bool isExt, float time, glm::uvec2& state) -> glm::vec3 {
+			glm::vec3 radiance_nee = glm::vec3(0.0f);
+			for (LightInstance& lightInstance : sceneResource.lightInstances) {
+				shaderio::Light light = lightInstance.getLight(time);
+				glm::vec3 radiance = light.color * light.intensity;
+				glm::vec3 sampleDir;
+				float distance = FLT_MAX;
+				//initNEEͬԴȲԴ˥
+				if (light.type == shaderio::Area) {
+					float randomNumber1 = LowDiscrepancySampler::next(samplerTables, samplerType, state);
+					float randomNumber2 = LowDiscrepancySampler::next(samplerTables, samplerType, state);
+					glm::vec3 samplePos = light.pos + light.edge1 * randomNumber1 + light.edge2 * randomNumber2;
+					sampleDir = samplePos - hitPos;
+					distance = glm::length(sampleDir);
+					if (distance <= 0.0f || glm::dot(-sampleDir, light.direction) <= 0.0f) continue;
+					sampleDir /= distance;
+					radiance *= glm::dot(sampleDir, -light.direction) / std::max(distance * distance, 1e-6f);
+				}
+				else if (light.type == shaderio::Direction) sampleDir = -glm::normalize(light.direction);
+				else if (light.type == shaderio::Point) {
+					sampleDir = light.pos - hitPos;
+					distance = glm::length(sampleDir);
+					if (distance <= 0.0f) continue;
+					sampleDir /= distance;
+				}
+				else continue;
+				if (!isDielectric(material.type) && glm::dot(sampleDir, hitNormal) <= 0.0f) continue;
+
+				glm::vec3 incidenceTangent = glm::transpose(TBN) * sampleDir;
+				glm::vec3 bsdf = CPUBSDF::getBSDF(material, incidenceTangent, outgoingTangent, isExt);
+				if (bsdf == glm::vec3(0.0f)) continue;
+				float tMax = distance == FLT_MAX ? FLT_MAX : distance - 0.002f;
+				if (bvh.occluded(hitPos + 0.001f * sampleDir, sampleDir, 0.001f, tMax, time)) continue;
+				radiance_nee += radiance * bsdf * std::abs(incidenceTangent.z);
+			}
+			return radiance_nee;
+		};
+
+	std::vector<float> image(3 * size_t(resolution.x) * resolution.y, 0.0f);
+	nvutils::parallel_batches_pooled<1>(resolution.y, [&](uint64_t y, uint32_t threadIndex) {
+		for (uint32_t x = 0; x < resolution.x; ++x) {
+			glm::vec3 pixelRadiance = glm::vec3(0.0f);
+			for (uint32_t sampleIndex = 0; sampleIndex < setting.spp; ++sampleIndex) {
+				glm::uvec2 state = LowDiscrepancySampler::initState(samplerType, glm::uvec2(x, uint32_t(y)), sampleIndex);
+				auto rand = [&]() { return LowDiscrepancySampler::next(samplerTables, samplerType, state); };
+
+				float time = rand();
+				glm::vec2 pixelCenter = glm::vec2(float(x) + rand(), float(y) + rand());
+				glm::vec2 clip = pixelCenter / glm::vec2(resolution) * 2.0f - 1.0f;
+				glm::vec4 viewCoords = projInverse * glm::vec4(clip, 1.0f, 1.0f);
+				glm::vec3 rayOrigin = glm::vec3(viewInverse * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+				glm::vec3 rayDirection = glm::normalize(glm::vec3(viewInverse * glm::vec4(glm::normalize(glm::vec3(viewCoords)), 0.0f)));
+
+				glm::vec3 radiance = glm::vec3(0.0f);
+				glm::vec3 throughput = glm::vec3(1.0f);
+				bool isExt = true;
+				bool lastDelta = true;		//Ϊdelta
+				for (uint32_t depth = 0; depth < setting.maxDepth; ++depth) {
+					CPUHit hit;
+					if (!bvh.intersect(rayOrigin, rayDirection, 0.001f, FLT_MAX, time, hit)) {
+						radiance += throughput * sceneResource.sceneInfo.backgroundColor;
+						break;
+					}
+					const shaderio::Instance& instance = sceneResource.instances[hit.instanceIndex];
+					shaderio::BSDFMaterial material = sceneResource.materials[instance.materialIndex];
+
+					glm::vec3 hitPos = rayOrigin + hit.distance * rayDirection;
+					glm::vec3 hitNormal = hit.normal;
+					float cosineON = glm::dot(hitNormal, -rayDirection);
+					if (cosineON < 0.0f) hitNormal = -hitNormal;
+					if (!isDielectric(material.type) && cosineON <= 0.0f) material.emissive = glm::vec3(0.0f);
+					if (lastDelta || !hasAreaLight) radiance += throughput * material.emissive;
+
+					glm::vec3 tangent, bitangent;
+					getOrthonormalBasis(hitNormal, tangent, bitangent);
+					glm::mat3 TBN = glm::mat3(tangent, bitangent, hitNormal);
+					glm::vec3 outgoingTangent = glm::transpose(TBN) * -rayDirection;
+
+					bool isDeltaMaterial = CPUBSDF::isDelta(material.type);
+					if (!isDeltaMaterial) radiance += throughput * getNEE(hitPos, hitNormal, TBN, material, outgoingTangent, isExt, time, state);
+
+					glm::vec3 randomNumbers = glm::vec3(rand(), rand(), rand());
+					CPUBSDFSample bsdfSample = CPUBSDF::sample(material, outgoingTangent, isExt, randomNumbers);
+					if (!bsdfSample.valid || bsdfSample.pdf <= 0.0f) break;
+					throughput *= bsdfSample.bsdf * std::abs(bsdfSample.incidence.z) / bsdfSample.pdf;
+					isExt = bsdfSample.isExt;
+					lastDelta = isDeltaMaterial;
+
+					if (depth >= 2) {
+						float continueProbability = std::min(std::max(throughput.x, std::max(throughput.y, throughput.z)), 0.95f);
+						if (rand() >= continueProbability) break;
+						throughput /= continueProbability;
+					}
+					rayDirection = glm::normalize(TBN * bsdfSample.incidence);
+					rayOrigin = hitPos + 0.001f * rayDirection;
+				}
+				if (!glm::any(glm::isnan(radiance)) && !glm::any(glm::isinf(radiance))) pixelRadiance += radiance;
+			}
+			pixelRadiance /= float(setting.spp);
+			size_t pixelIndex = 3 * (size_t(y) * resolution.x + x);
+			image[pixelIndex + 0] = pixelRadiance.x;
+			image[pixelIndex + 1] = pixelRadiance.y;
+			image[pixelIndex + 2] = pixelRadiance.z;
+		}
+		});
+	return image;
+}
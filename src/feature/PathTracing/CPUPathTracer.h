@@ -0,0 +1,33 @@
+#pragma once
+
+#include "./CPUMotionBVH.h"
+#include <filesystem>
+
+#ifndef FZBRENDERER_CPU_PATH_TRACER_H
+#define FZBRENDERER_CPU_PATH_TRACER_H
+
+namespace FzbRenderer {
+struct CPUPathTracerSetting {
+	bool enable = false;
+	uint32_t spp = 16;
+	uint32_t maxDepth = 4;
+	glm::uvec2 resolution = glm::uvec2(0);		//ApplicationΪڷֱ
+	std::filesystem::path outputPath;			//hdrļ
+};
+/*
+ߵCPU·׷٣CPUMotionBVHȾڵ˶ģΪGPU˶ģߵĲοҲûVK_NV_ray_tracing_motion_blur豸ʹ
+1. ÿ[0, 1]ȡһʱ̣ߡNEEӰ䶼ʹһʱ̣ԴLightInstance::getLight(time)ֵ
+2. pathTracingCommon.slangNEEһ£ԴԴ뷽⣬۹ƺԣԷֻɼ
+   ԴԷֻdelta֮ۼӣNEE
+3. BSDFʹCPUBSDFȡδʱbackgroundColor
+4. вУΪradianceдhdr
+*/
+class CPUPathTracer {
+public:
+	static void render(const CPUPathTracerSetting& setting);
+	//ذеrgb radianceҲwavefront·׷ٵĲο
+	static std::vector<float> renderImage(const CPUPathTracerSetting& setting);
+};
+}
+
+#endif
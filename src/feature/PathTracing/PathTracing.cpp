@@ -51,6 +51,11 @@ void FzbRenderer::addPathTracingSlangMacro() {
 		});
 #endif
 }
+void FzbRenderer::addPathTracingSlangMacro(std::vector<std::pair<std::string, std::string>>& macros) {
+#ifdef PathTracingMotionBlur
+	macros.push_back({ "PathTracingMotionBlur", "" });
+#endif
+}
 void FzbRenderer::createShaderBindingTable(
 	const VkRayTracingPipelineCreateInfoKHR& rtPipelineInfo, VkPipeline& rtPipeline,
 	nvvk::SBTGenerator& sbtGenerator, nvvk::Buffer& sbtBuffer) {
@@ -43,6 +43,7 @@ public:
 };
 
 void addPathTracingSlangMacro();
+void addPathTracingSlangMacro(std::vector<std::pair<std::string, std::string>>& macros);
 void createShaderBindingTable(
 	const VkRayTracingPipelineCreateInfoKHR& rtPipelineInfo, VkPipeline& rtPipeline,
 	nvvk::SBTGenerator& sbtGenerator, nvvk::Buffer& sbtBuffer);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <common/Shader/shaderStructType.h>
+#include <common/Sampler/SamplerShaderio.h>
+#include <feature/ReSTIRDI/shaderio.h>
 
 #ifndef FZBRENDERER_PATHTRACING_FEATURE_SHADER_IO_H
 #define FZBRENDERER_PATHTRACING_FEATURE_SHADER_IO_H
@@ -22,7 +24,11 @@ struct PathTracingPushConstant
 	int maxDepth = 3;
 	int spp = 1;
 	float time = 0.0f;
+	uint samplerType = 0;                  // SamplerType
 	SceneInfo* sceneInfoAddress;           // Address of the scene information buffer
+	SamplerTables* samplerTablesAddress;
+	ReSTIRDISurface* restirSurfaces;       // primary hits handed to ReSTIR DI when useReSTIRDI is set
+	int useReSTIRDI = 0;
 };
 
 NAMESPACE_SHADERIO_END()
@@ -0,0 +1,815 @@
+#include "./ReSTIRDI.h"
+#include <common/Application/Application.h>
+#include <common/Shader/Shader.h>
+#include <feature/PathTracing/CPUBSDF.h>
+#include <feature/PathTracing/shaderio.h>
+#include <nvutils/timers.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvvk/compute_pipeline.hpp>
+#include <nvvk/debug_util.hpp>
+#include <nvgui/property_editor.hpp>
+#include <random>
+
+using namespace FzbRenderer;
+
+//-----------------------------------------------------Դ--------------------------------------------------------
+static float luminance(glm::vec3 color) {
+	return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+float ReSTIRDI::getLightPower(const shaderio::ReSTIRDILight& light) {
+	if (light.type != shaderio::ReSTIRDILight_Triangle) return 0.0f;
+	//ʲ棬ΪLe * area * pi
+	float area = 0.5f * glm::length(glm::cross(light.edge1, light.edge2));
+	return std::max(luminance(light.radiance), 0.0f) * area * glm::pi<float>();
+}
+void ReSTIRDI::buildLightAliasTable(const std::vector<shaderio::ReSTIRDILight>& lights, std::vector<shaderio::ReSTIRDIAliasEntry>& aliasTable) {
+	const uint32_t lightCount = uint32_t(lights.size());
+	aliasTable.assign(lightCount, shaderio::ReSTIRDIAliasEntry{ 1.0f, 0, 0.0f, 0 });
+	if (lightCount == 0) return;
+
+	std::vector<double> powers(lightCount, 0.0);
+	double trianglePower = 0.0;
+	for (uint32_t i = 0; i < lightCount; ++i) {
+		powers[i] = getLightPower(lights[i]);
+		trianglePower += powers[i];
+	}
+	for (uint32_t i = 0; i < lightCount; ++i) {
+		if (lights[i].type == shaderio::ReSTIRDILight_Direction && luminance(lights[i].radiance) > 0.0f)
+			powers[i] = trianglePower > 0.0 ? trianglePower : 1.0;
+	}
+	double totalPower = 0.0;
+	for (double power : powers) totalPower += power;
+	if (totalPower <= 0.0) {
+		std::fill(powers.begin(), powers.end(), 1.0);
+		totalPower = double(lightCount);
+	}
+
+	//VosealiasscaledС1ĹԴalias
+	std::vector<double> scaled(lightCount);
+	std::vector<uint32_t> small, large;
+	for (uint32_t i = 0; i < lightCount; ++i) {
+		aliasTable[i].probability = float(powers[i] / totalPower);
+		aliasTable[i].alias = i;
+		scaled[i] = powers[i] / totalPower * double(lightCount);
+		(scaled[i] < 1.0 ? small : large).push_back(i);
+	}
+	while (!small.empty() && !large.empty()) {
+		uint32_t smallIndex = small.back(); small.pop_back();
+		uint32_t largeIndex = large.back(); large.pop_back();
+		aliasTable[smallIndex].threshold = float(scaled[smallIndex]);
+		aliasTable[smallIndex].alias = largeIndex;
+		scaled[largeIndex] -= 1.0 - scaled[smallIndex];
+		(scaled[largeIndex] < 1.0 ? small : large).push_back(largeIndex);
+	}
+	//ʣֻ
+	for (uint32_t i : small) aliasTable[i].threshold = 1.0f;
+	for (uint32_t i : large) aliasTable[i].threshold = 1.0f;
+}
+void ReSTIRDI::collectLights() {
+	Scene& scene = Application::sceneResource;
+	lights.clear();
+	lightsDynamic = scene.hasDynamicLight;
+
+	for (int i = 0; i < scene.sceneInfo.numLights; ++i) {
+		const shaderio::Light& light = scene.sceneInfo.lights[i];
+		if (light.type != shaderio::Direction) continue;
+		shaderio::ReSTIRDILight directionLight{};
+		directionLight.type = shaderio::ReSTIRDILight_Direction;
+		directionLight.direction = glm::normalize(light.direction);
+		directionLight.radiance = light.color * light.intensity;
+		lights.push_back(directionLight);
+	}
+
+	for (uint32_t instanceIndex = 0; instanceIndex < scene.instances.size(); ++instanceIndex) {
+		const shaderio::Instance& instance = scene.instances[instanceIndex];
+		const glm::vec3 emissive = scene.materials[instance.materialIndex].emissive;
+		if (std::max(emissive.x, std::max(emissive.y, emissive.z)) <= 0.0f) continue;
+		if (instanceIndex >= scene.staticInstanceCount) lightsDynamic = true;
+
+		const shaderio::Mesh& mesh = scene.meshes[instance.meshIndex];
+		const std::vector<uint8_t>& meshByteData = scene.meshSets[scene.getMeshSetIndex(instance.meshIndex)].meshByteData;
+		const shaderio::BufferView& indices = mesh.triMesh.indices;
+		const glm::vec3* vertexData = reinterpret_cast<const glm::vec3*>(meshByteData.data() + mesh.triMesh.positions.offset);
+		auto getIndex = [&](uint32_t i) -> uint32_t {
+			const uint8_t* indexData = meshByteData.data() + indices.offset;
+			if (indices.byteStride == sizeof(uint16_t)) return reinterpret_cast<const uint16_t*>(indexData)[i];
+			return reinterpret_cast<const uint32_t*>(indexData)[i];
+		};
+		//任·ߵı任ߵĲ˷򣬽ַ߱һ
+		const bool mirrored = glm::determinant(glm::mat3(instance.transform)) < 0.0f;
+
+		for (uint32_t triangleIndex = 0; triangleIndex < indices.count / 3; ++triangleIndex) {
+			glm::vec3 v0 = instance.transform * glm::vec4(vertexData[getIndex(triangleIndex * 3 + 0)], 1.0f);
+			glm::vec3 v1 = instance.transform * glm::vec4(vertexData[getIndex(triangleIndex * 3 + 1)], 1.0f);
+			glm::vec3 v2 = instance.transform * glm::vec4(vertexData[getIndex(triangleIndex * 3 + 2)], 1.0f);
+
+			shaderio::ReSTIRDILight triangleLight{};
+			triangleLight.type = shaderio::ReSTIRDILight_Triangle;
+			triangleLight.position = v0;
+			triangleLight.edge1 = mirrored ? v2 - v0 : v1 - v0;
+			triangleLight.edge2 = mirrored ? v1 - v0 : v2 - v0;
+			triangleLight.radiance = emissive;
+			if (glm::length(glm::cross(triangleLight.edge1, triangleLight.edge2)) <= 0.0f) continue;
+			lights.push_back(triangleLight);
+		}
+	}
+
+	buildLightAliasTable(lights, lightAliasTable);
+}
+//vkCmdUpdateBufferÿ64KB
+void ReSTIRDI::uploadLights(VkCommandBuffer cmd) {
+	if (lights.empty()) return;
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	auto update = [&](const nvvk::Buffer& buffer, const void* data, VkDeviceSize size) {
+		constexpr VkDeviceSize MAX_UPDATE_SIZE = 65536;
+		for (VkDeviceSize offset = 0; offset < size; offset += MAX_UPDATE_SIZE)
+			vkCmdUpdateBuffer(cmd, buffer.buffer, offset, std::min(MAX_UPDATE_SIZE, size - offset), static_cast<const uint8_t*>(data) + offset);
+	};
+	update(lightBuffer, lights.data(), std::span(lights).size_bytes());
+	update(lightAliasTableBuffer, lightAliasTable.data(), std::span(lightAliasTable).size_bytes());
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+}
+
+//-----------------------------------------------------CPU汾--------------------------------------------------------
+//shaders/restirDI.slangͬRNGΪmt19937ɼԻΪεı
+struct ReSTIRDICPUScene {
+	glm::ivec2 size;
+	std::vector<shaderio::ReSTIRDILight> lights;
+	std::vector<shaderio::ReSTIRDIAliasEntry> aliasTable;
+	std::vector<shaderio::ReSTIRDISurface> surfaces;
+	std::vector<std::array<glm::vec3, 3>> occluders;		//(v0, edge1, edge2)
+};
+struct ReSTIRDICPULightSample {
+	glm::vec3 direction;
+	float distance;
+	glm::vec3 radiance;
+	float areaPdf;
+};
+
+static bool isSimilarCPU(const shaderio::ReSTIRDISurface& surface, const shaderio::ReSTIRDISurface& neighbour) {
+	if (neighbour.valid == 0u) return false;
+	if (std::abs(surface.depth - neighbour.depth) > RESTIRDI_DEPTH_THRESHOLD * surface.depth) return false;
+	return glm::dot(surface.normal, neighbour.normal) >= RESTIRDI_NORMAL_THRESHOLD;
+}
+static bool sampleLightCPU(const ReSTIRDICPUScene& scene, uint32_t lightIndex, glm::vec2 uv, glm::vec3 position, ReSTIRDICPULightSample& lightSample) {
+	const shaderio::ReSTIRDILight& light = scene.lights[lightIndex];
+	lightSample = { glm::vec3(0.0f, 0.0f, 1.0f), 0.0f, glm::vec3(0.0f), 1.0f };
+
+	if (light.type == shaderio::ReSTIRDILight_Direction) {
+		lightSample.direction = -light.direction;
+		lightSample.distance = INFINITY;
+		lightSample.radiance = light.radiance;
+		return true;
+	}
+
+	float su = std::sqrt(uv.x);
+	glm::vec3 lightPosition = light.position + light.edge1 * (su * (1.0f - uv.y)) + light.edge2 * (su * uv.y);
+	glm::vec3 normal = glm::cross(light.edge1, light.edge2);
+	float doubleArea = glm::length(normal);
+	lightSample.areaPdf = 2.0f / doubleArea;
+
+	glm::vec3 toLight = lightPosition - position;
+	float distanceSquared = glm::dot(toLight, toLight);
+	if (distanceSquared <= 1e-12f) return false;
+	lightSample.distance = std::sqrt(distanceSquared);
+	lightSample.direction = toLight / lightSample.distance;
+
+	float cosineLight = glm::dot(-lightSample.direction, normal) / doubleArea;
+	if (cosineLight <= 0.0f) return false;
+	lightSample.radiance = light.radiance * cosineLight / distanceSquared;
+	return true;
+}
+//slanggetBSDFTBN¼㣬ת߿ռCPUBSDFͬԵĲߵѡȡ޹
+static glm::vec3 getContributionCPU(const shaderio::ReSTIRDISurface& surface, const ReSTIRDICPULightSample& lightSample) {
+	float cosine = glm::dot(surface.normal, lightSample.direction);
+	if (cosine <= 0.0f) return glm::vec3(0.0f);
+
+	shaderio::BSDFMaterial material{};
+	material.type = shaderio::MaterialType(surface.materialType);
+	material.albedo = surface.albedo;
+	material.eta = glm::vec3(1.0f);
+	material.roughness = surface.roughness;
+	material.materialMapIndex = glm::ivec3(-1);
+
+	glm::vec3 normal = surface.normal;
+	glm::vec3 tangent = std::abs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+	tangent = glm::normalize(tangent - normal * glm::dot(normal, tangent));
+	glm::vec3 bitangent = glm::cross(normal, tangent);
+	auto toTangentSpace = [&](glm::vec3 direction) {
+		return glm::vec3(glm::dot(direction, tangent), glm::dot(direction, bitangent), glm::dot(direction, normal));
+	};
+	glm::vec3 bsdf = CPUBSDF::getBSDF(material, toTangentSpace(lightSample.direction), toTangentSpace(surface.outgoing), true);
+	return bsdf * cosine * lightSample.radiance;
+}
+static float getTargetPdfCPU(const ReSTIRDICPUScene& scene, const shaderio::ReSTIRDISurface& surface, uint32_t lightIndex, glm::vec2 uv) {
+	if (lightIndex == RESTIRDI_INVALID_LIGHT || surface.valid == 0u) return 0.0f;
+	ReSTIRDICPULightSample lightSample;
+	if (!sampleLightCPU(scene, lightIndex, uv, surface.position, lightSample)) return 0.0f;
+	return luminance(getContributionCPU(surface, lightSample));
+}
+//Moller-Trumbore˫
+static bool isVisibleCPU(const ReSTIRDICPUScene& scene, const shaderio::ReSTIRDISurface& surface, const ReSTIRDICPULightSample& lightSample) {
+	glm::vec3 origin = surface.position + surface.normal * 1e-4f;
+	float maxDistance = std::isinf(lightSample.distance) ? INFINITY : lightSample.distance * (1.0f - RESTIRDI_RAY_EPSILON);
+	for (const std::array<glm::vec3, 3>& triangle : scene.occluders) {
+		glm::vec3 p = glm::cross(lightSample.direction, triangle[2]);
+		float determinant = glm::dot(triangle[1], p);
+		if (std::abs(determinant) < 1e-12f) continue;
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 s = origin - triangle[0];
+		float u = glm::dot(s, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f) continue;
+		glm::vec3 q = glm::cross(s, triangle[1]);
+		float v = glm::dot(lightSample.direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f) continue;
+		float t = glm::dot(triangle[2], q) * inverseDeterminant;
+		if (t > 0.0f && t < maxDistance) return false;
+	}
+	return true;
+}
+static bool isSampleVisibleCPU(const ReSTIRDICPUScene& scene, const shaderio::ReSTIRDISurface& surface, uint32_t lightIndex, glm::vec2 uv) {
+	ReSTIRDICPULightSample lightSample;
+	if (!sampleLightCPU(scene, lightIndex, uv, surface.position, lightSample)) return false;
+	return isVisibleCPU(scene, surface, lightSample);
+}
+
+static shaderio::ReSTIRDIReservoir emptyReservoirCPU() {
+	shaderio::ReSTIRDIReservoir reservoir{};
+	reservoir.lightIndex = RESTIRDI_INVALID_LIGHT;
+	return reservoir;
+}
+static void updateReservoirCPU(shaderio::ReSTIRDIReservoir& reservoir, uint32_t lightIndex, glm::vec2 uv, float weight, float random) {
+	if (!(weight > 0.0f) || std::isinf(weight)) return;
+	reservoir.weightSum += weight;
+	if (random * reservoir.weightSum < weight) {
+		reservoir.lightIndex = lightIndex;
+		reservoir.uv = uv;
+	}
+}
+
+/*
+һ飺ͬһsurfaceframeCountֱ֡֡ӹ֮
+*/
+template<typename RNG>
+static double runReSTIRDICPU(const ReSTIRDICPUScene& scene, const ReSTIRDISetting& setting, uint32_t frameCount, RNG& rng) {
+	std::uniform_real_distribution<float> uniform(0.0f, std::nextafter(1.0f, 0.0f));
+	const uint32_t pixelCount = uint32_t(scene.size.x * scene.size.y);
+	const uint32_t lightCount = uint32_t(scene.lights.size());
+	std::vector<shaderio::ReSTIRDIReservoir> reservoirs(pixelCount), prevReservoirs(pixelCount), outReservoirs(pixelCount);
+
+	auto getPixelIndex = [&](glm::ivec2 pixel) { return uint32_t(pixel.y * scene.size.x + pixel.x); };
+	auto isInside = [&](glm::ivec2 pixel) { return pixel.x >= 0 && pixel.y >= 0 && pixel.x < scene.size.x && pixel.y < scene.size.y; };
+	auto combineReservoir = [&](shaderio::ReSTIRDIReservoir& combined, const shaderio::ReSTIRDIReservoir& input, const shaderio::ReSTIRDISurface& surface) {
+		float targetPdf = getTargetPdfCPU(scene, surface, input.lightIndex, input.uv);
+		updateReservoirCPU(combined, input.lightIndex, input.uv, targetPdf * input.W * input.M, uniform(rng));
+		combined.M += input.M;
+	};
+	auto getSupportM = [&](const shaderio::ReSTIRDIReservoir& combined, const shaderio::ReSTIRDIReservoir& input, const shaderio::ReSTIRDISurface& inputSurface) {
+		if (getTargetPdfCPU(scene, inputSurface, combined.lightIndex, combined.uv) <= 0.0f) return 0.0f;
+		if (setting.biasCorrection == shaderio::ReSTIRDIBiasCorrection_RayTraced && !isSampleVisibleCPU(scene, inputSurface, combined.lightIndex, combined.uv))
+			return 0.0f;
+		return input.M;
+	};
+	auto finalizeReservoir = [&](shaderio::ReSTIRDIReservoir& reservoir, const shaderio::ReSTIRDISurface& surface, float Z) {
+		float targetPdf = getTargetPdfCPU(scene, surface, reservoir.lightIndex, reservoir.uv);
+		float normalization = setting.biasCorrection == shaderio::ReSTIRDIBiasCorrection_None ? reservoir.M : Z;
+		reservoir.W = targetPdf > 0.0f && normalization > 0.0f ? reservoir.weightSum / (normalization * targetPdf) : 0.0f;
+	};
+
+	double sum = 0.0;
+	for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+		//initial
+		for (uint32_t pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex) {
+			const shaderio::ReSTIRDISurface& surface = scene.surfaces[pixelIndex];
+			shaderio::ReSTIRDIReservoir reservoir = emptyReservoirCPU();
+			if (surface.valid != 0u && lightCount > 0) {
+				for (int candidateIndex = 0; candidateIndex < setting.initialCandidateCount; ++candidateIndex) {
+					uint32_t lightIndex = std::min(uint32_t(uniform(rng) * float(lightCount)), lightCount - 1);
+					shaderio::ReSTIRDIAliasEntry entry = scene.aliasTable[lightIndex];
+					if (uniform(rng) >= entry.threshold) {
+						lightIndex = entry.alias;
+						entry = scene.aliasTable[lightIndex];
+					}
+					glm::vec2 uv(uniform(rng), uniform(rng));
+					float random = uniform(rng);
+
+					ReSTIRDICPULightSample lightSample;
+					if (!sampleLightCPU(scene, lightIndex, uv, surface.position, lightSample)) continue;
+					float targetPdf = luminance(getContributionCPU(surface, lightSample));
+					updateReservoirCPU(reservoir, lightIndex, uv, targetPdf / (entry.probability * lightSample.areaPdf), random);
+				}
+				reservoir.M = float(setting.initialCandidateCount);
+				finalizeReservoir(reservoir, surface, reservoir.M);
+				if (reservoir.W > 0.0f && !isSampleVisibleCPU(scene, surface, reservoir.lightIndex, reservoir.uv)) reservoir.W = 0.0f;
+			}
+			reservoirs[pixelIndex] = reservoir;
+		}
+
+		//temporalһ֡ؾǵǰ
+		if (setting.temporalReuse && frameIndex > 0) {
+			for (uint32_t pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex) {
+				const shaderio::ReSTIRDISurface& surface = scene.surfaces[pixelIndex];
+				if (surface.valid == 0u || !isSimilarCPU(surface, surface)) continue;
+				shaderio::ReSTIRDIReservoir current = reservoirs[pixelIndex];
+				shaderio::ReSTIRDIReservoir previous = prevReservoirs[pixelIndex];
+				previous.M = std::min(previous.M, float(setting.temporalMCap) * std::max(current.M, 1.0f));
+
+				shaderio::ReSTIRDIReservoir combined = emptyReservoirCPU();
+				combineReservoir(combined, current, surface);
+				combineReservoir(combined, previous, surface);
+				float Z = getSupportM(combined, current, surface) + getSupportM(combined, previous, surface);
+				finalizeReservoir(combined, surface, Z);
+				if (combined.W > 0.0f && !isSampleVisibleCPU(scene, surface, combined.lightIndex, combined.uv)) combined.W = 0.0f;
+				reservoirs[pixelIndex] = combined;
+			}
+		}
+
+		//spatial
+		for (int y = 0; y < scene.size.y; ++y) {
+			for (int x = 0; x < scene.size.x; ++x) {
+				glm::ivec2 pixel(x, y);
+				uint32_t pixelIndex = getPixelIndex(pixel);
+				const shaderio::ReSTIRDISurface& surface = scene.surfaces[pixelIndex];
+				const shaderio::ReSTIRDIReservoir& current = reservoirs[pixelIndex];
+				if (surface.valid == 0u) {
+					outReservoirs[pixelIndex] = current;
+					continue;
+				}
+
+				shaderio::ReSTIRDIReservoir combined = emptyReservoirCPU();
+				combineReservoir(combined, current, surface);
+
+				std::array<uint32_t, RESTIRDI_MAX_SPATIAL_SAMPLES> neighbourIndices;
+				uint32_t neighbourCount = 0;
+				int sampleCount = std::min(setting.spatialSampleCount, RESTIRDI_MAX_SPATIAL_SAMPLES);
+				for (int sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex) {
+					float radius = setting.spatialRadius * std::sqrt(uniform(rng));
+					float angle = glm::two_pi<float>() * uniform(rng);
+					glm::ivec2 neighbourPixel = pixel + glm::ivec2(glm::round(radius * glm::vec2(std::cos(angle), std::sin(angle))));
+					if (!isInside(neighbourPixel) || neighbourPixel == pixel) continue;
+					uint32_t neighbourPixelIndex = getPixelIndex(neighbourPixel);
+					if (!isSimilarCPU(surface, scene.surfaces[neighbourPixelIndex])) continue;
+
+					combineReservoir(combined, reservoirs[neighbourPixelIndex], surface);
+					neighbourIndices[neighbourCount++] = neighbourPixelIndex;
+				}
+
+				float Z = 0.0f;
+				if (combined.lightIndex != RESTIRDI_INVALID_LIGHT && setting.biasCorrection != shaderio::ReSTIRDIBiasCorrection_None) {
+					Z = getSupportM(combined, current, surface);
+					for (uint32_t neighbourIndex = 0; neighbourIndex < neighbourCount; ++neighbourIndex) {
+						uint32_t neighbourPixelIndex = neighbourIndices[neighbourIndex];
+						Z += getSupportM(combined, reservoirs[neighbourPixelIndex], scene.surfaces[neighbourPixelIndex]);
+					}
+				}
+				finalizeReservoir(combined, surface, Z);
+				outReservoirs[pixelIndex] = combined;
+			}
+		}
+
+		//shade
+		for (uint32_t pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex) {
+			const shaderio::ReSTIRDISurface& surface = scene.surfaces[pixelIndex];
+			const shaderio::ReSTIRDIReservoir& reservoir = outReservoirs[pixelIndex];
+			ReSTIRDICPULightSample lightSample;
+			if (surface.valid != 0u && reservoir.W > 0.0f && sampleLightCPU(scene, reservoir.lightIndex, reservoir.uv, surface.position, lightSample) &&
+				isVisibleCPU(scene, surface, lightSample)) {
+				float directLighting = luminance(getContributionCPU(surface, lightSample)) * reservoir.W;
+				if (std::isfinite(directLighting)) sum += directLighting;
+			}
+		}
+		std::swap(prevReservoirs, outReservoirs);
+	}
+	return sum / double(frameCount);
+}
+
+//16x16أxбϰΪDiffuse°ΪRoughConductorɵԴһбСԴһĹԴ
+//һ泯صĹԴһ⣬һڵ
+static ReSTIRDICPUScene createValidationScene() {
+	ReSTIRDICPUScene scene;
+	scene.size = glm::ivec2(16, 16);
+	const glm::vec3 cameraPosition(0.0f, -1.0f, 5.0f);
+	for (int y = 0; y < scene.size.y; ++y) {
+		for (int x = 0; x < scene.size.x; ++x) {
+			shaderio::ReSTIRDISurface surface{};
+			surface.position = glm::vec3((float(x) + 0.5f) / float(scene.size.x) * 4.0f - 2.0f, (float(y) + 0.5f) / float(scene.size.y) * 4.0f - 2.0f, 0.0f);
+			float tilt = (float(x) / float(scene.size.x - 1) - 0.5f) * 1.2f;
+			surface.normal = glm::vec3(std::sin(tilt), 0.0f, std::cos(tilt));
+			surface.valid = 1u;
+			if (y < scene.size.y / 2) {
+				surface.materialType = shaderio::Diffuse;
+				surface.albedo = glm::vec3(0.8f, 0.6f, 0.4f);
+				surface.roughness = 1.0f;
+			}
+			else {
+				surface.materialType = shaderio::RoughConductor;
+				surface.albedo = glm::vec3(0.9f, 0.8f, 0.6f);
+				surface.roughness = 0.4f;
+			}
+			surface.outgoing = glm::normalize(cameraPosition - surface.position);
+			surface.depth = glm::length(cameraPosition - surface.position);
+			scene.surfaces.push_back(surface);
+		}
+	}
+
+	auto addTriangle = [&](glm::vec3 v0, glm::vec3 edge1, glm::vec3 edge2, glm::vec3 radiance) {
+		shaderio::ReSTIRDILight light{};
+		light.type = shaderio::ReSTIRDILight_Triangle;
+		light.position = v0;
+		light.edge1 = edge1;
+		light.edge2 = edge2;
+		light.radiance = radiance;
+		scene.lights.push_back(light);
+		scene.occluders.push_back({ v0, edge1, edge2 });
+	};
+	const glm::vec3 corner(-0.25f, -0.25f, 2.5f);
+	addTriangle(corner, glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.5f, 0.5f, 0.0f), glm::vec3(8.0f));
+	addTriangle(corner, glm::vec3(0.5f, 0.5f, 0.0f), glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(8.0f));
+	addTriangle(glm::vec3(1.2f, -1.5f, 0.6f), glm::vec3(0.0f, 0.3f, 0.0f), glm::vec3(0.2f, 0.0f, 0.1f), glm::vec3(40.0f, 20.0f, 10.0f));
+	addTriangle(glm::vec3(-2.6f, 0.5f, 0.3f), glm::vec3(0.0f, 0.6f, 0.0f), glm::vec3(0.0f, 0.0f, 0.6f), glm::vec3(5.0f, 10.0f, 15.0f));
+	addTriangle(glm::vec3(0.8f, 0.8f, 1.5f), glm::vec3(0.3f, 0.0f, 0.0f), glm::vec3(0.0f, 0.3f, 0.0f), glm::vec3(10.0f));
+
+	shaderio::ReSTIRDILight directionLight{};
+	directionLight.type = shaderio::ReSTIRDILight_Direction;
+	directionLight.direction = glm::normalize(glm::vec3(0.3f, 0.2f, -1.0f));
+	directionLight.radiance = glm::vec3(1.0f, 0.95f, 0.9f);
+	scene.lights.push_back(directionLight);
+
+	scene.occluders.push_back({ glm::vec3(-1.0f, -0.2f, 1.2f), glm::vec3(1.2f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) });
+
+	ReSTIRDI::buildLightAliasTable(scene.lights, scene.aliasTable);
+	return scene;
+}
+//ιԴuvȡе֣uvεӳ䱣ֱӼ
+static double integrateReferenceCPU(const ReSTIRDICPUScene& scene, uint32_t resolution) {
+	double sum = 0.0;
+	for (const shaderio::ReSTIRDISurface& surface : scene.surfaces) {
+		for (uint32_t lightIndex = 0; lightIndex < scene.lights.size(); ++lightIndex) {
+			const bool isDirection = scene.lights[lightIndex].type == shaderio::ReSTIRDILight_Direction;
+			const uint32_t sampleCount = isDirection ? 1 : resolution;
+			double lightSum = 0.0;
+			for (uint32_t i = 0; i < sampleCount; ++i) {
+				for (uint32_t j = 0; j < sampleCount; ++j) {
+					glm::vec2 uv((float(i) + 0.5f) / float(sampleCount), (float(j) + 0.5f) / float(sampleCount));
+					ReSTIRDICPULightSample lightSample;
+					if (!sampleLightCPU(scene, lightIndex, uv, surface.position, lightSample) || !isVisibleCPU(scene, surface, lightSample)) continue;
+					lightSum += luminance(getContributionCPU(surface, lightSample)) / lightSample.areaPdf;
+				}
+			}
+			sum += lightSum / double(sampleCount * sampleCount);
+		}
+	}
+	return sum;
+}
+
+bool ReSTIRDI::validate(uint32_t trialCount) {
+	if (trialCount == 0) return true;
+	SCOPED_TIMER(__FUNCTION__);
+	bool allPassed = true;
+	auto report = [&](bool passed, const std::string& message) {
+		allPassed &= passed;
+		if (passed) LOGI("ReSTIRDI validate: %s, pass\n", message.c_str());
+		else LOGW("ReSTIRDI validate: %s, FAIL\n", message.c_str());
+	};
+	char message[256];
+
+	ReSTIRDICPUScene scene = createValidationScene();
+
+	//aliasÿԴѡеĸʵڱprobability
+	{
+		const uint32_t lightCount = uint32_t(scene.lights.size());
+		std::vector<double> reconstructed(lightCount, 0.0);
+		double probabilitySum = 0.0;
+		for (uint32_t i = 0; i < lightCount; ++i) {
+			const shaderio::ReSTIRDIAliasEntry& entry = scene.aliasTable[i];
+			reconstructed[i] += entry.threshold / double(lightCount);
+			reconstructed[entry.alias] += (1.0 - entry.threshold) / double(lightCount);
+			probabilitySum += entry.probability;
+		}
+		double maxError = std::abs(probabilitySum - 1.0);
+		for (uint32_t i = 0; i < lightCount; ++i) maxError = std::max(maxError, std::abs(reconstructed[i] - scene.aliasTable[i].probability));
+		snprintf(message, sizeof(message), "alias table of %u lights, max probability error %.2e", lightCount, maxError);
+		report(maxError < 1e-5, message);
+	}
+
+	const double reference = integrateReferenceCPU(scene, 128);
+
+	struct ValidationCase {
+		const char* name;
+		bool temporalReuse;
+		int spatialSampleCount;
+		int biasCorrection;
+		bool mustBeUnbiased;
+	};
+	const ValidationCase validationCases[] = {
+		{ "RIS only", false, 0, shaderio::ReSTIRDIBiasCorrection_Basic, true },
+		{ "bias correction None", true, 5, shaderio::ReSTIRDIBiasCorrection_None, false },
+		{ "bias correction Basic", true, 5, shaderio::ReSTIRDIBiasCorrection_Basic, false },
+		{ "bias correction RayTraced", true, 5, shaderio::ReSTIRDIBiasCorrection_RayTraced, true },
+	};
+	constexpr uint32_t FRAME_COUNT = 4;
+	std::mt19937 rng(1234);
+	for (const ValidationCase& validationCase : validationCases) {
+		ReSTIRDISetting setting;
+		setting.initialCandidateCount = 8;
+		setting.temporalReuse = validationCase.temporalReuse;
+		setting.spatialSampleCount = validationCase.spatialSampleCount;
+		setting.spatialRadius = 4.0f;
+		setting.biasCorrection = validationCase.biasCorrection;
+
+		double mean = 0.0, squaredSum = 0.0;
+		for (uint32_t trialIndex = 0; trialIndex < trialCount; ++trialIndex) {
+			double estimate = runReSTIRDICPU(scene, setting, FRAME_COUNT, rng);
+			mean += estimate;
+			squaredSum += estimate * estimate;
+		}
+		mean /= double(trialCount);
+		double variance = std::max(squaredSum / double(trialCount) - mean * mean, 0.0);
+		double standardError = std::sqrt(variance / double(std::max(trialCount, 2u) - 1));
+		double z = standardError > 0.0 ? (mean - reference) / standardError : 0.0;
+		snprintf(message, sizeof(message), "%s, mean %.5f reference %.5f, relative bias %+.3f%%, z %+.2f", validationCase.name,
+			mean, reference, (mean / reference - 1.0) * 100.0, z);
+		if (validationCase.mustBeUnbiased) report(std::abs(z) < 4.0, message);
+		else LOGI("ReSTIRDI validate: %s, reported only\n", message);
+	}
+	return allPassed;
+}
+
+//-----------------------------------------------------GPU汾--------------------------------------------------------
+ReSTIRDI::ReSTIRDI(pugi::xml_node& featureNode) {
+	profileName = "ReSTIRDI";
+	if (pugi::xml_node enableNode = featureNode.child("enable"))
+		enable = std::string(enableNode.attribute("value").value()) == "true";
+	if (pugi::xml_node candidateNode = featureNode.child("initialCandidateCount"))
+		setting.initialCandidateCount = std::stoi(candidateNode.attribute("value").value());
+	if (pugi::xml_node temporalReuseNode = featureNode.child("temporalReuse"))
+		setting.temporalReuse = std::string(temporalReuseNode.attribute("value").value()) == "true";
+	if (pugi::xml_node mCapNode = featureNode.child("temporalMCap"))
+		setting.temporalMCap = std::stoi(mCapNode.attribute("value").value());
+	if (pugi::xml_node spatialSampleNode = featureNode.child("spatialSampleCount"))
+		setting.spatialSampleCount = std::min(std::stoi(spatialSampleNode.attribute("value").value()), RESTIRDI_MAX_SPATIAL_SAMPLES);
+	if (pugi::xml_node spatialRadiusNode = featureNode.child("spatialRadius"))
+		setting.spatialRadius = std::stof(spatialRadiusNode.attribute("value").value());
+	if (pugi::xml_node biasCorrectionNode = featureNode.child("biasCorrection")) {
+		std::string biasCorrection = biasCorrectionNode.attribute("value").value();
+		if (biasCorrection == "none") setting.biasCorrection = shaderio::ReSTIRDIBiasCorrection_None;
+		else if (biasCorrection == "basic") setting.biasCorrection = shaderio::ReSTIRDIBiasCorrection_Basic;
+		else if (biasCorrection == "rayTraced") setting.biasCorrection = shaderio::ReSTIRDIBiasCorrection_RayTraced;
+		else LOGW("ReSTIRDI: unknown biasCorrection %s, use basic\n", biasCorrection.c_str());
+	}
+}
+void ReSTIRDI::init() {
+	collectLights();
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->createBuffer(lightBuffer, std::max<VkDeviceSize>(std::span(lights).size_bytes(), sizeof(shaderio::ReSTIRDILight)),
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT);
+	NVVK_DBG_NAME(lightBuffer.buffer);
+	allocator->createBuffer(lightAliasTableBuffer, std::max<VkDeviceSize>(std::span(lightAliasTable).size_bytes(), sizeof(shaderio::ReSTIRDIAliasEntry)),
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT);
+	NVVK_DBG_NAME(lightAliasTableBuffer.buffer);
+	if (!lights.empty()) {
+		NVVK_CHECK(Application::stagingUploader.appendBuffer(lightBuffer, 0, std::span<const shaderio::ReSTIRDILight>(lights)));
+		NVVK_CHECK(Application::stagingUploader.appendBuffer(lightAliasTableBuffer, 0, std::span<const shaderio::ReSTIRDIAliasEntry>(lightAliasTable)));
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		Application::stagingUploader.cmdUploadAppended(cmd);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+		Application::stagingUploader.releaseStaging();
+	}
+	LOGI("ReSTIRDI: %u lights%s\n", uint32_t(lights.size()), lightsDynamic ? ", updated every frame" : "");
+
+	createDescriptorSetLayout();
+	addTextureArrayDescriptor(shaderio::StaticSetBindingPoints_PT::eTextures_PT);
+	createPipelineLayout();
+	compileAndCreateShaders();
+}
+void ReSTIRDI::clean() {
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_initial, nullptr);
+	vkDestroyShaderEXT(device, computeShader_temporal, nullptr);
+	vkDestroyShaderEXT(device, computeShader_spatial, nullptr);
+	vkDestroyShaderEXT(device, computeShader_shade, nullptr);
+	destroyBuffers();
+	Application::allocator.destroyBuffer(lightBuffer);
+	Application::allocator.destroyBuffer(lightAliasTableBuffer);
+	Feature::clean();
+}
+void ReSTIRDI::uiRender() {
+	bool& UIModified = Application::UIModified;
+	namespace PE = nvgui::PropertyEditor;
+	if (ImGui::Begin("ReSTIR DI")) {
+		UIModified |= ImGui::Checkbox("Enable", &enable);
+		PE::begin();
+		UIModified |= PE::SliderInt("Initial Candidates", &setting.initialCandidateCount, 1, 64, "%d", ImGuiSliderFlags_AlwaysClamp, "Lights resampled per pixel by RIS");
+		UIModified |= PE::Checkbox("Temporal Reuse", &setting.temporalReuse);
+		UIModified |= PE::SliderInt("Temporal M Cap", &setting.temporalMCap, 1, 64, "%d", ImGuiSliderFlags_AlwaysClamp, "History M is clamped to this many times the M of the frame");
+		UIModified |= PE::SliderInt("Spatial Samples", &setting.spatialSampleCount, 0, RESTIRDI_MAX_SPATIAL_SAMPLES, "%d", ImGuiSliderFlags_AlwaysClamp, "Neighbours combined per pixel");
+		UIModified |= PE::SliderFloat("Spatial Radius", &setting.spatialRadius, 1.0f, 64.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp, "In pixels");
+		UIModified |= PE::Combo("Bias Correction", &setting.biasCorrection, "None\0Basic\0RayTraced\0", shaderio::ReSTIRDIBiasCorrection_Count);
+		PE::end();
+		ImGui::TextDisabled("Lights: %u", uint32_t(lights.size()));
+	}
+	ImGui::End();
+}
+void ReSTIRDI::resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex) {
+	sceneSize = size;
+	destroyBuffers();
+	createBuffers(size);
+	historyReset = true;
+
+	nvvk::WriteSetContainer write{};
+	VkWriteDescriptorSet outImageWrite = staticDescPack.makeWrite(shaderio::StaticSetBindingPoints_PT::eOutImage_PT, 0, 0, 1);
+	write.append(outImageWrite, outGBuffer.getColorImageView(outImageIndex), VK_IMAGE_LAYOUT_GENERAL);
+	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+}
+void ReSTIRDI::preRender() {
+	//·׷д뱾֡surfaceһ֡temporalж
+	frameParity ^= 1;
+}
+void ReSTIRDI::render(VkCommandBuffer cmd, VkAccelerationStructureKHR tlas, int maxFrameCount, shaderio::DenoiserFeature* denoiserFeatures) {
+	NVVK_DBG_SCOPE(cmd);
+	if (sceneSize.width == 0 || sceneSize.height == 0) return;
+
+	if (lightsDynamic) {
+		auto section = profileStage(cmd, "UpdateLights");
+		const size_t lightCount = lights.size();
+		collectLights();
+		if (lights.size() == lightCount) uploadLights(cmd);
+		else LOGW("ReSTIRDI: light count changed from %zu to %zu, lights are not updated\n", lightCount, lights.size());
+	}
+
+	const glm::mat4& viewProjMatrix = Application::sceneResource.sceneInfo.viewProjMatrix;
+	const uint32_t previous = frameParity ^ 1;
+	pushConstant.prevViewProjMatrix = prevViewProjMatrix;
+	pushConstant.sceneSize = shaderio::uint2(sceneSize.width, sceneSize.height);
+	pushConstant.frameIndex = Application::frameIndex;
+	pushConstant.maxFrameCount = maxFrameCount;
+	pushConstant.lightCount = uint32_t(lights.size());
+	pushConstant.initialCandidateCount = uint32_t(setting.initialCandidateCount);
+	pushConstant.temporalMCap = uint32_t(setting.temporalMCap);
+	pushConstant.spatialSampleCount = uint32_t(setting.spatialSampleCount);
+	pushConstant.spatialRadius = setting.spatialRadius;
+	pushConstant.biasCorrection = uint32_t(setting.biasCorrection);
+	pushConstant.useTemporalReuse = setting.temporalReuse ? 1 : 0;
+	pushConstant.resetHistory = historyReset ? 1 : 0;
+	pushConstant.useDenoiser = denoiserFeatures != nullptr ? 1 : 0;
+	pushConstant.sceneInfoAddress = (shaderio::SceneInfo*)Application::sceneResource.bSceneInfo.address;
+	pushConstant.lights = (shaderio::ReSTIRDILight*)lightBuffer.address;
+	pushConstant.lightAliasTable = (shaderio::ReSTIRDIAliasEntry*)lightAliasTableBuffer.address;
+	pushConstant.surfaces = (shaderio::ReSTIRDISurface*)surfaceBuffers[frameParity].address;
+	pushConstant.prevSurfaces = (shaderio::ReSTIRDISurface*)surfaceBuffers[previous].address;
+	pushConstant.reservoirs = (shaderio::ReSTIRDIReservoir*)reservoirBuffer.address;
+	pushConstant.prevReservoirs = (shaderio::ReSTIRDIReservoir*)finalReservoirBuffers[previous].address;
+	pushConstant.outReservoirs = (shaderio::ReSTIRDIReservoir*)finalReservoirBuffers[frameParity].address;
+	pushConstant.denoiserFeatures = denoiserFeatures;
+
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, staticDescPack.getSetPtr(), 0, nullptr);
+	nvvk::WriteSetContainer write{};
+	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), tlas);
+	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 1, write.size(), write.data());
+
+	{
+		auto section = profileStage(cmd, "Initial");
+		dispatch(cmd, computeShader_initial);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	{
+		auto section = profileStage(cmd, "Temporal");
+		dispatch(cmd, computeShader_temporal);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	{
+		auto section = profileStage(cmd, "Spatial");
+		dispatch(cmd, computeShader_spatial);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	{
+		auto section = profileStage(cmd, "Shade");
+		dispatch(cmd, computeShader_shade);
+	}
+
+	prevViewProjMatrix = viewProjMatrix;
+	historyReset = false;
+}
+
+void ReSTIRDI::createDescriptorSetLayout() {
+	nvvk::DescriptorBindings bindings;
+	bindings.addBinding({ .binding = shaderio::StaticSetBindingPoints_PT::eTextures_PT,
+					 .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+					 .descriptorCount = 10,
+					 .stageFlags = VK_SHADER_STAGE_ALL });
+	bindings.addBinding({
+		.binding = shaderio::StaticSetBindingPoints_PT::eOutImage_PT,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+	NVVK_DBG_NAME(staticDescPack.getLayout());
+	NVVK_DBG_NAME(staticDescPack.getPool());
+	NVVK_DBG_NAME(staticDescPack.getSet(0));
+
+	bindings.clear();
+	bindings.addBinding({
+		.binding = shaderio::DynamicSetBindingPoints_PT::eTlas_PT,
+		.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+}
+void ReSTIRDI::createPipelineLayout() {
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRDIPushConstant)
+	};
+
+	std::array<VkDescriptorSetLayout, 2> layouts = { {staticDescPack.getLayout(), dynamicDescPack.getLayout()} };
+	const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = layouts.size(),
+		.pSetLayouts = layouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
+	NVVK_DBG_NAME(pipelineLayout);
+}
+void ReSTIRDI::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "restirDI.slang" });
+}
+void ReSTIRDI::compileAndCreateShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "restirDI.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRDIPushConstant),
+	};
+	std::array<VkDescriptorSetLayout, 2> layouts = { {staticDescPack.getLayout(), dynamicDescPack.getLayout()} };
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.setLayoutCount = layouts.size(),
+		.pSetLayouts = layouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	VkDevice device = Application::app->getDevice();
+	std::array<std::pair<VkShaderEXT*, const char*>, 4> shaders = { {
+		{ &computeShader_initial, "computeMain_initial" },
+		{ &computeShader_temporal, "computeMain_temporal" },
+		{ &computeShader_spatial, "computeMain_spatial" },
+		{ &computeShader_shade, "computeMain_shade" },
+	} };
+	for (auto& [shader, entryName] : shaders) {
+		vkDestroyShaderEXT(device, *shader, nullptr);
+		shaderInfo.pName = entryName;
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, shader);
+		NVVK_DBG_NAME(*shader);
+	}
+}
+
+void ReSTIRDI::createBuffers(VkExtent2D size) {
+	const VkDeviceSize pixelCount = std::max(VkDeviceSize(size.width) * size.height, VkDeviceSize(1));
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	for (int i = 0; i < 2; ++i) {
+		allocator->createBuffer(surfaceBuffers[i], pixelCount * sizeof(shaderio::ReSTIRDISurface), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(surfaceBuffers[i].buffer);
+		allocator->createBuffer(finalReservoirBuffers[i], pixelCount * sizeof(shaderio::ReSTIRDIReservoir), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(finalReservoirBuffers[i].buffer);
+	}
+	allocator->createBuffer(reservoirBuffer, pixelCount * sizeof(shaderio::ReSTIRDIReservoir), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(reservoirBuffer.buffer);
+}
+void ReSTIRDI::destroyBuffers() {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	for (int i = 0; i < 2; ++i) {
+		allocator->destroyBuffer(surfaceBuffers[i]);
+		allocator->destroyBuffer(finalReservoirBuffers[i]);
+	}
+	allocator->destroyBuffer(reservoirBuffer);
+}
+void ReSTIRDI::dispatch(VkCommandBuffer cmd, VkShaderEXT shader) {
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &shader);
+	VkPushConstantsInfo pushInfo{
+		.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+		.layout = pipelineLayout,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRDIPushConstant),
+		.pValues = &pushConstant,
+	};
+	vkCmdPushConstants2(cmd, &pushInfo);
+	VkExtent2D groupSize = nvvk::getGroupCounts(sceneSize, VkExtent2D{ RESTIRDI_THREADGROUP_SIZE_X, RESTIRDI_THREADGROUP_SIZE_Y });
+	vkCmdDispatch(cmd, groupSize.width, groupSize.height, 1);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "feature/Feature.h"
+#include "./shaderio.h"
+#include <pugixml.hpp>
+
+#ifndef FZBRENDERER_FEATURE_RESTIRDI_H
+#define FZBRENDERER_FEATURE_RESTIRDI_H
+
+namespace FzbRenderer {
+struct ReSTIRDISetting {
+	int initialCandidateCount = 32;
+	int temporalMCap = 20;
+	int spatialSampleCount = 5;
+	float spatialRadius = 30.0f;
+	int biasCorrection = shaderio::ReSTIRDIBiasCorrection_Basic;
+	bool temporalReuse = true;
+};
+/*
+ReSTIR DI滻·׷ֱӹգBitterli et al. 2020
+1. ԴбΪSceneInfoķʵԷΣʽaliasNEE·׷һ£ԴԴֻNEEԴԷ
+2. ·׷дrestirDIMakeSurfaceshaders/restirDICommon.slangԿɴĲʲټֱӹ⣬
+   һԷҲۼӣ·radianceдsurfaceͼ
+3. initialÿشaliasȡinitialCandidateCountѡRISѡеɼʱWΪ0
+4. temporalһ֡viewProjͶӰһ֡յreservoirϲʷMضΪtemporalMCap
+5. spatial뾶spatialSampleCountƵھӺϲƫУReSTIRDIBiasCorrection
+6. shadeһοɼԲԣ·radianceۼƵͼ񣨿ʱӵϣ
+validateΪreservoir߼CPU汾ںϳɳͳƼƵƫ
+*/
+class ReSTIRDI : public Feature {
+public:
+	ReSTIRDI() = default;
+	virtual ~ReSTIRDI() = default;
+
+	ReSTIRDI(pugi::xml_node& featureNode);
+
+	void init() override;
+	void clean() override;
+	void uiRender() override;
+	void resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex);
+	void preRender();
+	void render(VkCommandBuffer cmd, VkAccelerationStructureKHR tlas, int maxFrameCount, shaderio::DenoiserFeature* denoiserFeatures);
+
+	void createDescriptorSetLayout() override;
+	void createPipelineLayout();
+	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
+
+	shaderio::ReSTIRDISurface* getSurfaceAddress() const { return (shaderio::ReSTIRDISurface*)surfaceBuffers[frameParity].address; }
+	void resetHistory() { historyReset = true; }
+
+	static float getLightPower(const shaderio::ReSTIRDILight& light);
+	//Ĺ޷壬ȡԴ֮
+	static void buildLightAliasTable(const std::vector<shaderio::ReSTIRDILight>& lights, std::vector<shaderio::ReSTIRDIAliasEntry>& aliasTable);
+	/*
+	ںϳɳϱȽÿƫУĹƾֵֵֵĲοֵ־
+	ÿ֡initialtemporalspatialshade֮ı׼zֵ
+	ֻRISRayTracedУƫNoneBasicڵԵƫֻ棬ȫͨʱtrue
+	*/
+	static bool validate(uint32_t trialCount);
+
+	ReSTIRDISetting setting;
+	bool enable = true;
+private:
+	void collectLights();
+	void createBuffers(VkExtent2D size);
+	void destroyBuffers();
+	void dispatch(VkCommandBuffer cmd, VkShaderEXT shader);
+
+	void uploadLights(VkCommandBuffer cmd);
+
+	std::vector<shaderio::ReSTIRDILight> lights;
+	std::vector<shaderio::ReSTIRDIAliasEntry> lightAliasTable;
+	bool lightsDynamic = false;		//ж̬Դ̬Էʵʱÿ֡ռԴ
+
+	VkExtent2D sceneSize{};
+	uint32_t frameParity = 0;
+	bool historyReset = true;
+	glm::mat4 prevViewProjMatrix = glm::mat4(1.0f);
+
+	nvvk::Buffer lightBuffer;
+	nvvk::Buffer lightAliasTableBuffer;
+	std::array<nvvk::Buffer, 2> surfaceBuffers;
+	nvvk::Buffer reservoirBuffer;
+	std::array<nvvk::Buffer, 2> finalReservoirBuffers;
+
+	shaderio::ReSTIRDIPushConstant pushConstant{};
+	VkShaderEXT computeShader_initial{};
+	VkShaderEXT computeShader_temporal{};
+	VkShaderEXT computeShader_spatial{};
+	VkShaderEXT computeShader_shade{};
+};
+}
+
+#endif
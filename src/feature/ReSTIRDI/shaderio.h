@@ -0,0 +1,104 @@
+#pragma once
+
+#include <common/Shader/shaderStructType.h>
+#include <feature/Denoiser/shaderio.h>
+
+#ifndef FZBRENDERER_RESTIRDI_SHADER_IO_H
+#define FZBRENDERER_RESTIRDI_SHADER_IO_H
+NAMESPACE_SHADERIO_BEGIN()
+
+#define RESTIRDI_THREADGROUP_SIZE_X 16
+#define RESTIRDI_THREADGROUP_SIZE_Y 16
+
+#define RESTIRDI_INVALID_LIGHT 0xffffffffu
+#define RESTIRDI_MAX_SPATIAL_SAMPLES 16
+#define RESTIRDI_NORMAL_THRESHOLD 0.9f			// neighbours whose normals differ more are not reused
+#define RESTIRDI_DEPTH_THRESHOLD 0.1f			// relative depth difference of reused neighbours
+#define RESTIRDI_RAY_EPSILON 1e-3f
+
+// the path tracers light the scene by emissive geometry and directional lights, point, spot and area lights of SceneInfo
+// only feed NEE (area lights have their emissive mesh), so these two are the lights ReSTIR DI takes over
+enum ReSTIRDILightType {
+	ReSTIRDILight_Triangle = 0,
+	ReSTIRDILight_Direction = 1,
+};
+enum ReSTIRDIBiasCorrection {
+	ReSTIRDIBiasCorrection_None = 0,		// 1 / M, biased where the neighbours see other lights
+	ReSTIRDIBiasCorrection_Basic = 1,		// 1 / Z, Z counts the inputs whose target pdf is not 0 at the sample
+	ReSTIRDIBiasCorrection_RayTraced = 2,	// 1 / Z with a visibility ray from every input, unbiased with occluders
+	ReSTIRDIBiasCorrection_Count
+};
+
+// one light of the candidate list: the directional lights of SceneInfo followed by the emissive triangles of the instances
+struct ReSTIRDILight {
+	float3 position;		// triangle: first vertex
+	uint type;				// ReSTIRDILightType
+	float3 edge1;			// triangle, emitting towards cross(edge1, edge2)
+	float padding0;
+	float3 edge2;
+	float padding1;
+	float3 direction;		// direction: direction the light travels
+	float padding2;
+	float3 radiance;		// triangle: emitted radiance, direction: irradiance
+	float padding3;
+};
+
+// lights are picked by power, see ReSTIRDI::buildLightAliasTable
+struct ReSTIRDIAliasEntry {
+	float threshold;		// keep this light if u < threshold, otherwise take alias
+	uint alias;
+	float probability;		// probability of picking this light
+	uint padding;
+};
+
+// a light sample is the light index and the uv on its surface, so every pixel can evaluate it again
+struct ReSTIRDIReservoir {
+	uint lightIndex;		// RESTIRDI_INVALID_LIGHT for an empty reservoir
+	float2 uv;
+	float weightSum;
+	float M;				// number of candidates seen
+	float W;				// unbiased contribution weight, 0 if the sample is occluded
+	float2 padding;
+};
+
+// primary hit written by the path tracers, see restirDIMakeSurface
+struct ReSTIRDISurface {
+	float3 position;
+	uint valid;				// primary hit with a material handled by ReSTIR DI
+	float3 normal;			// facing the camera
+	uint materialType;
+	float3 albedo;
+	float roughness;
+	float3 outgoing;
+	float depth;			// distance to the camera
+	float3 radiance;		// path tracer estimate of the frame without the direct lighting of valid surfaces
+	float directLightingScale;	// share of the paths of the pixel that left the direct lighting to ReSTIR DI
+};
+
+struct ReSTIRDIPushConstant {
+	float4x4 prevViewProjMatrix;
+	uint2 sceneSize;
+	int frameIndex = 0;
+	int maxFrameCount = 1;
+	uint lightCount = 0;
+	uint initialCandidateCount = 32;
+	uint temporalMCap = 20;				// history M is clamped to temporalMCap times the M of the frame
+	uint spatialSampleCount = 5;
+	float spatialRadius = 30.0f;		// in pixels
+	uint biasCorrection = ReSTIRDIBiasCorrection_Basic;
+	uint useTemporalReuse = 1;
+	uint resetHistory = 0;
+	uint useDenoiser = 0;				// add the direct lighting to denoiserFeatures instead of writing outImage
+	SceneInfo* sceneInfoAddress;
+	ReSTIRDILight* lights;
+	ReSTIRDIAliasEntry* lightAliasTable;
+	ReSTIRDISurface* surfaces;
+	ReSTIRDISurface* prevSurfaces;
+	ReSTIRDIReservoir* reservoirs;		// initial candidates and temporal reuse of the frame
+	ReSTIRDIReservoir* prevReservoirs;	// final reservoirs of the previous frame
+	ReSTIRDIReservoir* outReservoirs;	// spatial reuse, the final reservoirs of the frame
+	DenoiserFeature* denoiserFeatures;
+};
+
+NAMESPACE_SHADERIO_END()
+#endif
@@ -0,0 +1,249 @@
+#include "./ReSTIRGI.h"
+#include <common/Application/Application.h>
+#include <common/Shader/Shader.h>
+#include <feature/PathTracing/shaderio.h>
+#include <nvutils/timers.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvvk/compute_pipeline.hpp>
+#include <nvvk/debug_util.hpp>
+#include <nvgui/property_editor.hpp>
+
+using namespace FzbRenderer;
+
+ReSTIRGI::ReSTIRGI(pugi::xml_node& featureNode) {
+	profileName = "ReSTIRGI";
+	if (pugi::xml_node temporalReuseNode = featureNode.child("temporalReuse"))
+		setting.temporalReuse = std::string(temporalReuseNode.attribute("value").value()) == "true";
+	if (pugi::xml_node mCapNode = featureNode.child("temporalMCap"))
+		setting.temporalMCap = std::stoi(mCapNode.attribute("value").value());
+	if (pugi::xml_node spatialSampleNode = featureNode.child("spatialSampleCount"))
+		setting.spatialSampleCount = std::min(std::stoi(spatialSampleNode.attribute("value").value()), RESTIRGI_MAX_SPATIAL_SAMPLES);
+	if (pugi::xml_node spatialRadiusNode = featureNode.child("spatialRadius"))
+		setting.spatialRadius = std::stof(spatialRadiusNode.attribute("value").value());
+	if (pugi::xml_node biasCorrectionNode = featureNode.child("biasCorrection")) {
+		std::string biasCorrection = biasCorrectionNode.attribute("value").value();
+		if (biasCorrection == "none") setting.biasCorrection = shaderio::ReSTIRGIBiasCorrection_None;
+		else if (biasCorrection == "basic") setting.biasCorrection = shaderio::ReSTIRGIBiasCorrection_Basic;
+		else if (biasCorrection == "rayTraced") setting.biasCorrection = shaderio::ReSTIRGIBiasCorrection_RayTraced;
+		else LOGW("ReSTIRGI: unknown biasCorrection %s, use rayTraced\n", biasCorrection.c_str());
+	}
+}
+void ReSTIRGI::init() {
+	createDescriptorSetLayout();
+	addTextureArrayDescriptor(shaderio::StaticSetBindingPoints_PT::eTextures_PT);
+	createPipelineLayout();
+	compileAndCreateShaders();
+}
+void ReSTIRGI::clean() {
+	VkDevice device = Application::app->getDevice();
+	vkDestroyShaderEXT(device, computeShader_temporal, nullptr);
+	vkDestroyShaderEXT(device, computeShader_spatial, nullptr);
+	vkDestroyShaderEXT(device, computeShader_shade, nullptr);
+	destroyBuffers();
+	Feature::clean();
+}
+void ReSTIRGI::uiRender() {
+	bool& UIModified = Application::UIModified;
+	namespace PE = nvgui::PropertyEditor;
+	if (ImGui::Begin("ReSTIR GI")) {
+		PE::begin();
+		UIModified |= PE::Checkbox("Temporal Reuse", &setting.temporalReuse);
+		UIModified |= PE::SliderInt("Temporal M Cap", &setting.temporalMCap, 1, 64, "%d", ImGuiSliderFlags_AlwaysClamp, "History M is clamped to this many times the M of the frame");
+		UIModified |= PE::SliderInt("Spatial Samples", &setting.spatialSampleCount, 0, RESTIRGI_MAX_SPATIAL_SAMPLES, "%d", ImGuiSliderFlags_AlwaysClamp, "Neighbours combined per pixel");
+		UIModified |= PE::SliderFloat("Spatial Radius", &setting.spatialRadius, 1.0f, 64.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp, "In pixels");
+		UIModified |= PE::Combo("Bias Correction", &setting.biasCorrection, "None\0Basic\0RayTraced\0", shaderio::ReSTIRGIBiasCorrection_Count);
+		PE::end();
+	}
+	ImGui::End();
+}
+void ReSTIRGI::resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex) {
+	sceneSize = size;
+	destroyBuffers();
+	createBuffers(size);
+	historyReset = true;
+
+	nvvk::WriteSetContainer write{};
+	VkWriteDescriptorSet outImageWrite = staticDescPack.makeWrite(shaderio::StaticSetBindingPoints_PT::eOutImage_PT, 0, 0, 1);
+	write.append(outImageWrite, outGBuffer.getColorImageView(outImageIndex), VK_IMAGE_LAYOUT_GENERAL);
+	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+}
+void ReSTIRGI::preRender() {
+	//·׷д뱾֡surfaceһ֡temporalжJacobian
+	frameParity ^= 1;
+}
+void ReSTIRGI::render(VkCommandBuffer cmd, VkAccelerationStructureKHR tlas, int maxFrameCount,
+	shaderio::DenoiserFeature* denoiserFeatures, shaderio::ReSTIRDISurface* restirDISurfaces) {
+	NVVK_DBG_SCOPE(cmd);
+	if (sceneSize.width == 0 || sceneSize.height == 0) return;
+
+	const glm::mat4& viewProjMatrix = Application::sceneResource.sceneInfo.viewProjMatrix;
+	const uint32_t previous = frameParity ^ 1;
+	pushConstant.prevViewProjMatrix = prevViewProjMatrix;
+	pushConstant.sceneSize = shaderio::uint2(sceneSize.width, sceneSize.height);
+	pushConstant.frameIndex = Application::frameIndex;
+	pushConstant.maxFrameCount = maxFrameCount;
+	pushConstant.temporalMCap = uint32_t(setting.temporalMCap);
+	pushConstant.spatialSampleCount = uint32_t(setting.spatialSampleCount);
+	pushConstant.spatialRadius = setting.spatialRadius;
+	pushConstant.biasCorrection = uint32_t(setting.biasCorrection);
+	pushConstant.useTemporalReuse = setting.temporalReuse ? 1 : 0;
+	pushConstant.resetHistory = historyReset ? 1 : 0;
+	pushConstant.useDenoiser = denoiserFeatures != nullptr ? 1 : 0;
+	pushConstant.useReSTIRDI = restirDISurfaces != nullptr ? 1 : 0;
+	pushConstant.sceneInfoAddress = (shaderio::SceneInfo*)Application::sceneResource.bSceneInfo.address;
+	pushConstant.samples = (shaderio::ReSTIRGISample*)sampleBuffer.address;
+	pushConstant.surfaces = (shaderio::ReSTIRGISurface*)surfaceBuffers[frameParity].address;
+	pushConstant.prevSurfaces = (shaderio::ReSTIRGISurface*)surfaceBuffers[previous].address;
+	pushConstant.temporalReservoirs = (shaderio::ReSTIRGIReservoir*)temporalReservoirBuffers[frameParity].address;
+	pushConstant.prevTemporalReservoirs = (shaderio::ReSTIRGIReservoir*)temporalReservoirBuffers[previous].address;
+	pushConstant.outReservoirs = (shaderio::ReSTIRGIReservoir*)outReservoirBuffer.address;
+	pushConstant.denoiserFeatures = denoiserFeatures;
+	pushConstant.restirDISurfaces = restirDISurfaces;
+
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, staticDescPack.getSetPtr(), 0, nullptr);
+	nvvk::WriteSetContainer write{};
+	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), tlas);
+	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 1, write.size(), write.data());
+
+	{
+		auto section = profileStage(cmd, "Temporal");
+		dispatch(cmd, computeShader_temporal);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	{
+		auto section = profileStage(cmd, "Spatial");
+		dispatch(cmd, computeShader_spatial);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	{
+		auto section = profileStage(cmd, "Shade");
+		dispatch(cmd, computeShader_shade);
+	}
+
+	prevViewProjMatrix = viewProjMatrix;
+	historyReset = false;
+}
+
+void ReSTIRGI::createDescriptorSetLayout() {
+	nvvk::DescriptorBindings bindings;
+	bindings.addBinding({ .binding = shaderio::StaticSetBindingPoints_PT::eTextures_PT,
+					 .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+					 .descriptorCount = 10,
+					 .stageFlags = VK_SHADER_STAGE_ALL });
+	bindings.addBinding({
+		.binding = shaderio::StaticSetBindingPoints_PT::eOutImage_PT,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+	NVVK_DBG_NAME(staticDescPack.getLayout());
+	NVVK_DBG_NAME(staticDescPack.getPool());
+	NVVK_DBG_NAME(staticDescPack.getSet(0));
+
+	bindings.clear();
+	bindings.addBinding({
+		.binding = shaderio::DynamicSetBindingPoints_PT::eTlas_PT,
+		.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+}
+void ReSTIRGI::createPipelineLayout() {
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRGIPushConstant)
+	};
+
+	std::array<VkDescriptorSetLayout, 2> layouts = { {staticDescPack.getLayout(), dynamicDescPack.getLayout()} };
+	const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = layouts.size(),
+		.pSetLayouts = layouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
+	NVVK_DBG_NAME(pipelineLayout);
+}
+void ReSTIRGI::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "restirGI.slang" });
+}
+void ReSTIRGI::compileAndCreateShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "restirGI.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRGIPushConstant),
+	};
+	std::array<VkDescriptorSetLayout, 2> layouts = { {staticDescPack.getLayout(), dynamicDescPack.getLayout()} };
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.setLayoutCount = layouts.size(),
+		.pSetLayouts = layouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	VkDevice device = Application::app->getDevice();
+	std::array<std::pair<VkShaderEXT*, const char*>, 3> shaders = { {
+		{ &computeShader_temporal, "computeMain_temporal" },
+		{ &computeShader_spatial, "computeMain_spatial" },
+		{ &computeShader_shade, "computeMain_shade" },
+	} };
+	for (auto& [shader, entryName] : shaders) {
+		vkDestroyShaderEXT(device, *shader, nullptr);
+		shaderInfo.pName = entryName;
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, shader);
+		NVVK_DBG_NAME(*shader);
+	}
+}
+
+void ReSTIRGI::createBuffers(VkExtent2D size) {
+	const VkDeviceSize pixelCount = std::max(VkDeviceSize(size.width) * size.height, VkDeviceSize(1));
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->createBuffer(sampleBuffer, pixelCount * sizeof(shaderio::ReSTIRGISample), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(sampleBuffer.buffer);
+	for (int i = 0; i < 2; ++i) {
+		allocator->createBuffer(surfaceBuffers[i], pixelCount * sizeof(shaderio::ReSTIRGISurface), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(surfaceBuffers[i].buffer);
+		allocator->createBuffer(temporalReservoirBuffers[i], pixelCount * sizeof(shaderio::ReSTIRGIReservoir), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(temporalReservoirBuffers[i].buffer);
+	}
+	allocator->createBuffer(outReservoirBuffer, pixelCount * sizeof(shaderio::ReSTIRGIReservoir), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(outReservoirBuffer.buffer);
+}
+void ReSTIRGI::destroyBuffers() {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->destroyBuffer(sampleBuffer);
+	for (int i = 0; i < 2; ++i) {
+		allocator->destroyBuffer(surfaceBuffers[i]);
+		allocator->destroyBuffer(temporalReservoirBuffers[i]);
+	}
+	allocator->destroyBuffer(outReservoirBuffer);
+}
+void ReSTIRGI::dispatch(VkCommandBuffer cmd, VkShaderEXT shader) {
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &shader);
+	VkPushConstantsInfo pushInfo{
+		.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+		.layout = pipelineLayout,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::ReSTIRGIPushConstant),
+		.pValues = &pushConstant,
+	};
+	vkCmdPushConstants2(cmd, &pushInfo);
+	VkExtent2D groupSize = nvvk::getGroupCounts(sceneSize, VkExtent2D{ RESTIRGI_THREADGROUP_SIZE_X, RESTIRGI_THREADGROUP_SIZE_Y });
+	vkCmdDispatch(cmd, groupSize.width, groupSize.height, 1);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "feature/Feature.h"
+#include "./shaderio.h"
+#include <pugixml.hpp>
+
+#ifndef FZBRENDERER_FEATURE_RESTIRGI_H
+#define FZBRENDERER_FEATURE_RESTIRGI_H
+
+namespace FzbRenderer {
+struct ReSTIRGISetting {
+	int temporalMCap = 20;
+	int spatialSampleCount = 3;
+	float spatialRadius = 30.0f;
+	int biasCorrection = shaderio::ReSTIRGIBiasCorrection_RayTraced;
+	bool temporalReuse = true;
+};
+/*
+ReSTIR GIļӹOuyang et al. 2021ΪFzbPathGuidingа˲֮һʽ
+1. ·׷дrestirGIMakeSurfaceһsppBSDFõĵڶ㼰radianceдrestirGIMakeSampleshaders/restirGICommon.slang
+   spp֮radianceۼӣ·radianceдsurface
+2. temporal·׷ΪһѡW = 1 / sourcePdfͶӰõһ֡temporal reservoirϲʷMضΪtemporalMCap
+3. spatial뾶spatialSampleCountƵھӵtemporal reservoirϲֻڱ֡ɫΪʷ
+4. ͬ㿴ǲͬϲʱJacobiangetJacobian仯Ĳ
+5. shadeһοɼԲԣ·radianceۼƵͼ񣨿ʱӵϣReSTIR DIʱӵsurfaceϣ
+radianceͬԹ⻬ƫ
+*/
+class ReSTIRGI : public Feature {
+public:
+	ReSTIRGI() = default;
+	virtual ~ReSTIRGI() = default;
+
+	ReSTIRGI(pugi::xml_node& featureNode);
+
+	void init() override;
+	void clean() override;
+	void uiRender() override;
+	void resize(VkCommandBuffer cmd, const VkExtent2D& size, nvvk::GBuffer& outGBuffer, uint32_t outImageIndex);
+	void preRender();
+	void render(VkCommandBuffer cmd, VkAccelerationStructureKHR tlas, int maxFrameCount,
+		shaderio::DenoiserFeature* denoiserFeatures, shaderio::ReSTIRDISurface* restirDISurfaces);
+
+	void createDescriptorSetLayout() override;
+	void createPipelineLayout();
+	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
+
+	shaderio::ReSTIRGISurface* getSurfaceAddress() const { return (shaderio::ReSTIRGISurface*)surfaceBuffers[frameParity].address; }
+	shaderio::ReSTIRGISample* getSampleAddress() const { return (shaderio::ReSTIRGISample*)sampleBuffer.address; }
+	void resetHistory() { historyReset = true; }
+
+	ReSTIRGISetting setting;
+private:
+	void createBuffers(VkExtent2D size);
+	void destroyBuffers();
+	void dispatch(VkCommandBuffer cmd, VkShaderEXT shader);
+
+	VkExtent2D sceneSize{};
+	uint32_t frameParity = 0;
+	bool historyReset = true;
+	glm::mat4 prevViewProjMatrix = glm::mat4(1.0f);
+
+	nvvk::Buffer sampleBuffer;
+	std::array<nvvk::Buffer, 2> surfaceBuffers;
+	std::array<nvvk::Buffer, 2> temporalReservoirBuffers;
+	nvvk::Buffer outReservoirBuffer;
+
+	shaderio::ReSTIRGIPushConstant pushConstant{};
+	VkShaderEXT computeShader_temporal{};
+	VkShaderEXT computeShader_spatial{};
+	VkShaderEXT computeShader_shade{};
+};
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <common/Shader/shaderStructType.h>
+#include <feature/Denoiser/shaderio.h>
+#include <feature/ReSTIRDI/shaderio.h>
+
+#ifndef FZBRENDERER_RESTIRGI_SHADER_IO_H
+#define FZBRENDERER_RESTIRGI_SHADER_IO_H
+NAMESPACE_SHADERIO_BEGIN()
+
+#define RESTIRGI_THREADGROUP_SIZE_X 16
+#define RESTIRGI_THREADGROUP_SIZE_Y 16
+
+#define RESTIRGI_MAX_SPATIAL_SAMPLES 16
+#define RESTIRGI_NORMAL_THRESHOLD 0.9f			// neighbours whose normals differ more are not reused
+#define RESTIRGI_DEPTH_THRESHOLD 0.1f			// relative depth difference of reused neighbours
+#define RESTIRGI_MAX_JACOBIAN 10.0f				// reuse is rejected when the solid angle changes more than this, or less than the inverse
+#define RESTIRGI_RAY_EPSILON 1e-3f
+
+enum ReSTIRGIBiasCorrection {
+	ReSTIRGIBiasCorrection_None = 0,		// 1 / M
+	ReSTIRGIBiasCorrection_Basic = 1,		// 1 / Z, Z counts the inputs whose target pdf is not 0 at the sample
+	ReSTIRGIBiasCorrection_RayTraced = 2,	// 1 / Z with a visibility ray from every input to the sample point
+	ReSTIRGIBiasCorrection_Count
+};
+
+// the secondary vertex of a path: the first bounce from the visible point and the radiance it sends back
+struct ReSTIRGISample {
+	float3 position;		// sample point, or the direction for paths that left the scene
+	uint isSky;
+	float3 normal;			// at the sample point, facing the visible point that traced it
+	float sourcePdf;		// solid angle pdf of the bounce at the visible point
+	float3 radiance;		// outgoing radiance of the sample point, assumed to be the same towards the neighbours
+	float padding;
+};
+
+struct ReSTIRGIReservoir {
+	ReSTIRGISample sample;
+	float weightSum;
+	float M;				// number of candidates seen
+	float W;				// unbiased contribution weight in solid angle at the visible point of the pixel
+	float padding;
+};
+
+// visible point written by the path tracers, see restirGIMakeSurface
+struct ReSTIRGISurface {
+	float3 position;
+	uint valid;				// primary hit with a material handled by ReSTIR GI
+	float3 normal;			// facing the camera
+	uint materialType;
+	float3 albedo;
+	float roughness;
+	float3 outgoing;
+	float depth;			// distance to the camera
+	float3 radiance;		// path tracer estimate of the frame without the indirect lighting of the sample
+	float indirectLightingScale;	// share of the paths of the pixel that left the indirect lighting to ReSTIR GI
+};
+
+struct ReSTIRGIPushConstant {
+	float4x4 prevViewProjMatrix;
+	uint2 sceneSize;
+	int frameIndex = 0;
+	int maxFrameCount = 1;
+	uint temporalMCap = 20;				// history M is clamped to temporalMCap times the M of the frame
+	uint spatialSampleCount = 3;
+	float spatialRadius = 30.0f;		// in pixels
+	uint biasCorrection = ReSTIRGIBiasCorrection_RayTraced;
+	uint useTemporalReuse = 1;
+	uint resetHistory = 0;
+	uint useDenoiser = 0;				// add the indirect lighting to denoiserFeatures instead of writing outImage
+	uint useReSTIRDI = 0;				// add the indirect lighting to restirDISurfaces, ReSTIR DI shades the frame after
+	SceneInfo* sceneInfoAddress;
+	ReSTIRGISample* samples;			// written by the path tracer, one per pixel
+	ReSTIRGISurface* surfaces;
+	ReSTIRGISurface* prevSurfaces;
+	ReSTIRGIReservoir* temporalReservoirs;		// history of the temporal reuse, not spread by the spatial reuse
+	ReSTIRGIReservoir* prevTemporalReservoirs;
+	ReSTIRGIReservoir* outReservoirs;	// spatial reuse, shaded this frame
+	DenoiserFeature* denoiserFeatures;
+	ReSTIRDISurface* restirDISurfaces;
+};
+
+NAMESPACE_SHADERIO_END()
+#endif
@@ -248,7 +248,7 @@ void Octree::createDescriptorSetLayout() {
 		.stageFlags = VK_SHADER_STAGE_ALL });
 #endif
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -322,7 +322,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
 	NVVK_DBG_NAME(computeShader_initOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray, nullptr);
@@ -332,7 +332,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
 	NVVK_DBG_NAME(computeShader_createOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray2, nullptr);
@@ -342,7 +342,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
 	NVVK_DBG_NAME(computeShader_createOctreeArray2);
 #ifndef NDEBUG
 	//--------------------------------------------------------------------------------------
@@ -354,7 +354,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
 	NVVK_DBG_NAME(vertexShader_Wireframe);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -362,7 +362,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 	//---------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_MergeResult, nullptr);
@@ -372,7 +372,7 @@ void Octree::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_MergeResult";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_MergeResult);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_MergeResult);
 	NVVK_DBG_NAME(computeShader_MergeResult);
 #endif
 }
@@ -185,7 +185,7 @@ void FzbRenderer::RasterVoxelization::createDescriptorSetLayout() {
 		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
 		| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
 #endif
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -227,7 +227,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_clearVGB";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_clearVGB);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_clearVGB);
 	NVVK_DBG_NAME(computeShader_clearVGB);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader, nullptr);
@@ -237,7 +237,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader);
 	NVVK_DBG_NAME(vertexShader);
 #ifndef NDEBUG
 	//------------------------------------------ThreeView--------------------------------------
@@ -249,7 +249,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
 	NVVK_DBG_NAME(geometryShader_ThreeView);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -257,7 +257,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
 	NVVK_DBG_NAME(fragmentShader_ThreeView);
 	//-------------------------------------------Cube--------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_Cube, nullptr);
@@ -268,7 +268,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Cube);
 	NVVK_DBG_NAME(vertexShader_Cube);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -276,7 +276,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Cube);
 	NVVK_DBG_NAME(fragmentShader_Cube);
 	//-------------------------------------------Wireframe--------------------------------------
 	vkDestroyShaderEXT(device, fragmentShader_Wireframe, nullptr);
@@ -286,7 +286,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 	//-------------------------------------------PostProcess--------------------------------------
 	vkDestroyShaderEXT(device, computeShader_postProcess, nullptr);
@@ -296,7 +296,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_postProcess";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_postProcess);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_postProcess);
 	NVVK_DBG_NAME(computeShader_postProcess);
 #else
 	vkDestroyShaderEXT(device, geometryShader, nullptr);
@@ -307,7 +307,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader);
 	NVVK_DBG_NAME(geometryShader);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -315,7 +315,7 @@ void FzbRenderer::RasterVoxelization::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader);
 	NVVK_DBG_NAME(fragmentShader);
 #endif
 }
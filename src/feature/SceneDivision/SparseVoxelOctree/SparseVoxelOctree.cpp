@@ -266,7 +266,7 @@ void SparseVoxelOctree::createDescriptorSetLayout() {
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -354,7 +354,7 @@ void SparseVoxelOctree::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_initSVOArray";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initSVOArray);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initSVOArray);
 		NVVK_DBG_NAME(computeShader_initSVOArray);
 	}
 	//--------------------------------------------------------------------------------------
@@ -366,7 +366,7 @@ void SparseVoxelOctree::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_createSVOArray";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createSVOArray);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createSVOArray);
 		NVVK_DBG_NAME(computeShader_createSVOArray);
 	}
 	//--------------------------------------------------------------------------------------
@@ -378,7 +378,7 @@ void SparseVoxelOctree::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_offsetLabelMultiBlock";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_offsetLabelMultiBlock);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_offsetLabelMultiBlock);
 		NVVK_DBG_NAME(computeShader_offsetLabelMultiBlock);
 	}
 
@@ -391,7 +391,7 @@ void SparseVoxelOctree::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
 	NVVK_DBG_NAME(vertexShader_Wireframe);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -399,7 +399,7 @@ void SparseVoxelOctree::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 #endif
 }
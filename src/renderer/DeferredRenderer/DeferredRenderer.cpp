@@ -44,7 +44,7 @@ void FzbRenderer::DeferredRenderer::compileAndCreateShaders() {
     shaderInfo.pName = "vertexMain";
     shaderInfo.codeSize = shaderCode.codeSize;
     shaderInfo.pCode = shaderCode.pCode;
-    vkCreateShadersEXT(Application::app->getDevice(), 1U, &shaderInfo, nullptr, &vertexShader);
+    Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader);
     NVVK_DBG_NAME(vertexShader);
 
     shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -52,7 +52,7 @@ void FzbRenderer::DeferredRenderer::compileAndCreateShaders() {
     shaderInfo.pName = "fragmentMain";
     shaderInfo.codeSize = shaderCode.codeSize;
     shaderInfo.pCode = shaderCode.pCode;
-    vkCreateShadersEXT(Application::app->getDevice(), 1U, &shaderInfo, nullptr, &fragmentShader);
+    Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader);
     NVVK_DBG_NAME(fragmentShader);
 }
 void FzbRenderer::DeferredRenderer::init() {
@@ -7,7 +7,9 @@
 using namespace FzbRenderer;
 
 FzbPathGuidingRenderer::FzbPathGuidingRenderer(pugi::xml_node& rendererNode) {
+	profileName = "FzbPathGuiding";
 	ptContext.setContextInfo();
+	asManager.getSettingFromXML(rendererNode);
 
 	if (pugi::xml_node maxDepthNode = rendererNode.child("maxDepth"))
 		pushConstant.maxDepth = std::stoi(maxDepthNode.attribute("value").value());
@@ -19,6 +21,28 @@ FzbPathGuidingRenderer::FzbPathGuidingRenderer(pugi::xml_node& rendererNode) {
 		lightInject = std::make_shared<LightInject_FzbPG>(lightInjectNode);
 	if (pugi::xml_node octreeNode = rendererNode.child("Octree"))
 		octree = std::make_shared<Octree_FzbPG>(octreeNode);
+	//˲MAX_OCTREE_LAYER_FZBPG㣬ػ֮ǰض
+	if (rasterVoxelization && octree) {
+		float& voxelCount = rasterVoxelization->setting.pushConstant.voxelSize_Count.w;
+		uint32_t maxVoxelCount = 1u << MAX_OCTREE_LAYER_FZBPG;
+		if (voxelCount > maxVoxelCount) {
+			LOGW("FzbPathGuiding: voxelCount %u exceeds the octree limit, use %u\n", uint32_t(voxelCount), maxVoxelCount);
+			voxelCount = float(maxVoxelCount);
+		}
+	}
+	if (pugi::xml_node denoiserNode = rendererNode.child("Denoiser"))
+		denoiser = std::make_shared<Denoiser>(denoiserNode);
+	if (pugi::xml_node restirDINode = rendererNode.child("ReSTIRDI"))
+		restirDI = std::make_shared<ReSTIRDI>(restirDINode);
+	if (pugi::xml_node backendNode = rendererNode.child("guidingBackend")) {
+		std::string backend = backendNode.attribute("value").value();
+		if (backend == "restirGI") pushConstant.guidingBackend = shaderio::FzbPathGuidingBackend_ReSTIRGI;
+		else if (backend != "octree") LOGW("FzbPathGuiding: unknown guidingBackend %s, use octree\n", backend.c_str());
+	}
+	guidingDataCache = GuidingDataCache_FzbPG(rendererNode);
+	//ReSTIRGIڵʱUIлʽԱͬʱµ
+	pugi::xml_node restirGINode = rendererNode.child("ReSTIRGI");
+	if (restirGINode || !useOctreeGuiding()) restirGI = std::make_shared<ReSTIRGI>(restirGINode);
 	//if (pugi::xml_node weightNode = rendererNode.child("Weight"))
 	//	weight = std::make_shared<FzbRenderer::Weight_FzbPG>(weightNode);
 }
@@ -47,6 +71,10 @@ void FzbPathGuidingRenderer::init() {
 		.asManager = &asManager,
 	};
 	octree->init(octreeCreateInfo);
+	loadGuidingDataCache();
+	if (denoiser) denoiser->init();
+	if (restirDI) restirDI->init();
+	if (restirGI) restirGI->init();
 
 	IF_DEBUG(Feature::createGBuffer(true, true, 1), Feature::createGBuffer(false, true, 1));
 	createDescriptorSetLayout();
@@ -60,6 +88,8 @@ void FzbPathGuidingRenderer::clean() {
 	rasterVoxelization->clean();
 	lightInject->clean();
 	octree->clean();
+	if (denoiser) denoiser->clean();
+	if (restirGI) restirGI->clean();
 
 	VkDevice device = Application::app->getDevice();
 	vkDestroyShaderEXT(device, computeShader_FzbPathGuiding, nullptr);
@@ -71,6 +101,7 @@ void FzbPathGuidingRenderer::uiRender() {
 
 	namespace PE = nvgui::PropertyEditor;
 	Application::viewportImage = gBuffers.getDescriptorSet(eImgTonemapped);
+	asManager.uiRender();
 
 	if (ImGui::Begin("FzbPathGuidingSettings"))
 	{
@@ -89,6 +120,14 @@ void FzbPathGuidingRenderer::uiRender() {
 			PE::end();
 		}
 
+		if (restirGI) {
+			ImGui::SeparatorText("Guiding");
+			PE::begin();
+			UIModified |= PE::Combo("Guiding Backend", &pushConstant.guidingBackend, "Octree\0ReSTIR GI\0", shaderio::FzbPathGuidingBackend_Count,
+				"Octree node pairs, or ReSTIR GI reuse of the secondary vertices");
+			PE::end();
+		}
+
 		if (ptContext.rtPosFetchFeature.rayTracingPositionFetch == VK_FALSE)
 		{
 			ImGui::TextColored({ 1, 0, 0, 1 }, "ERROR: Position Fetch not supported!");
@@ -104,11 +143,21 @@ void FzbPathGuidingRenderer::uiRender() {
 	}
 	ImGui::End();
 
-	rasterVoxelization->uiRender();
-	lightInject->uiRender();
-	octree->uiRender();
-
-	if (UIModified) resetFrame();
+	if (useOctreeGuiding()) {
+		rasterVoxelization->uiRender();
+		lightInject->uiRender();
+		octree->uiRender();
+	}
+	else restirGI->uiRender();
+	if (denoiser) denoiser->uiRender();
+	if (restirDI) restirDI->uiRender();
+
+	if (UIModified) {
+		resetFrame();
+		if (denoiser) denoiser->resetHistory();
+		if (restirDI) restirDI->resetHistory();
+		if (restirGI) restirGI->resetHistory();
+	}
 };
 void FzbPathGuidingRenderer::resize(VkCommandBuffer cmd, const VkExtent2D& size) {
 	NVVK_CHECK(gBuffers.update(cmd, size));
@@ -129,8 +178,12 @@ void FzbPathGuidingRenderer::resize(VkCommandBuffer cmd, const VkExtent2D& size)
 	IF_DEBUG(rasterVoxelization->resize(cmd, size, gBuffers, eImgTonemapped), rasterVoxelization->resize(cmd, size));
 	lightInject->resize(cmd, size);
 	IF_DEBUG(octree->resize(cmd, size, gBuffers, eImgTonemapped), octree->resize(cmd, size));
+	if (denoiser) denoiser->resize(cmd, size, gBuffers, eImgRendered);
+	if (restirDI) restirDI->resize(cmd, size, gBuffers, eImgRendered);
+	if (restirGI) restirGI->resize(cmd, size, gBuffers, eImgRendered);
 };
 void FzbPathGuidingRenderer::preRender() {
+	auto section = profileStage(nullptr, "PreRender");
 	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
 
 	Scene& scene = Application::sceneResource;
@@ -145,14 +198,33 @@ void FzbPathGuidingRenderer::preRender() {
 	pushConstant.VGBVoxelSize = shaderio::float3(rasterVoxelization->setting.pushConstant.voxelSize_Count);
 	asManager.updateToplevelAS(cmd);
 
+	//octree->preRenderڵԱת֮ǰһ֡Ľ
+	saveGuidingDataCache();
 	rasterVoxelization->preRender(cmd);
 	lightInject->preRender();
 	octree->preRender();
+	if (guidingDataCached) octree->pushConstant.randomRotateMatrix = cachedRandomRotateMatrix;
 
 	octree->pushConstant.maxFrameCount = maxFrames;
 
 	pushConstant.randomRotateMatrix = octree->pushConstant.randomRotateMatrix;
 
+	pushConstant.useDenoiser = denoiser && denoiser->enable ? 1 : 0;
+	if (pushConstant.useDenoiser) {
+		denoiser->preRender();
+		pushConstant.denoiserFeatures = denoiser->getFeatureAddress();
+	}
+	pushConstant.useReSTIRDI = restirDI && restirDI->enable ? 1 : 0;
+	if (pushConstant.useReSTIRDI) {
+		restirDI->preRender();
+		pushConstant.restirSurfaces = restirDI->getSurfaceAddress();
+	}
+	if (!useOctreeGuiding()) {
+		restirGI->preRender();
+		pushConstant.restirGISurfaces = restirGI->getSurfaceAddress();
+		pushConstant.restirGISamples = restirGI->getSampleAddress();
+	}
+
 	Application::app->submitAndWaitTempCmdBuffer(cmd);
 }
 void FzbPathGuidingRenderer::render(VkCommandBuffer cmd) {
@@ -161,26 +233,107 @@ void FzbPathGuidingRenderer::render(VkCommandBuffer cmd) {
 	updateDataPerFrame(cmd);
 	if (pushConstant.frameIndex >= maxFrames && maxFrames > 1) return;
 
-	rasterVoxelization->render(cmd);
-	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
-	lightInject->render(cmd);
-	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
-	octree->render(cmd);
-	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	//ReSTIR GIҪ˲ʽĸ׶ηֱʱRasterVoxelization/LightInject/OctreeReSTIRGI
+	//ݴӻʱߵĽѾڻ
+	if (useOctreeGuiding() && !guidingDataCached) {
+		rasterVoxelization->render(cmd);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		lightInject->render(cmd);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		octree->render(cmd);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	}
 
-	pathGuiding(cmd);
+	{
+		auto section = profileStage(cmd, "PathGuiding");
+		pathGuiding(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
-	Renderer::postProcess(cmd);
+	//ReSTIR GIļӹReSTIR DI֮ǰӵsurfaceϣ߶Ҫڽ֮ǰӵ
+	if (!useOctreeGuiding()) {
+		restirGI->render(cmd, asManager.asBuilder.tlas, maxFrames, pushConstant.useDenoiser ? denoiser->getFeatureAddress() : nullptr,
+			pushConstant.useReSTIRDI ? restirDI->getSurfaceAddress() : nullptr);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	}
+	if (pushConstant.useReSTIRDI) {
+		restirDI->render(cmd, asManager.asBuilder.tlas, maxFrames, pushConstant.useDenoiser ? denoiser->getFeatureAddress() : nullptr);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	}
+
+	//̬ʱʷȸmaxFrames֡ۼƵĽ
+	if (pushConstant.useDenoiser) {
+		denoiser->render(cmd, maxFrames > 1 ? maxFrames : denoiser->setting.maxHistoryLength);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	}
+
+	{
+		auto section = profileStage(cmd, "PostProcess");
+		Renderer::postProcess(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
 		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
-	rasterVoxelization->postProcess(cmd);
-	lightInject->postProcess(cmd);
-	octree->postProcess(cmd);
+	if (useOctreeGuiding()) {
+		rasterVoxelization->postProcess(cmd);
+		lightInject->postProcess(cmd);
+		octree->postProcess(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT);
 };
 
+std::vector<GuidingDataCacheBuffer_FzbPG> FzbPathGuidingRenderer::getGuidingDataCacheBuffers() {
+	std::vector<GuidingDataCacheBuffer_FzbPG> buffers;
+	//δĻ壨<Octree><permutation/>йرյĹܣд뻺
+	auto addBuffer = [&](const std::string& name, nvvk::Buffer& buffer) {
+		if (buffer.buffer != VK_NULL_HANDLE) buffers.push_back({ name, &buffer });
+		};
+	for (size_t i = 0; i < rasterVoxelization->VGBs.size(); ++i) addBuffer("VGB" + std::to_string(i), rasterVoxelization->VGBs[i]);
+	addBuffer("octreeData_G", octree->octreeDataBuffer_G);
+	addBuffer("octreeClusterData_G", octree->octreeClusterDataBuffer_G);
+	addBuffer("octreeClusterData_E", octree->octreeClusterDataBuffer_E);
+	addBuffer("clusterLayerData_E", octree->clusterLayerDataBuffer_E);
+	addBuffer("globalInfo", octree->globalInfoBuffer);
+	addBuffer("indivisibleNodeInfos_G", octree->indivisibleNodeInfosBuffer_G);
+	addBuffer("indivisibleNodeInfos_E", octree->indivisibleNodeInfosBuffer_E);
+	addBuffer("octreeNodePairWeight", octree->octreeNodePairWeightBuffer);
+	addBuffer("octreeNodePairAliasTable", octree->octreeNodePairAliasTableBuffer);
+	addBuffer("octreeNodePairData", octree->octreeNodePairDataBuffer);
+	addBuffer("nearbyNodeInfo", octree->nearbyNodeInfoBuffer);
+	return buffers;
+}
+void FzbPathGuidingRenderer::loadGuidingDataCache() {
+	if (!guidingDataCache.enable) return;
+	Scene& scene = Application::sceneResource;
+	if (scene.periodInstanceCount + scene.randomInstanceCount > 0 || scene.hasDynamicLight) {
+		LOGI("FzbPathGuiding: dynamic scene, guiding data cache disabled\n");
+		guidingDataCache.enable = false;
+		return;
+	}
+	guidingDataCache.init();
+
+	GuidingDataCacheState_FzbPG state;
+	if (!guidingDataCache.loadState(state)) return;
+	//ڵԻ˲ڵ㻺泡仯ȰʱؽСһ
+	octree->restoreNodePairSizes(state.nodePairWeightCapacity, state.nodePairDataCapacity, state.nodePairAliasCapacity, state.requiredNodePairSize);
+	octree->restoreOctreeBlockSizes(state.octreeBlockCapacity, state.requiredOctreeBlockCount);
+	guidingDataCached = guidingDataCache.loadBuffers(getGuidingDataCacheBuffers());
+	if (guidingDataCached) cachedRandomRotateMatrix = state.randomRotateMatrix;
+}
+void FzbPathGuidingRenderer::saveGuidingDataCache() {
+	if (!guidingDataCache.enable || guidingDataCached || guidingDataSaved || !useOctreeGuiding() || Application::frameIndex == 0) return;
+	//ȴһ֡ɣضĽڵԱСͬһ֡
+	vkDeviceWaitIdle(Application::app->getDevice());
+	if (!octree->isBufferSizeStable()) return;
+
+	GuidingDataCacheState_FzbPG state;
+	state.randomRotateMatrix = octree->pushConstant.randomRotateMatrix;
+	octree->getNodePairSizes(state.nodePairWeightCapacity, state.nodePairDataCapacity, state.nodePairAliasCapacity, state.requiredNodePairSize);
+	octree->getOctreeBlockSizes(state.octreeBlockCapacity, state.requiredOctreeBlockCount);
+	guidingDataSaved = guidingDataCache.save(getGuidingDataCacheBuffers(), state);
+	if (!guidingDataSaved) guidingDataCache.enable = false;	//дʧʱÿ֡
+}
+
 void FzbPathGuidingRenderer::createDescriptorSetLayout() {
 	SCOPED_TIMER(__FUNCTION__);
 	nvvk::DescriptorBindings bindings;
@@ -193,45 +346,23 @@ void FzbPathGuidingRenderer::createDescriptorSetLayout() {
 			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeData_G,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = (uint32_t)octree->octreeDataBuffer_G.size(),
-		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eClusterLayerData_E,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeNodePairData,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
-#endif
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeNodePairWeight,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eGlobalInfo,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#ifdef NEARBYNODE_JITTER_FZBPG
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeClusterData_G,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = (uint32_t)octree->octreeClusterDataBuffer_G.size(),
-		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eNearbyNodeInfos,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
-#endif
+	if (octree->permutation.nearbyNodeJitter) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eNearbyNodeInfos,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
 #ifndef NDEBUG
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::StaticBindingPoints_FzbPG::eDepthImage,
@@ -240,7 +371,7 @@ void FzbPathGuidingRenderer::createDescriptorSetLayout() {
 		.stageFlags = VK_SHADER_STAGE_ALL });
 #endif
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	LOGI("Fzb PathGuiding static descriptor layout created\n");
@@ -255,7 +386,31 @@ void FzbPathGuidingRenderer::createDescriptorSetLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	bindings.addBinding({
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeNodePairAliasTable,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	if (octree->permutation.adaptiveImportanceSampling) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeNodePairData,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+	bindings.addBinding({
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeData_G,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
+	if (octree->permutation.nearbyNodeJitter) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeClusterData_G,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("Fzb PathGuiding dynamic descriptor layout created\n");
 }
@@ -269,37 +424,18 @@ void FzbPathGuidingRenderer::createDescriptorSet() {
 	}
 
 	VkWriteDescriptorSet	OctreeArrayWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeData_G, 0, 0, octree->octreeDataBuffer_G.size());
-	nvvk::Buffer* octreeArraysPtr = octree->octreeDataBuffer_G.data();
-	write.append(OctreeArrayWrite, octreeArraysPtr);
-
-	OctreeArrayWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eClusterLayerData_E, 0, 0, 1);
 	write.append(OctreeArrayWrite, octree->clusterLayerDataBuffer_E, 0, octree->clusterLayerDataBuffer_E.bufferSize);
 
-	VkWriteDescriptorSet NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeNodePairWeight, 0, 0, 1);
-	write.append(NodePairInfoWrite, octree->octreeNodePairWeightBuffer, 0, octree->octreeNodePairWeightBuffer.bufferSize);
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeNodePairData, 0, 0, 1);
-	write.append(NodePairInfoWrite, octree->octreeNodePairDataBuffer, 0, octree->octreeNodePairDataBuffer.bufferSize);
-#endif
-
 	VkWriteDescriptorSet    GlobalInfoWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eGlobalInfo, 0, 0, 1);
 	write.append(GlobalInfoWrite, octree->globalInfoBuffer, 0, octree->globalInfoBuffer.bufferSize);
 
-#ifdef NEARBYNODE_JITTER_FZBPG
-	VkWriteDescriptorSet    OctreeClusterDataWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eOctreeClusterData_G, 0, 0, octree->octreeClusterDataBuffer_G.size());
-	nvvk::Buffer* octreeClusterDataPtr = octree->octreeClusterDataBuffer_G.data();
-	write.append(OctreeClusterDataWrite, octreeClusterDataPtr);
-
-	VkWriteDescriptorSet    NearbyDataWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eNearbyNodeInfos, 0, 0, 1);
-	write.append(NearbyDataWrite, octree->nearbyNodeInfoBuffer, 0, octree->nearbyNodeInfoBuffer.bufferSize);
-#endif
+	if (octree->permutation.nearbyNodeJitter) {
+		VkWriteDescriptorSet    NearbyDataWrite =
+			staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_FzbPG::eNearbyNodeInfos, 0, 0, 1);
+		write.append(NearbyDataWrite, octree->nearbyNodeInfoBuffer, 0, octree->nearbyNodeInfoBuffer.bufferSize);
+	}
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
 }
@@ -321,12 +457,23 @@ void FzbPathGuidingRenderer::createPipelineLayout() {
 	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
 	NVVK_DBG_NAME(pipelineLayout);
 }
+void FzbPathGuidingRenderer::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "FzbPathGuiding.slang", .macros = octree->permutation.getMacros() });
+	rasterVoxelization->collectShaderRequests(requests);
+	lightInject->collectShaderRequests(requests);
+	octree->collectShaderRequests(requests);
+	if (denoiser) denoiser->collectShaderRequests(requests);
+	if (restirDI) restirDI->collectShaderRequests(requests);
+	if (restirGI) restirGI->collectShaderRequests(requests);
+}
 void FzbPathGuidingRenderer::compileAndCreateShaders() {
 	SCOPED_TIMER(__FUNCTION__);
 
 	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
 	std::filesystem::path shaderSource = shaderPath / "FzbPathGuiding.slang";
+	octree->permutation.addMacros();
 	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+	Application::slangCompiler.clearMacros();
 
 	const VkPushConstantRange pushConstantRange{
 		.stageFlags = VK_SHADER_STAGE_ALL ,
@@ -354,7 +501,7 @@ void FzbPathGuidingRenderer::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_FzbPathGuiding";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_FzbPathGuiding);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_FzbPathGuiding);
 		NVVK_DBG_NAME(computeShader_FzbPathGuiding);
 	}
 };
@@ -372,6 +519,17 @@ void FzbPathGuidingRenderer::pathGuiding(VkCommandBuffer cmd) {
 
 	nvvk::WriteSetContainer write{};
 	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), asManager.asBuilder.tlas);
+	//octreeĽڵԻڵ㻺preRender´
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeNodePairAliasTable),
+		octree->octreeNodePairAliasTableBuffer, 0, octree->octreeNodePairAliasTableBuffer.bufferSize);
+	if (octree->permutation.adaptiveImportanceSampling)
+		write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeNodePairData),
+			octree->octreeNodePairDataBuffer, 0, octree->octreeNodePairDataBuffer.bufferSize);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeData_G),
+		octree->octreeDataBuffer_G, 0, octree->octreeDataBuffer_G.bufferSize);
+	if (octree->permutation.nearbyNodeJitter)
+		write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_FzbPG::eOctreeClusterData_G),
+			octree->octreeClusterDataBuffer_G, 0, octree->octreeClusterDataBuffer_G.bufferSize);
 	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 1, write.size(), write.data());
 
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
@@ -5,6 +5,9 @@
 #include "RasterVoxelization/RasterVoxelization_FzbPG.h"
 #include "LightInject/LightInject_FzbPG.h"
 #include "Octree/Octree_FzbPG.h"
+#include "GuidingDataCache/GuidingDataCache_FzbPG.h"
+#include "feature/Denoiser/Denoiser.h"
+#include "feature/ReSTIRGI/ReSTIRGI.h"
 
 #ifndef FZBRENDERER_FZB_PATHGUIDING_H
 #define FZBRENDERER_FZB_PATHGUIDING_H
@@ -28,16 +31,30 @@ public:
 	void createDescriptorSet();
 	void createPipelineLayout();
 	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
 	void updateDataPerFrame(VkCommandBuffer cmd) override;
 
 	void pathGuiding(VkCommandBuffer cmd);
+	bool useOctreeGuiding() const { return pushConstant.guidingBackend == shaderio::FzbPathGuidingBackend_Octree; }
 private:
 	std::shared_ptr<RasterVoxelization_FzbPG> rasterVoxelization;
 	std::shared_ptr<LightInject_FzbPG> lightInject;
 	std::shared_ptr<Octree_FzbPG> octree;
+	std::shared_ptr<Denoiser> denoiser;
+	std::shared_ptr<ReSTIRGI> restirGI;		//guidingBackendΪrestirGIʱػע˲
 
 	shaderio::FzbPathGuidingPushConstant pushConstant{};
 	VkShaderEXT computeShader_FzbPathGuiding{};
+
+	//̬ݻ棺ʱػע˲renderδʱڵһڵԱȶ֡д
+	std::vector<GuidingDataCacheBuffer_FzbPG> getGuidingDataCacheBuffers();
+	void loadGuidingDataCache();
+	void saveGuidingDataCache();
+
+	GuidingDataCache_FzbPG guidingDataCache;
+	bool guidingDataCached = false;
+	bool guidingDataSaved = false;
+	glm::mat3 cachedRandomRotateMatrix = glm::mat3(1.0f);
 };
 }
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <common/Shader/shaderStructType.h>
+#include <feature/Denoiser/shaderio.h>
+#include <feature/ReSTIRDI/shaderio.h>
+#include <feature/ReSTIRGI/shaderio.h>
 
 #ifndef FZBRENDERER_FZB_PATHGUIDING_SHADER_IO_H
 #define FZBRENDERER_FZB_PATHGUIDING_SHADER_IO_H
@@ -8,16 +11,29 @@ NAMESPACE_SHADERIO_BEGIN()
 
 //#define GEOMETRY_CLUSTER_WITH_E
 
+// the guiding shaders are compiled with FZBPG_PERMUTATION and the macros chosen in rendererInfo.xml <Octree><permutation/>,
+// the defaults below are only used when the header is included without them (host code, other features)
+#ifndef FZBPG_PERMUTATION
 #define ADAPTIVE_IMPORTANCE_SAMPLING	//Adaptive importance sampling
+#define NEARBYNODE_JITTER_FZBPG
+#endif
 #define HITTEST_COUNT_PER_CHILDNODE_FZBPG 4		//must <= 4
 #define ADAPTIVE_IMPORTANCE_SAMPLING_MAX_LAYER 3
 
-#define NEARBYNODE_JITTER_FZBPG
+#ifndef NEARBY_NODE_COUNT_FZBPG
 #define NEARBY_NODE_COUNT_FZBPG 8
+#endif
 
 #define FZB_PATHGUIDING_THREADGROUP_SIZE_X 16
 #define FZB_PATHGUIDING_THREADGROUP_SIZE_Y 16
 
+// how the first bounce of the paths is guided, rendererInfo.xml <guidingBackend value = "octree" /> or "restirGI"
+enum FzbPathGuidingBackend {
+	FzbPathGuidingBackend_Octree = 0,		// mixture of the bsdf and the octree node pairs at every bounce
+	FzbPathGuidingBackend_ReSTIRGI = 1,		// bsdf sampling, the secondary vertices of the first sample are resampled by ReSTIR GI
+	FzbPathGuidingBackend_Count
+};
+
 struct FzbPathGuidingPushConstant
 {
 	float3x3 randomRotateMatrix;
@@ -32,23 +48,22 @@ struct FzbPathGuidingPushConstant
 	SceneInfo* sceneInfoAddress;
 	uint2 sceneSize;
 	uint2 threadGroupCount;
+	DenoiserFeature* denoiserFeatures;
+	int useDenoiser = 0;			// write the frame to denoiserFeatures and leave outImage to the denoiser
+	ReSTIRDISurface* restirSurfaces;
+	int useReSTIRDI = 0;			// the direct lighting of the primary hits is added by ReSTIR DI
+	ReSTIRGISurface* restirGISurfaces;
+	ReSTIRGISample* restirGISamples;
+	int guidingBackend = FzbPathGuidingBackend_Octree;
 };
 
 enum class StaticBindingPoints_FzbPG
 {
 	//eTextures = 0,
 	//eOutImage = 1,
-	eOctreeData_G = 2,
-	eClusterLayerData_E,
-	eOctreeNodePairWeight,
+	eClusterLayerData_E = 2,
 	eGlobalInfo,
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	eOctreeNodePairData,
-#endif
-#ifdef NEARBYNODE_JITTER_FZBPG
-	eOctreeClusterData_G,
-	eNearbyNodeInfos,
-#endif
+	eNearbyNodeInfos,			// only bound with NEARBYNODE_JITTER_FZBPG, the binding points don't depend on the permutation
 #ifndef NDEBUG
 	eDepthImage,
 #endif
@@ -56,6 +71,10 @@ enum class StaticBindingPoints_FzbPG
 enum class DynamicBindingPoints_FzbPG {
 	//eTlas_SVOPG = 0,
 	eSVOTlas_SVOPG = 1,
+	eOctreeNodePairAliasTable,	// the octree node pair buffers and node buffers are recreated when their capacity changes, pushed every frame
+	eOctreeNodePairData,		// only bound with ADAPTIVE_IMPORTANCE_SAMPLING
+	eOctreeData_G,
+	eOctreeClusterData_G,		// only bound with NEARBYNODE_JITTER_FZBPG
 };
 struct GlobalInfo_FzbPG {
 	uint SVOMaxLayer_G;
@@ -0,0 +1,280 @@
+#include "./GuidingDataCache_FzbPG.h"
+#include <common/Application/Application.h>
+#include <nvvk/barriers.hpp>
+#include <nvutils/file_operations.hpp>
+#include <nvutils/timers.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace FzbRenderer;
+
+static constexpr char GUIDING_DATA_CACHE_MAGIC[8] = { 'F', 'Z', 'B', 'P', 'G', 'G', 'D', 'C' };
+static constexpr uint32_t GUIDING_DATA_CACHE_VERSION = 3;
+
+static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+	//FNV-1aҪȶԲʹstd::hash
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+template<typename T>
+static void hashValue(uint64_t& hash, const T& value) {
+	hashBytes(hash, &value, sizeof(T));
+}
+static void hashString(uint64_t& hash, const std::string& str) {
+	hashBytes(hash, str.data(), str.size());
+	hashBytes(hash, "\0", 1);
+}
+static void hashFile(uint64_t& hash, const std::filesystem::path& filePath) {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		hashString(hash, filePath.string());
+		return;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	hashString(hash, buffer.str());
+}
+//Աhashṹpadding
+static void hashInstance(uint64_t& hash, const shaderio::Instance& instance) {
+	hashValue(hash, instance.transform);
+	hashValue(hash, instance.materialIndex);
+	hashValue(hash, instance.meshIndex);
+}
+static void hashMaterial(uint64_t& hash, const shaderio::BSDFMaterial& material) {
+	hashValue(hash, material.type);
+	hashValue(hash, material.albedo);
+	hashValue(hash, material.emissive);
+	hashValue(hash, material.eta);
+	hashValue(hash, material.roughness);
+	hashValue(hash, material.materialMapIndex);
+}
+//LightpaddingûгʼԱhash
+static void hashLight(uint64_t& hash, const shaderio::Light& light) {
+	hashValue(hash, light.pos);
+	hashValue(hash, light.type);
+	hashValue(hash, light.direction);
+	hashValue(hash, light.intensity);
+	hashValue(hash, light.color);
+	hashValue(hash, light.coneAngle);
+	hashValue(hash, light.edge1);
+	hashValue(hash, light.SphericalRectangleSample);
+	hashValue(hash, light.edge2);
+}
+static uint64_t hashScene() {
+	Scene& sceneResource = Application::sceneResource;
+	uint64_t hash = 14695981039346656037ull;
+	for (const MeshSet& meshSet : sceneResource.meshSets) {
+		hashValue(hash, meshSet.meshByteData.size());
+		hashBytes(hash, meshSet.meshByteData.data(), meshSet.meshByteData.size());
+	}
+	//Mesh::dataBuffer豸ַÿжͬ
+	for (const shaderio::Mesh& mesh : sceneResource.meshes) {
+		hashValue(hash, mesh.triMesh);
+		hashValue(hash, mesh.indexType);
+	}
+	hashValue(hash, sceneResource.instances.size());
+	for (const shaderio::Instance& instance : sceneResource.instances) hashInstance(hash, instance);
+	hashValue(hash, sceneResource.materials.size());
+	for (const shaderio::BSDFMaterial& material : sceneResource.materials) hashMaterial(hash, material);
+
+	std::vector<std::pair<int, std::filesystem::path>> texturePaths;
+	for (const auto& [texturePath, textureIndex] : sceneResource.texturePathToIndex) texturePaths.push_back({ textureIndex, texturePath });
+	std::sort(texturePaths.begin(), texturePaths.end());
+	for (const auto& texturePath : texturePaths) hashFile(hash, texturePath.second);
+
+	const shaderio::SceneInfo& sceneInfo = sceneResource.sceneInfo;
+	hashValue(hash, sceneInfo.useSky);
+	hashValue(hash, sceneInfo.backgroundColor);
+	hashValue(hash, sceneInfo.skySimpleParam);
+	hashValue(hash, sceneInfo.numLights);
+	for (int i = 0; i < sceneInfo.numLights; ++i) hashLight(hash, sceneInfo.lights[i]);
+	for (const LightInstance& lightInstance : sceneResource.lightInstances) hashLight(hash, lightInstance.light);
+	return hash;
+}
+static bool readHeader(std::ifstream& file, uint64_t key, GuidingDataCacheState_FzbPG& state) {
+	char magic[8];
+	uint32_t version = 0;
+	uint64_t fileKey = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+	file.read(reinterpret_cast<char*>(&state), sizeof(state));
+	return file.good() && memcmp(magic, GUIDING_DATA_CACHE_MAGIC, sizeof(magic)) == 0 &&
+		version == GUIDING_DATA_CACHE_VERSION && fileKey == key;
+}
+
+GuidingDataCache_FzbPG::GuidingDataCache_FzbPG(pugi::xml_node& rendererNode) {
+	pugi::xml_node cacheNode = rendererNode.child("guidingDataCache");
+	enable = std::string(cacheNode.attribute("value").value()) == "true";
+	std::filesystem::path exeDir = nvutils::getExecutablePath().parent_path();
+	if (pugi::xml_attribute pathAttribute = cacheNode.attribute("path")) cacheDir = exeDir / pathAttribute.value();
+	else cacheDir = exeDir / "guidingCache";
+
+	//ֻhashӰݵĽڵ㣬롢ReSTIRñ仯ʱȻЧ
+	settingHash = 14695981039346656037ull;
+	for (const char* featureName : { "RasterVoxelization", "LightInject", "Octree" }) {
+		std::ostringstream featureStream;
+		rendererNode.child(featureName).print(featureStream, "", pugi::format_raw);
+		hashString(settingHash, featureStream.str());
+	}
+}
+void GuidingDataCache_FzbPG::init() {
+	if (!enable) return;
+	SCOPED_TIMER(__FUNCTION__);
+	key = 14695981039346656037ull;
+	hashValue(key, GUIDING_DATA_CACHE_VERSION);
+	hashValue(key, settingHash);
+	uint64_t sceneHash = hashScene();
+	hashValue(key, sceneHash);
+
+	std::filesystem::path rendererDir = std::filesystem::path(__FILE__).parent_path().parent_path();
+	for (const std::filesystem::path& shaderSource : {
+		rendererDir / "RasterVoxelization" / "shaders" / "RasterVoxelization.slang",
+		rendererDir / "LightInject" / "shaders" / "LightInject.slang",
+		rendererDir / "Octree" / "shaders" / "Octree2.slang",
+		rendererDir / "Octree" / "shaders" / "GetOctreeIndivisibleNodeLabel.slang",
+		rendererDir / "Octree" / "shaders" / "GetNearbyNodeInfo.slang" })
+		hashValue(key, Application::shaderCache.getSourceHash(shaderSource));
+#ifndef NDEBUG
+	hashString(key, "debug");	//debugػͼ·
+#endif
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(cacheDir, errorCode);
+	if (errorCode) LOGW("޷ݻĿ¼: %s\n", cacheDir.string().c_str());
+}
+std::filesystem::path GuidingDataCache_FzbPG::getCachePath() const {
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.fzbpg", (unsigned long long)key);
+	return cacheDir / fileName;
+}
+
+bool GuidingDataCache_FzbPG::loadState(GuidingDataCacheState_FzbPG& state) {
+	if (!enable) return false;
+	std::ifstream file(getCachePath(), std::ios::binary);
+	if (!file.is_open()) return false;
+	if (!readHeader(file, key, state)) {
+		LOGW("ݻʽ: %s\n", getCachePath().string().c_str());
+		return false;
+	}
+	return true;
+}
+bool GuidingDataCache_FzbPG::loadBuffers(const std::vector<GuidingDataCacheBuffer_FzbPG>& buffers) {
+	SCOPED_TIMER(__FUNCTION__);
+	std::ifstream file(getCachePath(), std::ios::binary);
+	GuidingDataCacheState_FzbPG state;
+	if (!file.is_open() || !readHeader(file, key, state)) return false;
+
+	uint32_t bufferCount = 0;
+	file.read(reinterpret_cast<char*>(&bufferCount), sizeof(bufferCount));
+	if (!file.good() || bufferCount != buffers.size()) {
+		LOGW("ݻĻ: %u, Ҫ%zu\n", bufferCount, buffers.size());
+		return false;
+	}
+
+	//Улͷϴⲿֻ屻
+	std::vector<std::streamoff> dataOffsets(bufferCount);
+	for (uint32_t i = 0; i < bufferCount; ++i) {
+		uint32_t nameLength = 0;
+		uint64_t byteSize = 0;
+		file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+		std::string name(nameLength, '\0');
+		file.read(name.data(), nameLength);
+		file.read(reinterpret_cast<char*>(&byteSize), sizeof(byteSize));
+		if (!file.good() || name != buffers[i].name || byteSize != buffers[i].buffer->bufferSize) {
+			LOGW("ݻĻ%s\n", buffers[i].name.c_str());
+			return false;
+		}
+		dataOffsets[i] = file.tellg();
+		file.seekg(std::streamoff(byteSize), std::ios::cur);
+	}
+	if (!file.good()) return false;
+
+	nvvk::StagingUploader& stagingUploader = Application::stagingUploader;
+	for (uint32_t i = 0; i < bufferCount; ++i) {
+		void* mapping = nullptr;
+		NVVK_CHECK(stagingUploader.appendBufferMapping(*buffers[i].buffer, 0, buffers[i].buffer->bufferSize, mapping));
+		file.seekg(dataOffsets[i]);
+		file.read(static_cast<char*>(mapping), std::streamsize(buffers[i].buffer->bufferSize));
+	}
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	stagingUploader.releaseStaging();
+	if (!file.good()) {
+		LOGW("ݻȡʧ: %s\n", getCachePath().string().c_str());
+		return false;
+	}
+	LOGI("ݻ: %s\n", getCachePath().string().c_str());
+	return true;
+}
+bool GuidingDataCache_FzbPG::save(const std::vector<GuidingDataCacheBuffer_FzbPG>& buffers, const GuidingDataCacheState_FzbPG& state) {
+	if (!enable) return false;
+	SCOPED_TIMER(__FUNCTION__);
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+
+	VkDeviceSize totalSize = 0;
+	for (const GuidingDataCacheBuffer_FzbPG& buffer : buffers) totalSize += buffer.buffer->bufferSize;
+	nvvk::Buffer stageBuffer;
+	allocator->createBuffer(stageBuffer, std::max<VkDeviceSize>(totalSize, 4), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(stageBuffer.buffer);
+
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	VkDeviceSize offset = 0;
+	for (const GuidingDataCacheBuffer_FzbPG& buffer : buffers) {
+		VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2, .srcOffset = 0, .dstOffset = offset, .size = buffer.buffer->bufferSize };
+		VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2, .srcBuffer = buffer.buffer->buffer,
+			.dstBuffer = stageBuffer.buffer, .regionCount = 1, .pRegions = &region };
+		vkCmdCopyBuffer2(cmd, &copyInfo);
+		offset += buffer.buffer->bufferSize;
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	vmaInvalidateAllocation(*allocator, stageBuffer.allocation, 0, VK_WHOLE_SIZE);
+
+	std::filesystem::path cachePath = getCachePath();
+	std::filesystem::path tempPath = cachePath;
+	tempPath += ".tmp";
+	bool succeeded = false;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (file.is_open()) {
+			file.write(GUIDING_DATA_CACHE_MAGIC, sizeof(GUIDING_DATA_CACHE_MAGIC));
+			file.write(reinterpret_cast<const char*>(&GUIDING_DATA_CACHE_VERSION), sizeof(GUIDING_DATA_CACHE_VERSION));
+			file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+			file.write(reinterpret_cast<const char*>(&state), sizeof(state));
+			uint32_t bufferCount = uint32_t(buffers.size());
+			file.write(reinterpret_cast<const char*>(&bufferCount), sizeof(bufferCount));
+
+			offset = 0;
+			for (const GuidingDataCacheBuffer_FzbPG& buffer : buffers) {
+				uint32_t nameLength = uint32_t(buffer.name.size());
+				uint64_t byteSize = buffer.buffer->bufferSize;
+				file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+				file.write(buffer.name.data(), nameLength);
+				file.write(reinterpret_cast<const char*>(&byteSize), sizeof(byteSize));
+				file.write(reinterpret_cast<const char*>(stageBuffer.mapping + offset), std::streamsize(byteSize));
+				offset += byteSize;
+			}
+			succeeded = file.good();
+		}
+	}
+	allocator->destroyBuffer(stageBuffer);
+
+	std::error_code errorCode;
+	if (succeeded) std::filesystem::rename(tempPath, cachePath, errorCode);
+	if (!succeeded || errorCode) {
+		std::filesystem::remove(tempPath, errorCode);
+		LOGW("޷дݻ: %s\n", cachePath.string().c_str());
+		return false;
+	}
+	LOGI("ݻ: %s, %.2f MB\n", cachePath.string().c_str(), totalSize / (1024.0 * 1024.0));
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <nvvk/resources.hpp>
+#include <pugixml.hpp>
+#include <glm/glm.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef FZBRENDERER_GUIDING_DATA_CACHE_FZBPG_H
+#define FZBRENDERER_GUIDING_DATA_CACHE_FZBPG_H
+
+namespace FzbRenderer {
+struct GuidingDataCacheBuffer_FzbPG {
+	std::string name;
+	nvvk::Buffer* buffer = nullptr;
+};
+//⣬غҪָ״̬
+struct GuidingDataCacheState_FzbPG {
+	glm::mat3 randomRotateMatrix = glm::mat3(1.0f);		//ɻһ֡ĳ䷽תغ·̶ʹ
+	uint32_t nodePairWeightCapacity = 0;				//ڵԻǰؽ
+	uint32_t nodePairDataCapacity = 0;
+	uint32_t nodePairAliasCapacity = 0;
+	uint32_t requiredNodePairSize[3] = { 0, 0, 0 };		//GPUͳƵʵСдػض壬ʹ˲ٵ
+	uint32_t octreeBlockCapacity = 0;					//˲ڵ㻺Ŀǰؽ
+	uint32_t requiredOctreeBlockCount = 0;
+};
+/*
+̬ݣVGB˲ǩڵȨaliasڽڵϢĴ̻
+1. key = hash( + rendererInfo.xmlRasterVoxelizationLightInjectOctreeڵ + Щ׶εshaderԴļincludeհ)
+	ݰmeshݡʵʡļԴӰݣhash
+2. ļΪcacheDir/<key>.fzbpgֱÿֽڣʱ֡СڵԻ˲ڵ㻺Ȱؽһ²
+3. ÿ֡xxhash(frameIndex)תɣһ֡Ľغػע˲render
+	·ʹûһ֡תȻƫģֻǲ֡ı䷽ɢ
+4. ֻû/ʵͶ̬Դĳ
+*/
+class GuidingDataCache_FzbPG {
+public:
+	GuidingDataCache_FzbPG() = default;
+	~GuidingDataCache_FzbPG() = default;
+
+	//ȡrendererNodeе<guidingDataCache>ڵ㣬hashӰݵFeatureڵ
+	GuidingDataCache_FzbPG(pugi::xml_node& rendererNode);
+
+	//볡shaderhashõkeyҪѾ
+	void init();
+	//ȡļͷȱʧʽʱfalse
+	bool loadState(GuidingDataCacheState_FzbPG& state);
+	//ѻϴbuffersbuffers֡˳СҪ뱣ʱһ
+	bool loadBuffers(const std::vector<GuidingDataCacheBuffer_FzbPG>& buffers);
+	//ضbuffersд뻺ļдʱļжʱ²Ļ
+	bool save(const std::vector<GuidingDataCacheBuffer_FzbPG>& buffers, const GuidingDataCacheState_FzbPG& state);
+
+	bool enable = false;
+	uint64_t key = 0;
+	std::filesystem::path cacheDir;
+private:
+	uint64_t settingHash = 0;
+
+	std::filesystem::path getCachePath() const;
+};
+}
+
+#endif
@@ -18,6 +18,10 @@ struct LightInjectPushConstant_FzbPG {
 	SceneInfo* sceneInfoAddress;
 	float3x3 randomRotateMatrix;
 	float time;
+	uint amortization;			// 0: every occupied voxel traces LIGHTINJECT_SAMPLE_COUNT rays and overwrites its irradiance
+	uint voxelSubsetCount;		// voxels traced this frame: (voxelIndex_atAll + frameIndex) % voxelSubsetCount == 0
+	uint raysPerVoxel;			// divides LIGHTINJECT_SAMPLE_COUNT, the Fibonacci set is interleaved over the passes
+	uint maxHistoryLength;		// 0: cumulative average, otherwise exponential moving average with alpha = 1 / maxHistoryLength
 #ifndef NDEBUG
 	uint normalIndex;
 #endif
@@ -26,6 +30,7 @@ enum class StaticBindingPoints_LightInject_FzbPG {
 	eVGB = 2,
 	eHasGeometryVoxelInfo,
 	eGlobalInfo,
+	eHistory,
 };
 
 struct HasGeometryVoxelInfo {
@@ -36,6 +41,11 @@ struct LightInjectGlobalInfo {
 	uint hasGeometryVoxelCount;
 };
 
+// Amortized light injection keeps the averaged irradiance of every voxel, because the VGB is cleared each frame
+struct LightInjectHistory {
+	float4 irradiance_length;	// xyz: averaged irradiance, w: history length (0 = no history)
+};
+
 #define LIGHTINJECT_CS_THREADGROUP_SIZE 256
 
 NAMESPACE_SHADERIO_END()
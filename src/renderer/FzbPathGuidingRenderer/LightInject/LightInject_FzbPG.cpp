@@ -10,11 +10,25 @@
 using namespace FzbRenderer;
 
 LightInject_FzbPG::LightInject_FzbPG(pugi::xml_node& featureNode) {
+	profileName = "LightInject";
 #ifndef NDEBUG
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().geometryShader = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().fillModeNonSolid = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().wideLines = VK_TRUE;
 #endif
+	if (pugi::xml_node amortizationNode = featureNode.child("amortization")) {
+		amortization.enable = std::string(amortizationNode.attribute("value").value()) == "true";
+		if (pugi::xml_attribute attribute = amortizationNode.attribute("voxelSubsets")) amortization.voxelSubsetCount = std::max(std::stoi(attribute.value()), 1);
+		if (pugi::xml_attribute attribute = amortizationNode.attribute("raysPerVoxel")) amortization.raysPerVoxel = std::stoi(attribute.value());
+		if (pugi::xml_attribute attribute = amortizationNode.attribute("maxHistory")) amortization.maxHistoryLength = std::stoi(attribute.value());
+		if (pugi::xml_attribute attribute = amortizationNode.attribute("dynamicMaxHistory")) amortization.dynamicMaxHistoryLength = std::max(std::stoi(attribute.value()), 1);
+	}
+	//ÿֵĹҪܾFibonacci㼯ȡڸֵLIGHTINJECT_SAMPLE_COUNTԼ
+	uint32_t raysPerVoxel = std::clamp(amortization.raysPerVoxel, 1u, (uint32_t)LIGHTINJECT_SAMPLE_COUNT);
+	while (LIGHTINJECT_SAMPLE_COUNT % raysPerVoxel != 0) --raysPerVoxel;
+	if (amortization.enable && raysPerVoxel != amortization.raysPerVoxel)
+		LOGW("LightInject: raysPerVoxel %u does not divide %d, use %u\n", amortization.raysPerVoxel, LIGHTINJECT_SAMPLE_COUNT, raysPerVoxel);
+	amortization.raysPerVoxel = raysPerVoxel;
 }
 void LightInject_FzbPG::init(LightInjectCreateInfo_FzbPG setting) {
 	this->setting = setting;
@@ -47,6 +61,7 @@ void LightInject_FzbPG::clean() {
 
 	Application::allocator.destroyBuffer(hasGeometryVoxelInfoBuffer);
 	Application::allocator.destroyBuffer(globalInfoBuffer);
+	Application::allocator.destroyBuffer(historyBuffer);
 
 #ifndef NDEBUG
 	vkDestroyShaderEXT(device, vertexShader_Cube, nullptr);
@@ -106,11 +121,26 @@ void LightInject_FzbPG::preRender() {
 	pushConstant.time = Application::sceneResource.time;
 	pushConstant.sceneInfoAddress = (shaderio::SceneInfo*)Application::sceneResource.bSceneInfo.address;
 
-	float angle = FzbRenderer::rand(Application::frameIndex) * glm::two_pi<float>();
+	pushConstant.amortization = amortization.enable ? 1 : 0;
+	if (amortization.enable) {
+		Scene& scene = Application::sceneResource;
+		bool dynamicScene = scene.periodInstanceCount + scene.randomInstanceCount > 0 || scene.hasDynamicLight;
+		//̬ļԴÿ֡ڱ䣬ʷʧȥ˷̯壬ý϶̵EMA仯
+		resetHistory |= Application::UIModified;
+		if (resetHistory) amortizedFrameIndex = 0;
+
+		pushConstant.frameIndex = amortizedFrameIndex++;
+		pushConstant.voxelSubsetCount = amortization.voxelSubsetCount;
+		pushConstant.raysPerVoxel = amortization.raysPerVoxel;
+		pushConstant.maxHistoryLength = dynamicScene ? amortization.dynamicMaxHistoryLength : amortization.maxHistoryLength;
+	}
+
+	float angle = FzbRenderer::rand(pushConstant.frameIndex) * glm::two_pi<float>();
 	pushConstant.randomRotateMatrix = glm::mat3(glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0, 0, 1)));
 }
 void LightInject_FzbPG::render(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd);
+	auto section = profileStage(cmd, "Render");
 
 	updateDataPerFrame(cmd);
 
@@ -130,6 +160,11 @@ void LightInject_FzbPG::render(VkCommandBuffer cmd) {
 	};
 	vkCmdPushConstants2(cmd, &pushInfo);
 
+	if (amortization.enable && resetHistory) {
+		vkCmdFillBuffer(cmd, historyBuffer.buffer, 0, historyBuffer.bufferSize, 0);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		resetHistory = false;
+	}
 	getHasGeometryVoxels(cmd);
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
 	lightInject(cmd);
@@ -154,6 +189,11 @@ void LightInject_FzbPG::createBuffer() {
 	allocator->createBuffer(globalInfoBuffer, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_2_INDIRECT_BUFFER_BIT);
 	NVVK_DBG_NAME(globalInfoBuffer.buffer);
+
+	bufferSize = (amortization.enable ? voxelTotalCount : 1) * sizeof(shaderio::LightInjectHistory);
+	allocator->createBuffer(historyBuffer, bufferSize,
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT);
+	NVVK_DBG_NAME(historyBuffer.buffer);
 }
 void LightInject_FzbPG::createDescriptorSetLayout() {
 	SCOPED_TIMER(__FUNCTION__);
@@ -182,8 +222,13 @@ void LightInject_FzbPG::createDescriptorSetLayout() {
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
+	bindings.addBinding({
+		.binding = (uint32_t)shaderio::StaticBindingPoints_LightInject_FzbPG::eHistory,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	LOGI("LightInject ray tracing static descriptor layout created\n");
@@ -198,7 +243,7 @@ void LightInject_FzbPG::createDescriptorSetLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("LightInject ray tracing dynamic descriptor layout created\n");
 }
@@ -224,6 +269,10 @@ void LightInject_FzbPG::createDescriptorSet() {
 		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_LightInject_FzbPG::eGlobalInfo, 0, 0, 1);
 	write.append(globalInfoWrite, globalInfoBuffer, 0, globalInfoBuffer.bufferSize);
 
+	VkWriteDescriptorSet    historyWrite =
+		staticDescPack.makeWrite((uint32_t)shaderio::StaticBindingPoints_LightInject_FzbPG::eHistory, 0, 0, 1);
+	write.append(historyWrite, historyBuffer, 0, historyBuffer.bufferSize);
+
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
 }
 void LightInject_FzbPG::createPipeline() {
@@ -244,6 +293,9 @@ void LightInject_FzbPG::createPipeline() {
 	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
 	NVVK_DBG_NAME(pipelineLayout);
 }
+void LightInject_FzbPG::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "LightInject.slang" });
+}
 void LightInject_FzbPG::compileAndCreateShaders() {
 	SCOPED_TIMER(__FUNCTION__);
 
@@ -276,7 +328,7 @@ void LightInject_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getHasGeometryVoxels";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getHasGeometryVoxels);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getHasGeometryVoxels);
 	NVVK_DBG_NAME(computeShader_getHasGeometryVoxels);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_setDispatchIndirectCommand, nullptr);
@@ -286,7 +338,7 @@ void LightInject_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_setDispatchIndirectCommand";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_setDispatchIndirectCommand);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_setDispatchIndirectCommand);
 	NVVK_DBG_NAME(computeShader_setDispatchIndirectCommand);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_LightInject, nullptr);
@@ -296,7 +348,7 @@ void LightInject_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_LightInject";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_LightInject);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_LightInject);
 	NVVK_DBG_NAME(computeShader_LightInject);
 	//--------------------------------------------------------------------------------------
 #ifndef NDEBUG
@@ -308,7 +360,7 @@ void LightInject_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Cube);
 	NVVK_DBG_NAME(vertexShader_Cube);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -316,7 +368,7 @@ void LightInject_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Cube);
 	NVVK_DBG_NAME(fragmentShader_Cube);
 #endif
 }
@@ -16,6 +16,21 @@ struct LightInjectCreateInfo_FzbPG {
 	PathTracingContext* ptContext;
 	AccelerationStructureManager* asManager;
 };
+/*
+̯ע룺ÿֻ֡׷һأÿֻһֹߣÿصʷϲ
+1. VGBķնÿ֡գʷhistoryBufferУ֡δѡеgetHasGeometryVoxelsаʷдVGB
+2. ѡеΪ(voxelIndex_atAll + frameIndex) % voxelSubsetCount == 0أûʷÿ֡׷
+3. ÿصraysPerVoxelִ߰νȡFibonacci㼯ĲͬӼټÿ֡ת֮󸲸з
+4. maxHistoryLengthΪ0ʱۼƽΪEMAж̬ʵ̬ԴĳʹdynamicMaxHistoryLength
+5. UI޸ģԴաʵȣʱʷزмʱgetHasGeometryVoxelsʷ
+*/
+struct LightInjectAmortizationSetting_FzbPG {
+	bool enable = false;
+	uint32_t voxelSubsetCount = 4;
+	uint32_t raysPerVoxel = LIGHTINJECT_SAMPLE_COUNT;
+	uint32_t maxHistoryLength = 0;
+	uint32_t dynamicMaxHistoryLength = 8;
+};
 class LightInject_FzbPG : public PathTracing {
 public:
 	LightInject_FzbPG() = default;
@@ -36,6 +51,7 @@ public:
 	void createDescriptorSet();
 	void createPipeline();
 	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
 	void updateDataPerFrame(VkCommandBuffer cmd) override;
 
 	void getHasGeometryVoxels(VkCommandBuffer cmd);
@@ -43,6 +59,7 @@ public:
 
 	nvvk::Buffer hasGeometryVoxelInfoBuffer;
 	nvvk::Buffer globalInfoBuffer;
+	nvvk::Buffer historyBuffer;		//δ̯ʱֻһԪ
 
 	VkShaderEXT computeShader_getHasGeometryVoxels{};
 	VkShaderEXT computeShader_setDispatchIndirectCommand{};
@@ -57,11 +74,14 @@ public:
 #endif
 
 	LightInjectCreateInfo_FzbPG setting;
+	LightInjectAmortizationSetting_FzbPG amortization;
 	VkPipeline rtPipeline{};
 	VkPipelineLayout rtPipelineLayout{};
 
 private:
 	shaderio::LightInjectPushConstant_FzbPG pushConstant;
+	uint32_t amortizedFrameIndex = 0;	//ʷʱ0ƶӰע˲Application::frameIndex
+	bool resetHistory = true;
 };
 }
 
@@ -0,0 +1,185 @@
+#include "./NodePairAliasTable_FzbPG.h"
+#include <nvutils/logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace FzbRenderer;
+
+static uint32_t encodeProbability(float probability) {
+	return uint32_t(std::clamp(probability, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+static float decodeProbability(uint32_t code) {
+	return float(code & 0xFFFFu) / 65535.0f;
+}
+//pdfΪ1 / (65535 * nodeCount)ĵλ
+static double getPdfCode(float pdf, uint32_t nodeCount) {
+	return double(pdf) * 65535.0 * nodeCount;
+}
+//Wilson-HilfertyƵĿֲβ
+static double chiSquarePValue(double chiSquare, int degreesOfFreedom) {
+	if (degreesOfFreedom <= 0) return 1.0;
+	double k = degreesOfFreedom;
+	double z = (std::cbrt(chiSquare / k) - (1.0 - 2.0 / (9.0 * k))) / std::sqrt(2.0 / (9.0 * k));
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+float NodePairAliasTable_FzbPG::decodeWeight(uint32_t code) {
+	code &= 0xFFFFu;
+	if (code == 0) return 0.0f;
+	return std::exp2((float(code) - 1.0f) / NODEPAIR_WEIGHT_LOG_SCALE_FZBPG - NODEPAIR_WEIGHT_LOG_OFFSET_FZBPG);
+}
+void NodePairAliasTable_FzbPG::build(std::span<const float> weights, std::span<shaderio::OctreeNodePairAliasEntry_FzbPG> entries) {
+	const uint32_t nodeCount = uint32_t(weights.size());
+	float totalWeight = 0.0f;
+	for (float weight : weights) totalWeight += weight;
+	if (totalWeight <= 0.0f) {
+		for (uint32_t i = 0; i < nodeCount; ++i) entries[i] = { i << 16, 0.0f };
+		return;
+	}
+
+	std::vector<uint32_t> lights, heavies;
+	std::vector<uint32_t> thresholds(nodeCount, 0), excesses(nodeCount, 0);
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		float probability = weights[i] * nodeCount / totalWeight;
+		if (probability < 1.0f) {
+			thresholds[i] = encodeProbability(probability);
+			lights.push_back(i);
+		}
+		else {
+			excesses[i] = uint32_t((probability - 1.0f) * 65535.0f + 0.5f);
+			heavies.push_back(i);
+		}
+	}
+	if (heavies.empty()) {		//pС1
+		for (uint32_t i = 0; i < nodeCount; ++i) entries[i] = { 0xFFFFu | (i << 16), 1.0f / nodeCount };
+		return;
+	}
+
+	std::vector<uint64_t> pdfCodes(nodeCount, 0);
+	size_t heavyRank = 0;
+	int64_t residual = 65535 + int64_t(excesses[heavies[0]]);		//ǰheavyʣĸ
+	for (uint32_t light : lights) {
+		uint32_t heavy = heavies[heavyRank];
+		entries[light].threshold_alias = thresholds[light] | (heavy << 16);
+		pdfCodes[light] += thresholds[light];
+		pdfCodes[heavy] += 65535 - thresholds[light];
+		residual -= 65535 - thresholds[light];
+
+		//ʣ಻1ʱΪlight˳һheavy
+		while (residual < 65535 && heavyRank + 1 < heavies.size()) {
+			uint32_t threshold = uint32_t(std::max<int64_t>(residual, 0));
+			uint32_t nextHeavy = heavies[heavyRank + 1];
+			entries[heavy].threshold_alias = threshold | (nextHeavy << 16);
+			pdfCodes[heavy] += threshold;
+			pdfCodes[nextHeavy] += 65535 - threshold;
+			residual = 65535 + int64_t(excesses[nextHeavy]) - (65535 - threshold);
+			heavy = nextHeavy;
+			++heavyRank;
+		}
+	}
+	for (; heavyRank < heavies.size(); ++heavyRank) {
+		uint32_t heavy = heavies[heavyRank];
+		entries[heavy].threshold_alias = 0xFFFFu | (heavy << 16);
+		pdfCodes[heavy] += 65535;
+	}
+	for (uint32_t i = 0; i < nodeCount; ++i) entries[i].pdf = float(pdfCodes[i]) / (65535.0f * nodeCount);
+}
+uint32_t NodePairAliasTable_FzbPG::sample(std::span<const shaderio::OctreeNodePairAliasEntry_FzbPG> entries, float rand0, float rand1) {
+	const uint32_t nodeCount = uint32_t(entries.size());
+	uint32_t nodeLabel = std::min(uint32_t(rand0 * nodeCount), nodeCount - 1);
+	if (rand1 >= decodeProbability(entries[nodeLabel].threshold_alias)) nodeLabel = entries[nodeLabel].threshold_alias >> 16;
+	return nodeLabel;
+}
+
+bool NodePairAliasTable_FzbPG::validate(std::span<const float> weights, std::span<const shaderio::OctreeNodePairAliasEntry_FzbPG> gpuEntries,
+	uint32_t sampleCount, const char* name) {
+	const uint32_t nodeCount = uint32_t(weights.size());
+	bool allPassed = true;
+	auto report = [&](bool passed, const char* message) {
+		allPassed &= passed;
+		if (passed) LOGI("NodePairAliasTable_FzbPG validate: %s %s, pass\n", name, message);
+		else LOGW("NodePairAliasTable_FzbPG validate: %s %s, FAIL\n", name, message);
+	};
+	char message[256];
+	if (nodeCount == 0 || gpuEntries.size() != nodeCount) {
+		snprintf(message, sizeof(message), "entry count %zu, node count %u", gpuEntries.size(), nodeCount);
+		report(false, message);
+		return false;
+	}
+	double totalWeight = 0.0;
+	for (float weight : weights) totalWeight += weight;
+	//ȨȫΪ0вᱻpdfӦȫΪ0
+	if (totalWeight <= 0.0) {
+		bool zeroPdf = std::all_of(gpuEntries.begin(), gpuEntries.end(), [](const shaderio::OctreeNodePairAliasEntry_FzbPG& entry) { return entry.pdf == 0.0f; });
+		report(zeroPdf, "zero weight row, pdf all zero");
+		return allPassed;
+	}
+
+	//1. GPU¼pdfӦڰֵaliasĸʣaliasԽʱֱʧ
+	std::vector<uint64_t> tableCodes(nodeCount, 0);
+	bool aliasInRange = true;
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		uint32_t threshold = gpuEntries[i].threshold_alias & 0xFFFFu;
+		uint32_t alias = gpuEntries[i].threshold_alias >> 16;
+		tableCodes[i] += threshold;
+		if (threshold == 0xFFFFu) continue;
+		if (alias >= nodeCount) aliasInRange = false;
+		else tableCodes[alias] += 0xFFFFu - threshold;
+	}
+	double maxTableError = 0.0;
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		double code = double(tableCodes[i]);
+		maxTableError = std::max(maxTableError, std::abs(getPdfCode(gpuEntries[i].pdf, nodeCount) - code) / std::max(code, 1.0));
+	}
+	snprintf(message, sizeof(message), "alias in range %d, pdf vs table sampling probability max relative error %.2e", int(aliasInRange), maxTableError);
+	report(aliasInRange && maxTableError < 1e-5, message);
+	if (!aliasInRange) return false;
+
+	//2. CPUοʵֱȽϣȨص˳ͬʱֵ1ɨۻΪλ
+	std::vector<shaderio::OctreeNodePairAliasEntry_FzbPG> cpuEntries(nodeCount);
+	build(weights, cpuEntries);
+	double maxPdfError = 0.0, gpuPdfSum = 0.0;
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		double cpuCode = getPdfCode(cpuEntries[i].pdf, nodeCount);
+		maxPdfError = std::max(maxPdfError, std::abs(getPdfCode(gpuEntries[i].pdf, nodeCount) - cpuCode) / (16.0 + 1e-5 * cpuCode));
+		gpuPdfSum += gpuEntries[i].pdf;
+	}
+	snprintf(message, sizeof(message), "pdf vs cpu max error %.2f of tolerance, pdf sum %.6f", maxPdfError, gpuPdfSum);
+	report(maxPdfError <= 1.0 && std::abs(gpuPdfSum - 1.0) < 1e-4, message);
+	if (sampleCount == 0) return allPassed;
+
+	//3. GPUweight / totalWeight飬С5ϲ
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> uniform(0.0f, std::nextafter(1.0f, 0.0f));
+	std::vector<uint32_t> histogram(nodeCount, 0);
+	for (uint32_t i = 0; i < sampleCount; ++i) {
+		float rand0 = uniform(rng);
+		float rand1 = uniform(rng);
+		++histogram[sample(gpuEntries, rand0, rand1)];
+	}
+	double chiSquare = 0.0, pooledObserved = 0.0, pooledExpected = 0.0;
+	int degreesOfFreedom = -1;
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		double expected = weights[i] / totalWeight * sampleCount;
+		if (expected < 5.0) {
+			pooledObserved += histogram[i];
+			pooledExpected += expected;
+			continue;
+		}
+		double difference = histogram[i] - expected;
+		chiSquare += difference * difference / expected;
+		++degreesOfFreedom;
+	}
+	if (pooledExpected >= 5.0) {
+		double difference = pooledObserved - pooledExpected;
+		chiSquare += difference * difference / pooledExpected;
+		++degreesOfFreedom;
+	}
+	else if (pooledObserved > 5.0 * std::max(pooledExpected, 1.0)) chiSquare += pooledObserved;		//ȨΪ0Ľڵ
+	double pValue = chiSquarePValue(chiSquare, degreesOfFreedom);
+	snprintf(message, sizeof(message), "%u samples chi-square %.1f, dof %d, p %.4f", sampleCount, chiSquare, degreesOfFreedom, pValue);
+	report(pValue > 0.01, message);
+	return allPassed;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "./OctreeShaderio_FzbPG.h"
+#include <cstdint>
+#include <span>
+
+#ifndef FZBRENDERER_NODEPAIR_ALIAS_TABLE_FZBPG_H
+#define FZBRENDERER_NODEPAIR_ALIAS_TABLE_FZBPG_H
+
+namespace FzbRenderer {
+/*
+Octree2.slangcomputeMain_getProbabilityCPUοʵ֣һΪһ(outgoingIndex, nodeLabel_G)вɷEڵalias
+1. build˳ɨ裺lightźĸp < 1heavylabel˳򣬵ǰheavylightĲʣ಻1ʱΪlight˳
+   aliasΪһheavyһheavyʣµlightֵΪunorm16pdfֵ1 / 65535Ϊλۼ
+2. GPUÿ߳ǰ׺ֲҶԼȷbuildֻͬȨص˳ͬ
+3. sampleFzbPathGuiding.slangĲͬѡһСֵʱȡalias
+*/
+class NodePairAliasTable_FzbPG {
+public:
+	//NodePairWeight.slangdecodeNodePairWeight_FzbPGͬ
+	static float decodeWeight(uint32_t code);
+	static void build(std::span<const float> weights, std::span<shaderio::OctreeNodePairAliasEntry_FzbPG> entries);
+	//rand0ѡrand1ֵȽϣ[0, 1)
+	static uint32_t sample(std::span<const shaderio::OctreeNodePairAliasEntry_FzbPG> entries, float rand0, float rand1);
+
+	/*
+	GPUһalias־ͨʱtrue
+	1. ¼pdf밴ֵaliasĸһ£aliasԽ
+	2. ÿpdfCPUοʵֵĲ죬Լpdf֮
+	3. GPUısampleCountΣweight / totalWeight飬С5ϲ
+	*/
+	static bool validate(std::span<const float> weights, std::span<const shaderio::OctreeNodePairAliasEntry_FzbPG> gpuEntries,
+		uint32_t sampleCount, const char* name);
+};
+}
+
+#endif
@@ -6,7 +6,7 @@
 #ifndef FZBRENDERER_OCTREE_FZBPG_SHADERIO_H
 #define FZBRENDERER_OCTREE_FZBPG_SHADERIO_H
 
-#define MAX_OCTREE_LAYER_FZBPG 5
+#define MAX_OCTREE_LAYER_FZBPG 8		//256x256x256, the layers below OCTREE_DENSE_LAYER_FZBPG are allocated from the block pool
 #define IndivisibleNodeCount_G_FZBPG 1024
 
 NAMESPACE_SHADERIO_BEGIN()
@@ -18,12 +18,17 @@ struct OctreePushConstant_FzbPG {
 	float voxelVolume;
 	uint32_t octreeNodeTotalCount;
 	uint32_t currentLayerBlockCount;
+	uint32_t currentLayerBlockInfoOffset;	//the BlockInfos_G region of currentLayer
 	uint32_t currentLayerNodeCount;
 	uint32_t VGBVoxelTotalCount;
 	SceneInfo* sceneInfoAddress;
 	float frameIndex;
 	float4 VGBStartPos_Size;
 	float4 VGBVoxelSize;
+	uint32_t nodePairWeightCapacity;		//OctreeNodePairWeightBuffer uint count
+	uint32_t nodePairDataCapacity;			//OctreeNodePairDataBuffer element count
+	uint32_t nodePairAliasCapacity;			//OctreeNodePairAliasTableBuffer element count
+	uint32_t octreeBlockCapacity;			//OctreeDataBuffer_G block count, a block is 8 sibling nodes
 #ifndef NDEBUG
 	int showOctreeNodeTotalCount;
 	int normalIndex;
@@ -36,45 +41,73 @@ struct OctreePushConstant_FzbPG {
 
 enum class BindingPoints_Octree_FzbPG : uint32_t {
 	eVGB = 2,
-	eOctreeClusterData_G,
-	eOctreeData_G,
-	eOctreeClusterData_E,
 	eClusterLayerData_E,
 	eBlockInfos_G,
-	eBlockInfos_E,
 	eHasDataBlockIndices_G,
-	eHasDataBlockIndices_E,
 	eHasDataBlockCount,
 	eGlobalInfo,
 	eDivisibleNodeInfos_G,
 	eThreadGroupInfos,
 	eIndivisibleNodeInfos_G,
 	eIndivisibleNodeInfos_E,
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	eOctreeNodePairData,
-	ePartialHitNodePairCount,
-	ePartialHitNodePairTempData,
+	ePartialHitNodePairCount,		// only bound with ADAPTIVE_IMPORTANCE_SAMPLING, the binding points don't depend on the permutation
 	eHitTestNodePairCount,
-	eHitTestNodePairInfo,
-#endif
-	eOctreeNodePairWeight,
-#ifdef NEARBYNODE_JITTER_FZBPG
-	eNearbyNodeTempInfos,
+	eNearbyNodeTempInfos,			// only bound with NEARBYNODE_JITTER_FZBPG
 	eNearbyNodeInfos,
-#endif
+};
+// the node pair buffers and the octree node buffers are recreated when their capacity changes, so they are pushed every frame in set 1
+enum class DynamicBindingPoints_Octree_FzbPG : uint32_t {
+	//eTlas_PT = 0,
+	eOctreeNodePairWeight = 1,
+	eOctreeNodePairAliasTable,
+	eOctreeData_G,
+	eOctreeClusterData_G,
+	eOctreeClusterData_E,
+	eOctreeNodePairData,			// only bound with ADAPTIVE_IMPORTANCE_SAMPLING
+	ePartialHitNodePairTempData,
+	eHitTestNodePairInfo,
 };
 //------------------------------------------------------------------------------------------
 #define OCTREE_CLUSTER_LAYER_FZBPG 2		//don't change!!!!!
 #define OCTREE_NODECOUNT_E_FZBPG 440		//8 + 48 + 384
 #define CLUSTER_LAYER_NODECOUNT_E_FZBPG 384
-static const uint OctreeLayerNodeCount_FzbPG[MAX_OCTREE_LAYER_FZBPG] = { 8, 48, 384, 3072, 24576 };
-static const uint OctreeLayerStartIndex_FzbPG[3] = { 0, 8, 56 };
+/*
+all octree nodes are in one buffer, the node address is block * 8 + lane, a block is 8 sibling nodes
+layer 0 - OCTREE_DENSE_LAYER_FZBPG are dense: layer0 is block 0, layer1 is block 1 - 6, layer2 is block 7 - 54, layer3 is block 55 - 438
+so the address of dense layer node is OctreeLayerStartIndex_FzbPG[layer] + nodeIndex, and the layer0 - 2 address is same as the E tree node
+the blocks of deeper layer are allocated from the pool after the dense blocks, only the blocks that have data are allocated
+*/
+#define OCTREE_DENSE_LAYER_FZBPG 3
+#define OCTREE_DENSE_NODECOUNT_FZBPG 3512		//8 + 48 + 384 + 3072
+#define OCTREE_DENSE_BLOCKCOUNT_FZBPG 439
+static const uint OctreeLayerNodeCount_FzbPG[OCTREE_DENSE_LAYER_FZBPG + 1] = { 8, 48, 384, 3072 };
+static const uint OctreeLayerStartIndex_FzbPG[OCTREE_DENSE_LAYER_FZBPG + 1] = { 0, 8, 56, 440 };
+/*
+BlockInfos_G and HasDataBlockIndices_G have a region for every layer from OCTREE_DENSE_LAYER_FZBPG to octreeMaxLayer, indexed by the dense block index
+the region of octreeMaxLayer is first, layer l has 6 * 8^(l - 1) blocks
+BlockInfos_G: 0 mean no data, 1 mean has data, after the layer is compacted it is the block of the pool, 0 if the pool is full
+HasDataBlockIndices_G: the dense block index of the blocks that have data, HasDataBlockCount[layer] is the count
+*/
+/*
+node pair weight table is a CSR table, row is (outgoingIndex, nodeLabel_G), column is the E tree node (0 - 439) that has data
+all rows share the same columns, so E subtrees without data are dropped for every row
+the E tree nodes are grouped into blocks of 8 siblings: block 0 is layer0, block 1 - 8 is layer1 (child of layer0 node 0 - 7), block 9 - 56 is layer2
+nodePairBlockInfos_E[block]: 0 - 7 bite is childMask, 8 - 31 bite is the column of the block's first child that has data
+every column is 16 bite, two columns are packed in one uint, every row is aligned to uint
+the table keeps the raw hit test weight, getProbability turns every row into an alias table over the indivisible E nodes
+*/
+#define NODEPAIR_BLOCK_COUNT_E_FZBPG 57
+#define NODEPAIR_ROW_MAX_SIZE_FZBPG (OCTREE_NODECOUNT_E_FZBPG / 2)
+// raw weight is log-quantised, 0 mean no weight, covers 2^-64 - 2^64 with 0.14% relative error
+#define NODEPAIR_WEIGHT_LOG_SCALE_FZBPG 512.0f
+#define NODEPAIR_WEIGHT_LOG_OFFSET_FZBPG 64.0f
 
 struct OctreeNodeClusterData_G_FzbPG {
 	float4 meanNormal;
 	AABB aabb;
 	float fillRate;
 	uint indivisible;
+	uint normalIndex;		//the VGB of the node, the node address of sparse layer doesn't have it
 #ifdef GEOMETRY_CLUSTER_WITH_E
 	float E;
 #endif
@@ -87,6 +120,7 @@ the 1 - 31 bite is label, 0 mean no data, other mean the node's index of this la
 
 struct OctreeNodeData_G_FzbPG {
 	uint32_t label_indivisible;
+	uint32_t childBlock;		//the children address is childBlock * 8 + lane, 0 mean no child
 };
 
 /*
@@ -105,7 +139,7 @@ the OCTREE_CLUSTER_LAYER layer node must is indivisible, and 0-OCTREE_CLUSTER_LA
 so we only record the OCTREE_CLUSTER_LAYER layer node's label
 */
 struct OctreeNodeData_E_FzbPG {
-#ifndef ADAPTIVE_IMPORTANCE_SAMPLING
+#ifndef ADAPTIVE_IMPORTANCE_SAMPLING	// the size depends on the permutation, the host uses GuidingPermutation_FzbPG::getNodeDataSize_E
 	AABB aabb;
 	float pdf;
 #endif
@@ -113,30 +147,34 @@ struct OctreeNodeData_E_FzbPG {
 };
 
 //------------------------------------------------------------------------------------------
-struct HasDataOctreeBlockCount_FzbPG {
-	uint32_t count_G;
-	uint32_t count_E;
-};
 struct OctreeLayerInfo_FzbPG {
 	uint32_t divisibleNodeCount;
 	uint32_t indivisibleNodeCount;
 };
 struct OctreeGlobalInfo_FzbPG {
 	DispatchIndirectCommand cmd;
-#ifdef NEARBYNODE_JITTER_FZBPG
-	DispatchIndirectCommand cmd2;
-#endif
+	DispatchIndirectCommand cmd2;		// only used with NEARBYNODE_JITTER_FZBPG, kept so the host offsets don't depend on the permutation
 	uint indivisibleNodeCount_G;
 	uint indivisibleNodeCount_E;
-	OctreeLayerInfo_FzbPG layerInfos_G[MAX_OCTREE_LAYER_FZBPG];
+	OctreeLayerInfo_FzbPG layerInfos_G[MAX_OCTREE_LAYER_FZBPG + 1];
+	uint requiredNodePairWeightSize;	//read back by cpu, if bigger than capacity, indivisibleNodeCount_G and indivisibleNodeCount_E are 0 this frame
+	uint requiredNodePairDataSize;
+	uint requiredNodePairAliasSize;		//OUTGOING_COUNT * indivisibleNodeCount_G * indivisibleNodeCount_E
+	uint requiredOctreeBlockCount;		//read back by cpu, OCTREE_DENSE_BLOCKCOUNT_FZBPG + the has data block count of sparse layer
+	uint nodePairRowSize;		//uint count of every row
+	uint nodePairBlockInfos_E[NODEPAIR_BLOCK_COUNT_E_FZBPG];
 };
 struct OctreeThreadGroupInfo_FzbPG {
 	uint threadGroupDivisibleNodeCount_G;
 	uint threadGroupIndivisibleNodeCount_G;
 };
 //------------------------------------------------------------------------------------------
-#define OUTGOING_COUNT_FZBPG 64
+#ifndef OUTGOING_COUNT_FZBPG
+#define OUTGOING_COUNT_FZBPG 64		//power of 2, 64 - 512
+#endif
+#ifndef HITTEST_COUNT_FZBPG
 #define HITTEST_COUNT_FZBPG 16		//not bigger than 32 or smaller than 8
+#endif
 
 #define OUTGOING_TYPE_FZBPG 0
 #if OUTGOING_TYPE_FZBPG == 0
@@ -160,6 +198,16 @@ struct OctreeNodePairData_FzbPG {
 	AABB aabb;
 	float pdf;
 };
+/*
+alias table of row (outgoingIndex, nodeLabel_G), indexed by nodeLabel_E, rows are packed with the compacted indivisibleNodeCount_E
+so the size is requiredNodePairAliasSize, getProbability builds a row with one thread group, NodePairAliasTable_FzbPG is the cpu reference
+threshold_alias: 0 - 15 bite is unorm16 threshold, 16 - 31 bite is the alias nodeLabel_E
+pdf is the probability of sampling this nodeLabel_E with the quantised thresholds, so sample and pdf lookup are consistent
+*/
+struct OctreeNodePairAliasEntry_FzbPG {
+	uint threshold_alias;
+	float pdf;
+};
 //------------------------------------------------------------------------------------------
 struct IndivisibleNodeNearbyNodeTempInfo_FzbPG {
 	uint nodeLabel;
@@ -168,7 +216,7 @@ struct IndivisibleNodeNearbyNodeTempInfo_FzbPG {
 };
 
 struct OctreeNearbyNodeInfo_FzbPG {
-	int2 nearbyNodeInfos[NEARBY_NODE_COUNT_FZBPG];		//0-3 is layer, 4 - 31 is nodeIndex
+	int2 nearbyNodeInfos[NEARBY_NODE_COUNT_FZBPG];		//x is layer, y is node address
 };
 
 #define CREATEOCTREE_CS_THREADGROUP_SIZE 256
@@ -1,4 +1,5 @@
 #include "./Octree_FzbPG.h"
+#include "./NodePairAliasTable_FzbPG.h"
 #include <nvutils/timers.hpp>
 #include <common/Application/Application.h>
 #include <common/Shader/Shader.h>
@@ -11,12 +12,68 @@
 
 using namespace FzbRenderer;
 
+void GuidingPermutation_FzbPG::parse(pugi::xml_node permutationNode) {
+	if (permutationNode) {
+		if (pugi::xml_attribute attribute = permutationNode.attribute("adaptiveImportanceSampling"))
+			adaptiveImportanceSampling = std::string(attribute.value()) == "true";
+		if (pugi::xml_attribute attribute = permutationNode.attribute("nearbyNodeJitter"))
+			nearbyNodeJitter = std::string(attribute.value()) == "true";
+		nearbyNodeCount = permutationNode.attribute("nearbyNodeCount").as_uint(nearbyNodeCount);
+		hitTestCount = permutationNode.attribute("hitTestCount").as_uint(hitTestCount);
+		outgoingCount = permutationNode.attribute("outgoingCount").as_uint(outgoingCount);
+	}
+
+	//nearbyNodeCountÿڵ֮߳ܳһwarp
+	if (nearbyNodeCount < 1 || nearbyNodeCount > 32) {
+		LOGW("GuidingPermutation_FzbPG: nearbyNodeCount %u is out of [1, 32], use 8\n", nearbyNodeCount);
+		nearbyNodeCount = 8;
+	}
+	if (hitTestCount < 8 || hitTestCount > 32) {
+		LOGW("GuidingPermutation_FzbPG: hitTestCount %u is out of [8, 32], use 16\n", hitTestCount);
+		hitTestCount = 16;
+	}
+	//Octree2.slang&(OUTGOING_COUNT_FZBPG - 1)ȡ䷽һ߳ٴһGڵг䷽С64ʱgroupHitPayloadsڴ
+	if (!std::has_single_bit(outgoingCount) || outgoingCount < 64 || outgoingCount > HITTEST_CS_THREADGROUP_SIZE) {
+		LOGW("GuidingPermutation_FzbPG: outgoingCount %u must be a power of 2 in [64, %u], use 64\n", outgoingCount, uint32_t(HITTEST_CS_THREADGROUP_SIZE));
+		outgoingCount = 64;
+	}
+
+	macroStrings.clear();
+	macroStrings.push_back({ "FZBPG_PERMUTATION", "1" });
+	if (adaptiveImportanceSampling) macroStrings.push_back({ "ADAPTIVE_IMPORTANCE_SAMPLING", "1" });
+	if (nearbyNodeJitter) macroStrings.push_back({ "NEARBYNODE_JITTER_FZBPG", "1" });
+	macroStrings.push_back({ "NEARBY_NODE_COUNT_FZBPG", std::to_string(nearbyNodeCount) });
+	macroStrings.push_back({ "HITTEST_COUNT_FZBPG", std::to_string(hitTestCount) });
+	macroStrings.push_back({ "OUTGOING_COUNT_FZBPG", std::to_string(outgoingCount) });
+}
+void GuidingPermutation_FzbPG::addMacros() {
+	if (macroStrings.empty()) parse(pugi::xml_node());
+	for (const auto& [name, value] : macroStrings)
+		Application::slangCompiler.addMacro({ .name = name.c_str(), .value = value.c_str() });
+}
+uint32_t GuidingPermutation_FzbPG::getNodeDataSize_E() const {
+	//OctreeNodeData_E_FzbPGһ£ûӦҪԲʱaabbpdf
+	uint32_t size = sizeof(uint32_t);
+	if (!adaptiveImportanceSampling) size += sizeof(shaderio::AABB) + sizeof(float);
+	return size;
+}
+uint32_t GuidingPermutation_FzbPG::getNearbyNodeTempInfoSize() const {
+	return sizeof(uint32_t) + nearbyNodeCount * (sizeof(shaderio::int2) + sizeof(float));		//IndivisibleNodeNearbyNodeTempInfo_FzbPG
+}
+uint32_t GuidingPermutation_FzbPG::getNearbyNodeInfoSize() const {
+	return nearbyNodeCount * sizeof(shaderio::int2);		//OctreeNearbyNodeInfo_FzbPG
+}
+
 Octree_FzbPG::Octree_FzbPG(pugi::xml_node& featureNode) {
+	profileName = "Octree";
 #ifndef NDEBUG
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().geometryShader = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().fillModeNonSolid = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().wideLines = VK_TRUE;
 #endif
+	if (pugi::xml_node aliasTableValidationNode = featureNode.child("aliasTableValidation"))
+		aliasTableValidationSampleCount = aliasTableValidationNode.attribute("value").as_uint(0);
+	permutation.parse(featureNode.child("permutation"));
 }
 void Octree_FzbPG::init(OctreeCreateInfo_FzbPG createInfo) {
 	this->setting = createInfo;
@@ -34,9 +91,9 @@ void Octree_FzbPG::init(OctreeCreateInfo_FzbPG createInfo) {
 }
 void Octree_FzbPG::clean() {
 	Feature::clean();
-	for (int i = 0; i < octreeClusterDataBuffer_G.size(); ++i) Application::allocator.destroyBuffer(octreeClusterDataBuffer_G[i]);
-	for (int i = 0; i < octreeDataBuffer_G.size(); ++i) Application::allocator.destroyBuffer(octreeDataBuffer_G[i]);
-	for (int i = 0; i < octreeClusterDataBuffer_E.size(); ++i) Application::allocator.destroyBuffer(octreeClusterDataBuffer_E[i]);
+	Application::allocator.destroyBuffer(octreeClusterDataBuffer_G);
+	Application::allocator.destroyBuffer(octreeDataBuffer_G);
+	Application::allocator.destroyBuffer(octreeClusterDataBuffer_E);
 	Application::allocator.destroyBuffer(clusterLayerDataBuffer_E);
 
 	Application::allocator.destroyBuffer(globalInfoBuffer);
@@ -44,15 +101,14 @@ void Octree_FzbPG::clean() {
 	Application::allocator.destroyBuffer(indivisibleNodeInfosBuffer_E);
 
 	Application::allocator.destroyBuffer(blockInfoBuffer_G);
-	Application::allocator.destroyBuffer(blockInfoBuffer_E);
 	Application::allocator.destroyBuffer(hasDataBlockIndexBuffer_G);
-	Application::allocator.destroyBuffer(hasDataBlockIndexBuffer_E);
 	Application::allocator.destroyBuffer(hasDataBlockCountBuffer);
 
 	Application::allocator.destroyBuffer(divisibleNodeInfoBuffer_G);
 	Application::allocator.destroyBuffer(threadGroupInfoBuffer);
 
 	Application::allocator.destroyBuffer(octreeNodePairWeightBuffer);
+	Application::allocator.destroyBuffer(octreeNodePairAliasTableBuffer);
 
 	Application::allocator.destroyBuffer(nearbyNodeTempInfoBuffer);
 	Application::allocator.destroyBuffer(nearbyNodeInfoBuffer);
@@ -62,6 +118,9 @@ void Octree_FzbPG::clean() {
 	Application::allocator.destroyBuffer(partialHitNodePairTempDataBuffer);
 	Application::allocator.destroyBuffer(hitTestNodePairCountBuffer);
 	Application::allocator.destroyBuffer(hitTestNodePairInfoBuffer);
+	for (nvvk::Buffer& stageBuffer : nodePairSizeStageBuffers) Application::allocator.destroyBuffer(stageBuffer);
+	for (std::vector<nvvk::Buffer>& buffers : retiredBuffers)
+		for (nvvk::Buffer& buffer : buffers) Application::allocator.destroyBuffer(buffer);
 
 	VkDevice device = Application::app->getDevice();
 	vkDestroyShaderEXT(device, computeShader_initOctreeArray, nullptr);
@@ -295,6 +354,17 @@ void Octree_FzbPG::uiRender() {
 void Octree_FzbPG::resize(VkCommandBuffer cmd, const VkExtent2D& size) {
 	//gBuffers.update(cmd, size);
 };
+/*
+ڵԱ˲ص
+1. СʱGPUһ֡path guiding
+2. СһʱݣΪפԴ
+25%ڱ߽總ؽ
+*/
+static uint32_t getBufferCapacity(uint32_t requiredSize, uint32_t capacity) {
+	if (requiredSize == 0) return capacity;
+	if (requiredSize > capacity || requiredSize < capacity / 2) return requiredSize + requiredSize / 4;
+	return capacity;
+}
 void Octree_FzbPG::preRender() {
 	pushConstant.sceneInfoAddress = (shaderio::SceneInfo*)Application::sceneResource.bSceneInfo.address;
 	pushConstant.voxelVolume = setting.VGBVoxelSize.x * setting.VGBVoxelSize.y * setting.VGBVoxelSize.z;
@@ -304,9 +374,187 @@ void Octree_FzbPG::preRender() {
 
 	float angle = FzbRenderer::rand(Application::frameIndex) * glm::two_pi<float>();
 	pushConstant.randomRotateMatrix = glm::mat3(glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0, 0, 1)));
+
+	/*
+	nvapppreRender֮ǰѾȴǰ֡һύ֡
+	1. ֡дĻضۿԶȡ֮֡ǰ۵Ļ岻ٱʹã
+	2. ִ֡Уֻܶдǰ֡
+	*/
+	uint32_t frameCycleIndex = Application::app->getFrameCycleIndex();
+	for (nvvk::Buffer& buffer : retiredBuffers[frameCycleIndex]) Application::allocator.destroyBuffer(buffer);
+	retiredBuffers[frameCycleIndex].clear();
+	if (nodePairSizeStageWritten[frameCycleIndex]) {
+		const nvvk::Buffer& stageBuffer = nodePairSizeStageBuffers[frameCycleIndex];
+		//GPU_TO_CPUڴ治һHOST_COHERENTȡmappingǰҪinvalidate
+		vmaInvalidateAllocation(Application::allocator, stageBuffer.allocation, 0, VK_WHOLE_SIZE);
+		//OctreeGlobalInfo_FzbPGе˳ͬڵԱС֮
+		const uint32_t* requiredSizes = (const uint32_t*)stageBuffer.mapping;
+		memcpy(requiredNodePairSize, requiredSizes, sizeof(requiredNodePairSize));
+		requiredOctreeBlockCount = requiredSizes[3];
+		nodePairSizeStageWritten[frameCycleIndex] = false;
+	}
+
+	//ؽ壬һ֡ıҪڴ֮ǰ
+	if (aliasTableValidationSampleCount > 0 && !aliasTableValidated && Application::frameIndex > 0) validateNodePairAliasTable();
+
+	//GPUͳƵʵСڵԱ
+	uint32_t weightCapacity = getBufferCapacity(requiredNodePairSize[0], nodePairWeightCapacity);
+	uint32_t dataCapacity = getBufferCapacity(requiredNodePairSize[1], nodePairDataCapacity);
+	uint32_t aliasCapacity = getBufferCapacity(requiredNodePairSize[2], nodePairAliasCapacity);
+	resizeNodePairBuffers(weightCapacity, dataCapacity, aliasCapacity);
+	//֡ͬ˲ÿ֡ؽ»岻Ҫƾ
+	resizeOctreeNodeBuffers(getBufferCapacity(requiredOctreeBlockCount, octreeBlockCapacity));
+}
+bool Octree_FzbPG::isBufferSizeStable() const {
+	return requiredNodePairSize[0] > 0 && getBufferCapacity(requiredNodePairSize[0], nodePairWeightCapacity) == nodePairWeightCapacity &&
+		getBufferCapacity(requiredNodePairSize[1], nodePairDataCapacity) == nodePairDataCapacity &&
+		getBufferCapacity(requiredNodePairSize[2], nodePairAliasCapacity) == nodePairAliasCapacity &&
+		getBufferCapacity(requiredOctreeBlockCount, octreeBlockCapacity) == octreeBlockCapacity;
+}
+void Octree_FzbPG::getNodePairSizes(uint32_t& weightCapacity, uint32_t& dataCapacity, uint32_t& aliasCapacity, uint32_t requiredSize[3]) const {
+	weightCapacity = nodePairWeightCapacity;
+	dataCapacity = nodePairDataCapacity;
+	aliasCapacity = nodePairAliasCapacity;
+	memcpy(requiredSize, requiredNodePairSize, sizeof(requiredNodePairSize));
+}
+void Octree_FzbPG::restoreNodePairSizes(uint32_t weightCapacity, uint32_t dataCapacity, uint32_t aliasCapacity, const uint32_t requiredSize[3]) {
+	resizeNodePairBuffers(weightCapacity, dataCapacity, aliasCapacity);
+	//renderʱض۲ٸ£д뻺ʱСʹpreRenderֵǰָǰ֡Ļض
+	memcpy(requiredNodePairSize, requiredSize, sizeof(requiredNodePairSize));
+	nodePairSizeStageWritten.assign(nodePairSizeStageWritten.size(), false);
+}
+void Octree_FzbPG::getOctreeBlockSizes(uint32_t& blockCapacity, uint32_t& requiredBlockCount) const {
+	blockCapacity = octreeBlockCapacity;
+	requiredBlockCount = requiredOctreeBlockCount;
+}
+void Octree_FzbPG::restoreOctreeBlockSizes(uint32_t blockCapacity, uint32_t requiredBlockCount) {
+	resizeOctreeNodeBuffers(blockCapacity);
+	//restoreNodePairSizesͬضrestoreNodePairSizesж
+	requiredOctreeBlockCount = requiredBlockCount;
+}
+void Octree_FzbPG::resizeOctreeNodeBuffers(uint32_t blockCapacity) {
+	if (blockCapacity == octreeBlockCapacity) return;
+
+	LOGI("Octree_FzbPG: octree node buffer resize, block %u -> %u\n", octreeBlockCapacity, blockCapacity);
+	octreeBlockCapacity = blockCapacity;
+
+	std::vector<nvvk::Buffer>& frameRetiredBuffers = retiredBuffers[Application::app->getFrameCycleIndex()];
+	frameRetiredBuffers.push_back(octreeDataBuffer_G);
+	frameRetiredBuffers.push_back(octreeClusterDataBuffer_G);
+	frameRetiredBuffers.push_back(octreeClusterDataBuffer_E);
+	createOctreeNodeBuffers();
+}
+void Octree_FzbPG::resizeNodePairBuffers(uint32_t weightCapacity, uint32_t dataCapacity, uint32_t aliasCapacity) {
+	if (weightCapacity == nodePairWeightCapacity && dataCapacity == nodePairDataCapacity && aliasCapacity == nodePairAliasCapacity) return;
+
+	LOGI("Octree_FzbPG: nodePair buffer resize, weight %u -> %u, data %u -> %u, alias %u -> %u\n",
+		nodePairWeightCapacity, weightCapacity, nodePairDataCapacity, dataCapacity, nodePairAliasCapacity, aliasCapacity);
+	nodePairWeightCapacity = weightCapacity;
+	nodePairDataCapacity = dataCapacity;
+	nodePairAliasCapacity = aliasCapacity;
+
+	//ִе֡ʹþɻ壬뵱ǰۣ֡ȸ֡һαȴ
+	std::vector<nvvk::Buffer>& frameRetiredBuffers = retiredBuffers[Application::app->getFrameCycleIndex()];
+	frameRetiredBuffers.push_back(octreeNodePairWeightBuffer);
+	frameRetiredBuffers.push_back(octreeNodePairAliasTableBuffer);
+	if (permutation.adaptiveImportanceSampling) {
+		frameRetiredBuffers.push_back(octreeNodePairDataBuffer);
+		frameRetiredBuffers.push_back(partialHitNodePairTempDataBuffer);
+		frameRetiredBuffers.push_back(hitTestNodePairInfoBuffer);
+	}
+	createNodePairBuffers();
+}
+/*
+ضһ֡ȫϢȨرaliasȨصоѡȡнNodePairAliasTable_FzbPG::validate
+1. һ֡ʱûݣȴʵʴСݺ֡
+2. еȨذgetProbabilityķʽȨر룺аnodeLabel_E
+*/
+void Octree_FzbPG::validateNodePairAliasTable() {
+	if (requiredNodePairSize[0] == 0 || requiredNodePairSize[0] > nodePairWeightCapacity || requiredNodePairSize[1] > nodePairDataCapacity ||
+		requiredNodePairSize[2] > nodePairAliasCapacity) return;
+	aliasTableValidated = true;
+	SCOPED_TIMER(__FUNCTION__);
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+
+	//ضеСһ֡ƣʵʴСͬһθƵȫϢȷ
+	VkDeviceSize weightOffset = sizeof(shaderio::OctreeGlobalInfo_FzbPG);
+	VkDeviceSize weightByteSize = VkDeviceSize(nodePairWeightCapacity) * sizeof(uint32_t);
+	VkDeviceSize aliasOffset = weightOffset + weightByteSize;
+	VkDeviceSize aliasByteSize = VkDeviceSize(nodePairAliasCapacity) * sizeof(shaderio::OctreeNodePairAliasEntry_FzbPG);
+	nvvk::Buffer stageBuffer;
+	allocator->createBuffer(stageBuffer, aliasOffset + aliasByteSize, VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(stageBuffer.buffer);
+
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	//ȴһ֡дڵԱ
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	auto copyToStage = [&](const nvvk::Buffer& srcBuffer, VkDeviceSize dstOffset, VkDeviceSize size) {
+		VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2, .srcOffset = 0, .dstOffset = dstOffset, .size = size };
+		VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2, .srcBuffer = srcBuffer.buffer,
+			.dstBuffer = stageBuffer.buffer, .regionCount = 1, .pRegions = &region };
+		vkCmdCopyBuffer2(cmd, &copyInfo);
+	};
+	copyToStage(globalInfoBuffer, 0, sizeof(shaderio::OctreeGlobalInfo_FzbPG));
+	copyToStage(octreeNodePairWeightBuffer, weightOffset, weightByteSize);
+	if (aliasByteSize > 0) copyToStage(octreeNodePairAliasTableBuffer, aliasOffset, aliasByteSize);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	//GPU_TO_CPUڴ治һHOST_COHERENTȡmappingǰҪinvalidate
+	vmaInvalidateAllocation(*allocator, stageBuffer.allocation, 0, VK_WHOLE_SIZE);
+
+	const uint8_t* stageData = static_cast<const uint8_t*>(stageBuffer.mapping);
+	const auto* globalInfo = reinterpret_cast<const shaderio::OctreeGlobalInfo_FzbPG*>(stageData);
+	const uint32_t* weightTable = reinterpret_cast<const uint32_t*>(stageData + weightOffset);
+	const auto* aliasTable = reinterpret_cast<const shaderio::OctreeNodePairAliasEntry_FzbPG*>(stageData + aliasOffset);
+	uint32_t indivisibleNodeCount_G = globalInfo->indivisibleNodeCount_G;
+	uint32_t indivisibleNodeCount_E = globalInfo->indivisibleNodeCount_E;
+	uint32_t rowCount = permutation.outgoingCount * indivisibleNodeCount_G;
+	if (rowCount == 0 || indivisibleNodeCount_E == 0 || rowCount * indivisibleNodeCount_E != globalInfo->requiredNodePairAliasSize ||
+		globalInfo->requiredNodePairWeightSize > nodePairWeightCapacity || globalInfo->requiredNodePairAliasSize > nodePairAliasCapacity) {
+		LOGW("Octree_FzbPG: һ֡ûнڵԱG: %u  E: %ualias\n", indivisibleNodeCount_G, indivisibleNodeCount_E);
+		allocator->destroyBuffer(stageBuffer);
+		return;
+	}
+
+	//getNodePairBlockIndex_FzbPGͬһڵڿĵһ
+	uint32_t clusterLayerStartIndex = shaderio::OctreeLayerStartIndex_FzbPG[OCTREE_CLUSTER_LAYER_FZBPG];
+	uint32_t clusterLayerFirstColumn = globalInfo->nodePairBlockInfos_E[clusterLayerStartIndex / 8 + 2] >> 8;
+	std::vector<float> weights(indivisibleNodeCount_E);
+	auto getRowWeights = [&](uint32_t rowIndex) {
+		const uint32_t* row = weightTable + size_t(rowIndex) * globalInfo->nodePairRowSize;
+		float totalWeight = 0.0f;
+		for (uint32_t nodeLabel_E = 0; nodeLabel_E < indivisibleNodeCount_E; ++nodeLabel_E) {
+			uint32_t column = clusterLayerFirstColumn + nodeLabel_E;
+			weights[nodeLabel_E] = NodePairAliasTable_FzbPG::decodeWeight(row[column / 2] >> ((column & 1) * 16));
+			totalWeight += weights[nodeLabel_E];
+		}
+		return totalWeight;
+	};
+	std::vector<uint32_t> weightedRows;
+	for (uint32_t rowIndex = 0; rowIndex < rowCount; ++rowIndex)
+		if (getRowWeights(rowIndex) > 0.0f) weightedRows.push_back(rowIndex);
+
+	constexpr uint32_t VALIDATION_ROW_COUNT = 4;
+	uint32_t validationRowCount = std::min<uint32_t>(VALIDATION_ROW_COUNT, uint32_t(weightedRows.size()));
+	bool allPassed = true;
+	for (uint32_t i = 0; i < validationRowCount; ++i) {
+		uint32_t rowIndex = weightedRows[size_t(i) * weightedRows.size() / validationRowCount];
+		getRowWeights(rowIndex);
+		char name[64];
+		snprintf(name, sizeof(name), "outgoing %u nodeLabel_G %u", rowIndex / indivisibleNodeCount_G, rowIndex % indivisibleNodeCount_G);
+		std::span<const shaderio::OctreeNodePairAliasEntry_FzbPG> row(aliasTable + size_t(rowIndex) * indivisibleNodeCount_E, indivisibleNodeCount_E);
+		allPassed &= NodePairAliasTable_FzbPG::validate(weights, row, aliasTableValidationSampleCount, name);
+	}
+	if (validationRowCount == 0) LOGW("Octree_FzbPG: ڵȨرȫΪ0ûпɼalias\n");
+	else if (allPassed) LOGI("Octree_FzbPG: %u/%zualiasCPUοʵһ\n", validationRowCount, weightedRows.size());
+	else LOGE("Octree_FzbPG: aliasCPUοʵֲһ\n");
+
+	allocator->destroyBuffer(stageBuffer);
 }
 void Octree_FzbPG::render(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd, "Octree_render");
+	auto section = profileStage(cmd, "Render");
 
 	updateDataPerFrame(cmd);
 
@@ -321,21 +569,77 @@ void Octree_FzbPG::render(VkCommandBuffer cmd) {
 
 	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
 		staticDescPack.getSetPtr(), 0, nullptr);
-
-	nvvk::WriteSetContainer write{};
-	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), setting.asManager->asBuilder.tlas);
-	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 1, write.size(), write.data());
+	pushDynamicDescriptorSet(cmd, VK_PIPELINE_BIND_POINT_COMPUTE);
 
 	vkCmdPushConstants2(cmd, &pushInfo);
 
-	initOctreeArray(cmd);
+	{
+		auto stageSection = profileStage(cmd, "InitOctreeArray");
+		initOctreeArray(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
-	createOctreeArray(cmd);
+	{
+		auto stageSection = profileStage(cmd, "CreateOctreeArray");
+		createOctreeArray(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
-	getOctreeLabel(cmd);
+	{
+		auto stageSection = profileStage(cmd, "GetOctreeLabel");
+		getOctreeLabel(cmd);
+	}
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
-	getOctreeNodePairData(cmd);
-	getNearbyNodeInfo(cmd);
+	{
+		auto stageSection = profileStage(cmd, "GetOctreeNodePairData");
+		getOctreeNodePairData(cmd);
+	}
+	{
+		auto stageSection = profileStage(cmd, "GetNearbyNodeInfo");
+		getNearbyNodeInfo(cmd);
+	}
+
+	//ضʵĽڵԱСǰۣ֡֡һαȴpreRenderеС
+	uint32_t frameCycleIndex = Application::app->getFrameCycleIndex();
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	VkBufferCopy2 copyRegionInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+		.srcOffset = offsetof(shaderio::OctreeGlobalInfo_FzbPG, requiredNodePairWeightSize),
+		.dstOffset = 0,
+		.size = 4 * sizeof(uint32_t),
+	};
+	VkCopyBufferInfo2 copyBufferInfo{
+		.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+		.srcBuffer = globalInfoBuffer.buffer,
+		.dstBuffer = nodePairSizeStageBuffers[frameCycleIndex].buffer,
+		.regionCount = 1,
+		.pRegions = &copyRegionInfo,
+	};
+	vkCmdCopyBuffer2(cmd, &copyBufferInfo);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+	nodePairSizeStageWritten[frameCycleIndex] = true;
+}
+//ڵԻ˲ڵ㻺ؽÿ֡TLASһpushִе֡Լ¼ʱĻ
+void Octree_FzbPG::pushDynamicDescriptorSet(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint) {
+	nvvk::WriteSetContainer write{};
+	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), setting.asManager->asBuilder.tlas);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairWeight),
+		octreeNodePairWeightBuffer, 0, octreeNodePairWeightBuffer.bufferSize);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairAliasTable),
+		octreeNodePairAliasTableBuffer, 0, octreeNodePairAliasTableBuffer.bufferSize);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeData_G),
+		octreeDataBuffer_G, 0, octreeDataBuffer_G.bufferSize);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeClusterData_G),
+		octreeClusterDataBuffer_G, 0, octreeClusterDataBuffer_G.bufferSize);
+	write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeClusterData_E),
+		octreeClusterDataBuffer_E, 0, octreeClusterDataBuffer_E.bufferSize);
+	if (permutation.adaptiveImportanceSampling) {
+		write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairData),
+			octreeNodePairDataBuffer, 0, octreeNodePairDataBuffer.bufferSize);
+		write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::ePartialHitNodePairTempData),
+			partialHitNodePairTempDataBuffer, 0, partialHitNodePairTempDataBuffer.bufferSize);
+		write.append(dynamicDescPack.makeWrite((uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eHitTestNodePairInfo),
+			hitTestNodePairInfoBuffer, 0, hitTestNodePairInfoBuffer.bufferSize);
+	}
+	vkCmdPushDescriptorSetKHR(cmd, bindPoint, pipelineLayout, 1, write.size(), write.data());
 }
 void Octree_FzbPG::postProcess(VkCommandBuffer cmd) {
 #ifndef NDEBUG
@@ -346,73 +650,49 @@ void Octree_FzbPG::postProcess(VkCommandBuffer cmd) {
 #endif
 };
 
+//Octree2.slanggetOctreeBlockInfoOffsetͬlayerIndexBlockInfos_Gеķ㣬ĸĿ֮
+static uint32_t getOctreeBlockInfoOffset(uint32_t octreeMaxLayer, uint32_t layerIndex) {
+	uint32_t offset = 0;
+	for (uint32_t i = layerIndex + 1; i <= octreeMaxLayer; ++i) offset += 6u << (3 * (i - 1));
+	return offset;
+}
 void Octree_FzbPG::createOctreeArray() {
 	uint32_t VGBSize = uint32_t(setting.VGBSize);
-	octreeMaxLayer = std::countr_zero(VGBSize);	//start from 0
-	if (octreeMaxLayer > MAX_OCTREE_LAYER_FZBPG) {
-		throw std::runtime_error("˲Ϊ532x32x32");
-	}
+	octreeMaxLayer = std::countr_zero(VGBSize);	//start from 0FzbPathGuidingRendererѽضϵMAX_OCTREE_LAYER_FZBPG
 
 	nvvk::StagingUploader& stagingUploader = Application::stagingUploader;
 	nvvk::ResourceAllocator* allocator = stagingUploader.getResourceAllocator();
 
-	octreeDataBuffer_G.resize(octreeMaxLayer + 1);
-	uint32_t layerNodeCount = 6;
-	for (int layerIndex = 0; layerIndex <= octreeMaxLayer; ++layerIndex) {
-		uint32_t bufferSize = layerNodeCount * sizeof(shaderio::OctreeNodeData_G_FzbPG);
-		allocator->createBuffer(octreeDataBuffer_G[layerIndex], bufferSize,
-			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-		NVVK_DBG_NAME(octreeDataBuffer_G[layerIndex].buffer);
-
-		layerNodeCount *= 8;
-	}
-
-	uint32_t octreeClusterLayerCount = octreeMaxLayer - OCTREE_CLUSTER_LAYER_FZBPG + 1;
-	octreeClusterDataBuffer_G.resize(octreeClusterLayerCount);
-	octreeClusterDataBuffer_E.resize(octreeClusterLayerCount);
-	layerNodeCount = 6 * (1 << (3 * OCTREE_CLUSTER_LAYER_FZBPG));
-	for (int layerIndex = 0; layerIndex < octreeClusterLayerCount; ++layerIndex) {
-		uint32_t bufferSize = layerNodeCount * sizeof(shaderio::OctreeNodeClusterData_G_FzbPG);
-		allocator->createBuffer(octreeClusterDataBuffer_G[layerIndex], bufferSize,
-			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-		NVVK_DBG_NAME(octreeClusterDataBuffer_G[layerIndex].buffer);
-
-		bufferSize = layerNodeCount * sizeof(shaderio::OctreeNodeClusterData_E_FzbPG);
-		allocator->createBuffer(octreeClusterDataBuffer_E[layerIndex], bufferSize,
-			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-		NVVK_DBG_NAME(octreeClusterDataBuffer_E[layerIndex].buffer);
-
-		layerNodeCount *= 8;
-	}
-
-	uint32_t bufferSize = CLUSTER_LAYER_NODECOUNT_E_FZBPG * sizeof(shaderio::OctreeNodeData_E_FzbPG);
+	uint32_t bufferSize = CLUSTER_LAYER_NODECOUNT_E_FZBPG * permutation.getNodeDataSize_E();
 	allocator->createBuffer(clusterLayerDataBuffer_E, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(clusterLayerDataBuffer_E.buffer);
 
-	bufferSize = uint32_t(pow(8, octreeMaxLayer)) * 6 / 8 * sizeof(uint32_t);
+	//OCTREE_DENSE_LAYER_FZBPG㼰֮ÿһǰҶӲΪʱҪҲһ֤Ч
+	uint32_t blockInfoCount = std::max(getOctreeBlockInfoOffset(octreeMaxLayer, OCTREE_DENSE_LAYER_FZBPG - 1), 1u);
+	bufferSize = blockInfoCount * sizeof(uint32_t);
 	allocator->createBuffer(blockInfoBuffer_G, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(blockInfoBuffer_G.buffer);
 
-	allocator->createBuffer(blockInfoBuffer_E, bufferSize,
-		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(blockInfoBuffer_E.buffer);
-
-	bufferSize = int(pow(8, octreeMaxLayer)) * 6 / 8 * sizeof(uint32_t);
 	allocator->createBuffer(hasDataBlockIndexBuffer_G, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(hasDataBlockIndexBuffer_G.buffer);
 
-	allocator->createBuffer(hasDataBlockIndexBuffer_E, bufferSize,
-		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(hasDataBlockIndexBuffer_E.buffer);
-
-	bufferSize = sizeof(shaderio::HasDataOctreeBlockCount_FzbPG);
+	bufferSize = (MAX_OCTREE_LAYER_FZBPG + 1) * sizeof(uint32_t);
 	allocator->createBuffer(hasDataBlockCountBuffer, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(hasDataBlockCountBuffer.buffer);
 
+	/*
+	˲ڵ㻺ĳʼ
+	1. ܲĿ֮ϡ2^17飬256x256x256ʱΪʮGB
+	2. һ֡ʱpath guidingضʵĿ
+	*/
+	uint32_t sparseBlockCount = getOctreeBlockInfoOffset(octreeMaxLayer, OCTREE_DENSE_LAYER_FZBPG);
+	octreeBlockCapacity = OCTREE_DENSE_BLOCKCOUNT_FZBPG + std::min(sparseBlockCount, 1u << 17);
+	createOctreeNodeBuffers();
+
 	bufferSize = sizeof(shaderio::OctreeGlobalInfo_FzbPG);
 	allocator->createBuffer(globalInfoBuffer, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_2_INDIRECT_BUFFER_BIT);
@@ -439,54 +719,108 @@ void Octree_FzbPG::createOctreeArray() {
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(indivisibleNodeInfosBuffer_E.buffer);
 
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	bufferSize = IndivisibleNodeCount_G_FZBPG * CLUSTER_LAYER_NODECOUNT_E_FZBPG * sizeof(shaderio::OctreeNodePairData_FzbPG);
-	allocator->createBuffer(octreeNodePairDataBuffer, bufferSize,
-		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(octreeNodePairDataBuffer.buffer);
+	if (permutation.adaptiveImportanceSampling) {
+		uint32_t adaptiveImportantSampleLayerCount = ADAPTIVE_IMPORTANCE_SAMPLING_MAX_LAYER - OCTREE_CLUSTER_LAYER_FZBPG;
+		bufferSize = adaptiveImportantSampleLayerCount * sizeof(uint32_t);
+		allocator->createBuffer(partialHitNodePairCountBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(partialHitNodePairCountBuffer.buffer);
 
-	uint32_t adaptiveImportantSampleLayerCount = ADAPTIVE_IMPORTANCE_SAMPLING_MAX_LAYER - OCTREE_CLUSTER_LAYER_FZBPG;
-	bufferSize = adaptiveImportantSampleLayerCount * sizeof(uint32_t);
-	allocator->createBuffer(partialHitNodePairCountBuffer, bufferSize,
-		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(partialHitNodePairCountBuffer.buffer);
+		bufferSize = sizeof(uint32_t);
+		allocator->createBuffer(hitTestNodePairCountBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(hitTestNodePairCountBuffer.buffer);
+	}
 
-	bufferSize = IndivisibleNodeCount_G_FZBPG * CLUSTER_LAYER_NODECOUNT_E_FZBPG * sizeof(shaderio::OctreePartialHiNodePairTempData_FzbPG);
-	allocator->createBuffer(partialHitNodePairTempDataBuffer, bufferSize,
+	/*
+	ȨرڵaliasĳʼΪ֤һ֡һ֡ضʵʴС
+	aliasÿCLUSTER_LAYER_NODECOUNT_E_FZBPGgetProbabilityһ߳鴦һУ
+	*/
+	nodePairWeightCapacity = permutation.outgoingCount * IndivisibleNodeCount_G_FZBPG * NODEPAIR_ROW_MAX_SIZE_FZBPG;
+	nodePairDataCapacity = IndivisibleNodeCount_G_FZBPG * CLUSTER_LAYER_NODECOUNT_E_FZBPG;
+	nodePairAliasCapacity = permutation.outgoingCount * IndivisibleNodeCount_G_FZBPG * CLUSTER_LAYER_NODECOUNT_E_FZBPG;
+	createNodePairBuffers();
+
+	//ÿ֡һض壬ֻڸ֡۵֡ɺȡ
+	uint32_t frameCycleSize = Application::app->getFrameCycleSize();
+	nodePairSizeStageBuffers.resize(frameCycleSize);
+	nodePairSizeStageWritten.assign(frameCycleSize, false);
+	retiredBuffers.resize(frameCycleSize);
+	for (nvvk::Buffer& stageBuffer : nodePairSizeStageBuffers) {
+		allocator->createBuffer(stageBuffer, 4 * sizeof(uint32_t), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+		NVVK_DBG_NAME(stageBuffer.buffer);
+	}
+
+	if (permutation.nearbyNodeJitter) {
+		bufferSize = IndivisibleNodeCount_G_FZBPG * (IndivisibleNodeCount_G_FZBPG / GETNEARBYNODES_CS_THREADGROUP_SIZE) * permutation.getNearbyNodeTempInfoSize();
+		allocator->createBuffer(nearbyNodeTempInfoBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(nearbyNodeTempInfoBuffer.buffer);
+
+		bufferSize = IndivisibleNodeCount_G_FZBPG * permutation.getNearbyNodeInfoSize();
+		allocator->createBuffer(nearbyNodeInfoBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(nearbyNodeInfoBuffer.buffer);
+	}
+
+	pushConstant.octreeMaxLayer = octreeMaxLayer;
+	pushConstant.VGBVoxelTotalCount = VGBSize * VGBSize * VGBSize;
+	//initOctreeArray߳ΪҶӲÿأ֮Ϊܲÿڵַ
+	pushConstant.octreeNodeTotalCount = pushConstant.VGBVoxelTotalCount * 6 + OCTREE_DENSE_NODECOUNT_FZBPG;
+}
+void Octree_FzbPG::createOctreeNodeBuffers() {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+
+	VkDeviceSize nodeCount = VkDeviceSize(octreeBlockCapacity) * 8;
+	allocator->createBuffer(octreeDataBuffer_G, nodeCount * sizeof(shaderio::OctreeNodeData_G_FzbPG),
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(partialHitNodePairTempDataBuffer.buffer);
+	NVVK_DBG_NAME(octreeDataBuffer_G.buffer);
 
-	bufferSize = sizeof(uint32_t);
-	allocator->createBuffer(hitTestNodePairCountBuffer, bufferSize,
+	allocator->createBuffer(octreeClusterDataBuffer_G, nodeCount * sizeof(shaderio::OctreeNodeClusterData_G_FzbPG),
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(hitTestNodePairCountBuffer.buffer);
+	NVVK_DBG_NAME(octreeClusterDataBuffer_G.buffer);
 
-	bufferSize = IndivisibleNodeCount_G_FZBPG * CLUSTER_LAYER_NODECOUNT_E_FZBPG * sizeof(shaderio::OctreeHitTestNodePairInfo_FzbPG);
-	allocator->createBuffer(hitTestNodePairInfoBuffer, bufferSize,
+	allocator->createBuffer(octreeClusterDataBuffer_E, nodeCount * sizeof(shaderio::OctreeNodeClusterData_E_FzbPG),
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(hitTestNodePairInfoBuffer.buffer);
-#endif
+	NVVK_DBG_NAME(octreeClusterDataBuffer_E.buffer);
+
+	pushConstant.octreeBlockCapacity = octreeBlockCapacity;
+}
+void Octree_FzbPG::createNodePairBuffers() {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
 
-	bufferSize = OUTGOING_COUNT_FZBPG * IndivisibleNodeCount_G_FZBPG * OCTREE_NODECOUNT_E_FZBPG * sizeof(float);
+	VkDeviceSize bufferSize = VkDeviceSize(nodePairWeightCapacity) * sizeof(uint32_t);
 	allocator->createBuffer(octreeNodePairWeightBuffer, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(octreeNodePairWeightBuffer.buffer);
 
-	#ifdef NEARBYNODE_JITTER_FZBPG
-	bufferSize = IndivisibleNodeCount_G_FZBPG * (IndivisibleNodeCount_G_FZBPG / GETNEARBYNODES_CS_THREADGROUP_SIZE) * sizeof(shaderio::IndivisibleNodeNearbyNodeTempInfo_FzbPG);
-	allocator->createBuffer(nearbyNodeTempInfoBuffer, bufferSize,
+	//aliasȨرͬÿֻѹindivisibleNodeCount_EлָΪ0ʱҲһ֤Ч
+	bufferSize = VkDeviceSize(std::max(nodePairAliasCapacity, 1u)) * sizeof(shaderio::OctreeNodePairAliasEntry_FzbPG);
+	allocator->createBuffer(octreeNodePairAliasTableBuffer, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(nearbyNodeTempInfoBuffer.buffer);
+	NVVK_DBG_NAME(octreeNodePairAliasTableBuffer.buffer);
 
-	bufferSize = IndivisibleNodeCount_G_FZBPG * sizeof(shaderio::OctreeNearbyNodeInfo_FzbPG);
-	allocator->createBuffer(nearbyNodeInfoBuffer, bufferSize,
-		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
-	NVVK_DBG_NAME(nearbyNodeInfoBuffer.buffer);
-	#endif
+	if (permutation.adaptiveImportanceSampling) {
+		bufferSize = VkDeviceSize(nodePairDataCapacity) * sizeof(shaderio::OctreeNodePairData_FzbPG);
+		allocator->createBuffer(octreeNodePairDataBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(octreeNodePairDataBuffer.buffer);
 
-	pushConstant.octreeMaxLayer = octreeMaxLayer;
-	pushConstant.octreeNodeTotalCount = int(pow(8, octreeMaxLayer + 1) - 1) / 7 * 6;
-	pushConstant.VGBVoxelTotalCount = VGBSize * VGBSize * VGBSize;
+		bufferSize = VkDeviceSize(nodePairDataCapacity) * sizeof(shaderio::OctreePartialHiNodePairTempData_FzbPG);
+		allocator->createBuffer(partialHitNodePairTempDataBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(partialHitNodePairTempDataBuffer.buffer);
+
+		bufferSize = VkDeviceSize(nodePairDataCapacity) * sizeof(shaderio::OctreeHitTestNodePairInfo_FzbPG);
+		allocator->createBuffer(hitTestNodePairInfoBuffer, bufferSize,
+			VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+		NVVK_DBG_NAME(hitTestNodePairInfoBuffer.buffer);
+	}
+
+	pushConstant.nodePairWeightCapacity = nodePairWeightCapacity;
+	pushConstant.nodePairDataCapacity = nodePairDataCapacity;
+	pushConstant.nodePairAliasCapacity = nodePairAliasCapacity;
 }
 void Octree_FzbPG::createDescriptorSetLayout() {
 	SCOPED_TIMER(__FUNCTION__);
@@ -496,21 +830,6 @@ void Octree_FzbPG::createDescriptorSetLayout() {
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = (uint32_t)setting.VGBs.size(),
 		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeClusterData_G,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = (uint32_t)octreeClusterDataBuffer_G.size(),	//max 128x128x128
-		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeData_G,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = (uint32_t)octreeDataBuffer_G.size(),
-		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeClusterData_E,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = (uint32_t)octreeClusterDataBuffer_E.size(),
-		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eClusterLayerData_E,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
@@ -521,21 +840,11 @@ void Octree_FzbPG::createDescriptorSetLayout() {
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eBlockInfos_E,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockIndices_G,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockIndices_E,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
 		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockCount,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
@@ -566,66 +875,88 @@ void Octree_FzbPG::createDescriptorSetLayout() {
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeNodePairData,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
-	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairCount,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
+	if (permutation.adaptiveImportanceSampling) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairCount,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairCount,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+	if (permutation.nearbyNodeJitter) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeTempInfos,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeInfos,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+
+	NVVK_DBG_NAME(staticDescPack.getLayout());
+	NVVK_DBG_NAME(staticDescPack.getPool());
+	NVVK_DBG_NAME(staticDescPack.getSet(0));
+
+	bindings.clear();
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairTempData,
-		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_ALL });
+			.binding = shaderio::DynamicSetBindingPoints_PT::eTlas_PT,
+			.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL
+		});
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairCount,
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairWeight,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairInfo,
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairAliasTable,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#endif
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeNodePairWeight,
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeData_G,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#ifdef NEARBYNODE_JITTER_FZBPG
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeTempInfos,
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeClusterData_G,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
 	bindings.addBinding({
-		.binding = (uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeInfos,
+		.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeClusterData_E,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
-#endif
-
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
-		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
-
-	NVVK_DBG_NAME(staticDescPack.getLayout());
-	NVVK_DBG_NAME(staticDescPack.getPool());
-	NVVK_DBG_NAME(staticDescPack.getSet(0));
-
-	bindings.clear();
-	bindings.addBinding({
-			.binding = shaderio::DynamicSetBindingPoints_PT::eTlas_PT,
-			.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+	if (permutation.adaptiveImportanceSampling) {
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eOctreeNodePairData,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 			.descriptorCount = 1,
-			.stageFlags = VK_SHADER_STAGE_ALL
-		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+			.stageFlags = VK_SHADER_STAGE_ALL });
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::ePartialHitNodePairTempData,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+		bindings.addBinding({
+			.binding = (uint32_t)shaderio::DynamicBindingPoints_Octree_FzbPG::eHitTestNodePairInfo,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 }
 void Octree_FzbPG::createDescriptorSet() {
 	nvvk::WriteSetContainer write{};
@@ -635,21 +966,6 @@ void Octree_FzbPG::createDescriptorSet() {
 	write.append(VGBWrite, VGBsPtr);
 
 	VkWriteDescriptorSet    OctreeArrayWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeClusterData_G, 0, 0, octreeClusterDataBuffer_G.size());
-	nvvk::Buffer* octreeArraysPtr = octreeClusterDataBuffer_G.data();
-	write.append(OctreeArrayWrite, octreeArraysPtr);
-
-	OctreeArrayWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeData_G, 0, 0, octreeDataBuffer_G.size());
-	octreeArraysPtr = octreeDataBuffer_G.data();
-	write.append(OctreeArrayWrite, octreeArraysPtr);
-
-	OctreeArrayWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeClusterData_E, 0, 0, octreeClusterDataBuffer_E.size());
-	octreeArraysPtr = octreeClusterDataBuffer_E.data();
-	write.append(OctreeArrayWrite, octreeArraysPtr);
-
-	OctreeArrayWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eClusterLayerData_E, 0, 0, 1);
 	write.append(OctreeArrayWrite, clusterLayerDataBuffer_E, 0, clusterLayerDataBuffer_E.bufferSize);
 
@@ -657,18 +973,10 @@ void Octree_FzbPG::createDescriptorSet() {
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eBlockInfos_G, 0, 0, 1);
 	write.append(HasDataInfoWrite, blockInfoBuffer_G, 0, blockInfoBuffer_G.bufferSize);
 
-	HasDataInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eBlockInfos_E, 0, 0, 1);
-	write.append(HasDataInfoWrite, blockInfoBuffer_E, 0, blockInfoBuffer_E.bufferSize);
-
 	HasDataInfoWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockIndices_G, 0, 0, 1);
 	write.append(HasDataInfoWrite, hasDataBlockIndexBuffer_G, 0, hasDataBlockIndexBuffer_G.bufferSize);
 
-	HasDataInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockIndices_E, 0, 0, 1);
-	write.append(HasDataInfoWrite, hasDataBlockIndexBuffer_E, 0, hasDataBlockIndexBuffer_E.bufferSize);
-
 	HasDataInfoWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHasDataBlockCount, 0, 0, 1);
 	write.append(HasDataInfoWrite, hasDataBlockCountBuffer, 0, hasDataBlockCountBuffer.bufferSize);
@@ -693,41 +1001,25 @@ void Octree_FzbPG::createDescriptorSet() {
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eIndivisibleNodeInfos_E, 0, 0, 1);
 	write.append(IndivisibleInfoWrite, indivisibleNodeInfosBuffer_E, 0, indivisibleNodeInfosBuffer_E.bufferSize);
 
-	VkWriteDescriptorSet NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeNodePairWeight, 0, 0, 1);
-	write.append(NodePairInfoWrite, octreeNodePairWeightBuffer, 0, octreeNodePairWeightBuffer.bufferSize);
-
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eOctreeNodePairData, 0, 0, 1);
-	write.append(NodePairInfoWrite, octreeNodePairDataBuffer, 0, octreeNodePairDataBuffer.bufferSize);
+	if (permutation.adaptiveImportanceSampling) {
+		VkWriteDescriptorSet NodePairInfoWrite =
+			staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairCount, 0, 0, 1);
+		write.append(NodePairInfoWrite, partialHitNodePairCountBuffer, 0, partialHitNodePairCountBuffer.bufferSize);
 
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairCount, 0, 0, 1);
-	write.append(NodePairInfoWrite, partialHitNodePairCountBuffer, 0, partialHitNodePairCountBuffer.bufferSize);
-
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::ePartialHitNodePairTempData, 0, 0, 1);
-	write.append(NodePairInfoWrite, partialHitNodePairTempDataBuffer, 0, partialHitNodePairTempDataBuffer.bufferSize);
-
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairCount, 0, 0, 1);
-	write.append(NodePairInfoWrite, hitTestNodePairCountBuffer, 0, hitTestNodePairCountBuffer.bufferSize);
-
-	NodePairInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairInfo, 0, 0, 1);
-	write.append(NodePairInfoWrite, hitTestNodePairInfoBuffer, 0, hitTestNodePairInfoBuffer.bufferSize);
-#endif
+		NodePairInfoWrite =
+			staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eHitTestNodePairCount, 0, 0, 1);
+		write.append(NodePairInfoWrite, hitTestNodePairCountBuffer, 0, hitTestNodePairCountBuffer.bufferSize);
+	}
 
-#ifdef NEARBYNODE_JITTER_FZBPG
-	VkWriteDescriptorSet    NearbyNodeInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeTempInfos, 0, 0, 1);
-	write.append(NearbyNodeInfoWrite, nearbyNodeTempInfoBuffer, 0, nearbyNodeTempInfoBuffer.bufferSize);
+	if (permutation.nearbyNodeJitter) {
+		VkWriteDescriptorSet    NearbyNodeInfoWrite =
+			staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeTempInfos, 0, 0, 1);
+		write.append(NearbyNodeInfoWrite, nearbyNodeTempInfoBuffer, 0, nearbyNodeTempInfoBuffer.bufferSize);
 
-	NearbyNodeInfoWrite =
-		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeInfos, 0, 0, 1);
-	write.append(NearbyNodeInfoWrite, nearbyNodeInfoBuffer, 0, nearbyNodeInfoBuffer.bufferSize);
-#endif
+		NearbyNodeInfoWrite =
+			staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_FzbPG::eNearbyNodeInfos, 0, 0, 1);
+		write.append(NearbyNodeInfoWrite, nearbyNodeInfoBuffer, 0, nearbyNodeInfoBuffer.bufferSize);
+	}
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
 }
@@ -749,9 +1041,22 @@ void Octree_FzbPG::createPipeline() {
 	NVVK_CHECK(vkCreatePipelineLayout(Application::app->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout));
 	NVVK_DBG_NAME(pipelineLayout);
 }
+void Octree_FzbPG::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	ShaderCompileRequest request{ .shaderSource = shaderPath / "Octree2.slang", .macros = permutation.getMacros() };
+	#ifndef NDEBUG
+	request.macros.push_back({ "OctreeLayerMapCount", std::to_string(showOctreeLayerMapCount) });
+	#endif
+	requests.push_back(request);
+
+	requests.push_back({ .shaderSource = shaderPath / "GetOctreeIndivisibleNodeLabel.slang", .macros = permutation.getMacros() });
+	if (permutation.nearbyNodeJitter)
+		requests.push_back({ .shaderSource = shaderPath / "GetNearbyNodeInfo.slang", .macros = permutation.getMacros() });
+}
 void Octree_FzbPG::compileAndCreateShaders() {
 	SCOPED_TIMER(__FUNCTION__);
 
+	permutation.addMacros();
 	#ifndef NDEBUG
 	std::string octreeLayerMapCountName = "OctreeLayerMapCount";
 	std::string octreeLayerMapCount = std::to_string(showOctreeLayerMapCount);
@@ -767,6 +1072,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 
 	#ifndef NDEBUG
 	Application::slangCompiler.clearMacros();
+	permutation.addMacros();
 	#endif
 
 	const VkPushConstantRange pushConstantRange{
@@ -794,7 +1100,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
 	NVVK_DBG_NAME(computeShader_initOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_initHasDataBlockInfo, nullptr);
@@ -804,7 +1110,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initHasDataBlockInfo";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initHasDataBlockInfo);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initHasDataBlockInfo);
 	NVVK_DBG_NAME(computeShader_initHasDataBlockInfo);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getGlobalInfo, nullptr);
@@ -814,7 +1120,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getGlobalInfo";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getGlobalInfo);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getGlobalInfo);
 	NVVK_DBG_NAME(computeShader_getGlobalInfo);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray, nullptr);
@@ -824,7 +1130,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
 	NVVK_DBG_NAME(computeShader_createOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray2, nullptr);
@@ -834,7 +1140,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
 	NVVK_DBG_NAME(computeShader_createOctreeArray2);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_initWeights, nullptr);
@@ -844,7 +1150,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initWeights";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initWeights);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initWeights);
 	NVVK_DBG_NAME(computeShader_initWeights);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_octreeNodeHitTest, nullptr);
@@ -854,7 +1160,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_octreeNodeHitTest";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_octreeNodeHitTest);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_octreeNodeHitTest);
 	NVVK_DBG_NAME(computeShader_octreeNodeHitTest);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getProbability, nullptr);
@@ -864,7 +1170,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getProbability";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getProbability);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getProbability);
 	NVVK_DBG_NAME(computeShader_getProbability);
 
 #ifndef NDEBUG
@@ -877,7 +1183,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_OctreeLayer";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_OctreeLayer);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_OctreeLayer);
 	NVVK_DBG_NAME(vertexShader_OctreeLayer);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -885,7 +1191,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_OctreeLayer";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_OctreeLayer);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_OctreeLayer);
 	NVVK_DBG_NAME(fragmentShader_OctreeLayer);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_OctreeNodePairHitTestResult, nullptr);
@@ -896,7 +1202,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_OctreeNodePairHitTestResult";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_OctreeNodePairHitTestResult);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_OctreeNodePairHitTestResult);
 	NVVK_DBG_NAME(vertexShader_OctreeNodePairHitTestResult);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -904,7 +1210,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_OctreeNodePairHitTestResult";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_OctreeNodePairHitTestResult);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_OctreeNodePairHitTestResult);
 	NVVK_DBG_NAME(fragmentShader_OctreeNodePairHitTestResult);
 #endif
 
@@ -921,7 +1227,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getOctreeLabel1";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel1);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel1);
 		NVVK_DBG_NAME(computeShader_getOctreeLabel1);
 		//--------------------------------------------------------------------------------------
 		vkDestroyShaderEXT(device, computeShader_getOctreeLabel2, nullptr);
@@ -931,7 +1237,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getOctreeLabel2";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel2);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel2);
 		NVVK_DBG_NAME(computeShader_getOctreeLabel2);
 		//--------------------------------------------------------------------------------------
 		vkDestroyShaderEXT(device, computeShader_getOctreeLabel3, nullptr);
@@ -941,7 +1247,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getOctreeLabel3";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel3);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel3);
 		NVVK_DBG_NAME(computeShader_getOctreeLabel3);
 		//--------------------------------------------------------------------------------------
 		vkDestroyShaderEXT(device, computeShader_getOctreeLabel4, nullptr);
@@ -951,7 +1257,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getOctreeLabel4";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel4);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel4);
 		NVVK_DBG_NAME(computeShader_getOctreeLabel4);
 		#ifndef NDEBUG
 		//--------------------------------------------------------------------------------------
@@ -963,7 +1269,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "vertexMain_OctreeIndivisibleNodes";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_OctreeIndivisibleNodes);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_OctreeIndivisibleNodes);
 		NVVK_DBG_NAME(vertexShader_OctreeIndivisibleNodes);
 
 		shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -971,14 +1277,13 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "fragmentMain_OctreeIndivisibleNodes";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_OctreeIndivisibleNodes);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_OctreeIndivisibleNodes);
 		NVVK_DBG_NAME(fragmentShader_OctreeIndivisibleNodes);
 		#endif
 	}
 
-#ifdef NEARBYNODE_JITTER_FZBPG
 //----------------------------------------getNearbyNodeInfo------------------------------------------
-	{
+	if (permutation.nearbyNodeJitter) {
 		shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
 		shaderSource = shaderPath / "GetNearbyNodeInfo.slang";
 		shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
@@ -990,7 +1295,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getNearbyNodes1";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes1);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes1);
 		NVVK_DBG_NAME(computeShader_getNearbyNodes1);
 		//--------------------------------------------------------------------------------------
 		vkDestroyShaderEXT(device, computeShader_getNearbyNodes2, nullptr);
@@ -1000,7 +1305,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getNearbyNodes2";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes2);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes2);
 		NVVK_DBG_NAME(computeShader_getNearbyNodes2);
 		#ifndef NDEBUG
 		//--------------------------------------------------------------------------------------
@@ -1012,7 +1317,7 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "vertexMain_nearby";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_NearbyNodeInfoResult);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_NearbyNodeInfoResult);
 		NVVK_DBG_NAME(vertexShader_NearbyNodeInfoResult);
 
 		shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -1020,11 +1325,12 @@ void Octree_FzbPG::compileAndCreateShaders() {
 		shaderInfo.pName = "fragmentMain_nearby";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_NearbyNodeInfoResult);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_NearbyNodeInfoResult);
 		NVVK_DBG_NAME(fragmentShader_NearbyNodeInfoResult);
 #endif
 	}
-#endif
+
+	Application::slangCompiler.clearMacros();
 }
 void Octree_FzbPG::updateDataPerFrame(VkCommandBuffer cmd) {}
 
@@ -1037,33 +1343,52 @@ void Octree_FzbPG::initOctreeArray(VkCommandBuffer cmd) {
 	VkExtent2D groupSize = nvvk::getGroupCounts({ pushConstant.octreeNodeTotalCount, 1 }, VkExtent2D{ 1024, 1 });
 	vkCmdDispatch(cmd, groupSize.width, groupSize.height, 1);
 }
+/*
+OCTREE_DENSE_LAYER_FZBPG㼰֮Ĳ
+1. ҶӲѹÿݵĿ飬Ϊϡӿط飬Ǹ飻ذǳ䣬ѹв
+2. ٴҶӲϺϲӽڵ㣬ڵĿڵ1Ѿ
+֮ϵĳܲ㰴ڵϲ
+*/
 void Octree_FzbPG::createOctreeArray(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd);
 
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
 
-	uint32_t layerBlockCount = uint32_t(pow(8, pushConstant.octreeMaxLayer)) * 6 / 8;
-	for (int layerIndex = pushConstant.octreeMaxLayer; layerIndex > OCTREE_CLUSTER_LAYER_FZBPG; --layerIndex) {
-		pushConstant.currentLayer = layerIndex;
-		pushConstant.currentLayerBlockCount = layerBlockCount;
-		vkCmdPushConstants2(cmd, &pushInfo);
-
-		vkCmdFillBuffer(cmd, hasDataBlockCountBuffer.buffer, 0, sizeof(shaderio::HasDataOctreeBlockCount_FzbPG), 0);
+	if (octreeMaxLayer > OCTREE_CLUSTER_LAYER_FZBPG) {
+		//ҶӲķinitOctreeArrayд룬ÿ֡
+		uint32_t blockInfoOffset = getOctreeBlockInfoOffset(octreeMaxLayer, octreeMaxLayer - 1);
+		if (blockInfoOffset < blockInfoBuffer_G.bufferSize / sizeof(uint32_t))
+			vkCmdFillBuffer(cmd, blockInfoBuffer_G.buffer, blockInfoOffset * sizeof(uint32_t), VK_WHOLE_SIZE, 0);
+		vkCmdFillBuffer(cmd, hasDataBlockCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
 		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
 		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_initHasDataBlockInfo);
-		VkExtent2D groupSize = nvvk::getGroupCounts({ layerBlockCount, 1 }, VkExtent2D{ 1024, 1 });
-		vkCmdDispatch(cmd, groupSize.width, 1, 1);
-		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		for (uint32_t layerIndex = octreeMaxLayer; layerIndex >= OCTREE_DENSE_LAYER_FZBPG; --layerIndex) {
+			uint32_t layerBlockCount = 6u << (3 * (layerIndex - 1));
+			pushConstant.currentLayer = layerIndex;
+			pushConstant.currentLayerBlockCount = layerBlockCount;
+			pushConstant.currentLayerBlockInfoOffset = getOctreeBlockInfoOffset(octreeMaxLayer, layerIndex);
+			vkCmdPushConstants2(cmd, &pushInfo);
+
+			VkExtent2D groupSize = nvvk::getGroupCounts({ layerBlockCount, 1 }, VkExtent2D{ 1024, 1 });
+			vkCmdDispatch(cmd, groupSize.width, 1, 1);
+			nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		}
 
-		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_getGlobalInfo);
-		vkCmdDispatch(cmd, 1, 1, 1);
-		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+		for (uint32_t layerIndex = octreeMaxLayer; layerIndex >= OCTREE_DENSE_LAYER_FZBPG; --layerIndex) {
+			pushConstant.currentLayer = layerIndex;
+			pushConstant.currentLayerBlockCount = 6u << (3 * (layerIndex - 1));
+			pushConstant.currentLayerBlockInfoOffset = getOctreeBlockInfoOffset(octreeMaxLayer, layerIndex);
+			vkCmdPushConstants2(cmd, &pushInfo);
 
-		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_createOctreeArray);
-		vkCmdDispatchIndirect(cmd, globalInfoBuffer.buffer, 0);
+			vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_getGlobalInfo);
+			vkCmdDispatch(cmd, 1, 1, 1);
+			nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
 
-		layerBlockCount /= 8;
+			vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_createOctreeArray);
+			vkCmdDispatchIndirect(cmd, globalInfoBuffer.buffer, 0);
+			nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		}
 	}
 
 	for (int layerIndex = OCTREE_CLUSTER_LAYER_FZBPG; layerIndex > 0; --layerIndex) {
@@ -1112,7 +1437,7 @@ void Octree_FzbPG::getOctreeNodePairData(VkCommandBuffer cmd) {
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
 
 	vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_initWeights);
-	uint32_t threadTotalCount = OUTGOING_COUNT_FZBPG * IndivisibleNodeCount_G_FZBPG * OCTREE_NODECOUNT_E_FZBPG;
+	uint32_t threadTotalCount = nodePairWeightCapacity;
 	VkExtent2D groupSize = nvvk::getGroupCounts({ threadTotalCount, 1 }, VkExtent2D{ INITWEIGHT_CS_THREADGROUP_SIZE, 1 });
 	vkCmdDispatch(cmd, groupSize.width, groupSize.height, 1);
 	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
@@ -1125,7 +1450,7 @@ void Octree_FzbPG::getOctreeNodePairData(VkCommandBuffer cmd) {
 	vkCmdDispatchIndirect(cmd, globalInfoBuffer.buffer, 0);
 }
 void Octree_FzbPG::getNearbyNodeInfo(VkCommandBuffer cmd) {
-#ifdef NEARBYNODE_JITTER_FZBPG
+	if (!permutation.nearbyNodeJitter) return;
 	NVVK_DBG_SCOPE(cmd);
 
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
@@ -1136,7 +1461,6 @@ void Octree_FzbPG::getNearbyNodeInfo(VkCommandBuffer cmd) {
 
 	vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_getNearbyNodes2);
 	vkCmdDispatchIndirect(cmd, globalInfoBuffer.buffer, offsetof(shaderio::OctreeGlobalInfo_FzbPG, cmd2));
-#endif
 }
 
 #ifndef NDEBUG
@@ -1149,10 +1473,10 @@ void Octree_FzbPG::debug_Prepare() {
 	showNearbyNodeInfoResultMapIndex = showOctreeIndivisibleNodeMapIndex + 2;
 
 	showMapCount = showOctreeLayerMapCount + 1 + 1 + 1;
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
-	showOctreeNodePairVisibleAabbMapIndex = showOctreeIndivisibleNodeMapIndex + 3;
-	++showMapCount;
-#endif
+	if (permutation.adaptiveImportanceSampling) {
+		showOctreeNodePairVisibleAabbMapIndex = showOctreeIndivisibleNodeMapIndex + 3;
+		++showMapCount;
+	}
 	Feature::createGBuffer(true, false, showMapCount);
 
 	pushConstant.sampleNodeLabel_G = 150;	// 49
@@ -1349,6 +1673,7 @@ void Octree_FzbPG::debug_OctreeNodePairHitTestResult_Visualization(VkCommandBuff
 
 	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
 		staticDescPack.getSetPtr(), 0, nullptr);
+	pushDynamicDescriptorSet(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
 	vkCmdBeginRendering(cmd, &renderingInfo);
 
@@ -1381,6 +1706,7 @@ void Octree_FzbPG::debug_OctreeNodePairHitTestResult_Visualization(VkCommandBuff
 	nvvk::cmdImageMemoryBarrier(cmd, { gBuffers.getColorImage(showOctreeNodePairHitTestResultMapIndex), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL });
 }
 void Octree_FzbPG::debug_NearbyNodeInfoResult_Visualization(VkCommandBuffer cmd) {
+	if (!permutation.nearbyNodeJitter) return;
 	NVVK_DBG_SCOPE(cmd);
 
 	nvvk::cmdImageMemoryBarrier(cmd, { gBuffers.getColorImage(showNearbyNodeInfoResultMapIndex), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
@@ -1436,7 +1762,7 @@ void Octree_FzbPG::debug_NearbyNodeInfoResult_Visualization(VkCommandBuffer cmd)
 	nvvk::cmdImageMemoryBarrier(cmd, { gBuffers.getColorImage(showNearbyNodeInfoResultMapIndex), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL });
 }
 void Octree_FzbPG::debug_NodePairVisibleAABB_Visualization(VkCommandBuffer cmd) {
-#ifdef ADAPTIVE_IMPORTANCE_SAMPLING
+	if (!permutation.adaptiveImportanceSampling) return;
 	//NVVK_DBG_SCOPE(cmd);
 
 	nvvk::cmdImageMemoryBarrier(cmd, { gBuffers.getColorImage(showOctreeNodePairVisibleAabbMapIndex), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
@@ -1493,6 +1819,5 @@ void Octree_FzbPG::debug_NodePairVisibleAABB_Visualization(VkCommandBuffer cmd)
 	vkCmdEndRendering(cmd);
 
 	nvvk::cmdImageMemoryBarrier(cmd, { gBuffers.getColorImage(showOctreeNodePairVisibleAabbMapIndex), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL });
-#endif
 }
 #endif
\ No newline at end of file
@@ -16,6 +16,31 @@ struct OctreeCreateInfo_FzbPG{
 
 	AccelerationStructureManager* asManager;
 };
+/*
+shaderУԭдshaderioеĺΪrendererInfo.xml<Octree><permutation/>ѡ
+1. ˲·shaderʱFZBPG_PERMUTATIONѡֵΪ꣬shaderioеĬֵֻûиúʱЧ
+2. 󶨵öʹõĽṹ岼ֲб仯˰ؾǷ񴴽塢dispatchֵ㻺С
+3. ͬеĺ겻ͬShaderCachekey꣬лвḴþɵSPIR-Výڵ<Octree>£Ҳݻkey
+*/
+struct GuidingPermutation_FzbPG {
+	bool adaptiveImportanceSampling = true;		//ADAPTIVE_IMPORTANCE_SAMPLING
+	bool nearbyNodeJitter = true;				//NEARBYNODE_JITTER_FZBPG
+	uint32_t nearbyNodeCount = 8;				//NEARBY_NODE_COUNT_FZBPG1 - 32
+	uint32_t hitTestCount = 16;					//HITTEST_COUNT_FZBPG8 - 32
+	uint32_t outgoingCount = 64;				//OUTGOING_COUNT_FZBPG64 - 5122
+
+	void parse(pugi::xml_node permutationNode);
+	//еĺApplication::slangCompilerslangָֻ룬ַmacroStrings
+	void addMacros();
+	const std::vector<std::pair<std::string, std::string>>& getMacros() const { return macroStrings; }
+
+	//˰мĽṹС
+	uint32_t getNodeDataSize_E() const;
+	uint32_t getNearbyNodeTempInfoSize() const;
+	uint32_t getNearbyNodeInfoSize() const;
+private:
+	std::vector<std::pair<std::string, std::string>> macroStrings;
+};
 
 class Octree_FzbPG : public Feature {
 public:
@@ -33,10 +58,13 @@ public:
 	void postProcess(VkCommandBuffer cmd);
 
 	void createOctreeArray();
+	void createNodePairBuffers();
 	void createDescriptorSetLayout() override;
 	void createDescriptorSet();
+	void pushDynamicDescriptorSet(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint);
 	void createPipeline();
 	void compileAndCreateShaders();
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
 	void updateDataPerFrame(VkCommandBuffer cmd) override;
 
 	void initOctreeArray(VkCommandBuffer cmd);
@@ -48,11 +76,13 @@ public:
 	shaderio::OctreePushConstant_FzbPG pushConstant{};
 
 	uint32_t octreeMaxLayer = 6;
+	GuidingPermutation_FzbPG permutation;
 
-	std::vector<nvvk::Buffer> octreeClusterDataBuffer_G;
-	std::vector<nvvk::Buffer> octreeDataBuffer_G;	//layer0: 6  layer1 48 
+	//вĽڵͬһУڵַΪ * 8 + ӽڵţǰOCTREE_DENSE_LAYER_FZBPGܣ֮Ĳӿз
+	nvvk::Buffer octreeClusterDataBuffer_G;
+	nvvk::Buffer octreeDataBuffer_G;
 
-	std::vector<nvvk::Buffer> octreeClusterDataBuffer_E;
+	nvvk::Buffer octreeClusterDataBuffer_E;
 	nvvk::Buffer clusterLayerDataBuffer_E;
 
 	nvvk::Buffer globalInfoBuffer;
@@ -60,18 +90,32 @@ public:
 	nvvk::Buffer indivisibleNodeInfosBuffer_E;
 
 	nvvk::Buffer octreeNodePairWeightBuffer;
+	nvvk::Buffer octreeNodePairAliasTableBuffer;	//ÿ(outgoing, nodeLabel_G)вɷEڵalias
 
 	nvvk::Buffer nearbyNodeInfoBuffer;
 
 	nvvk::Buffer octreeNodePairDataBuffer;
+
+	//ڵԻһ֡GPUͳƵʵСݻ汣ָʱʹ
+	void getNodePairSizes(uint32_t& weightCapacity, uint32_t& dataCapacity, uint32_t& aliasCapacity, uint32_t requiredSize[3]) const;
+	void restoreNodePairSizes(uint32_t weightCapacity, uint32_t dataCapacity, uint32_t aliasCapacity, const uint32_t requiredSize[3]);
+	//˲ڵ㻺Ŀһ֡Ŀ
+	void getOctreeBlockSizes(uint32_t& blockCapacity, uint32_t& requiredBlockCount) const;
+	void restoreOctreeBlockSizes(uint32_t blockCapacity, uint32_t requiredBlockCount);
+	//һ֡ĽڵԱûpreRender
+	bool isBufferSizeStable() const;
 private:
+	void resizeNodePairBuffers(uint32_t weightCapacity, uint32_t dataCapacity, uint32_t aliasCapacity);
+	void createOctreeNodeBuffers();
+	void resizeOctreeNodeBuffers(uint32_t blockCapacity);
+	//ضһ֡ȨرaliasCPUοʵֱȽϲֲ
+	void validateNodePairAliasTable();
+
 	OctreeCreateInfo_FzbPG setting;
 
-	nvvk::Buffer blockInfoBuffer_G;
-	nvvk::Buffer blockInfoBuffer_E;
-	nvvk::Buffer hasDataBlockIndexBuffer_G;
-	nvvk::Buffer hasDataBlockIndexBuffer_E;
-	nvvk::Buffer hasDataBlockCountBuffer;
+	nvvk::Buffer blockInfoBuffer_G;			//ܵһ㼰֮ÿĿűOctreeShaderio_FzbPG.h
+	nvvk::Buffer hasDataBlockIndexBuffer_G;	//ÿݵĿбblockInfoBuffer_Gķͬ
+	nvvk::Buffer hasDataBlockCountBuffer;	//ÿݵĿ
 
 	nvvk::Buffer divisibleNodeInfoBuffer_G;	
 	nvvk::Buffer threadGroupInfoBuffer;
@@ -83,6 +127,19 @@ private:
 	nvvk::Buffer hitTestNodePairCountBuffer;
 	nvvk::Buffer hitTestNodePairInfoBuffer;		//еӽڵϢ
 
+	uint32_t nodePairWeightCapacity = 0;		//octreeNodePairWeightBufferɵuint
+	uint32_t nodePairDataCapacity = 0;			//octreeNodePairDataBufferɵĽڵ
+	uint32_t nodePairAliasCapacity = 0;			//octreeNodePairAliasTableBufferɵ
+	std::vector<nvvk::Buffer> nodePairSizeStageBuffers;		//ÿ֡һضGPUͳƵʵĽڵԱС
+	std::vector<bool> nodePairSizeStageWritten;				//֡۵Ļضѱ¼ƣδȡ
+	uint32_t requiredNodePairSize[3] = {};					//ȡСȨرڵݡalias
+	uint32_t octreeBlockCapacity = 0;						//˲ڵ㻺ɵĿܲĿ
+	uint32_t requiredOctreeBlockCount = 0;					//ȡ
+	std::vector<std::vector<nvvk::Buffer>> retiredBuffers;	//ؽǰĽڵԻ˲ڵ㻺壬ʱ֡ڸ֡һαȴ
+
+	uint32_t aliasTableValidationSampleCount = 0;	//rendererInfo.xml<aliasTableValidation>ÿеĲ0Ϊ
+	bool aliasTableValidated = false;
+
 	VkShaderEXT computeShader_initOctreeArray{};
 	VkShaderEXT computeShader_initHasDataBlockInfo{};
 	VkShaderEXT computeShader_getGlobalInfo{};
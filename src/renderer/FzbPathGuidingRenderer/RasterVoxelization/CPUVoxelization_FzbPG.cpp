@@ -0,0 +1,319 @@
+#include "./CPUVoxelization_FzbPG.h"
+#include <common/Application/Application.h>
+#include <nvutils/logger.hpp>
+#include <nvutils/parallel_work.hpp>
+#include <nvutils/timers.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+using namespace FzbRenderer;
+
+namespace {
+struct VoxelAccumulator {
+	glm::vec4 sumNormal_G = glm::vec4(0.0f);
+	glm::vec3 minimum = glm::vec3(FLT_MAX);
+	glm::vec3 maximum = glm::vec3(-FLT_MAX);
+};
+//üĶ3 + 6
+struct ClipPolygon {
+	std::array<glm::vec3, 12> vertices;
+	uint32_t count = 0;
+};
+}
+
+//commonFunction.slangеFloatToOrderedIntOrderedIntToFloatͬ
+static int32_t floatToOrderedInt(float value) {
+	uint32_t bits = std::bit_cast<uint32_t>(value);
+	uint32_t ordered = (bits & 0x80000000u) != 0 ? ~bits : (bits ^ 0x80000000u);
+	return std::bit_cast<int32_t>(ordered ^ 0x80000000u);
+}
+static float orderedIntToFloat(int32_t orderedInt) {
+	uint32_t ordered = std::bit_cast<uint32_t>(orderedInt) ^ 0x80000000u;
+	uint32_t bits = (ordered & 0x80000000u) != 0 ? (ordered ^ 0x80000000u) : ~ordered;
+	return std::bit_cast<float>(bits);
+}
+//VGBذMortonţxλ
+static uint32_t expandMortonBits(uint32_t value) {
+	value &= 0x3FF;
+	value = (value | (value << 16)) & 0x030000FF;
+	value = (value | (value << 8)) & 0x0300F00F;
+	value = (value | (value << 4)) & 0x030C30C3;
+	value = (value | (value << 2)) & 0x09249249;
+	return value;
+}
+static uint32_t encodeMorton3(uint32_t x, uint32_t y, uint32_t z) {
+	return expandMortonBits(x) | (expandMortonBits(y) << 1) | (expandMortonBits(z) << 2);
+}
+//SVOPGCommon.slangеgetNormalIndexͬ
+static uint32_t getNormalIndex(const glm::vec3& normal) {
+	glm::vec3 absNormal = glm::abs(normal);
+	int maxAxis = absNormal.x > absNormal.y ? (absNormal.x > absNormal.z ? 0 : 2) : (absNormal.y > absNormal.z ? 1 : 2);
+	return uint32_t(maxAxis * 2 + (normal[maxAxis] > 0.0f ? 1 : 0));
+}
+//ԣ3ᡢη9߲
+static bool triangleBoxOverlap(const glm::vec3& boxCenter, const glm::vec3& boxHalfSize, const glm::vec3* positions) {
+	glm::vec3 v[3] = { positions[0] - boxCenter, positions[1] - boxCenter, positions[2] - boxCenter };
+	for (int axis = 0; axis < 3; ++axis) {
+		float minimum = std::min(v[0][axis], std::min(v[1][axis], v[2][axis]));
+		float maximum = std::max(v[0][axis], std::max(v[1][axis], v[2][axis]));
+		if (minimum > boxHalfSize[axis] || maximum < -boxHalfSize[axis]) return false;
+	}
+	glm::vec3 edges[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+	auto separated = [&](const glm::vec3& axis) {
+		float p0 = glm::dot(axis, v[0]);
+		float p1 = glm::dot(axis, v[1]);
+		float p2 = glm::dot(axis, v[2]);
+		float radius = glm::dot(boxHalfSize, glm::abs(axis));
+		return std::min(p0, std::min(p1, p2)) > radius || std::max(p0, std::max(p1, p2)) < -radius;
+		};
+	if (separated(glm::cross(edges[0], edges[1]))) return false;
+	for (const glm::vec3& edge : edges) {
+		if (separated(glm::vec3(0.0f, -edge.z, edge.y))) return false;
+		if (separated(glm::vec3(edge.z, 0.0f, -edge.x))) return false;
+		if (separated(glm::vec3(-edge.y, edge.x, 0.0f))) return false;
+	}
+	return true;
+}
+//Sutherland-HodgmanaxisboundaryȽϺڲĲ
+static void clipPolygon(ClipPolygon& polygon, int axis, float boundary, bool keepGreater) {
+	ClipPolygon result;
+	for (uint32_t i = 0; i < polygon.count; ++i) {
+		const glm::vec3& current = polygon.vertices[i];
+		const glm::vec3& next = polygon.vertices[(i + 1) % polygon.count];
+		float currentDistance = keepGreater ? current[axis] - boundary : boundary - current[axis];
+		float nextDistance = keepGreater ? next[axis] - boundary : boundary - next[axis];
+		if (currentDistance >= 0.0f) result.vertices[result.count++] = current;
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+			glm::vec3 intersection = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+			intersection[axis] = boundary;
+			result.vertices[result.count++] = intersection;
+		}
+	}
+	polygon = result;
+}
+static void voxelizeTriangle(const CPUVoxelizationSetting_FzbPG& setting, const CPUVoxelizationTriangle_FzbPG& triangle,
+	std::vector<VoxelAccumulator>& grid) {
+	const glm::vec3* p = triangle.positions;
+	const glm::vec3* n = triangle.normals;
+	glm::vec3 geometryNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+	float doubleArea = glm::length(geometryNormal);
+	if (!(doubleArea > 0.0f)) return;
+
+	//뼸ɫͬ㷨֮ѡͶӰͼ0z1x2y
+	glm::vec3 viewNormal = n[0] + n[1] + n[2];
+	if (glm::dot(viewNormal, viewNormal) <= 0.0f) viewNormal = geometryNormal;
+	glm::vec3 absNormal = glm::abs(viewNormal);
+	int viewIndex = absNormal.x > absNormal.y ? (absNormal.x > absNormal.z ? 1 : 0) : (absNormal.y > absNormal.z ? 2 : 0);
+	const int viewAxis[3] = { 2, 0, 1 };
+	float pixelArea = setting.pixelAreas[viewIndex];
+
+	int voxelCount = int(setting.voxelCount);
+	uint32_t voxelTotalCount = setting.voxelCount * setting.voxelCount * setting.voxelCount;
+	glm::vec3 triangleMin = glm::min(p[0], glm::min(p[1], p[2]));
+	glm::vec3 triangleMax = glm::max(p[0], glm::max(p[1], p[2]));
+	glm::ivec3 startIndex = glm::clamp(glm::ivec3(glm::floor((triangleMin - setting.voxelGroupStartPos) / setting.voxelSize)), glm::ivec3(0), glm::ivec3(voxelCount - 1));
+	glm::ivec3 endIndex = glm::clamp(glm::ivec3(glm::floor((triangleMax - setting.voxelGroupStartPos) / setting.voxelSize)), glm::ivec3(0), glm::ivec3(voxelCount - 1));
+
+	//Ԥ
+	glm::vec3 edge0 = p[1] - p[0];
+	glm::vec3 edge1 = p[2] - p[0];
+	float d00 = glm::dot(edge0, edge0), d01 = glm::dot(edge0, edge1), d11 = glm::dot(edge1, edge1);
+	float inverseDenominator = 1.0f / (d00 * d11 - d01 * d01);
+
+	glm::vec3 boxHalfSize = setting.voxelSize * 0.5f;
+	for (int z = startIndex.z; z <= endIndex.z; ++z)
+		for (int y = startIndex.y; y <= endIndex.y; ++y)
+			for (int x = startIndex.x; x <= endIndex.x; ++x) {
+				glm::vec3 boxMin = setting.voxelGroupStartPos + glm::vec3(x, y, z) * setting.voxelSize;
+				glm::vec3 boxMax = boxMin + setting.voxelSize;
+				if (!triangleBoxOverlap(boxMin + boxHalfSize, boxHalfSize, p)) continue;
+
+				ClipPolygon polygon;
+				polygon.vertices[0] = p[0];
+				polygon.vertices[1] = p[1];
+				polygon.vertices[2] = p[2];
+				polygon.count = 3;
+				for (int axis = 0; axis < 3 && polygon.count >= 3; ++axis) {
+					clipPolygon(polygon, axis, boxMin[axis], true);
+					if (polygon.count >= 3) clipPolygon(polygon, axis, boxMax[axis], false);
+				}
+				if (polygon.count < 3) continue;
+
+				glm::vec3 minimum = polygon.vertices[0], maximum = polygon.vertices[0], centroid = glm::vec3(0.0f), areaVector = glm::vec3(0.0f);
+				for (uint32_t i = 0; i < polygon.count; ++i) {
+					minimum = glm::min(minimum, polygon.vertices[i]);
+					maximum = glm::max(maximum, polygon.vertices[i]);
+					centroid += polygon.vertices[i];
+					if (i >= 1 && i + 1 < polygon.count)
+						areaVector += glm::cross(polygon.vertices[i] - polygon.vertices[0], polygon.vertices[i + 1] - polygon.vertices[0]);
+				}
+				centroid /= float(polygon.count);
+				float fragmentCount = 0.5f * std::abs(areaVector[viewAxis[viewIndex]]) / pixelArea;
+				if (!(fragmentCount > 0.0f)) continue;
+
+				glm::vec3 toCentroid = centroid - p[0];
+				float d20 = glm::dot(toCentroid, edge0), d21 = glm::dot(toCentroid, edge1);
+				float v = (d11 * d20 - d01 * d21) * inverseDenominator;
+				float w = (d00 * d21 - d01 * d20) * inverseDenominator;
+				glm::vec3 normal = (1.0f - v - w) * n[0] + v * n[1] + w * n[2];
+				if (glm::dot(normal, normal) <= 0.0f) normal = geometryNormal;
+
+				uint32_t voxelIndex = encodeMorton3(uint32_t(x), uint32_t(y), uint32_t(z));
+				VoxelAccumulator& voxel = grid[getNormalIndex(normal) * voxelTotalCount + voxelIndex];
+				voxel.sumNormal_G += glm::vec4(glm::normalize(normal) * fragmentCount, fragmentCount);
+				voxel.minimum = glm::min(voxel.minimum, minimum);
+				voxel.maximum = glm::max(voxel.maximum, maximum);
+			}
+}
+
+void CPUVoxelization_FzbPG::collectTriangles(const CPUVoxelizationSetting_FzbPG& setting, std::vector<CPUVoxelizationTriangle_FzbPG>& triangles) {
+	Scene& sceneResource = Application::sceneResource;
+	std::vector<std::vector<CPUVoxelizationTriangle_FzbPG>> instanceTriangles(sceneResource.instances.size());
+	nvutils::parallel_batches_pooled<1>(sceneResource.instances.size(), [&](uint64_t instanceIndex, uint32_t threadIndex) {
+		const shaderio::Instance& instance = sceneResource.instances[instanceIndex];
+		const shaderio::Mesh& mesh = sceneResource.meshes[instance.meshIndex];
+		const shaderio::TriangleMesh& triMesh = mesh.triMesh;
+		const std::vector<uint8_t>& meshByteData = sceneResource.meshSets[sceneResource.getMeshSetIndex(instance.meshIndex)].meshByteData;
+
+		auto readVec3 = [&](const shaderio::BufferView& view, uint32_t vertexIndex) -> glm::vec3 {
+			uint32_t stride = view.byteStride ? view.byteStride : uint32_t(sizeof(glm::vec3));
+			glm::vec3 value;
+			memcpy(&value, meshByteData.data() + view.offset + size_t(stride) * vertexIndex, sizeof(glm::vec3));
+			return value;
+			};
+		const uint8_t* indexData = meshByteData.data() + triMesh.indices.offset;
+		auto getIndex = [&](uint32_t i) -> uint32_t {
+			if (triMesh.indices.byteStride == sizeof(uint16_t)) return reinterpret_cast<const uint16_t*>(indexData)[i];
+			return reinterpret_cast<const uint32_t*>(indexData)[i];
+			};
+		const uint32_t* lodIndices = nullptr;
+		uint32_t indexCount = triMesh.indices.count;
+		if (setting.meshLOD.enable) {
+			if (const MeshLODLevel* lod = sceneResource.getMeshLOD(instance.meshIndex, MeshLOD::getMaxError(setting.meshLOD, instance.transform, setting.voxelSize))) {
+				lodIndices = sceneResource.meshLODIndices.data() + lod->indexOffset;
+				indexCount = lod->indexCount;
+			}
+		}
+
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(instance.transform)));
+		bool hasNormal = triMesh.normals.count > 0;
+		std::vector<CPUVoxelizationTriangle_FzbPG>& localTriangles = instanceTriangles[instanceIndex];
+		localTriangles.resize(indexCount / 3);
+		for (uint32_t t = 0; t < localTriangles.size(); ++t) {
+			CPUVoxelizationTriangle_FzbPG& triangle = localTriangles[t];
+			for (uint32_t k = 0; k < 3; ++k) {
+				uint32_t vertexIndex = lodIndices ? lodIndices[3 * t + k] : getIndex(3 * t + k);
+				triangle.positions[k] = glm::vec3(instance.transform * glm::vec4(readVec3(triMesh.positions, vertexIndex), 1.0f));
+				triangle.normals[k] = hasNormal ? normalMatrix * readVec3(triMesh.normals, vertexIndex) : glm::vec3(0.0f);
+			}
+		}
+		});
+
+	size_t triangleCount = 0;
+	for (const auto& localTriangles : instanceTriangles) triangleCount += localTriangles.size();
+	triangles.clear();
+	triangles.reserve(triangleCount);
+	for (const auto& localTriangles : instanceTriangles) triangles.insert(triangles.end(), localTriangles.begin(), localTriangles.end());
+}
+void CPUVoxelization_FzbPG::voxelize(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<CPUVoxelizationTriangle_FzbPG>& triangles,
+	std::vector<shaderio::VGBVoxelData_FzbPG>& VGBs) {
+	const uint64_t voxelTotalCount = uint64_t(setting.voxelCount) * setting.voxelCount * setting.voxelCount;
+	const uint64_t cellCount = 6 * voxelTotalCount;
+
+	//˽߳1GBڴԤ
+	const uint64_t memoryBudget = 1ull << 30;
+	uint64_t gridCount = std::max<uint64_t>(1, nvutils::get_thread_pool().get_thread_count());
+	gridCount = std::min(gridCount, std::max<uint64_t>(1, memoryBudget / (cellCount * sizeof(VoxelAccumulator))));
+	gridCount = std::min(gridCount, std::max<uint64_t>(1, triangles.size() / 256));
+	std::vector<std::vector<VoxelAccumulator>> grids(gridCount);
+
+	nvutils::parallel_batches_pooled<1>(gridCount, [&](uint64_t gridIndex, uint32_t threadIndex) {
+		std::vector<VoxelAccumulator>& grid = grids[gridIndex];
+		grid.resize(cellCount);
+		uint64_t begin = triangles.size() * gridIndex / gridCount;
+		uint64_t end = triangles.size() * (gridIndex + 1) / gridCount;
+		for (uint64_t i = begin; i < end; ++i) voxelizeTriangle(setting, triangles[i], grid);
+		});
+
+	VGBs.resize(cellCount);
+	nvutils::parallel_ranges_pooled<4096>(cellCount, [&](uint64_t begin, uint64_t end, uint32_t threadIndex) {
+		for (uint64_t cell = begin; cell < end; ++cell) {
+			VoxelAccumulator voxel;
+			for (const std::vector<VoxelAccumulator>& grid : grids) {
+				voxel.sumNormal_G += grid[cell].sumNormal_G;
+				voxel.minimum = glm::min(voxel.minimum, grid[cell].minimum);
+				voxel.maximum = glm::max(voxel.maximum, grid[cell].maximum);
+			}
+			//computeMain_clearVGBͬĿ
+			shaderio::VGBVoxelData_FzbPG& voxelData = VGBs[cell];
+			voxelData.irradiance = glm::vec4(0.0f);
+			voxelData.sumNormal_G = voxel.sumNormal_G;
+			voxelData.aabbI.minimum = glm::ivec4(floatToOrderedInt(voxel.minimum.x), floatToOrderedInt(voxel.minimum.y), floatToOrderedInt(voxel.minimum.z), floatToOrderedInt(FLT_MAX));
+			voxelData.aabbI.maximum = glm::ivec4(floatToOrderedInt(voxel.maximum.x), floatToOrderedInt(voxel.maximum.y), floatToOrderedInt(voxel.maximum.z), floatToOrderedInt(-FLT_MAX));
+		}
+		});
+}
+bool CPUVoxelization_FzbPG::validate(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<const shaderio::VGBVoxelData_FzbPG*>& gpuVGBs,
+	const std::vector<shaderio::VGBVoxelData_FzbPG>& cpuVGBs) {
+	const uint64_t voxelTotalCount = uint64_t(setting.voxelCount) * setting.voxelCount * setting.voxelCount;
+	if (gpuVGBs.size() != 6 || cpuVGBs.size() != 6 * voxelTotalCount) {
+		LOGW("CPU voxelization validation: VGB size mismatch\n");
+		return false;
+	}
+	//GPUaabbصĸǷΧܳһ
+	float tolerance = 1.5f * std::sqrt(std::max(setting.pixelAreas.x, std::max(setting.pixelAreas.y, setting.pixelAreas.z)))
+		+ 1e-4f * std::max(setting.voxelSize.x, std::max(setting.voxelSize.y, setting.voxelSize.z));
+	const float normalCosineThreshold = std::cos(glm::radians(20.0f));
+
+	uint64_t gpuCount = 0, cpuCount = 0, bothCount = 0, gpuOnlyCount = 0;
+	uint64_t normalMismatchCount = 0, aabbMismatchCount = 0;
+	double fragmentRelativeError = 0.0;
+	for (uint32_t normalIndex = 0; normalIndex < 6; ++normalIndex) {
+		for (uint64_t voxelIndex = 0; voxelIndex < voxelTotalCount; ++voxelIndex) {
+			const shaderio::VGBVoxelData_FzbPG& gpuVoxel = gpuVGBs[normalIndex][voxelIndex];
+			const shaderio::VGBVoxelData_FzbPG& cpuVoxel = cpuVGBs[normalIndex * voxelTotalCount + voxelIndex];
+			bool gpuOccupied = gpuVoxel.sumNormal_G.w > 0.0f;
+			bool cpuOccupied = cpuVoxel.sumNormal_G.w > 0.0f;
+			gpuCount += gpuOccupied;
+			cpuCount += cpuOccupied;
+			if (gpuOccupied && !cpuOccupied) ++gpuOnlyCount;
+			if (!gpuOccupied || !cpuOccupied) continue;
+			++bothCount;
+
+			glm::vec3 gpuNormal = glm::vec3(gpuVoxel.sumNormal_G);
+			glm::vec3 cpuNormal = glm::vec3(cpuVoxel.sumNormal_G);
+			float lengthProduct = glm::length(gpuNormal) * glm::length(cpuNormal);
+			if (lengthProduct > 0.0f && glm::dot(gpuNormal, cpuNormal) < normalCosineThreshold * lengthProduct) ++normalMismatchCount;
+
+			bool aabbMismatch = false;
+			for (int axis = 0; axis < 3; ++axis) {
+				aabbMismatch |= orderedIntToFloat(gpuVoxel.aabbI.minimum[axis]) < orderedIntToFloat(cpuVoxel.aabbI.minimum[axis]) - tolerance;
+				aabbMismatch |= orderedIntToFloat(gpuVoxel.aabbI.maximum[axis]) > orderedIntToFloat(cpuVoxel.aabbI.maximum[axis]) + tolerance;
+			}
+			aabbMismatchCount += aabbMismatch;
+			fragmentRelativeError += std::abs(cpuVoxel.sumNormal_G.w - gpuVoxel.sumNormal_G.w) / gpuVoxel.sumNormal_G.w;
+		}
+	}
+
+	bool passed = gpuOnlyCount <= gpuCount / 100 && normalMismatchCount <= bothCount / 20 && aabbMismatchCount <= bothCount / 20;
+	LOGI("CPU voxelization validation (%u^3): GPU %llu voxels, CPU %llu voxels, both %llu, GPU only %llu, CPU only %llu\n", setting.voxelCount,
+		(unsigned long long)gpuCount, (unsigned long long)cpuCount, (unsigned long long)bothCount, (unsigned long long)gpuOnlyCount, (unsigned long long)(cpuCount - bothCount));
+	LOGI("CPU voxelization validation: normal mismatch %llu, aabb mismatch %llu, mean fragment count error %.1f%%, %s\n",
+		(unsigned long long)normalMismatchCount, (unsigned long long)aabbMismatchCount, bothCount ? 100.0 * fragmentRelativeError / bothCount : 0.0, passed ? "PASS" : "FAIL");
+	return passed;
+}
+void CPUVoxelization_FzbPG::benchmark(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<CPUVoxelizationTriangle_FzbPG>& triangles, uint32_t repeatCount) {
+	std::vector<shaderio::VGBVoxelData_FzbPG> VGBs;
+	double totalTime = 0.0;
+	for (uint32_t i = 0; i < repeatCount; ++i) {
+		auto start = std::chrono::high_resolution_clock::now();
+		voxelize(setting, triangles, VGBs);
+		totalTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	double averageTime = totalTime / std::max(repeatCount, 1u);
+	LOGI("CPU voxelization benchmark (%u^3, %u threads): %zu triangles, %.3f ms, %.2f M triangles/s\n", setting.voxelCount,
+		uint32_t(nvutils::get_thread_pool().get_thread_count()), triangles.size(), averageTime * 1000.0, averageTime > 0.0 ? triangles.size() / averageTime * 1e-6 : 0.0);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "./RasterVoxelizationShaderio_FzbPG.h"
+#include <common/Mesh/MeshLOD.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef FZBRENDERER_CPU_VOXELIZATION_FZBPG_H
+#define FZBRENDERER_CPU_VOXELIZATION_FZBPG_H
+
+namespace FzbRenderer {
+struct CPUVoxelizationSetting_FzbPG {
+	glm::vec3 voxelGroupStartPos = glm::vec3(0.0f);
+	glm::vec3 voxelSize = glm::vec3(1.0f);
+	uint32_t voxelCount = 0;				//ÿ2
+	glm::vec3 pixelAreas = glm::vec3(1.0f);	//GPUͼzxyͶӰһصڰѸΪƬԪ
+	MeshLODSetting meshLOD;					//GPUդѡͬLOD
+};
+//ռΣΪ㷨
+struct CPUVoxelizationTriangle_FzbPG {
+	glm::vec3 positions[3];
+	glm::vec3 normals[3];
+};
+/*
+RasterVoxelization.slangCPU汾6VGBͬذMortonVGBs[normalIndex * voxelCount^3 + voxelIndex]
+1. ÷ԣAkenine-MollerжصǱصģGPUݵCPUҲӦ
+2. صʱβüڣaabbΪüεİΧУڶĴֵ㷨ߣ߷ۼӵsumNormal_G
+   sumNormal_G.wΪGPUƬԪĹƣڼɫѡͼϵͶӰ
+3. ΰ̷ֿ߳飬ÿ߳д˽زкϲܴСڴԤʱ߳
+4. irradianceΪ0עд
+*/
+class CPUVoxelization_FzbPG {
+public:
+	//ռʵռΣmeshLODʱGPUѡͬLOD
+	static void collectTriangles(const CPUVoxelizationSetting_FzbPG& setting, std::vector<CPUVoxelizationTriangle_FzbPG>& triangles);
+	static void voxelize(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<CPUVoxelizationTriangle_FzbPG>& triangles,
+		std::vector<shaderio::VGBVoxelData_FzbPG>& VGBs);
+
+	/*
+	GPUصVGBȽϣ־ͨʱtrue
+	1. ռãֻGPUݵӦӽ0ֻCPUݵǱزԶı
+	2. ߶ݵأƽ߼нǡGPUaabbǷCPUaabbſһأڡƬԪ
+	*/
+	static bool validate(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<const shaderio::VGBVoxelData_FzbPG*>& gpuVGBs,
+		const std::vector<shaderio::VGBVoxelData_FzbPG>& cpuVGBs);
+	//ظrepeatCountΣÿ봦
+	static void benchmark(const CPUVoxelizationSetting_FzbPG& setting, const std::vector<CPUVoxelizationTriangle_FzbPG>& triangles, uint32_t repeatCount);
+};
+}
+
+#endif
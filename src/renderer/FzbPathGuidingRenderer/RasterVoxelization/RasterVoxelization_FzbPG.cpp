@@ -7,10 +7,13 @@
 #include <cstdint>
 #include <nvgui/property_editor.hpp>
 #include <nvvk/compute_pipeline.hpp>
+#include <nvvk/barriers.hpp>
+#include <nvutils/timers.hpp>
 
 using namespace FzbRenderer;
 
 RasterVoxelization_FzbPG::RasterVoxelization_FzbPG(pugi::xml_node& featureNode) {
+	profileName = "RasterVoxelization";
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().geometryShader = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().vertexPipelineStoresAndAtomics = VK_TRUE;
 	Application::vkContext->getPhysicalDeviceFeatures_notConst().shaderSampledImageArrayDynamicIndexing = VK_TRUE;
@@ -34,6 +37,19 @@ RasterVoxelization_FzbPG::RasterVoxelization_FzbPG(pugi::xml_node& featureNode)
 		setting.pushConstant.voxelSize_Count.w = std::stoi(voxelCountNode.attribute("value").value());
 	else setting.pushConstant.voxelSize_Count.w = 16;
 
+	if (pugi::xml_node meshLODNode = featureNode.child("meshLOD")) {
+		MeshLODSetting& meshLOD = setting.meshLOD;
+		meshLOD.enable = std::string(meshLODNode.attribute("value").value()) == "true";
+		if (pugi::xml_attribute attribute = meshLODNode.attribute("levels")) meshLOD.levelCount = std::stoi(attribute.value());
+		if (pugi::xml_attribute attribute = meshLODNode.attribute("reduction")) meshLOD.reduction = std::clamp(std::stof(attribute.value()), 0.05f, 0.95f);
+		if (pugi::xml_attribute attribute = meshLODNode.attribute("minTriangles")) meshLOD.minTriangleCount = std::stoi(attribute.value());
+		if (pugi::xml_attribute attribute = meshLODNode.attribute("errorScale")) meshLOD.errorScale = std::stof(attribute.value());
+	}
+	if (pugi::xml_node cpuVoxelizationNode = featureNode.child("cpuVoxelization")) {
+		setting.cpuValidation = std::string(cpuVoxelizationNode.attribute("validate").value()) == "true";
+		if (pugi::xml_attribute attribute = cpuVoxelizationNode.attribute("benchmark")) setting.cpuBenchmarkCount = std::stoi(attribute.value());
+	}
+
 #ifndef NDEBUG
 	//-------------------------------------DebugSetting-------------------------------------------------
 	Application::vkContext->getPhysicalDeviceFeatures11_notConst().multiview = VK_TRUE;
@@ -61,6 +77,7 @@ void RasterVoxelization_FzbPG::init() {
 #endif
 
 	//---------------------------------------------------------------------------------------------
+	if (setting.meshLOD.enable) Application::sceneResource.createMeshLODs(setting.meshLOD);
 	createVGBs();
 	createDescriptorSetLayout();	//ϲ
 	createDescriptorSet();
@@ -104,6 +121,8 @@ void RasterVoxelization_FzbPG::uiRender() {
 		//---------------------------------------threeView-------------------------------------------
 		std::string fragmentCountText = "fragment count: " + std::to_string(fragmentCount_host);
 		ImGui::Text(fragmentCountText.c_str());
+		std::string triangleCountText = "rasterized triangles: " + std::to_string(rasterizedTriangleCount);
+		ImGui::Text(triangleCountText.c_str());
 		if (PE::begin()) {
 			if (PE::entry("ThreeViewMap", [&] {
 				static const ImVec4 highlightColor = ImVec4(118.f / 255.f, 185.f / 255.f, 0.f, 1.f);
@@ -193,6 +212,7 @@ void RasterVoxelization_FzbPG::uiRender() {
 }
 void RasterVoxelization_FzbPG::resize(VkCommandBuffer cmd, const VkExtent2D& size) {};
 void RasterVoxelization_FzbPG::preRender(VkCommandBuffer cmd) {
+	if ((setting.cpuValidation || setting.cpuBenchmarkCount > 0) && !cpuValidated && Application::frameIndex > 0) validateCPUVoxelization();
 #ifndef NDEBUG
 	setting.pushConstant.frameIndex = Application::frameIndex;
 	setting.pushConstant.normalIndex = normalIndex;
@@ -217,8 +237,62 @@ void RasterVoxelization_FzbPG::preRender(VkCommandBuffer cmd) {
 	memcpy(&fragmentCount_host, fragmentCountStageBuffer.mapping, sizeof(uint32_t));
 #endif
 }
+CPUVoxelizationSetting_FzbPG RasterVoxelization_FzbPG::getCPUVoxelizationSetting() const {
+	CPUVoxelizationSetting_FzbPG cpuSetting;
+	cpuSetting.voxelGroupStartPos = setting.pushConstant.voxelGroupStartPos;
+	cpuSetting.voxelSize = glm::vec3(setting.pushConstant.voxelSize_Count);
+	cpuSetting.voxelCount = uint32_t(setting.pushConstant.voxelSize_Count.w);
+	//createVGBsͶӰķΧͬ
+	glm::vec3 distance = glm::vec3(setting.sceneSize) * 1.1f;
+	float pixelCount = float(setting.resolution.width) * float(setting.resolution.height);
+	cpuSetting.pixelAreas = glm::vec3(distance.x * distance.y, distance.z * distance.y, distance.x * distance.z) / pixelCount;
+	cpuSetting.meshLOD = setting.meshLOD;
+	return cpuSetting;
+}
+void RasterVoxelization_FzbPG::validateCPUVoxelization() {
+	cpuValidated = true;
+	SCOPED_TIMER(__FUNCTION__);
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	CPUVoxelizationSetting_FzbPG cpuSetting = getCPUVoxelizationSetting();
+
+	std::vector<CPUVoxelizationTriangle_FzbPG> triangles;
+	CPUVoxelization_FzbPG::collectTriangles(cpuSetting, triangles);
+	if (setting.cpuBenchmarkCount > 0) CPUVoxelization_FzbPG::benchmark(cpuSetting, triangles, setting.cpuBenchmarkCount);
+	if (!setting.cpuValidation) return;
+
+	VkDeviceSize VGBByteSize = VkDeviceSize(cpuSetting.voxelCount) * cpuSetting.voxelCount * cpuSetting.voxelCount * sizeof(shaderio::VGBVoxelData_FzbPG);
+	nvvk::Buffer VGBStageBuffer;
+	allocator->createBuffer(VGBStageBuffer, VGBByteSize * VGBs.size(), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(VGBStageBuffer.buffer);
+
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	//ȴ֮ǰ֡дVGB
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	for (uint32_t i = 0; i < VGBs.size(); ++i) {
+		VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2, .srcOffset = 0, .dstOffset = VGBByteSize * i, .size = VGBByteSize };
+		VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2, .srcBuffer = VGBs[i].buffer,
+			.dstBuffer = VGBStageBuffer.buffer, .regionCount = 1, .pRegions = &region };
+		vkCmdCopyBuffer2(cmd, &copyInfo);
+	}
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	//GPU_TO_CPUڴ治һHOST_COHERENTȡmappingǰҪinvalidate
+	vmaInvalidateAllocation(*allocator, VGBStageBuffer.allocation, 0, VK_WHOLE_SIZE);
+
+	std::vector<const shaderio::VGBVoxelData_FzbPG*> gpuVGBs(VGBs.size());
+	for (uint32_t i = 0; i < VGBs.size(); ++i)
+		gpuVGBs[i] = reinterpret_cast<const shaderio::VGBVoxelData_FzbPG*>(static_cast<const uint8_t*>(VGBStageBuffer.mapping) + VGBByteSize * i);
+
+	std::vector<shaderio::VGBVoxelData_FzbPG> cpuVGBs;
+	CPUVoxelization_FzbPG::voxelize(cpuSetting, triangles, cpuVGBs);
+	CPUVoxelization_FzbPG::validate(cpuSetting, gpuVGBs, cpuVGBs);
+
+	allocator->destroyBuffer(VGBStageBuffer);
+}
 void RasterVoxelization_FzbPG::render(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd, "RasterVoxelization_render");
+	auto section = profileStage(cmd, "Render");
 
 	updateDataPerFrame(cmd);
 
@@ -367,7 +441,7 @@ void RasterVoxelization_FzbPG::createDescriptorSetLayout() {
 		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
 		| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
 #endif
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -409,6 +483,9 @@ void RasterVoxelization_FzbPG::createDescriptorSet() {
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
 }
+void RasterVoxelization_FzbPG::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	requests.push_back({ .shaderSource = std::filesystem::path(__FILE__).parent_path() / "shaders" / "RasterVoxelization.slang" });
+}
 void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	SCOPED_TIMER(__FUNCTION__);
 
@@ -441,7 +518,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_clearVGB";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_clearVGB);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_clearVGB);
 	NVVK_DBG_NAME(computeShader_clearVGB);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader, nullptr);
@@ -451,7 +528,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader);
 	NVVK_DBG_NAME(vertexShader);
 #ifndef NDEBUG
 	//------------------------------------------ThreeView--------------------------------------
@@ -463,7 +540,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
 	NVVK_DBG_NAME(geometryShader_ThreeView);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -471,7 +548,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
 	NVVK_DBG_NAME(fragmentShader_ThreeView);
 	//-------------------------------------------Cube--------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_Cube, nullptr);
@@ -482,7 +559,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Cube);
 	NVVK_DBG_NAME(vertexShader_Cube);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -490,7 +567,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Cube);
 	NVVK_DBG_NAME(fragmentShader_Cube);
 	//-------------------------------------------Wireframe--------------------------------------
 	vkDestroyShaderEXT(device, fragmentShader_Wireframe, nullptr);
@@ -500,7 +577,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 	//-------------------------------------------PostProcess--------------------------------------
 	vkDestroyShaderEXT(device, computeShader_postProcess, nullptr);
@@ -510,7 +587,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_postProcess";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_postProcess);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_postProcess);
 	NVVK_DBG_NAME(computeShader_postProcess);
 #else
 	vkDestroyShaderEXT(device, geometryShader, nullptr);
@@ -521,7 +598,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader);
 	NVVK_DBG_NAME(geometryShader);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -529,7 +606,7 @@ void RasterVoxelization_FzbPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader);
 	NVVK_DBG_NAME(fragmentShader);
 #endif
 }
@@ -579,24 +656,37 @@ void RasterVoxelization_FzbPG::createVGB(VkCommandBuffer cmd) {
 	VkVertexInputAttributeDescription2EXT attributeDescription = {};
 	vkCmdSetVertexInputEXT(cmd, 0, nullptr, 0, nullptr);
 
+	rasterizedTriangleCount = 0;
 	for (size_t i = 0; i < Application::sceneResource.instances.size(); ++i)
 	{
-		uint32_t meshIndex = Application::sceneResource.instances[i].meshIndex;
-		const shaderio::Mesh& mesh = Application::sceneResource.meshes[meshIndex];
-		const shaderio::TriangleMesh& triMesh = mesh.triMesh;
-
 		setting.pushConstant.instanceIndex = int(i);
 		vkCmdPushConstants2(cmd, &pushInfo);
+		cmdDrawInstance(cmd, uint32_t(i));
+	}
 
-		uint32_t bufferIndex = Application::sceneResource.getMeshBufferIndex(meshIndex);
-		const nvvk::Buffer& v = Application::sceneResource.bDatas[bufferIndex];
+	vkCmdEndRendering(cmd);
+}
+void RasterVoxelization_FzbPG::cmdDrawInstance(VkCommandBuffer cmd, uint32_t instanceIndex) {
+	Scene& sceneResource = Application::sceneResource;
+	const shaderio::Instance& instance = sceneResource.instances[instanceIndex];
+	const shaderio::Mesh& mesh = sceneResource.meshes[instance.meshIndex];
+	const shaderio::TriangleMesh& triMesh = mesh.triMesh;
 
-		vkCmdBindIndexBuffer(cmd, v.buffer, triMesh.indices.offset, VkIndexType(mesh.indexType));
+	const MeshLODLevel* lod = nullptr;
+	if (setting.meshLOD.enable)
+		lod = sceneResource.getMeshLOD(instance.meshIndex, MeshLOD::getMaxError(setting.meshLOD, instance.transform, glm::vec3(setting.pushConstant.voxelSize_Count)));
 
-		vkCmdDrawIndexed(cmd, triMesh.indices.count, 1, 0, 0, 0);
+	if (lod) {
+		vkCmdBindIndexBuffer(cmd, sceneResource.bMeshLODIndices.buffer, VkDeviceSize(lod->indexOffset) * sizeof(uint32_t), VK_INDEX_TYPE_UINT32);
+		vkCmdDrawIndexed(cmd, lod->indexCount, 1, 0, 0, 0);
+		rasterizedTriangleCount += lod->indexCount / 3;
+		return;
 	}
-
-	vkCmdEndRendering(cmd);
+	uint32_t bufferIndex = sceneResource.getMeshBufferIndex(instance.meshIndex);
+	const nvvk::Buffer& v = sceneResource.bDatas[bufferIndex];
+	vkCmdBindIndexBuffer(cmd, v.buffer, triMesh.indices.offset, VkIndexType(mesh.indexType));
+	vkCmdDrawIndexed(cmd, triMesh.indices.count, 1, 0, 0, 0);
+	rasterizedTriangleCount += triMesh.indices.count / 3;
 }
 
 #ifndef NDEBUG
@@ -687,21 +777,12 @@ void RasterVoxelization_FzbPG::createVGB_ThreeView(VkCommandBuffer cmd) {
 	VkVertexInputAttributeDescription2EXT attributeDescription = {};
 	vkCmdSetVertexInputEXT(cmd, 0, nullptr, 0, nullptr);
 
+	rasterizedTriangleCount = 0;
 	for (size_t i = 0; i < Application::sceneResource.instances.size(); ++i)
 	{
-		uint32_t meshIndex = Application::sceneResource.instances[i].meshIndex;
-		const shaderio::Mesh& mesh = Application::sceneResource.meshes[meshIndex];
-		const shaderio::TriangleMesh& triMesh = mesh.triMesh;
-
 		setting.pushConstant.instanceIndex = int(i);
 		vkCmdPushConstants2(cmd, &pushInfo);
-
-		uint32_t bufferIndex = Application::sceneResource.getMeshBufferIndex(meshIndex);
-		const nvvk::Buffer& v = Application::sceneResource.bDatas[bufferIndex];
-
-		vkCmdBindIndexBuffer(cmd, v.buffer, triMesh.indices.offset, VkIndexType(mesh.indexType));
-
-		vkCmdDrawIndexed(cmd, triMesh.indices.count, 1, 0, 0, 0);
+		cmdDrawInstance(cmd, uint32_t(i));
 	}
 
 	vkCmdEndRendering(cmd);
@@ -3,6 +3,8 @@
 #include "feature/Feature.h"
 #include <pugixml.hpp>
 #include "./RasterVoxelizationShaderio_FzbPG.h"
+#include "./CPUVoxelization_FzbPG.h"
+#include <common/Mesh/MeshLOD.h>
 #include <nvvk/context.hpp>
 
 #ifndef FZBRENDERER_FZBPG_RASTER_VOXELIZATION
@@ -14,6 +16,9 @@ struct RasterVoxelizationCreateInfo_FzbPG {
 	shaderio::RasterVoxelizationPushConstant pushConstant;
 	shaderio::float3 sceneStartPos;
 	shaderio::float3 sceneSize;
+	MeshLODSetting meshLOD;		//体素远大于三角形时光栅化简化后的mesh
+	bool cpuValidation = false;		//第一帧后读回VGB，与CPUVoxelization_FzbPG的结果比较
+	uint32_t cpuBenchmarkCount = 0;	//CPU体素化重复计时的次数，0为不计时
 };
 class RasterVoxelization_FzbPG : public Feature {
 public:
@@ -35,6 +40,7 @@ public:
 	void createDescriptorSet();
 
 	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
 	void updateDataPerFrame(VkCommandBuffer cmd) override;
 
 	void clearVGB(VkCommandBuffer cmd);
@@ -50,8 +56,17 @@ public:
 	VkPhysicalDeviceShaderAtomicFloatFeaturesEXT atomicFloatFeatures{};
 	VkPipelineRasterizationConservativeStateCreateInfoEXT conservativeRasterFeature{};
 
+	uint32_t rasterizedTriangleCount = 0;
+
+	//CPU体素化使用与GPU相同的体素范围、像素面积与LOD
+	CPUVoxelizationSetting_FzbPG getCPUVoxelizationSetting() const;
 private:
 	void createVGB(VkCommandBuffer cmd);
+	//选误差小于errorScale个体素的最粗LOD绘制实例
+	void cmdDrawInstance(VkCommandBuffer cmd, uint32_t instanceIndex);
+	void validateCPUVoxelization();
+
+	bool cpuValidated = false;
 
 	VkShaderModuleCreateInfo shaderCode;
 	VkBindDescriptorSetsInfo bindDescriptorSetsInfo;
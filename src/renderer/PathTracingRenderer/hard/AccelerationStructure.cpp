@@ -1,7 +1,11 @@
 #include "AccelerationStructure.h"
 #include <common/Application/Application.h>
 #include <nvvk/resource_allocator.hpp>
+#include <nvvk/barriers.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <numeric>
 
 using namespace FzbRenderer;
 
@@ -14,14 +18,24 @@ void AccelerationStructureManager::init() {
 #else
 	createBottomLevelAS_nvvk();
 	//createBottomLevelAS_indirect();
+	if (mergeSetting.enable) createMergedBottomLevelAS_nvvk();
 	createTopLevelAS_nvvk();
 #endif
+	createTlasInstanceMapBuffer();
+	collectMemoryStatistics();
 }
 void AccelerationStructureManager::clean() {
 	VkDevice device = Application::app->getDevice();
 	for (int i = 0; i < blasAccel.size(); ++i) Application::allocator.destroyBuffer(blasAccel[i].buffer);
 	Application::allocator.destroyBuffer(tlasAccel.buffer);
 
+	for (int i = 0; i < mergedBlasSet.size(); ++i) Application::allocator.destroyAcceleration(mergedBlasSet[i]);
+	mergedBlasSet.clear();
+	mergedGroups.clear();
+	mergedBlasMemory.clear();
+	Application::allocator.destroyBuffer(mergedTransformBuffer);
+	Application::allocator.destroyBuffer(tlasInstanceMapBuffer);
+
 	Application::allocator.destroyBuffer(scratchBuffer);
 	for (int i = 0; i < blasIndirectDataBuffers.size(); ++i) Application::allocator.destroyBuffer(blasIndirectDataBuffers[i]);
 	Application::allocator.destroyBuffer(tlasIndirectDataBuffer);
@@ -31,6 +45,159 @@ void AccelerationStructureManager::clean() {
 	asBuilder.deinit();
 }
 
+void AccelerationStructureManager::getSettingFromXML(pugi::xml_node& rendererNode) {
+	if (pugi::xml_node compactBLASNode = rendererNode.child("compactBLAS"))
+		compactBLAS = std::string(compactBLASNode.attribute("value").value()) == "true";
+	if (pugi::xml_node mergeNode = rendererNode.child("mergeStaticBLAS")) {
+		mergeSetting.enable = std::string(mergeNode.attribute("value").value()) == "true";
+		if (pugi::xml_attribute maxTrianglesAttr = mergeNode.attribute("maxTriangles")) mergeSetting.maxTriangles = maxTrianglesAttr.as_uint();
+		if (pugi::xml_attribute maxInstanceTrianglesAttr = mergeNode.attribute("maxInstanceTriangles"))
+			mergeSetting.maxInstanceTriangles = maxInstanceTrianglesAttr.as_uint();
+		if (pugi::xml_attribute maxSharedTrianglesAttr = mergeNode.attribute("maxSharedTriangles"))
+			mergeSetting.maxSharedTriangles = maxSharedTrianglesAttr.as_uint();
+		if (pugi::xml_attribute sahFactorAttr = mergeNode.attribute("sahFactor")) mergeSetting.sahFactor = sahFactorAttr.as_float();
+	}
+	if (pugi::xml_node tlasUpdateNode = rendererNode.child("tlasUpdate")) {
+		std::string policy = tlasUpdateNode.attribute("policy").value();
+		if (policy == "refit") tlasUpdateSetting.policy = TLASUpdatePolicy_Refit;
+		else if (policy == "rebuild") tlasUpdateSetting.policy = TLASUpdatePolicy_Rebuild;
+		else tlasUpdateSetting.policy = TLASUpdatePolicy_Auto;
+		if (pugi::xml_attribute inflationAttr = tlasUpdateNode.attribute("rebuildInflation"))
+			tlasUpdateSetting.rebuildInflation = inflationAttr.as_float();
+		if (pugi::xml_attribute maxRefitCountAttr = tlasUpdateNode.attribute("maxRefitCount"))
+			tlasUpdateSetting.maxRefitCount = maxRefitCountAttr.as_uint();
+		if (pugi::xml_attribute logAttr = tlasUpdateNode.attribute("log"))
+			tlasUpdateSetting.logDecisions = std::string(logAttr.value()) == "true";
+	}
+}
+void AccelerationStructureManager::collectMemoryStatistics() {
+	for (size_t i = 0; i < blasMemory.size() && i < asBuilder.blasSet.size(); ++i)
+		blasMemory[i].size = asBuilder.blasSet[i].buffer.bufferSize;
+	for (size_t i = 0; i < mergedBlasMemory.size() && i < mergedBlasSet.size(); ++i)
+		mergedBlasMemory[i].size = mergedBlasSet[i].buffer.bufferSize;
+
+	tlasMemory = {
+		.primitiveCount = uint32_t(asBuilder.tlasSize),
+		.buildSize = asBuilder.tlasBuildData.sizeInfo.accelerationStructureSize,
+		.size = asBuilder.tlas.buffer.bufferSize,
+		.scratchSize = asBuilder.tlasBuildData.sizeInfo.buildScratchSize,
+	};
+
+	Application::profiler.setReport("accelerationStructures", getMemoryReportJson());
+}
+std::string AccelerationStructureManager::getMemoryReportJson() const {
+	VkDeviceSize blasBuildSize = 0, blasSize = 0;
+	for (const AccelerationStructureMemory& memory : blasMemory) {
+		blasBuildSize += memory.buildSize;
+		blasSize += memory.size;
+	}
+
+	std::string json;
+	char line[256];
+	snprintf(line, sizeof(line), "{\"compactBLAS\":%s,\"blasCount\":%zu,\"blasBuildSize\":%llu,\"blasSize\":%llu,\"blasScratchBufferSize\":%llu,",
+		compactBLAS ? "true" : "false", blasMemory.size(), (unsigned long long)blasBuildSize, (unsigned long long)blasSize,
+		(unsigned long long)asBuilder.blasScratchBuffer.bufferSize);
+	json += line;
+	snprintf(line, sizeof(line), "\"tlas\":{\"instances\":%u,\"buildSize\":%llu,\"size\":%llu,\"scratchSize\":%llu,\"instanceBufferSize\":%llu},",
+		tlasMemory.primitiveCount, (unsigned long long)tlasMemory.buildSize, (unsigned long long)tlasMemory.size,
+		(unsigned long long)tlasMemory.scratchSize, (unsigned long long)asBuilder.tlasInstancesBuffer.bufferSize);
+	json += line;
+	json += "\"blas\":[";
+	for (size_t i = 0; i < blasMemory.size(); ++i) {
+		const AccelerationStructureMemory& memory = blasMemory[i];
+		snprintf(line, sizeof(line), "%s{\"mesh\":%zu,\"triangles\":%u,\"buildSize\":%llu,\"size\":%llu,\"scratchSize\":%llu}",
+			i == 0 ? "" : ",", i, memory.primitiveCount, (unsigned long long)memory.buildSize, (unsigned long long)memory.size,
+			(unsigned long long)memory.scratchSize);
+		json += line;
+	}
+	json += "],";
+	VkDeviceSize mergedBlasSize = 0;
+	for (const AccelerationStructureMemory& memory : mergedBlasMemory) mergedBlasSize += memory.size;
+	snprintf(line, sizeof(line), "\"mergeStaticBLAS\":%s,\"mergedBlasSize\":%llu,\"mergedTransformBufferSize\":%llu,\"tlasInstanceMapSize\":%llu,",
+		mergeSetting.enable ? "true" : "false", (unsigned long long)mergedBlasSize, (unsigned long long)mergedTransformBuffer.bufferSize,
+		(unsigned long long)tlasInstanceMapBuffer.bufferSize);
+	json += line;
+	json += "\"mergedBlas\":[";
+	for (size_t i = 0; i < mergedBlasMemory.size(); ++i) {
+		const AccelerationStructureMemory& memory = mergedBlasMemory[i];
+		snprintf(line, sizeof(line), "%s{\"instances\":%zu,\"triangles\":%u,\"buildSize\":%llu,\"size\":%llu,\"scratchSize\":%llu}",
+			i == 0 ? "" : ",", mergedGroups[i].size(), memory.primitiveCount, (unsigned long long)memory.buildSize,
+			(unsigned long long)memory.size, (unsigned long long)memory.scratchSize);
+		json += line;
+	}
+	json += "]}";
+	return json;
+}
+void AccelerationStructureManager::uiRender() {
+	constexpr double MB = 1024.0 * 1024.0;
+	if (ImGui::Begin("Acceleration Structure")) {
+		VkDeviceSize blasBuildSize = 0, blasSize = 0;
+		for (const AccelerationStructureMemory& memory : blasMemory) {
+			blasBuildSize += memory.buildSize;
+			blasSize += memory.size;
+		}
+		ImGui::Text("Compact BLAS: %s", compactBLAS ? "on" : "off");
+		ImGui::Text("BLAS: %zu, %.2f MB (build %.2f MB, scratch buffer %.2f MB)", blasMemory.size(), blasSize / MB, blasBuildSize / MB,
+			asBuilder.blasScratchBuffer.bufferSize / MB);
+		if (compactBLAS && blasBuildSize > 0)
+			ImGui::Text("Compaction saved %.2f MB (%.1f%%)", (blasBuildSize - blasSize) / MB, 100.0 * (blasBuildSize - blasSize) / blasBuildSize);
+		ImGui::Text("TLAS: %u instances, %.2f MB (scratch %.2f MB, instances %.2f MB)", tlasMemory.primitiveCount, tlasMemory.size / MB,
+			tlasMemory.scratchSize / MB, asBuilder.tlasInstancesBuffer.bufferSize / MB);
+		if (mergeSetting.enable) {
+			VkDeviceSize mergedBlasSize = 0;
+			size_t mergedInstanceCount = 0;
+			for (size_t i = 0; i < mergedBlasMemory.size(); ++i) {
+				mergedBlasSize += mergedBlasMemory[i].size;
+				mergedInstanceCount += mergedGroups[i].size();
+			}
+			ImGui::Text("Merged BLAS: %zu static instances -> %zu BLAS, %.2f MB", mergedInstanceCount, mergedBlasMemory.size(), mergedBlasSize / MB);
+		}
+		if (Application::sceneResource.instances.size() > Application::sceneResource.staticInstanceCount) {
+			const char* policyNames[] = { "Auto", "Refit", "Rebuild" };
+			ImGui::Combo("TLAS update", &tlasUpdateSetting.policy, policyNames, IM_ARRAYSIZE(policyNames));
+			if (tlasUpdateSetting.policy == TLASUpdatePolicy_Auto) {
+				ImGui::SliderFloat("Rebuild inflation", &tlasUpdateSetting.rebuildInflation, 1.0f, 4.0f, "%.2f");
+				int maxRefitCount = int(tlasUpdateSetting.maxRefitCount);
+				if (ImGui::InputInt("Max refit count", &maxRefitCount)) tlasUpdateSetting.maxRefitCount = uint32_t(std::max(maxRefitCount, 0));
+			}
+			ImGui::Checkbox("Log rebuilds and refits", &tlasUpdateSetting.logDecisions);
+			ImGui::Text("Inflation %.3f, %u refits since build, %u refits / %u rebuilds total", tlasInflation, tlasRefitCount,
+				tlasTotalRefitCount, tlasRebuildCount);
+		}
+
+		ImGuiTableFlags tableFlags = ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+		if (ImGui::BeginTable("BLASMemoryTable", 5, tableFlags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 16))) {
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableSetupColumn("Mesh");
+			ImGui::TableSetupColumn("Triangles");
+			ImGui::TableSetupColumn("Build (KB)");
+			ImGui::TableSetupColumn("Size (KB)");
+			ImGui::TableSetupColumn("Scratch (KB)");
+			ImGui::TableHeadersRow();
+			ImGuiListClipper clipper;		//ǧBLASֻƿɼ
+			clipper.Begin(int(blasMemory.size()));
+			while (clipper.Step()) {
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+					const AccelerationStructureMemory& memory = blasMemory[i];
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::Text("%d", i);
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", memory.primitiveCount);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", memory.buildSize / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", memory.size / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", memory.scratchSize / 1024.0);
+				}
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+}
+
 nvvk::AccelerationStructureGeometryInfo AccelerationStructureManager::primitiveToGeometry_nvvk(const shaderio::Mesh& mesh) {
 	//ͺ֮ǰcudaʵBVH˼·һһ
 
@@ -70,8 +237,7 @@ void AccelerationStructureManager::createBottomLevelAS_nvvk() {
 	for (uint32_t blasId = 0; blasId < Application::sceneResource.meshes.size(); ++blasId)
 		geoInfos[blasId] = primitiveToGeometry_nvvk(Application::sceneResource.meshes[blasId]);
 
-	asBuilder.blasSubmitBuildAndWait(geoInfos, VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR);
+	buildBottomLevelAS_nvvk(geoInfos);
 
 	LOGI("Bottom-level acceleration structures built successfully\n");
 }
@@ -93,42 +259,268 @@ void AccelerationStructureManager::createBottomLevelMotionAS_nvvk() {
 		geoInfos[blasId] = geo;
 	}
 		
-	asBuilder.blasSubmitBuildAndWait(geoInfos, VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR);
+	buildBottomLevelAS_nvvk(geoInfos);
 
 	LOGI("Bottom-level motion acceleration structures built successfully\n");
 }
+void AccelerationStructureManager::buildBottomLevelAS_nvvk(const std::vector<nvvk::AccelerationStructureGeometryInfo>& geoInfos) {
+	VkBuildAccelerationStructureFlagsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR;
+	if (compactBLAS) buildFlags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+
+	//ѹasBuilder.blasBuildDataֻʣѹĴСȼ¼ѹǰĴС
+	VkDevice device = Application::app->getDevice();
+	blasMemory.resize(geoInfos.size());
+	for (size_t i = 0; i < geoInfos.size(); ++i) {
+		nvvk::AccelerationStructureBuildData buildData{ VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR };
+		buildData.addGeometry(geoInfos[i]);
+		VkAccelerationStructureBuildSizesInfoKHR sizeInfo = buildData.finalizeGeometry(device, buildFlags);
+		blasMemory[i] = {
+			.primitiveCount = geoInfos[i].rangeInfo.primitiveCount,
+			.buildSize = sizeInfo.accelerationStructureSize,
+			.size = sizeInfo.accelerationStructureSize,
+			.scratchSize = sizeInfo.buildScratchSize,
+		};
+	}
+
+	//asBuilderԤÿѯѹСѹBLASԭBLAS
+	asBuilder.blasSubmitBuildAndWait(geoInfos, buildFlags);
+
+	if (compactBLAS) {
+		//BLAS֮ؽõʱռֱͷ
+		Application::allocator.destroyBuffer(asBuilder.blasScratchBuffer);
+		LOGI("BLAS compaction: %s\n", asBuilder.blasBuildStatistics.toString().c_str());
+	}
+}
+static float getAABBSurfaceArea(const shaderio::AABB& aabb) {
+	glm::vec3 size = glm::max(aabb.maximum - aabb.minimum, glm::vec3(0.0f));
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+static shaderio::AABB getAABBUnion(const shaderio::AABB& a, const shaderio::AABB& b) {
+	return { glm::min(a.minimum, b.minimum), glm::max(a.maximum, b.maximum) };
+}
+static shaderio::AABB transformAABB(const shaderio::AABB& aabb, const glm::mat4& matrix) {
+	glm::vec3 center = glm::vec3(matrix * glm::vec4((aabb.minimum + aabb.maximum) * 0.5f, 1.0f));
+	glm::vec3 extent = (aabb.maximum - aabb.minimum) * 0.5f;
+	glm::mat3 absMatrix = glm::mat3(matrix);
+	for (int i = 0; i < 3; ++i) absMatrix[i] = glm::abs(absMatrix[i]);
+	extent = absMatrix * extent;
+	return { center - extent, center + extent };
+}
+static uint32_t expandMortonBits(uint32_t v) {
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+void AccelerationStructureManager::groupStaticInstances() {
+	FzbRenderer::Scene& sceneResource = Application::sceneResource;
+	mergedGroups.clear();
+
+	//̬ʵmeshϲÿʵḴһݼ
+	std::vector<uint32_t> meshInstanceCounts(sceneResource.meshes.size(), 0);
+	for (uint32_t i = 0; i < sceneResource.staticInstanceCount; ++i) ++meshInstanceCounts[sceneResource.instances[i].meshIndex];
+
+	struct MergeCandidate {
+		uint32_t instanceIndex;
+		uint32_t triangleCount;
+		shaderio::AABB aabb;
+		uint32_t mortonCode = 0;
+	};
+	std::vector<MergeCandidate> candidates;
+	shaderio::AABB sceneAABB = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+	for (uint32_t i = 0; i < sceneResource.staticInstanceCount; ++i) {
+		const shaderio::Instance& instance = sceneResource.instances[i];
+		uint32_t triangleCount = sceneResource.meshes[instance.meshIndex].triMesh.indices.count / 3;
+		if (triangleCount == 0 || triangleCount > mergeSetting.maxInstanceTriangles) continue;
+		if (meshInstanceCounts[instance.meshIndex] > 1 && triangleCount > mergeSetting.maxSharedTriangles) continue;
+
+		MergeCandidate candidate{ i, triangleCount, sceneResource.getMeshInfo(instance.meshIndex).getAABB(instance.transform) };
+		sceneAABB = getAABBUnion(sceneAABB, candidate.aabb);
+		candidates.push_back(candidate);
+	}
+	if (candidates.size() < 2) return;
+
+	//ΧĵMortonʹڵĺѡڿռҲ
+	glm::vec3 sceneSize = glm::max(sceneAABB.maximum - sceneAABB.minimum, glm::vec3(1e-6f));
+	for (MergeCandidate& candidate : candidates) {
+		glm::vec3 center = (candidate.aabb.minimum + candidate.aabb.maximum) * 0.5f;
+		glm::uvec3 cell = glm::uvec3(glm::clamp((center - sceneAABB.minimum) / sceneSize * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f)));
+		candidate.mortonCode = (expandMortonBits(cell.x) << 2) | (expandMortonBits(cell.y) << 1) | expandMortonBits(cell.z);
+	}
+	std::stable_sort(candidates.begin(), candidates.end(),
+		[](const MergeCandidate& a, const MergeCandidate& b) { return a.mortonCode < b.mortonCode; });
+
+	std::vector<uint32_t> group;
+	shaderio::AABB groupAABB;
+	uint32_t groupTriangleCount = 0;
+	auto closeGroup = [&]() {
+		if (group.size() > 1) mergedGroups.push_back(group);		//ֻһʵ鱣ԭBLAS
+		group.clear();
+		};
+	for (const MergeCandidate& candidate : candidates) {
+		if (!group.empty()) {
+			shaderio::AABB unionAABB = getAABBUnion(groupAABB, candidate.aabb);
+			bool fitTriangles = groupTriangleCount + candidate.triangleCount <= mergeSetting.maxTriangles;
+			bool fitSurfaceArea = getAABBSurfaceArea(unionAABB) <=
+				mergeSetting.sahFactor * (getAABBSurfaceArea(groupAABB) + getAABBSurfaceArea(candidate.aabb));
+			if (fitTriangles && fitSurfaceArea) {
+				group.push_back(candidate.instanceIndex);
+				groupAABB = unionAABB;
+				groupTriangleCount += candidate.triangleCount;
+				continue;
+			}
+			closeGroup();
+		}
+		group.push_back(candidate.instanceIndex);
+		groupAABB = candidate.aabb;
+		groupTriangleCount = candidate.triangleCount;
+	}
+	closeGroup();
+}
+void AccelerationStructureManager::createMergedBottomLevelAS_nvvk() {
+	SCOPED_TIMER(__FUNCTION__);
+	FzbRenderer::Scene& sceneResource = Application::sceneResource;
+
+	groupStaticInstances();
+	if (mergedGroups.empty()) {
+		LOGI("No static instances to merge into bottom-level acceleration structures\n");
+		return;
+	}
+
+	//ÿһ任BLASʱ任ռ䣬tlasʵı任Ϊλ
+	std::vector<VkTransformMatrixKHR> transforms;
+	for (const std::vector<uint32_t>& group : mergedGroups)
+		for (uint32_t instanceIndex : group) transforms.push_back(nvvk::toTransformMatrixKHR(sceneResource.instances[instanceIndex].transform));
+	{
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		NVVK_CHECK(Application::allocator.createBuffer(mergedTransformBuffer, std::span<VkTransformMatrixKHR const>(transforms).size_bytes(),
+			VK_BUFFER_USAGE_2_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_2_SHADER_DEVICE_ADDRESS_BIT));
+		NVVK_CHECK(Application::stagingUploader.appendBuffer(mergedTransformBuffer, 0, std::span<VkTransformMatrixKHR const>(transforms)));
+		NVVK_DBG_NAME(mergedTransformBuffer.buffer);
+		Application::stagingUploader.cmdUploadAppended(cmd);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+	}
+
+	VkBuildAccelerationStructureFlagsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR;
+	if (compactBLAS) buildFlags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+
+	VkDevice device = Application::app->getDevice();
+	std::vector<nvvk::AccelerationStructureBuildData> buildDatas;
+	buildDatas.reserve(mergedGroups.size());
+	mergedBlasMemory.resize(mergedGroups.size());
+	uint32_t transformIndex = 0;
+	size_t mergedInstanceCount = 0;
+	for (size_t groupIndex = 0; groupIndex < mergedGroups.size(); ++groupIndex) {
+		nvvk::AccelerationStructureBuildData buildData{ VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR };
+		uint32_t triangleCount = 0;
+		for (uint32_t instanceIndex : mergedGroups[groupIndex]) {
+			nvvk::AccelerationStructureGeometryInfo geo = primitiveToGeometry_nvvk(sceneResource.meshes[sceneResource.instances[instanceIndex].meshIndex]);
+			geo.geometry.geometry.triangles.transformData.deviceAddress = mergedTransformBuffer.address + transformIndex++ * sizeof(VkTransformMatrixKHR);
+			buildData.addGeometry(geo);
+			triangleCount += geo.rangeInfo.primitiveCount;
+		}
+		VkAccelerationStructureBuildSizesInfoKHR sizeInfo = buildData.finalizeGeometry(device, buildFlags);
+		mergedBlasMemory[groupIndex] = {
+			.primitiveCount = triangleCount,
+			.buildSize = sizeInfo.accelerationStructureSize,
+			.size = sizeInfo.accelerationStructureSize,
+			.scratchSize = sizeInfo.buildScratchSize,
+		};
+		buildDatas.push_back(buildData);
+		mergedInstanceCount += mergedGroups[groupIndex].size();
+	}
+
+	//asBuilder.blasSubmitBuildAndWaitͬԤѹ
+	mergedBlasSet.resize(buildDatas.size());
+	nvvk::AccelerationStructureBuilder blasBuilder;
+	blasBuilder.init(&Application::allocator);
+	VkDeviceSize scratchSize = blasBuilder.getScratchSize(asBuilder.m_blasScratchBudget, buildDatas);
+
+	nvvk::Buffer mergedScratchBuffer;
+	NVVK_CHECK(Application::allocator.createBuffer(mergedScratchBuffer, scratchSize,
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_2_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
+		VMA_MEMORY_USAGE_AUTO, {}, asBuilder.m_accelStructProps.minAccelerationStructureScratchOffsetAlignment));
+
+	std::span<nvvk::AccelerationStructureBuildData> buildDataSpan = buildDatas;
+	std::span<nvvk::AccelerationStructure> blasSpan = mergedBlasSet;
+	bool finished = false;
+	do {
+		VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+		VkResult result = blasBuilder.cmdCreateBlas(cmd, buildDataSpan, blasSpan, mergedScratchBuffer.address,
+			mergedScratchBuffer.bufferSize, asBuilder.m_blasAccelerationStructureBudget);
+		if (result == VK_SUCCESS) finished = true;
+		else if (result != VK_INCOMPLETE) assert(0 && "Error building merged BLAS");
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
+
+		if (compactBLAS) {
+			cmd = Application::app->createTempCmdBuffer();
+			blasBuilder.cmdCompactBlas(cmd, buildDataSpan, blasSpan);
+			Application::app->submitAndWaitTempCmdBuffer(cmd);
+			blasBuilder.destroyNonCompactedBlas();
+		}
+	} while (!finished);
+	blasBuilder.deinit();
+	Application::allocator.destroyBuffer(mergedScratchBuffer);
+
+	for (nvvk::AccelerationStructure& blas : mergedBlasSet) NVVK_DBG_NAME(blas.accel);
+
+	LOGI("%zu static instances merged into %zu bottom-level acceleration structures\n", mergedInstanceCount, mergedBlasSet.size());
+}
 
 void AccelerationStructureManager::createTopLevelAS_nvvk() {
 	SCOPED_TIMER(__FUNCTION__);
 
 	FzbRenderer::Scene& sceneResource = Application::sceneResource;
 
-	std::vector<VkAccelerationStructureInstanceKHR> tlasInstances(0);
+	tlasInstances.clear();
 	tlasInstances.reserve(sceneResource.instances.size());
 
-	staticTlasInstances.resize(0);
-	staticTlasInstances.reserve(sceneResource.staticInstanceCount);		//ÿmeshһʵ
+	tlasInstanceMap.clear();
+	tlasInstanceMap.reserve(sceneResource.instances.size());
+
+	std::vector<bool> instanceMerged(sceneResource.staticInstanceCount, false);
+	for (const std::vector<uint32_t>& group : mergedGroups)
+		for (uint32_t instanceIndex : group) instanceMerged[instanceIndex] = true;
+
 	const VkGeometryInstanceFlagsKHR flgas{ VK_GEOMETRY_INSTANCE_TRIANGLE_CULL_DISABLE_BIT_NV };	//ûб޳
 	for (int i = 0; i < sceneResource.staticInstanceCount; ++i) {
+		if (instanceMerged[i]) continue;
 		const shaderio::Instance& instance = sceneResource.instances[i];
 		VkAccelerationStructureInstanceKHR asInstance{};
 		asInstance.transform = nvvk::toTransformMatrixKHR(instance.transform);
-		asInstance.instanceCustomIndex = instance.meshIndex;
+		asInstance.instanceCustomIndex = uint32_t(tlasInstanceMap.size());
 		asInstance.accelerationStructureReference = asBuilder.blasSet[instance.meshIndex].address;
 		asInstance.instanceShaderBindingTableRecordOffset = 0;		//ʵSBThitGroupеiĿshader
 		asInstance.flags = flgas;
 		asInstance.mask = 0xFF;
-		staticTlasInstances.emplace_back(asInstance);
+		tlasInstances.emplace_back(asInstance);
+		tlasInstanceMap.push_back(i);
+	}
+	for (size_t groupIndex = 0; groupIndex < mergedGroups.size(); ++groupIndex) {	//ϲBLASжռ
+		VkAccelerationStructureInstanceKHR asInstance{};
+		asInstance.transform = nvvk::toTransformMatrixKHR(glm::mat4(1.0f));
+		asInstance.instanceCustomIndex = uint32_t(tlasInstanceMap.size());
+		asInstance.accelerationStructureReference = mergedBlasSet[groupIndex].address;
+		asInstance.instanceShaderBindingTableRecordOffset = 0;
+		asInstance.flags = flgas;
+		asInstance.mask = 0xFF;
+		tlasInstances.emplace_back(asInstance);
+		tlasInstanceMap.insert(tlasInstanceMap.end(), mergedGroups[groupIndex].begin(), mergedGroups[groupIndex].end());
 	}
-	tlasInstances.insert(tlasInstances.end(), staticTlasInstances.begin(), staticTlasInstances.end());
+
+	//̬ʵϲӳаinstances˳
+	dynamicInstanceMapOffset = uint32_t(tlasInstanceMap.size());
+	for (uint32_t i = sceneResource.staticInstanceCount; i < sceneResource.instances.size(); ++i) tlasInstanceMap.push_back(i);
 
 	uint32_t offset = sceneResource.staticInstanceCount;
 	for (int i = 0; i < sceneResource.periodInstanceCount; ++i) {
 		const shaderio::Instance& instance = sceneResource.instances[i + offset];
 		VkAccelerationStructureInstanceKHR asInstance{};
 		asInstance.transform = nvvk::toTransformMatrixKHR(instance.transform);
-		asInstance.instanceCustomIndex = instance.meshIndex;
+		asInstance.instanceCustomIndex = dynamicInstanceMapOffset + i;
 		asInstance.accelerationStructureReference = asBuilder.blasSet[instance.meshIndex].address;
 		asInstance.instanceShaderBindingTableRecordOffset = 0;		//ʵSBThitGroupеiĿshader
 		asInstance.flags = flgas;
@@ -141,7 +533,7 @@ void AccelerationStructureManager::createTopLevelAS_nvvk() {
 		const shaderio::Instance& instance = sceneResource.instances[i + offset];
 		VkAccelerationStructureInstanceKHR asInstance{};
 		asInstance.transform = nvvk::toTransformMatrixKHR(instance.transform);
-		asInstance.instanceCustomIndex = instance.meshIndex;
+		asInstance.instanceCustomIndex = dynamicInstanceMapOffset + sceneResource.periodInstanceCount + i;
 		asInstance.accelerationStructureReference = asBuilder.blasSet[instance.meshIndex].address;
 		asInstance.instanceShaderBindingTableRecordOffset = 0;		//ʵSBThitGroupеiĿshader
 		asInstance.flags = flgas;
@@ -155,6 +547,20 @@ void AccelerationStructureManager::createTopLevelAS_nvvk() {
 	if (sceneResource.instances.size() > sceneResource.staticInstanceCount) createFlags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
 	asBuilder.tlasSubmitBuildAndWait(tlasInstances, createFlags);
 
+	//¼ʱ̬ʵİΧУ֮ĸ¸ݰΧе;refitؽ
+	uint32_t dynamicInstanceCount = uint32_t(sceneResource.instances.size()) - sceneResource.staticInstanceCount;
+	meshAABBs.assign(sceneResource.meshes.size(), { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } });
+	dynamicBuildAABBs.resize(dynamicInstanceCount);
+	for (uint32_t i = 0; i < dynamicInstanceCount; ++i) {
+		const shaderio::Instance& instance = sceneResource.instances[sceneResource.staticInstanceCount + i];
+		shaderio::AABB& meshAABB = meshAABBs[instance.meshIndex];
+		if (meshAABB.minimum.x > meshAABB.maximum.x) meshAABB = sceneResource.getMeshInfo(instance.meshIndex).getAABB();
+		dynamicBuildAABBs[i] = transformAABB(meshAABB, instance.transform);
+	}
+	dynamicAABBs = dynamicBuildAABBs;
+	tlasInflation = 1.0f;
+	tlasRefitCount = 0;
+
 	LOGI("Top-level accleration structures built successfully\n");
 }
 void AccelerationStructureManager::createTopLevelMotionAS_nvvk() {
@@ -162,11 +568,16 @@ void AccelerationStructureManager::createTopLevelMotionAS_nvvk() {
 
 	motionInstances.reserve(sceneResource.staticInstanceCount + sceneResource.periodInstanceCount);
 
+	//˶ģʱϲBLAStlasʵinstancesһһӦ
+	tlasInstanceMap.resize(sceneResource.instances.size());
+	std::iota(tlasInstanceMap.begin(), tlasInstanceMap.end(), 0u);
+	dynamicInstanceMapOffset = sceneResource.staticInstanceCount;
+
 	const VkGeometryInstanceFlagsKHR flags{ VK_GEOMETRY_INSTANCE_TRIANGLE_CULL_DISABLE_BIT_NV };
 	for (int i = 0; i < sceneResource.staticInstanceCount; ++i) {	//̬ʵ
 		VkAccelerationStructureInstanceKHR staticInst{};
 		staticInst.transform = nvvk::toTransformMatrixKHR(sceneResource.instances[i].transform);
-		staticInst.instanceCustomIndex = sceneResource.instances[i].meshIndex;
+		staticInst.instanceCustomIndex = i;
 		staticInst.accelerationStructureReference =
 			asBuilder.blasSet[sceneResource.instances[i].meshIndex].address;
 		staticInst.instanceShaderBindingTableRecordOffset = 0;
@@ -180,17 +591,21 @@ void AccelerationStructureManager::createTopLevelMotionAS_nvvk() {
 	}
 
 	uint32_t offset = sceneResource.staticInstanceCount;
+	uint32_t childInstanceIndex = 0;
 	for (int i = 0; i < sceneResource.periodInstanceCount; ++i) {
 		uint32_t index = i + offset;
-		InstanceSet& instanceSet = sceneResource.periodInstanceSets[sceneResource.periodInstanceIndexToInstanceSetIndex[index]];
+		uint32_t instanceSetIndex = sceneResource.periodInstanceIndexToInstanceSetIndex[i];
+		if (i > 0 && instanceSetIndex != sceneResource.periodInstanceIndexToInstanceSetIndex[i - 1]) childInstanceIndex = 0;
+		InstanceSet& instanceSet = sceneResource.periodInstanceSets[instanceSetIndex];
+		const glm::mat4& childMatrix = instanceSet.childInstances[childInstanceIndex++].transform;	//baseMatrix * gltfڵ任
 
-		glm::mat4 matT0 = instanceSet.startMatrix * instanceSet.baseMatrix;                 // Original position
-		glm::mat4 matT1 = instanceSet.endMatrix * instanceSet.baseMatrix;					// Translated position
+		glm::mat4 matT0 = instanceSet.startMatrix * childMatrix;                 // Original position
+		glm::mat4 matT1 = instanceSet.endMatrix * childMatrix;					// Translated position
 
 		VkAccelerationStructureMatrixMotionInstanceNV matrixData{};
 		matrixData.transformT0 = nvvk::toTransformMatrixKHR(matT0);
 		matrixData.transformT1 = nvvk::toTransformMatrixKHR(matT1);
-		matrixData.instanceCustomIndex = sceneResource.instances[index].meshIndex;
+		matrixData.instanceCustomIndex = index;
 		matrixData.accelerationStructureReference =
 			asBuilder.blasSet[sceneResource.instances[index].meshIndex].address;
 		matrixData.instanceShaderBindingTableRecordOffset = 0;
@@ -213,7 +628,7 @@ void AccelerationStructureManager::createTopLevelMotionAS_nvvk() {
 
 		VkAccelerationStructureInstanceKHR randomInstance{};
 		randomInstance.transform = nvvk::toTransformMatrixKHR(sceneResource.instances[index].transform);
-		randomInstance.instanceCustomIndex = sceneResource.instances[index].meshIndex;
+		randomInstance.instanceCustomIndex = index;
 		randomInstance.accelerationStructureReference =
 			asBuilder.blasSet[sceneResource.instances[index].meshIndex].address;
 		randomInstance.instanceShaderBindingTableRecordOffset = 0;
@@ -232,6 +647,17 @@ void AccelerationStructureManager::createTopLevelMotionAS_nvvk() {
 
 	LOGI("Top-level accleration motion structures built successfully\n");
 }
+void AccelerationStructureManager::createTlasInstanceMapBuffer() {
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	NVVK_CHECK(Application::allocator.createBuffer(tlasInstanceMapBuffer, std::span<const uint32_t>(tlasInstanceMap).size_bytes(),
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_SHADER_DEVICE_ADDRESS_BIT));
+	NVVK_CHECK(Application::stagingUploader.appendBuffer(tlasInstanceMapBuffer, 0, std::span<const uint32_t>(tlasInstanceMap)));
+	NVVK_DBG_NAME(tlasInstanceMapBuffer.buffer);
+	Application::stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+
+	Application::sceneResource.sceneInfo.tlasInstanceMap = (uint32_t*)tlasInstanceMapBuffer.address;
+}
 
 void AccelerationStructureManager::updateToplevelAS(VkCommandBuffer cmd) {
 #ifdef PathTracingMotionBlur
@@ -240,14 +666,43 @@ void AccelerationStructureManager::updateToplevelAS(VkCommandBuffer cmd) {
 	updateTopLevelAS_nvvk(cmd);
 #endif
 }
-void AccelerationStructureManager::tlasSubmitUpdateAndWait(VkCommandBuffer cmd, const std::vector<VkAccelerationStructureInstanceKHR>& tlasInstances) {
-	VkDevice device = asBuilder.m_alloc->getDevice();
-
-	bool sizeChanged = (tlasInstances.size() != asBuilder.tlasSize);
-
-	// Update the instance buffer
-	asBuilder.m_uploader->appendBuffer(asBuilder.tlasInstancesBuffer, 0, std::span(tlasInstances));
-	asBuilder.m_uploader->cmdUploadAppended(cmd);
+bool AccelerationStructureManager::shouldRebuildTopLevelAS(const char*& reason) const {
+	switch (tlasUpdateSetting.policy) {
+	case TLASUpdatePolicy_Refit: reason = "refit policy"; return false;
+	case TLASUpdatePolicy_Rebuild: reason = "rebuild policy"; return true;
+	default: break;
+	}
+	if (tlasInflation > tlasUpdateSetting.rebuildInflation) {
+		reason = "bound inflation";
+		return true;
+	}
+	if (tlasUpdateSetting.maxRefitCount > 0 && tlasRefitCount >= tlasUpdateSetting.maxRefitCount) {
+		reason = "refit count";
+		return true;
+	}
+	reason = "refit";
+	return false;
+}
+void AccelerationStructureManager::cmdUpdateTopLevelAS(VkCommandBuffer cmd, const std::vector<std::pair<uint32_t, uint32_t>>& changedRanges, bool rebuild) {
+	//vkCmdUpdateBufferһ65536ֽ
+	constexpr VkDeviceSize maxUpdateSize = 65536;
+	//vkDeviceWaitIdleͬһ֮ǰ֡TLASʵʱռĶд֮ǰ
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR);
+	for (const std::pair<uint32_t, uint32_t>& range : changedRanges) {
+		VkDeviceSize offset = range.first * sizeof(VkAccelerationStructureInstanceKHR);
+		VkDeviceSize size = (range.second - range.first) * sizeof(VkAccelerationStructureInstanceKHR);
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(tlasInstances.data() + range.first);
+		while (size > 0) {
+			VkDeviceSize updateSize = std::min(size, maxUpdateSize);
+			vkCmdUpdateBuffer(cmd, asBuilder.tlasInstancesBuffer.buffer, offset, updateSize, data);
+			offset += updateSize;
+			data += updateSize;
+			size -= updateSize;
+		}
+	}
 
 	// Make sure the copy of the instance buffer are copied before triggering the acceleration structure build
 	nvvk::accelerationStructureBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT,
@@ -261,16 +716,9 @@ void AccelerationStructureManager::tlasSubmitUpdateAndWait(VkCommandBuffer cmd,
 		NVVK_DBG_NAME(asBuilder.tlasScratchBuffer.buffer);
 	}
 
-	// Building or updating the top-level acceleration structure
-	if (sizeChanged)
-	{
-		asBuilder.tlasBuildData.cmdBuildAccelerationStructure(cmd, asBuilder.tlas.accel, asBuilder.tlasScratchBuffer.address);
-		asBuilder.tlasSize = tlasInstances.size();
-	}
-	else
-	{
-		asBuilder.tlasBuildData.cmdUpdateAccelerationStructure(cmd, asBuilder.tlas.accel, asBuilder.tlasScratchBuffer.address);
-	}
+	//ʵ䣬ؽʱԭTLASʱռ
+	if (rebuild) asBuilder.tlasBuildData.cmdBuildAccelerationStructure(cmd, asBuilder.tlas.accel, asBuilder.tlasScratchBuffer.address);
+	else asBuilder.tlasBuildData.cmdUpdateAccelerationStructure(cmd, asBuilder.tlas.accel, asBuilder.tlasScratchBuffer.address);
 
 	nvvk::accelerationStructureBarrier(cmd, VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
 		VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
@@ -280,40 +728,52 @@ void AccelerationStructureManager::updateTopLevelAS_nvvk(VkCommandBuffer cmd) {
 
 	FzbRenderer::Scene& sceneResource = Application::sceneResource;
 
-	std::vector<VkAccelerationStructureInstanceKHR> tlasInstances(0);
-	tlasInstances.reserve(sceneResource.instances.size());
-	tlasInstances.insert(tlasInstances.end(), staticTlasInstances.begin(), staticTlasInstances.end());
-
-	const VkGeometryInstanceFlagsKHR flags{ VK_GEOMETRY_INSTANCE_TRIANGLE_CULL_DISABLE_BIT_NV };	//ûб޳
-	uint32_t offset = sceneResource.staticInstanceCount;
-	for (int i = 0; i < sceneResource.periodInstanceCount; ++i) {
-		const shaderio::Instance& instance = sceneResource.instances[i + offset];
-		VkAccelerationStructureInstanceKHR asInstance{};
-		asInstance.transform = nvvk::toTransformMatrixKHR(instance.transform);
-		asInstance.instanceCustomIndex = instance.meshIndex;
-		asInstance.accelerationStructureReference = asBuilder.blasSet[instance.meshIndex].address;
-		asInstance.instanceShaderBindingTableRecordOffset = 0;		//ʵSBThitGroupеiĿshader
-		asInstance.flags = flags;
-		asInstance.mask = 0xFF;
-		tlasInstances.emplace_back(asInstance);
+	//̬ʵtlasInstancesĩβҳ任仯ʵϲΪϴ
+	uint32_t dynamicInstanceCount = uint32_t(sceneResource.instances.size()) - sceneResource.staticInstanceCount;
+	uint32_t dynamicTlasOffset = uint32_t(tlasInstances.size()) - dynamicInstanceCount;
+	std::vector<std::pair<uint32_t, uint32_t>> changedRanges;
+	float buildSurfaceArea = 0.0f;
+	float inflatedSurfaceArea = 0.0f;
+	for (uint32_t i = 0; i < dynamicInstanceCount; ++i) {
+		const shaderio::Instance& instance = sceneResource.instances[sceneResource.staticInstanceCount + i];
+		dynamicAABBs[i] = transformAABB(meshAABBs[instance.meshIndex], instance.transform);
+		buildSurfaceArea += getAABBSurfaceArea(dynamicBuildAABBs[i]);
+		inflatedSurfaceArea += getAABBSurfaceArea(getAABBUnion(dynamicBuildAABBs[i], dynamicAABBs[i]));
+
+		VkTransformMatrixKHR transform = nvvk::toTransformMatrixKHR(instance.transform);
+		uint32_t tlasIndex = dynamicTlasOffset + i;
+		if (memcmp(&tlasInstances[tlasIndex].transform, &transform, sizeof(VkTransformMatrixKHR)) == 0) continue;
+		tlasInstances[tlasIndex].transform = transform;
+		if (!changedRanges.empty() && changedRanges.back().second == tlasIndex) ++changedRanges.back().second;
+		else changedRanges.push_back({ tlasIndex, tlasIndex + 1 });
 	}
+	if (changedRanges.empty()) return;		//̬ʵûƶTLAS
 
-	offset += sceneResource.periodInstanceCount;
-	for (int i = 0; i < sceneResource.randomInstanceCount; ++i) {
-		const shaderio::Instance& instance = sceneResource.instances[i + offset];
-		VkAccelerationStructureInstanceKHR asInstance{};
-		asInstance.transform = nvvk::toTransformMatrixKHR(instance.transform);
-		asInstance.instanceCustomIndex = instance.meshIndex;
-		asInstance.accelerationStructureReference = asBuilder.blasSet[instance.meshIndex].address;
-		asInstance.instanceShaderBindingTableRecordOffset = 0;		//ʵSBThitGroupеiĿshader
-		asInstance.flags = flags;
-		asInstance.mask = 0xFF;
-		tlasInstances.emplace_back(asInstance);
+	tlasInflation = buildSurfaceArea > 0.0f ? inflatedSurfaceArea / buildSurfaceArea : 1.0f;
+	const char* reason = nullptr;
+	bool rebuild = shouldRebuildTopLevelAS(reason);
+
+	if (cmd) cmdUpdateTopLevelAS(cmd, changedRanges, rebuild);
+	else {
+		cmd = Application::app->createTempCmdBuffer();
+		cmdUpdateTopLevelAS(cmd, changedRanges, rebuild);
+		Application::app->submitAndWaitTempCmdBuffer(cmd);
 	}
 
-	NVVK_CHECK(vkDeviceWaitIdle(Application::app->getDevice()));	//ȴGPUָ
-	if (cmd) tlasSubmitUpdateAndWait(cmd, tlasInstances);
-	else asBuilder.tlasSubmitUpdateAndWait(tlasInstances);
+	if (rebuild) {
+		if (tlasUpdateSetting.logDecisions)
+			LOGI("TLAS rebuilt (%s): inflation %.3f after %u refits\n", reason, tlasInflation, tlasRefitCount);
+		dynamicBuildAABBs = dynamicAABBs;
+		tlasInflation = 1.0f;
+		tlasRefitCount = 0;
+		++tlasRebuildCount;
+	}
+	else {
+		++tlasRefitCount;
+		++tlasTotalRefitCount;
+		if (tlasUpdateSetting.logDecisions)
+			LOGI("TLAS refit (%s): inflation %.3f, %u refits since rebuild\n", reason, tlasInflation, tlasRefitCount);
+	}
 }
 void AccelerationStructureManager::updateTopLevelMotionAS_nvvk() {
 	if (Application::sceneResource.randomInstanceCount == 0) return;
@@ -331,7 +791,7 @@ void AccelerationStructureManager::updateTopLevelMotionAS_nvvk() {
 
 		VkAccelerationStructureInstanceKHR randomInstance{};
 		randomInstance.transform = nvvk::toTransformMatrixKHR(sceneResource.instances[index].transform);
-		randomInstance.instanceCustomIndex = sceneResource.instances[index].meshIndex;
+		randomInstance.instanceCustomIndex = index;
 		randomInstance.accelerationStructureReference =
 			asBuilder.blasSet[sceneResource.instances[index].meshIndex].address;
 		randomInstance.instanceShaderBindingTableRecordOffset = 0;
@@ -4,6 +4,9 @@
 #include <vulkan/vulkan_core.h>
 #include <nvvk/resources.hpp>
 #include <nvvk/acceleration_structures.hpp>
+#include <pugixml.hpp>
+#include <string>
+#include <utility>
 
 #ifndef FZBRENDERER_ACCELERATION_STRUCTURE_H
 #define FZBRENDERER_ACCELERATION_STRUCTURE_H
@@ -21,15 +24,91 @@ struct AccelerationStructureCreateInfo {
 	nvvk::AccelerationStructure* accelStruct;
 };
 
+//һٽṹԴ棬λֽ
+struct AccelerationStructureMemory {
+	uint32_t primitiveCount = 0;	//BLASΪTLASΪʵ
+	VkDeviceSize buildSize = 0;		//ʱĴСѹǰĴС
+	VkDeviceSize size = 0;			//ǰĴС
+	VkDeviceSize scratchSize = 0;	//Ҫʱռ
+};
+/*
+̬BLASϲĴģֻͣǰstaticInstanceCount̬ʵ
+1. ʵmaxInstanceTrianglesǺѡһϲBLASmaxTriangles
+2. Դ棺ϲʱλᰴʵ任һݣʵmeshֻmaxSharedTrianglesʱϲ
+3. صѡΧĵMorton̰ĳ飬ʵİΧбܳ
+   sahFactor * (ı + ʵı)Զʵһ
+*/
+struct StaticBLASMergeSetting {
+	bool enable = false;
+	uint32_t maxTriangles = 65536;
+	uint32_t maxInstanceTriangles = 4096;
+	uint32_t maxSharedTriangles = 256;
+	float sahFactor = 1.5f;
+};
+
+enum TLASUpdatePolicy {
+	TLASUpdatePolicy_Auto = 0,
+	TLASUpdatePolicy_Refit = 1,
+	TLASUpdatePolicy_Rebuild = 2,
+};
+/*
+̬ʵ仯TLASĸ²
+1. Refitֹʱֻ°ΧУСʵ빹ʱλԽԶڵΧԽɣ߱Խ
+2. Rebuildؽһιͬ
+3. Autoͳƶ̬ʵΧе  SA(ʱΧ  ǰΧ) /  SA(ʱΧ)
+   rebuildInflationϴιrefitmaxRefitCountʱؽrefit
+*/
+struct TLASUpdateSetting {
+	int policy = TLASUpdatePolicy_Auto;
+	float rebuildInflation = 1.5f;
+	uint32_t maxRefitCount = 0;		//0ʾ
+	bool logDecisions = false;		//ÿؽrefitʱԭͰΧͣrefitÿ֡ĬϹر
+};
+
 class AccelerationStructureManager {
 public:
 	void init();
 	void clean();
+	void uiRender();
+
+	/*
+	<compactBLAS value = "true" />BLASALLOW_COMPACTIONѯѹĴСѹBLASͷԭBLAS
+	<mergeStaticBLAS value = "true" maxTriangles = "65536" maxInstanceTriangles = "4096" maxSharedTriangles = "256" sahFactor = "1.5" />
+		ռڵС̬ʵϲΪһBLASStaticBLASMergeSetting
+	<tlasUpdate policy = "auto" rebuildInflation = "1.5" maxRefitCount = "0" log = "true" />policyΪautorefitrebuildTLASUpdateSetting
+	*/
+	void getSettingFromXML(pugi::xml_node& rendererNode);
+	/*
+	ͳÿBLASTLASԴ棺buildSizeڹǰfinalizeGeometryõsizeΪʵʵbufferС
+	ͳƽʾUIУΪaccelerationStructuresдheadlesschrome trace json
+	*/
+	void collectMemoryStatistics();
+	std::string getMemoryReportJson() const;
+
+	bool compactBLAS = false;
+	std::vector<AccelerationStructureMemory> blasMemory;
+	std::vector<AccelerationStructureMemory> mergedBlasMemory;
+	AccelerationStructureMemory tlasMemory;
+
+	StaticBLASMergeSetting mergeSetting;
+	std::vector<std::vector<uint32_t>> mergedGroups;		//ÿϲBLASľ̬ʵinstancesеkʵΪBLASĵk
+	std::vector<nvvk::AccelerationStructure> mergedBlasSet;
+	nvvk::Buffer mergedTransformBuffer;		//ϲBLASÿεı任󣬹ʱԤȽ任ռ
+
+	/*
+	tlasʵinstanceCustomIndexΪʵӳе㣬shaderͨtlasInstanceMap[InstanceID() + GeometryIndex()]õinstancesе
+	InstanceõmeshIndexmaterialIndexPrimitiveIndexΪڵԺϲÿһԭmeshе
+	*/
+	std::vector<uint32_t> tlasInstanceMap;
+	nvvk::Buffer tlasInstanceMapBuffer;
+	uint32_t dynamicInstanceMapOffset = 0;		//̬ʵӳе㣬̬ʵϲÿռһ
 
 	nvvk::AccelerationStructureGeometryInfo primitiveToGeometry_nvvk(const shaderio::Mesh& mesh);
 	
 	void createBottomLevelAS_nvvk();
 	void createBottomLevelMotionAS_nvvk();		//meshαʱ
+	//StaticBLASMergeSetting̬ʵ飬ÿ鹹һBLASÿʵһ
+	void createMergedBottomLevelAS_nvvk();
 
 	void createTopLevelAS_nvvk();
 	void createTopLevelMotionAS_nvvk();
@@ -40,7 +119,16 @@ public:
 
 	VkPhysicalDeviceAccelerationStructurePropertiesKHR asProperties;
 
-	std::vector<VkAccelerationStructureInstanceKHR> staticTlasInstances;
+	/*
+	tlasʵ飬asBuilder.tlasInstancesBufferһ£̬ʵǰ̬ʵinstances˳ں
+	ʱֻѱ任仯Ķ̬ʵvkCmdUpdateBufferдtlasInstancesBuffer
+	*/
+	std::vector<VkAccelerationStructureInstanceKHR> tlasInstances;
+	TLASUpdateSetting tlasUpdateSetting;
+	float tlasInflation = 1.0f;		//һθʱİΧ
+	uint32_t tlasRefitCount = 0;	//ϴιrefit
+	uint32_t tlasTotalRefitCount = 0;
+	uint32_t tlasRebuildCount = 0;
 	std::vector<nvvk::VkAccelerationStructureMotionInstanceNVPad> motionInstances;
 
 	VkDeviceSize maxScratchBufferSize = 0;
@@ -51,7 +139,18 @@ public:
 
 	nvvk::AccelerationStructureHelper asBuilder{};
 private:
-	void tlasSubmitUpdateAndWait(VkCommandBuffer cmd, const std::vector<VkAccelerationStructureInstanceKHR>& tlasInstances);
+	//changedRangesΪtlasInstancesҪϴ[begin, end)䣬rebuildΪfalseʱrefit
+	void cmdUpdateTopLevelAS(VkCommandBuffer cmd, const std::vector<std::pair<uint32_t, uint32_t>>& changedRanges, bool rebuild);
+	bool shouldRebuildTopLevelAS(const char*& reason) const;
+
+	std::vector<shaderio::AABB> meshAABBs;			//̬ʵõmeshľֲΧ
+	std::vector<shaderio::AABB> dynamicBuildAABBs;	//ϴιʱ̬ʵΧ
+	std::vector<shaderio::AABB> dynamicAABBs;		//̬ʵǰΧ
+	//¼ÿBLASѹǰĴС󹹽compactBLASʱasBuilderѹ
+	void buildBottomLevelAS_nvvk(const std::vector<nvvk::AccelerationStructureGeometryInfo>& geoInfos);
+	void groupStaticInstances();
+	//ϴtlasInstanceMapдsceneInfo
+	void createTlasInstanceMapBuffer();
 
 	/*
 	1. ȡmeshĶݣVkAccelerationStructureGeometryTrianglesDataKHRõһ
@@ -4,11 +4,14 @@
 #include "common/Shader/nvvk/shaderio.h"
 #include <nvgui/sky.hpp>
 #include <nvvk/default_structs.hpp>
+#include <nvvk/compute_pipeline.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <common/Shader/Shader.h>
 
 FzbRenderer::PathTracingRenderer::PathTracingRenderer(pugi::xml_node& rendererNode) {
+	profileName = "PathTracing";
 	ptContext.setContextInfo();
+	asManager.getSettingFromXML(rendererNode);
 
 	if (pugi::xml_node maxDepthNode = rendererNode.child("maxDepth")) 
 		pushValues.maxDepth = std::stoi(maxDepthNode.attribute("value").value());
@@ -16,7 +19,18 @@ FzbRenderer::PathTracingRenderer::PathTracingRenderer(pugi::xml_node& rendererNo
 		pushValues.spp = std::stoi(sppNode.attribute("value").value());
 	if (pugi::xml_node useNEENode = rendererNode.child("useNEE"))
 		useNEE = std::string(useNEENode.attribute("value").value()) == "true";
-		
+	if (pugi::xml_node wavefrontNode = rendererNode.child("wavefront"))
+		useWavefront = std::string(wavefrontNode.attribute("value").value()) == "true";
+	if (pugi::xml_node wavefrontValidationNode = rendererNode.child("wavefrontValidation"))
+		wavefrontValidationSpp = uint32_t(std::max(std::stoi(wavefrontValidationNode.attribute("value").value()), 0));
+	if (pugi::xml_node samplerNode = rendererNode.child("sampler")) {
+		std::string samplerName = samplerNode.attribute("value").value();
+		if (samplerName == "sobol") pushValues.samplerType = shaderio::SamplerType_Sobol;
+		else if (samplerName == "blueNoise") pushValues.samplerType = shaderio::SamplerType_BlueNoise;
+		else pushValues.samplerType = shaderio::SamplerType_Hash;
+	}
+	if (pugi::xml_node restirDINode = rendererNode.child("ReSTIRDI"))
+		restirDI = std::make_shared<ReSTIRDI>(restirDINode);
 }
 //-----------------------------------------创造光追管线----------------------------------------------------------
 /*
@@ -102,7 +116,15 @@ void FzbRenderer::PathTracingRenderer::createRayTracingDescriptorLayout() {
 			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL});
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	//wavefront的队列，光追管线不使用
+	for (uint32_t binding = shaderio::eWavefrontPathStates_PT; binding <= shaderio::eWavefrontQueueCounts_PT; ++binding) {
+		bindings.addBinding({
+				.binding = binding,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = binding == shaderio::eWavefrontRayQueues_PT ? 2u : 1u,
+				.stageFlags = VK_SHADER_STAGE_ALL });
+	}
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -116,7 +138,7 @@ void FzbRenderer::PathTracingRenderer::createRayTracingDescriptorLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("Ray tracing descriptor layout created\n");
 }
@@ -133,6 +155,8 @@ void FzbRenderer::PathTracingRenderer::createRayTracingDescriptor() {
 	write.append(OutImageWrite, gBuffers.getColorImageView(eImgRendered), VK_IMAGE_LAYOUT_GENERAL);
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+
+	updateWavefrontDescriptor();
 }
 void FzbRenderer::PathTracingRenderer::createRayTracingPipeline() {
 	SCOPED_TIMER(__FUNCTION__);
@@ -165,7 +189,8 @@ void FzbRenderer::PathTracingRenderer::createRayTracingPipeline() {
 
 	addPathTracingSlangMacro();
 	std::string shaderSlangName;
-	if (useNEE) {
+	pipelineUsesReSTIRDI = useReSTIRDI();
+	if (useNEE && !pipelineUsesReSTIRDI) {
 		shaderSlangName = "pathTracingNEEShaders.slang";
 		pushValues.HitTestShaderIndex = 1;
 	}
@@ -282,7 +307,7 @@ void FzbRenderer::PathTracingRenderer::createRayTracingPipeline() {
 #ifdef PathTracingMotionBlur
 	rtPipelineInfo.flags = VK_PIPELINE_CREATE_RAY_TRACING_ALLOW_MOTION_BIT_NV;
 #endif
-	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, {}, 1, & rtPipelineInfo, nullptr, &rtPipeline);
+	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, Application::deviceShaderCache.pipelineCache, 1, & rtPipelineInfo, nullptr, &rtPipeline);
 	NVVK_DBG_NAME(rtPipeline);
 
 	LOGI("Ray tracing pipeline layout created successfully\n");
@@ -330,6 +355,286 @@ void FzbRenderer::PathTracingRenderer::rayTraceScene(VkCommandBuffer cmd) {
 	vkCmdTraceRaysKHR(cmd, &regions.raygen, &regions.miss, &regions.hit, &regions.callable, size.width, size.height, 1);
 }
 
+//-----------------------------------------wavefront----------------------------------------------------------
+/*
+wavefront模式将raygen中的循环拆成多个compute shader，每个bounce依次为
+1. extend：求交，miss直接累加天空光，hit写入hitInfo并加入hit队列，同时统计每种材质的hit数
+2. prepareShade + bin：对材质计数做前缀和，将hit队列按材质做计数排序，使相邻线程执行相同的BSDF分支
+3. shade：自发光、方向光（写入shadow ray队列）、BSDF采样与俄罗斯轮盘，存活的路径写入另一个ray队列
+4. prepareNext + shadow：交换队列并求shadow ray的可见性
+队列长度只在GPU上，所以extend、bin/shade、shadow都使用vkCmdDispatchIndirect
+未开启wavefront时buffer只分配一个元素
+*/
+void FzbRenderer::PathTracingRenderer::createWavefrontBuffers(VkExtent2D size) {
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	allocator->destroyBuffer(wavefrontPathStateBuffer);
+	allocator->destroyBuffer(wavefrontHitInfoBuffer);
+	for (nvvk::Buffer& rayQueueBuffer : wavefrontRayQueueBuffers) allocator->destroyBuffer(rayQueueBuffer);
+	allocator->destroyBuffer(wavefrontHitQueueBuffer);
+	allocator->destroyBuffer(wavefrontSortedHitQueueBuffer);
+	allocator->destroyBuffer(wavefrontShadowRayBuffer);
+	allocator->destroyBuffer(wavefrontQueueCountsBuffer);
+
+	VkDeviceSize pathCount = useWavefront ? std::max(size.width * size.height, 1u) : 1;
+	allocator->createBuffer(wavefrontPathStateBuffer, pathCount * sizeof(shaderio::WavefrontPathState_PT), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontPathStateBuffer.buffer);
+	allocator->createBuffer(wavefrontHitInfoBuffer, pathCount * sizeof(shaderio::WavefrontHitInfo_PT), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontHitInfoBuffer.buffer);
+	for (nvvk::Buffer& rayQueueBuffer : wavefrontRayQueueBuffers) {
+		allocator->createBuffer(rayQueueBuffer, pathCount * sizeof(uint32_t), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+		NVVK_DBG_NAME(rayQueueBuffer.buffer);
+	}
+	allocator->createBuffer(wavefrontHitQueueBuffer, pathCount * sizeof(uint32_t), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontHitQueueBuffer.buffer);
+	allocator->createBuffer(wavefrontSortedHitQueueBuffer, pathCount * sizeof(uint32_t), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontSortedHitQueueBuffer.buffer);
+	allocator->createBuffer(wavefrontShadowRayBuffer, pathCount * sizeof(shaderio::WavefrontShadowRay_PT), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontShadowRayBuffer.buffer);
+	allocator->createBuffer(wavefrontQueueCountsBuffer, sizeof(shaderio::WavefrontQueueCounts_PT),
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_INDIRECT_BUFFER_BIT);
+	NVVK_DBG_NAME(wavefrontQueueCountsBuffer.buffer);
+}
+void FzbRenderer::PathTracingRenderer::updateWavefrontDescriptor() {
+	nvvk::WriteSetContainer write{};
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontPathStates_PT, 0, 0, 1), wavefrontPathStateBuffer, 0, wavefrontPathStateBuffer.bufferSize);
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontHitInfos_PT, 0, 0, 1), wavefrontHitInfoBuffer, 0, wavefrontHitInfoBuffer.bufferSize);
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontRayQueues_PT, 0, 0, uint32_t(wavefrontRayQueueBuffers.size())), wavefrontRayQueueBuffers.data());
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontHitQueue_PT, 0, 0, 1), wavefrontHitQueueBuffer, 0, wavefrontHitQueueBuffer.bufferSize);
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontSortedHitQueue_PT, 0, 0, 1), wavefrontSortedHitQueueBuffer, 0, wavefrontSortedHitQueueBuffer.bufferSize);
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontShadowRays_PT, 0, 0, 1), wavefrontShadowRayBuffer, 0, wavefrontShadowRayBuffer.bufferSize);
+	write.append(staticDescPack.makeWrite(shaderio::eWavefrontQueueCounts_PT, 0, 0, 1), wavefrontQueueCountsBuffer, 0, wavefrontQueueCountsBuffer.bufferSize);
+	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+}
+void FzbRenderer::PathTracingRenderer::createWavefrontShaders() {
+	SCOPED_TIMER(__FUNCTION__);
+	VkDevice device = Application::app->getDevice();
+
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = sizeof(shaderio::WavefrontPushConstant_PT),
+	};
+	std::array<VkDescriptorSetLayout, 2> layouts = { {staticDescPack.getLayout(), dynamicDescPack.getLayout()} };
+	if (wavefrontPipelineLayout == VK_NULL_HANDLE) {
+		const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = layouts.size(),
+			.pSetLayouts = layouts.data(),
+			.pushConstantRangeCount = 1,
+			.pPushConstantRanges = &pushConstantRange,
+		};
+		NVVK_CHECK(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &wavefrontPipelineLayout));
+		NVVK_DBG_NAME(wavefrontPipelineLayout);
+	}
+
+	addPathTracingSlangMacro();
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	std::filesystem::path shaderSource = shaderPath / "pathTracingWavefront.slang";
+	VkShaderModuleCreateInfo shaderCode = FzbRenderer::compileSlangShader(shaderSource, {});
+
+	VkShaderCreateInfoEXT shaderInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+		.nextStage = 0,
+		.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+		.codeSize = shaderCode.codeSize,
+		.pCode = shaderCode.pCode,
+		.pName = "main",
+		.setLayoutCount = layouts.size(),
+		.pSetLayouts = layouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	std::array<std::pair<VkShaderEXT*, const char*>, 8> computeShaders = { {
+		{ &computeShader_generate, "computeMain_generate" },
+		{ &computeShader_extend, "computeMain_extend" },
+		{ &computeShader_prepareShade, "computeMain_prepareShade" },
+		{ &computeShader_bin, "computeMain_bin" },
+		{ &computeShader_shade, "computeMain_shade" },
+		{ &computeShader_prepareNext, "computeMain_prepareNext" },
+		{ &computeShader_shadow, "computeMain_shadow" },
+		{ &computeShader_resolve, "computeMain_resolve" },
+	} };
+	for (auto& [computeShader, entryName] : computeShaders) {
+		vkDestroyShaderEXT(device, *computeShader, nullptr);
+		shaderInfo.pName = entryName;
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, computeShader);
+		NVVK_DBG_NAME(*computeShader);
+	}
+}
+void FzbRenderer::PathTracingRenderer::wavefrontTraceScene(VkCommandBuffer cmd) {
+	NVVK_DBG_SCOPE(cmd);
+
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, wavefrontPipelineLayout, 0, 1,
+		staticDescPack.getSetPtr(), 0, nullptr);
+
+	nvvk::WriteSetContainer write{};
+	write.append(dynamicDescPack.makeWrite(shaderio::DynamicSetBindingPoints_PT::eTlas_PT), asManager.asBuilder.tlas);
+	vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, wavefrontPipelineLayout, 1, write.size(), write.data());
+
+	const VkExtent2D& size = Application::app->getViewportSize();
+	wavefrontPushValues.frameIndex = pushValues.frameIndex;
+	wavefrontPushValues.maxFrameCount = pushValues.maxFrameCount;
+	wavefrontPushValues.maxDepth = pushValues.maxDepth;
+	wavefrontPushValues.spp = pushValues.spp;
+	wavefrontPushValues.sceneSize = shaderio::uint2(size.width, size.height);
+	wavefrontPushValues.sceneInfoAddress = pushValues.sceneInfoAddress;
+	wavefrontPushValues.samplerType = pushValues.samplerType;
+	wavefrontPushValues.samplerTablesAddress = pushValues.samplerTablesAddress;
+	wavefrontPushValues.useNEE = useNEE ? 1 : 0;
+
+	const VkPushConstantsInfo pushInfo{
+		.sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+		.layout = wavefrontPipelineLayout,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.size = sizeof(shaderio::WavefrontPushConstant_PT),
+		.pValues = &wavefrontPushValues
+	};
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	uint32_t pathGroupCount = nvvk::getGroupCounts({ size.width * size.height, 1 }, VkExtent2D{ WAVEFRONT_THREADGROUP_SIZE_PT, 1 }).width;
+	auto dispatchIndirect = [&](VkShaderEXT computeShader, VkDeviceSize offset) {
+		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader);
+		vkCmdDispatchIndirect(cmd, wavefrontQueueCountsBuffer.buffer, offset);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	};
+	auto dispatchSingle = [&](VkShaderEXT computeShader) {
+		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader);
+		vkCmdDispatch(cmd, 1, 1, 1);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+	};
+
+	for (int sampleIndex = 0; sampleIndex < wavefrontPushValues.spp; ++sampleIndex) {
+		wavefrontPushValues.sampleIndex = sampleIndex;
+		wavefrontPushValues.bounceIndex = 0;
+		wavefrontPushValues.rayQueueIndex = 0;
+		vkCmdPushConstants2(cmd, &pushInfo);
+
+		vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_generate);
+		vkCmdDispatch(cmd, pathGroupCount, 1, 1);
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+
+		for (int bounceIndex = 0; bounceIndex < wavefrontPushValues.maxDepth; ++bounceIndex) {
+			wavefrontPushValues.bounceIndex = bounceIndex;
+			wavefrontPushValues.rayQueueIndex = bounceIndex & 1;
+			vkCmdPushConstants2(cmd, &pushInfo);
+
+			dispatchIndirect(computeShader_extend, offsetof(shaderio::WavefrontQueueCounts_PT, extendDispatch));
+			dispatchSingle(computeShader_prepareShade);
+			dispatchIndirect(computeShader_bin, offsetof(shaderio::WavefrontQueueCounts_PT, shadeDispatch));
+			dispatchIndirect(computeShader_shade, offsetof(shaderio::WavefrontQueueCounts_PT, shadeDispatch));
+			dispatchSingle(computeShader_prepareNext);
+			dispatchIndirect(computeShader_shadow, offsetof(shaderio::WavefrontQueueCounts_PT, shadowDispatch));
+		}
+	}
+
+	vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_resolve);
+	vkCmdDispatch(cmd, pathGroupCount, 1, 1);
+}
+
+/*
+wavefront与CPUPathTracer以相同的分辨率、spp与最大深度各渲染一帧，比较整幅图与16x16块的平均radiance
+两者的随机数不同，只比较期望，所以spp要足够大；CPU端不读纹理、不算天空并在快门内采样时刻，这些场景跳过
+*/
+void FzbRenderer::PathTracingRenderer::validateWavefront() {
+	wavefrontValidated = true;
+	SCOPED_TIMER(__FUNCTION__);
+	Scene& sceneResource = Application::sceneResource;
+	bool hasTexture = false;
+	for (const shaderio::BSDFMaterial& material : sceneResource.materials)
+		hasTexture |= material.materialMapIndex.x >= 0 || material.materialMapIndex.y >= 0 || material.materialMapIndex.z >= 0;
+	if (hasTexture || sceneResource.sceneInfo.useSky || sceneResource.hasDynamicLight ||
+		sceneResource.periodInstanceCount + sceneResource.randomInstanceCount > 0) {
+		LOGW("Wavefront validation: skipped, the CPU path tracer renders neither textures, sky nor motion\n");
+		return;
+	}
+
+	nvvk::ResourceAllocator* allocator = &Application::allocator;
+	const VkExtent2D size = Application::app->getViewportSize();
+	const uint32_t pathCount = size.width * size.height;
+	nvvk::Buffer pathStateStageBuffer;
+	allocator->createBuffer(pathStateStageBuffer, VkDeviceSize(pathCount) * sizeof(shaderio::WavefrontPathState_PT), VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	NVVK_DBG_NAME(pathStateStageBuffer.buffer);
+
+	//frameIndex取1，使第一个样本也做像素内抖动；maxFrameCount为1时resolve直接覆盖，不与历史混合
+	shaderio::PathTracingPushConstant lastPushValues = pushValues;
+	pushValues.frameIndex = 1;
+	pushValues.maxFrameCount = 1;
+	pushValues.spp = int(wavefrontValidationSpp);
+
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	wavefrontTraceScene(cmd);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2, .srcOffset = 0, .dstOffset = 0, .size = pathStateStageBuffer.bufferSize };
+	VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2, .srcBuffer = wavefrontPathStateBuffer.buffer,
+		.dstBuffer = pathStateStageBuffer.buffer, .regionCount = 1, .pRegions = &region };
+	vkCmdCopyBuffer2(cmd, &copyInfo);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_HOST_BIT);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	vmaInvalidateAllocation(*allocator, pathStateStageBuffer.allocation, 0, VK_WHOLE_SIZE);
+	pushValues = lastPushValues;
+	resetFrame();
+
+	CPUPathTracerSetting cpuSetting;
+	cpuSetting.spp = wavefrontValidationSpp;
+	cpuSetting.maxDepth = uint32_t(pushValues.maxDepth);
+	cpuSetting.resolution = glm::uvec2(size.width, size.height);
+	std::vector<float> cpuImage = CPUPathTracer::renderImage(cpuSetting);
+	if (cpuImage.empty()) {
+		allocator->destroyBuffer(pathStateStageBuffer);
+		return;
+	}
+
+	//resolve丢弃nan/inf的像素，这里同样按0处理
+	const shaderio::WavefrontPathState_PT* pathStates = static_cast<const shaderio::WavefrontPathState_PT*>(pathStateStageBuffer.mapping);
+	const uint32_t tileSize = 16;
+	const uint32_t tileCountX = (size.width + tileSize - 1) / tileSize;
+	const uint32_t tileCountY = (size.height + tileSize - 1) / tileSize;
+	std::vector<glm::dvec2> tileLuminances(size_t(tileCountX) * tileCountY, glm::dvec2(0.0));	//x为GPU，y为CPU
+	std::vector<uint32_t> tilePixelCounts(tileLuminances.size(), 0);
+	glm::dvec3 gpuMean = glm::dvec3(0.0);
+	glm::dvec3 cpuMean = glm::dvec3(0.0);
+	for (uint32_t y = 0; y < size.height; ++y) {
+		for (uint32_t x = 0; x < size.width; ++x) {
+			uint32_t pixelIndex = y * size.width + x;
+			glm::vec3 gpuRadiance = pathStates[pixelIndex].radiance / float(wavefrontValidationSpp);
+			if (glm::any(glm::isnan(gpuRadiance)) || glm::any(glm::isinf(gpuRadiance))) gpuRadiance = glm::vec3(0.0f);
+			glm::vec3 cpuRadiance = glm::vec3(cpuImage[3 * pixelIndex + 0], cpuImage[3 * pixelIndex + 1], cpuImage[3 * pixelIndex + 2]);
+			gpuMean += glm::dvec3(gpuRadiance);
+			cpuMean += glm::dvec3(cpuRadiance);
+
+			size_t tileIndex = size_t(y / tileSize) * tileCountX + x / tileSize;
+			const glm::vec3 luminanceWeight = glm::vec3(0.2126f, 0.7152f, 0.0722f);
+			tileLuminances[tileIndex] += glm::dvec2(glm::dot(gpuRadiance, luminanceWeight), glm::dot(cpuRadiance, luminanceWeight));
+			++tilePixelCounts[tileIndex];
+		}
+	}
+	gpuMean /= double(pathCount);
+	cpuMean /= double(pathCount);
+	double meanError = 0.0;
+	for (int i = 0; i < 3; ++i) meanError = std::max(meanError, std::abs(gpuMean[i] - cpuMean[i]) / std::max(cpuMean[i], 1e-4));
+
+	//暗块的相对误差由噪声主导，分母不小于整幅图平均亮度的5%
+	const double cpuMeanLuminance = glm::dot(cpuMean, glm::dvec3(0.2126, 0.7152, 0.0722));
+	const double tileTolerance = 0.1;
+	uint32_t mismatchTileCount = 0;
+	double maxTileError = 0.0;
+	for (size_t i = 0; i < tileLuminances.size(); ++i) {
+		glm::dvec2 luminance = tileLuminances[i] / double(tilePixelCounts[i]);
+		double error = std::abs(luminance.x - luminance.y) / std::max(luminance.y, std::max(0.05 * cpuMeanLuminance, 1e-4));
+		maxTileError = std::max(maxTileError, error);
+		if (error > tileTolerance) ++mismatchTileCount;
+	}
+	bool match = meanError <= 0.02 && mismatchTileCount * 100 <= tileLuminances.size();
+	LOGI("Wavefront validation: %ux%u, %u spp, max depth %d, NEE %s, mean GPU (%.4f %.4f %.4f) CPU (%.4f %.4f %.4f), error %.2f%%, %u/%zu tiles above %.0f%% (max %.2f%%), %s\n",
+		size.width, size.height, wavefrontValidationSpp, pushValues.maxDepth, useNEE ? "on" : "off",
+		gpuMean.x, gpuMean.y, gpuMean.z, cpuMean.x, cpuMean.y, cpuMean.z, meanError * 100.0,
+		mismatchTileCount, tileLuminances.size(), tileTolerance * 100.0, maxTileError * 100.0, match ? "match" : "MISMATCH");
+
+	allocator->destroyBuffer(pathStateStageBuffer);
+}
+
 void FzbRenderer::PathTracingRenderer::updateDataPerFrame(VkCommandBuffer cmd) {}
 //-----------------------------------------渲染器行为----------------------------------------------------------
 void FzbRenderer::PathTracingRenderer::init() {
@@ -337,13 +642,16 @@ void FzbRenderer::PathTracingRenderer::init() {
 
 	asManager.init();	//建立AS
 	sbtGenerator.init(Application::app->getDevice(), ptContext.rtProperties);
+	if (restirDI) restirDI->init();
 
 	Renderer::createGBuffer(false, true, 1, {1, 1});
 
 	createRayTracingDescriptorLayout();
 	Renderer::createPipelineLayout(sizeof(shaderio::PathTracingPushConstant));
+	createWavefrontBuffers({ 1, 1 });
 	createRayTracingDescriptor();
 	createRayTracingPipeline();
+	createWavefrontShaders();
 
 	Renderer::init();
 }
@@ -353,15 +661,35 @@ void FzbRenderer::PathTracingRenderer::clean() {
 
 	asManager.clean();
 	sbtGenerator.deinit();
+	if (restirDI) restirDI->clean();
 
 	vkDestroyPipeline(device, rtPipeline, nullptr);
 	Application::allocator.destroyBuffer(sbtBuffer);
+
+	Application::allocator.destroyBuffer(wavefrontPathStateBuffer);
+	Application::allocator.destroyBuffer(wavefrontHitInfoBuffer);
+	for (nvvk::Buffer& rayQueueBuffer : wavefrontRayQueueBuffers) Application::allocator.destroyBuffer(rayQueueBuffer);
+	Application::allocator.destroyBuffer(wavefrontHitQueueBuffer);
+	Application::allocator.destroyBuffer(wavefrontSortedHitQueueBuffer);
+	Application::allocator.destroyBuffer(wavefrontShadowRayBuffer);
+	Application::allocator.destroyBuffer(wavefrontQueueCountsBuffer);
+
+	vkDestroyShaderEXT(device, computeShader_generate, nullptr);
+	vkDestroyShaderEXT(device, computeShader_extend, nullptr);
+	vkDestroyShaderEXT(device, computeShader_prepareShade, nullptr);
+	vkDestroyShaderEXT(device, computeShader_bin, nullptr);
+	vkDestroyShaderEXT(device, computeShader_shade, nullptr);
+	vkDestroyShaderEXT(device, computeShader_prepareNext, nullptr);
+	vkDestroyShaderEXT(device, computeShader_shadow, nullptr);
+	vkDestroyShaderEXT(device, computeShader_resolve, nullptr);
+	vkDestroyPipelineLayout(device, wavefrontPipelineLayout, nullptr);
 };
 void FzbRenderer::PathTracingRenderer::uiRender() {
 	bool& UIModified = Application::UIModified;
 
 	namespace PE = nvgui::PropertyEditor;
 	Application::viewportImage = gBuffers.getDescriptorSet(eImgTonemapped);
+	asManager.uiRender();
 
 	if (ImGui::Begin("PathTracingSettings"))
 	{
@@ -389,6 +717,22 @@ void FzbRenderer::PathTracingRenderer::uiRender() {
 			UIModified |= NEEChange;
 		}
 
+		//wavefront的buffer按视口大小分配，切换时重新创建
+		bool wavefrontChange = ImGui::Checkbox("Wavefront", &useWavefront);
+		if (wavefrontChange) {
+			vkQueueWaitIdle(Application::app->getQueue(0).queue);
+			createWavefrontBuffers(Application::app->getViewportSize());
+			updateWavefrontDescriptor();
+
+			UIModified |= wavefrontChange;
+		}
+
+		//采样器切换后样本序列不同，重新累计
+		PE::begin();
+		UIModified |= PE::Combo("Sampler", (int*)&pushValues.samplerType, "Hash\0Sobol\0BlueNoise\0", shaderio::SamplerType_Count,
+			"Random numbers of the paths (Hash, Owen-scrambled Sobol, blue-noise shifted Sobol)");
+		PE::end();
+
 		if (ptContext.rtPosFetchFeature.rayTracingPositionFetch == VK_FALSE)
 		{
 			ImGui::TextColored({ 1, 0, 0, 1 }, "ERROR: Position Fetch not supported!");
@@ -404,7 +748,20 @@ void FzbRenderer::PathTracingRenderer::uiRender() {
 	}
 	ImGui::End();
 
-	if(UIModified) resetFrame();
+	if (restirDI) {
+		restirDI->uiRender();
+		//开关ReSTIR DI时在NEE与非NEE的shader间切换
+		if (useReSTIRDI() != pipelineUsesReSTIRDI) {
+			vkQueueWaitIdle(Application::app->getQueue(0).queue);
+			createRayTracingPipeline();
+			UIModified = true;
+		}
+	}
+
+	if (UIModified) {
+		resetFrame();
+		if (restirDI) restirDI->resetHistory();
+	}
 };
 void FzbRenderer::PathTracingRenderer::resize(VkCommandBuffer cmd, const VkExtent2D& size) {
 	NVVK_CHECK(gBuffers.update(cmd, size));
@@ -415,6 +772,10 @@ void FzbRenderer::PathTracingRenderer::resize(VkCommandBuffer cmd, const VkExten
 	write.append(OutImageWrite, gBuffers.getColorImageView(eImgRendered), VK_IMAGE_LAYOUT_GENERAL);
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
+
+	createWavefrontBuffers(size);
+	updateWavefrontDescriptor();
+	if (restirDI) restirDI->resize(cmd, size, gBuffers, eImgRendered);
 };
 void FzbRenderer::PathTracingRenderer::preRender() {
 	Scene& scene = Application::sceneResource;
@@ -427,21 +788,62 @@ void FzbRenderer::PathTracingRenderer::preRender() {
 	pushValues.time = Application::sceneResource.time;
 
 	pushValues.sceneInfoAddress = (shaderio::SceneInfo*)Application::sceneResource.bSceneInfo.address;
+	pushValues.samplerTablesAddress = Application::ldSampler.getTablesAddress();
+
+	pushValues.useReSTIRDI = useReSTIRDI() ? 1 : 0;
+	if (pushValues.useReSTIRDI) {
+		restirDI->preRender();
+		pushValues.restirSurfaces = restirDI->getSurfaceAddress();
+	}
 
 	asManager.updateToplevelAS();
+	if (useWavefront && wavefrontValidationSpp > 0 && !wavefrontValidated && Application::frameIndex > 0) validateWavefront();
 }
 void FzbRenderer::PathTracingRenderer::render(VkCommandBuffer cmd) {
 	NVVK_DBG_SCOPE(cmd);
 
 	//maxFrames等于1表示只要一帧，我们就每帧都替换
 	if (pushValues.frameIndex >= maxFrames && maxFrames > 1) return;
+	//低差异采样器的样本序号为frameIndex * spp + sampleIndex，回绕前停止累计
+	if (pushValues.samplerType != shaderio::SamplerType_Hash && maxFrames > 1 &&
+		uint64_t(pushValues.frameIndex + 1) * pushValues.spp > SAMPLER_MAX_SAMPLE_COUNT) return;
 
 	updateDataPerFrame(cmd);
-	rayTraceScene(cmd);
-	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
-	Renderer::postProcess(cmd);
+	if (useWavefront) {
+		{
+			auto section = profileStage(cmd, "WavefrontTraceScene");
+			wavefrontTraceScene(cmd);
+		}
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	}
+	else {
+		{
+			auto section = profileStage(cmd, "RayTraceScene");
+			rayTraceScene(cmd);
+		}
+		nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		if (pushValues.useReSTIRDI) {
+			restirDI->render(cmd, asManager.asBuilder.tlas, maxFrames, nullptr);
+			nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		}
+	}
+	{
+		auto section = profileStage(cmd, "PostProcess");
+		Renderer::postProcess(cmd);
+	}
 };
 
+void FzbRenderer::PathTracingRenderer::collectShaderRequests(std::vector<ShaderCompileRequest>& requests) {
+	std::filesystem::path shaderPath = std::filesystem::path(__FILE__).parent_path() / "shaders";
+	ShaderCompileRequest request;
+	addPathTracingSlangMacro(request.macros);
+	request.shaderSource = shaderPath / (useNEE && !useReSTIRDI() ? "pathTracingNEEShaders.slang" : "pathTracingShaders.slang");
+	requests.push_back(request);
+	request.shaderSource = shaderPath / "pathTracingWavefront.slang";
+	requests.push_back(request);
+	if (restirDI) restirDI->collectShaderRequests(requests);
+}
 void FzbRenderer::PathTracingRenderer::compileAndCreateShaders() {
 	createRayTracingPipeline();
+	createWavefrontShaders();
 };
\ No newline at end of file
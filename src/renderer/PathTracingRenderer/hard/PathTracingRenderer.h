@@ -11,6 +11,7 @@
 #include "common/Application/Application.h"
 #include "AccelerationStructure.h"
 #include <feature/PathTracing/PathTracing.h>
+#include "feature/ReSTIRDI/ReSTIRDI.h"
 
 #ifndef FZB_PATH_TRACING_RENDERER_H
 #define FZB_PATH_TRACING_RENDERER_H
@@ -32,6 +33,7 @@ public:
 	void render(VkCommandBuffer cmd) override;
 
 	void compileAndCreateShaders() override;
+	void collectShaderRequests(std::vector<ShaderCompileRequest>& requests) override;
 	void updateDataPerFrame(VkCommandBuffer cmd) override;
 
 	virtual void createRayTracingDescriptorLayout();
@@ -39,7 +41,15 @@ public:
 	virtual void createRayTracingPipeline();
 	void rayTraceScene(VkCommandBuffer cmd);
 
+	void createWavefrontBuffers(VkExtent2D size);
+	void updateWavefrontDescriptor();
+	void createWavefrontShaders();
+	void wavefrontTraceScene(VkCommandBuffer cmd);
+	void validateWavefront();
+
 	void resetFrame() { Application::frameIndex = 0; };
+	//ReSTIR DIֻNEEĹ׷ߣNEEwavefrontָԵֱӹ
+	bool useReSTIRDI() const { return restirDI && restirDI->enable && !useWavefront; }
 
 	int maxFrames = (MAX_FRAME) / 2;
 
@@ -52,10 +62,35 @@ public:
 	AccelerationStructureManager asManager;
 	nvvk::SBTGenerator sbtGenerator;
 	nvvk::Buffer sbtBuffer;
+
+	nvvk::Buffer wavefrontPathStateBuffer;
+	nvvk::Buffer wavefrontHitInfoBuffer;
+	std::array<nvvk::Buffer, 2> wavefrontRayQueueBuffers;
+	nvvk::Buffer wavefrontHitQueueBuffer;
+	nvvk::Buffer wavefrontSortedHitQueueBuffer;
+	nvvk::Buffer wavefrontShadowRayBuffer;
+	nvvk::Buffer wavefrontQueueCountsBuffer;
+
+	std::shared_ptr<ReSTIRDI> restirDI;
 private:
 	shaderio::PathTracingPushConstant pushValues{};
+	shaderio::WavefrontPushConstant_PT wavefrontPushValues{};
 
 	bool useNEE = true;
+	bool useWavefront = false;
+	uint32_t wavefrontValidationSpp = 0;
+	bool wavefrontValidated = false;
+	bool pipelineUsesReSTIRDI = false;		//rtPipelineʱǷReSTIR DI˷NEEshader
+
+	VkPipelineLayout wavefrontPipelineLayout{};
+	VkShaderEXT computeShader_generate{};
+	VkShaderEXT computeShader_extend{};
+	VkShaderEXT computeShader_prepareShade{};
+	VkShaderEXT computeShader_bin{};
+	VkShaderEXT computeShader_shade{};
+	VkShaderEXT computeShader_prepareNext{};
+	VkShaderEXT computeShader_shadow{};
+	VkShaderEXT computeShader_resolve{};
 };
 
 }
@@ -7,7 +7,73 @@
 #define FZBRENDERER_PATHTRACING_SHADER_IO_H
 NAMESPACE_SHADERIO_BEGIN()
 
+//------------------------------------------------wavefront------------------------------------------------
+#define WAVEFRONT_THREADGROUP_SIZE_PT 128
+#define WAVEFRONT_MATERIAL_TYPE_COUNT_PT 5		// MaterialType::Diffuse ... MaterialType::RoughDielectric
 
+enum WavefrontBindingPoints_PT {
+	eWavefrontPathStates_PT = 2,		// after StaticSetBindingPoints_PT
+	eWavefrontHitInfos_PT,
+	eWavefrontRayQueues_PT,			// 2 queues, ping-pong between bounces
+	eWavefrontHitQueue_PT,
+	eWavefrontSortedHitQueue_PT,
+	eWavefrontShadowRays_PT,
+	eWavefrontQueueCounts_PT,
+};
+
+// one path per pixel, the path index is the pixel index
+struct WavefrontPathState_PT {
+	float3 origin;
+	uint2 randomSeed;		// SAMPLER_STATE, see common/Sampler/SamplerShaderio.h
+	float3 direction;
+	uint isExt;
+	float3 throughput;		// bsdf * cosine / pdf
+	float3 radiance;		// accumulated over all samples of this frame
+	uint lastDelta;			// the last bounce sampled a delta BSDF, with NEE the emission of area lights is only taken then
+};
+struct WavefrontHitInfo_PT {
+	float3 hitPos;
+	uint instanceIndex;
+	float3 hitNormal;		// geometric normal, facing the incoming ray
+	uint primitiveIndex;
+	float2 barycentrics;
+	float cosineON;
+	uint materialType;
+};
+struct WavefrontShadowRay_PT {
+	float3 origin;
+	uint pathIndex;
+	float3 direction;
+	float tMax;
+	float3 radiance;		// added to the path if the ray is not occluded
+};
+// indirect dispatch arguments of the extend, bin/shade and shadow kernels are written on GPU
+struct WavefrontQueueCounts_PT {
+	DispatchIndirectCommand extendDispatch;
+	DispatchIndirectCommand shadeDispatch;
+	DispatchIndirectCommand shadowDispatch;
+	uint rayCount;
+	uint nextRayCount;
+	uint hitCount;
+	uint shadowRayCount;
+	uint materialCounts[WAVEFRONT_MATERIAL_TYPE_COUNT_PT];		// hits per material, reused as bin cursors
+	uint materialOffsets[WAVEFRONT_MATERIAL_TYPE_COUNT_PT];
+};
+
+struct WavefrontPushConstant_PT {
+	int frameIndex = 0;
+	int maxFrameCount = 1;
+	int maxDepth = 3;
+	int spp = 1;
+	int sampleIndex = 0;
+	int bounceIndex = 0;
+	uint rayQueueIndex = 0;		// queue read by extend, shade writes the other one
+	uint2 sceneSize;
+	uint samplerType = 0;		// SamplerType
+	SceneInfo* sceneInfoAddress;
+	SamplerTables* samplerTablesAddress;
+	uint useNEE = 1;			// NEE of computeMain_shade, the same estimator as CPUPathTracer
+};
 
 NAMESPACE_SHADERIO_END()
 #endif
\ No newline at end of file
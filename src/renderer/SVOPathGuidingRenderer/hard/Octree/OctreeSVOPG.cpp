@@ -5,6 +5,7 @@
 #include <common/Shader/Shader.h>
 #include <nvvk/compute_pipeline.hpp>
 #include <bit>
+#include <numeric>
 #include <nvvk/default_structs.hpp>
 #include <nvgui/property_editor.hpp>
 
@@ -51,6 +52,9 @@ void Octree_SVOPG::clean() {
 
 	Application::allocator.destroyBuffer(indivisibleNodeInfosBuffer_G);
 	Application::allocator.destroyBuffer(indivisibleNodeInfosBuffer_E);
+	Application::allocator.destroyBuffer(indivisibleNodeFlagsBuffer_E);
+	Application::allocator.destroyBuffer(nodeIndexBuffer_E);
+	Application::allocator.destroyBuffer(indivisibleNodeCountBuffer_E);
 
 	vkDestroyShaderEXT(device, computeShader_getOctreeLabel1, nullptr);
 	vkDestroyShaderEXT(device, computeShader_getOctreeLabel2, nullptr);
@@ -310,6 +314,27 @@ void Octree_SVOPG::createOctreeArray() {
 	allocator->createBuffer(indivisibleNodeInfosBuffer_E, bufferSize,
 		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
 	NVVK_DBG_NAME(indivisibleNodeInfosBuffer_E.buffer);
+
+	allocator->createBuffer(indivisibleNodeFlagsBuffer_E, bufferSize,
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+	NVVK_DBG_NAME(indivisibleNodeFlagsBuffer_E.buffer);
+
+	std::vector<uint32_t> nodeIndices(NODECOUNT_E);
+	std::iota(nodeIndices.begin(), nodeIndices.end(), 0u);
+	allocator->createBuffer(nodeIndexBuffer_E, bufferSize,
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT);
+	NVVK_DBG_NAME(nodeIndexBuffer_E.buffer);
+	NVVK_CHECK(stagingUploader.appendBuffer(nodeIndexBuffer_E, 0, std::span(nodeIndices)));
+	VkCommandBuffer cmd = Application::app->createTempCmdBuffer();
+	stagingUploader.cmdUploadAppended(cmd);
+	Application::app->submitAndWaitTempCmdBuffer(cmd);
+	stagingUploader.releaseStaging();
+
+	allocator->createBuffer(indivisibleNodeCountBuffer_E, sizeof(uint32_t),
+		VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
+	NVVK_DBG_NAME(indivisibleNodeCountBuffer_E.buffer);
+
+	Application::primitives.reserve(NODECOUNT_E, false, true);
 	#endif
 
 	pushConstant.octreeMaxLayer = setting.OctreeLayerCount;
@@ -399,9 +424,14 @@ void Octree_SVOPG::createDescriptorSetLayout() {
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
 		.descriptorCount = 1,
 		.stageFlags = VK_SHADER_STAGE_ALL });
+	bindings.addBinding({
+		.binding = (uint32_t)shaderio::BindingPoints_Octree_SVOPG::eIndivisibleNodeFlags_E,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_ALL });
 	#endif
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -476,6 +506,10 @@ void Octree_SVOPG::createDescriptorSet() {
 	IndivisibleInfoWrite =
 		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_SVOPG::eIndivisibleNodeInfos_E, 0, 0, 1);
 	write.append(IndivisibleInfoWrite, indivisibleNodeInfosBuffer_E, 0, indivisibleNodeInfosBuffer_E.bufferSize);
+
+	IndivisibleInfoWrite =
+		staticDescPack.makeWrite((uint32_t)shaderio::BindingPoints_Octree_SVOPG::eIndivisibleNodeFlags_E, 0, 0, 1);
+	write.append(IndivisibleInfoWrite, indivisibleNodeFlagsBuffer_E, 0, indivisibleNodeFlagsBuffer_E.bufferSize);
 	#endif
 
 	vkUpdateDescriptorSets(Application::app->getDevice(), write.size(), write.data(), 0, nullptr);
@@ -528,7 +562,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initOctreeArray);
 	NVVK_DBG_NAME(computeShader_initOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_initHasDataBlockInfo, nullptr);
@@ -538,7 +572,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_initHasDataBlockInfo";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initHasDataBlockInfo);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initHasDataBlockInfo);
 	NVVK_DBG_NAME(computeShader_initHasDataBlockInfo);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getGlobalInfo, nullptr);
@@ -548,7 +582,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getGlobalInfo";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getGlobalInfo);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getGlobalInfo);
 	NVVK_DBG_NAME(computeShader_getGlobalInfo);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray, nullptr);
@@ -558,7 +592,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray);
 	NVVK_DBG_NAME(computeShader_createOctreeArray);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_createOctreeArray2, nullptr);
@@ -568,7 +602,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_createOctreeArray2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_createOctreeArray2);
 	NVVK_DBG_NAME(computeShader_createOctreeArray2);
 #ifndef USE_SVO
 	//--------------------------------------------------------------------------------------
@@ -579,7 +613,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getOctreeLabel1";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel1);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel1);
 	NVVK_DBG_NAME(computeShader_getOctreeLabel1);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getOctreeLabel2, nullptr);
@@ -589,7 +623,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getOctreeLabel2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel2);
 	NVVK_DBG_NAME(computeShader_getOctreeLabel2);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getOctreeLabel3, nullptr);
@@ -599,7 +633,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getOctreeLabel3";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel3);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getOctreeLabel3);
 	NVVK_DBG_NAME(computeShader_getOctreeLabel3);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_getIndivisibleNodeInfos, nullptr);
@@ -609,7 +643,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getIndivisibleInfos";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getIndivisibleNodeInfos);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getIndivisibleNodeInfos);
 	NVVK_DBG_NAME(computeShader_getIndivisibleNodeInfos);
 
 	#ifndef NDEBUG
@@ -622,7 +656,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Wireframe2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Wireframe2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Wireframe2);
 	NVVK_DBG_NAME(vertexShader_Wireframe2);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -630,7 +664,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe2";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe2);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe2);
 	NVVK_DBG_NAME(fragmentShader_Wireframe2);
 	#endif
 #endif
@@ -645,7 +679,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Wireframe);
 	NVVK_DBG_NAME(vertexShader_Wireframe);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -653,7 +687,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 	//---------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, computeShader_MergeResult, nullptr);
@@ -663,7 +697,7 @@ void Octree_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_MergeResult";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_MergeResult);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_MergeResult);
 	NVVK_DBG_NAME(computeShader_MergeResult);
 #endif
 }
@@ -751,6 +785,21 @@ void Octree_SVOPG::getIndivisibleNodeInfos(VkCommandBuffer cmd) {
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
 	vkCmdBindShadersEXT(cmd, 1, &stage, &computeShader_getIndivisibleNodeInfos);
 	vkCmdDispatch(cmd, 1, 1, 1);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	Application::primitives.cmdCompact(cmd, indivisibleNodeFlagsBuffer_E, nodeIndexBuffer_E, indivisibleNodeInfosBuffer_E,
+		indivisibleNodeCountBuffer_E, NODECOUNT_E);
+	VkBufferCopy region{
+		.srcOffset = 0,
+		.dstOffset = offsetof(shaderio::OctreeGlobalInfo, indivisibleNodeCount_E),
+		.size = sizeof(uint32_t)
+	};
+	vkCmdCopyBuffer(cmd, indivisibleNodeCountBuffer_E.buffer, GlobalInfoBuffer.buffer, 1, &region);
+	nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+	//GPUPrimitivesʹԼpipeline layoutpush descriptorָ˲descriptor set
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+		staticDescPack.getSetPtr(), 0, nullptr);
 }
 #endif
 
@@ -77,6 +77,10 @@ private:
 	nvvk::Buffer divisibleNodeInfos_G;		//ÿϸֽڵ
 	nvvk::Buffer threadGroupInfos;
 
+	nvvk::Buffer indivisibleNodeFlagsBuffer_E;	//getIndivisibleInfosд룬GPUPrimitives::cmdCompactѹindivisibleNodeInfosBuffer_E
+	nvvk::Buffer nodeIndexBuffer_E;				//0, 1, ..., NODECOUNT_E - 1ѹvalue
+	nvvk::Buffer indivisibleNodeCountBuffer_E;
+
 	VkShaderEXT computeShader_getOctreeLabel1{};
 	VkShaderEXT computeShader_getOctreeLabel2{};
 	VkShaderEXT computeShader_getOctreeLabel3{};
@@ -33,6 +33,7 @@ enum class BindingPoints_Octree_SVOPG : uint32_t {
 
 	eIndivisibleNodeInfos_G,
 	eIndivisibleNodeInfos_E,
+	eIndivisibleNodeFlags_E,
 #endif
 };
 
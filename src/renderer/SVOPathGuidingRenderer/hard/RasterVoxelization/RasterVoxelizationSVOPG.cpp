@@ -389,7 +389,7 @@ void RasterVoxelization_SVOPG::createDescriptorSetLayout() {
 		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
 		| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
 #endif
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -470,7 +470,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_clearVGB";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_clearVGB);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_clearVGB);
 	NVVK_DBG_NAME(computeShader_clearVGB);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader, nullptr);
@@ -480,7 +480,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader);
 	NVVK_DBG_NAME(vertexShader);
 #ifndef NDEBUG
 	//------------------------------------------ThreeView--------------------------------------
@@ -492,7 +492,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader_ThreeView);
 	NVVK_DBG_NAME(geometryShader_ThreeView);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -500,7 +500,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_ThreeView";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_ThreeView);
 	NVVK_DBG_NAME(fragmentShader_ThreeView);
 	//-------------------------------------------Cube--------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_Cube, nullptr);
@@ -511,7 +511,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_Cube);
 	NVVK_DBG_NAME(vertexShader_Cube);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -519,7 +519,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Cube";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Cube);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Cube);
 	NVVK_DBG_NAME(fragmentShader_Cube);
 	//-------------------------------------------Wireframe--------------------------------------
 	vkDestroyShaderEXT(device, fragmentShader_Wireframe, nullptr);
@@ -529,7 +529,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_Wireframe";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_Wireframe);
 	NVVK_DBG_NAME(fragmentShader_Wireframe);
 	//-------------------------------------------PostProcess--------------------------------------
 	vkDestroyShaderEXT(device, computeShader_postProcess, nullptr);
@@ -539,7 +539,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_postProcess";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_postProcess);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_postProcess);
 	NVVK_DBG_NAME(computeShader_postProcess);
 #else
 	vkDestroyShaderEXT(device, geometryShader, nullptr);
@@ -550,7 +550,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "geometryMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &geometryShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &geometryShader);
 	NVVK_DBG_NAME(geometryShader);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -558,7 +558,7 @@ void RasterVoxelization_SVOPG::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader);
 	NVVK_DBG_NAME(fragmentShader);
 #endif
 }
@@ -8,6 +8,7 @@ using namespace FzbRenderer;
 
 SVOPathGuidingRenderer::SVOPathGuidingRenderer(pugi::xml_node& rendererNode) {
 	ptContext.setContextInfo();
+	asManager.getSettingFromXML(rendererNode);
 
 	if (pugi::xml_node maxDepthNode = rendererNode.child("maxDepth"))
 		pushConstant.maxDepth = std::stoi(maxDepthNode.attribute("value").value());
@@ -108,6 +109,7 @@ void FzbRenderer::SVOPathGuidingRenderer::uiRender() {
 	
 	namespace PE = nvgui::PropertyEditor;
 	Application::viewportImage = gBuffers.getDescriptorSet(eImgTonemapped);
+	asManager.uiRender();
 	
 	if (ImGui::Begin("SVOPathGuidingSettings"))
 	{
@@ -300,7 +302,7 @@ void FzbRenderer::SVOPathGuidingRenderer::createDescriptorSetLayout() {
 		.stageFlags = VK_SHADER_STAGE_ALL });
 #endif
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	LOGI("SVO PathGuiding static descriptor layout created\n");
@@ -315,7 +317,7 @@ void FzbRenderer::SVOPathGuidingRenderer::createDescriptorSetLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("SVO PathGuiding dynamic descriptor layout created\n");
 }
@@ -414,7 +416,7 @@ void FzbRenderer::SVOPathGuidingRenderer::createShader() {
 		shaderInfo.pName = "computeMain_SVOPathGuiding";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_SVOPathGuiding);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_SVOPathGuiding);
 		NVVK_DBG_NAME(computeShader_SVOPathGuiding);
 	}
 }
@@ -554,7 +556,7 @@ void FzbRenderer::SVOPathGuidingRenderer::createPipeline() {
 #ifdef PathTracingMotionBlur
 	rtPipelineInfo.flags = VK_PIPELINE_CREATE_RAY_TRACING_ALLOW_MOTION_BIT_NV;
 #endif
-	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, {}, 1, &rtPipelineInfo, nullptr, &rtPipeline);
+	vkCreateRayTracingPipelinesKHR(Application::app->getDevice(), {}, Application::deviceShaderCache.pipelineCache, 1, &rtPipelineInfo, nullptr, &rtPipeline);
 	NVVK_DBG_NAME(rtPipeline);
 
 	LOGI("Ray tracing pipeline layout created successfully\n");
@@ -275,7 +275,7 @@ void SVOWeight::createDescriptorSetLayout() {
 				 .stageFlags = VK_SHADER_STAGE_ALL });
 	#endif
 
-	staticDescPack.init(bindings, Application::app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+	Application::deviceShaderCache.initDescriptorPack(staticDescPack, bindings, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
 	NVVK_DBG_NAME(staticDescPack.getLayout());
@@ -289,7 +289,7 @@ void SVOWeight::createDescriptorSetLayout() {
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_ALL
 		});
-	dynamicDescPack.init(bindings, Application::app->getDevice(), 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+	Application::deviceShaderCache.initDescriptorPack(dynamicDescPack, bindings, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
 
 	LOGI("LightInject ray tracing dynamic descriptor layout created\n");
 }
@@ -420,7 +420,7 @@ void SVOWeight::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_initWeights";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_initWeights);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_initWeights);
 		NVVK_DBG_NAME(computeShader_initWeights);
 	}
 	//--------------------------------------------------------------------------------------
@@ -432,7 +432,7 @@ void SVOWeight::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getWeights";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getWeights);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getWeights);
 		NVVK_DBG_NAME(computeShader_getWeights);
 	}
 	//--------------------------------------------------------------------------------------
@@ -444,7 +444,7 @@ void SVOWeight::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getProbability";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getProbability);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getProbability);
 		NVVK_DBG_NAME(computeShader_getProbability);
 	}
 	//--------------------------------------------------------------------------------------
@@ -456,7 +456,7 @@ void SVOWeight::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getNearbyNodes";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes);
 		NVVK_DBG_NAME(computeShader_getNearbyNodes);
 	}
 	//--------------------------------------------------------------------------------------
@@ -468,7 +468,7 @@ void SVOWeight::compileAndCreateShaders() {
 		shaderInfo.pName = "computeMain_getNearbyNodes2";
 		shaderInfo.codeSize = shaderCode.codeSize;
 		shaderInfo.pCode = shaderCode.pCode;
-		vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes2);
+		Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getNearbyNodes2);
 		NVVK_DBG_NAME(computeShader_getNearbyNodes2);
 	}
 
@@ -480,7 +480,7 @@ void SVOWeight::compileAndCreateShaders() {
 	shaderInfo.pName = "computeMain_getSampleNodeInfo";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &computeShader_getSampleNodeInfo);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &computeShader_getSampleNodeInfo);
 	NVVK_DBG_NAME(computeShader_getSampleNodeInfo);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_visualization, nullptr);
@@ -491,7 +491,7 @@ void SVOWeight::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_visualization);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_visualization);
 	NVVK_DBG_NAME(vertexShader_visualization);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -499,7 +499,7 @@ void SVOWeight::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_visualization);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_visualization);
 	NVVK_DBG_NAME(fragmentShader_visualization);
 	//--------------------------------------------------------------------------------------
 	vkDestroyShaderEXT(device, vertexShader_nearby, nullptr);
@@ -510,7 +510,7 @@ void SVOWeight::compileAndCreateShaders() {
 	shaderInfo.pName = "vertexMain_nearby";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &vertexShader_nearby);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &vertexShader_nearby);
 	NVVK_DBG_NAME(vertexShader_nearby);
 
 	shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -518,7 +518,7 @@ void SVOWeight::compileAndCreateShaders() {
 	shaderInfo.pName = "fragmentMain_nearby";
 	shaderInfo.codeSize = shaderCode.codeSize;
 	shaderInfo.pCode = shaderCode.pCode;
-	vkCreateShadersEXT(device, 1U, &shaderInfo, nullptr, &fragmentShader_nearby);
+	Application::deviceShaderCache.createShaders(1U, &shaderInfo, nullptr, &fragmentShader_nearby);
 	NVVK_DBG_NAME(fragmentShader_nearby);
 #endif
 }
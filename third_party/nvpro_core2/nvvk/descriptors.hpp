@@ -100,6 +100,8 @@ public:
 
   // Returns the bindings that were added
   const std::vector<VkDescriptorSetLayoutBinding>& getBindings() const { return m_bindings; }
+  // Returns the binding flags, in the same order as getBindings()
+  const std::vector<VkDescriptorBindingFlags>& getBindingFlags() const { return m_bindingFlags; }
 
 private:
   std::vector<VkDescriptorSetLayoutBinding> m_bindings;